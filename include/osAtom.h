@@ -0,0 +1,59 @@
+/**
+ * @file osAtom.h  Interface to the string interning
+ *
+ * Copyright (C) 2020, Sean Dai
+ *
+ * A string is interned once into a atom, a small integer that is unique for the string content.  Two
+ * interned strings are equal if and only if their atoms are equal.  The table keeps a canonical copy of
+ * each string and its hash for the process life time, it is meant for names from a bounded set, like
+ * header names, xsd element/type names and namespaces, not for the arbitrary content of a message.
+ *
+ * All functions are thread safe, osAtom_getPL()/osAtom_getHash() do not take any lock.
+ */
+
+#ifndef _OS_ATOM_H
+#define _OS_ATOM_H
+
+#include <stdint.h>
+
+#include "osTypes.h"
+#include "osPL.h"
+
+
+#define OS_ATOM_NONE			0			//not a atom, a pl that is not interned
+#define OS_ATOM_PAGE_SIZE		256			//number of atoms per page
+#define OS_ATOM_MAX_PAGE		256			//max number of atoms = OS_ATOM_PAGE_SIZE * OS_ATOM_MAX_PAGE - 1, the hash table is then 1MB, the largest premem block
+#define OS_ATOM_INIT_TABLE_SIZE	1024		//initial number of hash table slots, doubled when half of the slots are used
+#define OS_ATOM_STR_BLOCK_SIZE	8192		//size of a memory block the canonical strings are carved from
+
+
+typedef uint32_t osAtom_t;
+
+
+/* intern pl, return the atom of pl, or OS_ATOM_NONE if there is no memory.  If isCaseFold = true, pl
+ * is interned as its lower case form, i.e., the atom of ("Via", true) equals to the atom of ("via", false) */
+osAtom_t osAtom_intern(const osPointerLen_t* pl, bool isCaseFold);
+//same as osAtom_intern(), but does not add pl into the table, return OS_ATOM_NONE if pl has not been interned
+osAtom_t osAtom_find(const osPointerLen_t* pl, bool isCaseFold);
+//the canonical string of a atom, it is NUL terminated.  return NULL for a invalid atom
+const osPointerLen_t* osAtom_getPL(osAtom_t atom);
+//the hash of a atom's string, can be used directly as a hash key
+uint32_t osAtom_getHash(osAtom_t atom);
+//number of atoms interned
+uint32_t osAtom_getNum(void);
+
+
+/* compare two PLs that may have atoms.  A atom of OS_ATOM_NONE means the pl has not been looked up or
+ * has not been interned, in that case, the PLs are compared directly */
+static inline bool osAtom_isPLEqual(osAtom_t atom1, const osPointerLen_t* pl1, osAtom_t atom2, const osPointerLen_t* pl2)
+{
+	if(atom1 != OS_ATOM_NONE && atom2 != OS_ATOM_NONE)
+	{
+		return atom1 == atom2;
+	}
+
+	return osPL_cmp(pl1, pl2) == 0;
+}
+
+
+#endif
@@ -14,6 +14,7 @@
 #include <pthread.h>
 
 #include "osTypes.h"
+#include "osTime.h"
 
 
 /** Debug levels */
@@ -45,6 +46,51 @@ typedef enum {
 
 
 
+/* a log call site, one static instance per log macro expansion, used by the log rate limiting and the binary log */
+typedef struct osDbgSite {
+	const char* file;
+	const char* func;
+	int line;
+	const char* levelStr;		//the level string in the text log prefix, NULL for debug logs, which do not print the level
+	bool isNoPrefix;			//true for mdebug1 alike logs that have no prefix
+	const char* fmt;			//the fmt recorded for the site in the binary log
+	uint32_t siteId;			//assigned when the site logs the first time, 0 means not assigned
+	uint32_t fileGen;			//the binary log file generation the site was last written into
+	uint64_t tatUsec;			//rate limiting, the theoretical arrival time of the next log, atomically updated
+	uint32_t suppressed;		//rate limiting, the number of logs suppressed since the last logged one, atomically updated
+} osDbgSite_t;
+
+
+#define OS_DBG_SUPPRESSED_FMT	"suppressed %u messages"
+
+#define OS_DBG_SITE(levelStr, isNoPrefix) \
+	static osDbgSite_t osDbgSite = {__FILE__, __func__, __LINE__, levelStr, isNoPrefix}
+
+//drop the log if the call site exceeds its rate, osDbgSuppressed is set to the number of logs dropped before this one
+#define OS_DBG_RATE_LIMIT() \
+	uint32_t osDbgSuppressed = 0; \
+	if(osDbg_isRateLimited(&osDbgSite, &osDbgSuppressed)) \
+		continue
+
+//when the binary log is on, log the raw arguments of a call site into the binary log file instead of formatting the text log
+#define OS_DBG_BIN_LOG(level, module, suppressed, ...) \
+	if(osDbg_isBinary()) \
+	{ \
+		if(suppressed) \
+			osDbg_binPrintf(level, module, &osDbgSite, OS_DBG_SUPPRESSED_FMT, suppressed); \
+		osDbg_binPrintf(level, module, &osDbgSite, __VA_ARGS__); \
+		continue; \
+	}
+
+//a summary line of the logs dropped by the rate limiting, using the same prefix as the log
+#define OS_DBG_SUPPRESSED_LOG(level, dstr) \
+	if(osDbgSuppressed) \
+	{ \
+		osDbg_printf(level, OS_DBG_SUPPRESSED_FMT "\n", osDbgSuppressed); \
+		osDbg_printf(level, dstr); \
+	}
+
+
 //note: filename is used here.  According to basename() man page, it may not be safe to pass in __FILE__directly here.  
 //People suggest to take a copy of __FILE__ and do basename() on it, like char* filename = strdup(__FILE__); ... free(filename), 
 //or even a simpler way: char filename[]=__FILE__;  I also see there is a propsal to provide a compile time macro for the basename, 
@@ -55,14 +101,13 @@ typedef enum {
 //might be invalidated or the storage might be overwritten by a subsequent call to basename().
 #define logEmerg(...) \
 do {\
-	struct timespec tp; \
-	struct tm d; \
-	clock_gettime(CLOCK_REALTIME, &tp); \
-	gmtime_r(&tp.tv_sec, &d); \
-	pthread_t tid = pthread_self();	\
+	OS_DBG_SITE("Emergency", false); \
+	OS_DBG_BIN_LOG(DBG_EMERG, LM_ALL, 0, __VA_ARGS__); \
+	const osTimeCache_t* pTimeCache = osTime_updateCache(); \
+	pthread_t tid = pthread_self(); \
 	char dstr[200];  \
 	char filename[]=__FILE__;	\
-	sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Emergency] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+	sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Emergency] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
 	osDbg_printf(DBG_EMERG, dstr); \
 	osDbg_printf(DBG_EMERG, __VA_ARGS__);\
 	osDbg_printf(DBG_EMERG, "\n");\
@@ -72,15 +117,16 @@ do {\
 do {\
 	if(osDbg_isBypass(DBG_ALERT, LM_ALL)) \
 		continue;	\
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
-    pthread_t tid = pthread_self();	\
-    gmtime_r(&tp.tv_sec, &d); \
+    OS_DBG_SITE("Alert", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_ALERT, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
+    pthread_t tid = pthread_self(); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Alert] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Alert] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_ALERT, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_ALERT, dstr); \
     osDbg_printf(DBG_ALERT, __VA_ARGS__);\
 	osDbg_printf(DBG_ALERT, "\n");\
 } while(0);\
@@ -90,15 +136,16 @@ do {\
 do {\
 	if(osDbg_isBypass(DBG_CRIT, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Critical", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_CRIT, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Critical] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Critical] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_CRIT, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_CRIT, dstr); \
     osDbg_printf(DBG_CRIT, __VA_ARGS__);\
     osDbg_printf(DBG_CRIT, "\n");\
 } while(0);\
@@ -108,15 +155,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_ERROR, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Error", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_ERROR, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Error] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Error] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_ERROR, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_ERROR, dstr); \
     osDbg_printf(DBG_ERROR, __VA_ARGS__);\
     osDbg_printf(DBG_ERROR, "\n");\
 } while(0);\
@@ -126,15 +174,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_WARNING, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Warning", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_WARNING, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Warning] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Warning] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_WARNING, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_WARNING, dstr); \
     osDbg_printf(DBG_WARNING, __VA_ARGS__);\
     osDbg_printf(DBG_WARNING, "\n");\
 } while(0);\
@@ -144,15 +193,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_NOTICE, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Notice", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_NOTICE, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Notice] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Notice] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_NOTICE, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_NOTICE, dstr); \
     osDbg_printf(DBG_NOTICE, __VA_ARGS__);\
     osDbg_printf(DBG_NOTICE, "\n");\
 } while(0);\
@@ -162,15 +212,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_INFO, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Info", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_INFO, LM_ALL, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Info] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Info] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_INFO, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_INFO, dstr); \
     osDbg_printf(DBG_INFO, __VA_ARGS__);\
     osDbg_printf(DBG_INFO, "\n");\
 } while(0);\
@@ -180,14 +231,13 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_DEBUG, LM_ALL)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE(NULL, false); \
+    OS_DBG_BIN_LOG(DBG_DEBUG, LM_ALL, 0, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_DEBUG, dstr); \
     osDbg_printf(DBG_DEBUG, __VA_ARGS__);\
     osDbg_printf(DBG_DEBUG, "\n");\
@@ -204,15 +254,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_ALERT, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Alert", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_ALERT, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Alert] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Alert] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_ALERT, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_ALERT, dstr); \
     osDbg_printf(DBG_ALERT, __VA_ARGS__);\
     osDbg_printf(DBG_ALERT, "\n");\
 } while(0);\
@@ -222,15 +273,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_CRIT, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Critical", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_CRIT, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Critical] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Critical] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_CRIT, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_CRIT, dstr); \
     osDbg_printf(DBG_CRIT, __VA_ARGS__);\
     osDbg_printf(DBG_CRIT, "\n");\
 } while(0);\
@@ -240,15 +292,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_ERROR, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Error", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_ERROR, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Error] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Error] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_ERROR, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_ERROR, dstr); \
     osDbg_printf(DBG_ERROR, __VA_ARGS__);\
     osDbg_printf(DBG_ERROR, "\n");\
 } while(0);\
@@ -258,15 +311,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_WARNING, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Warning", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_WARNING, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Warning] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Warning] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_WARNING, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_WARNING, dstr); \
     osDbg_printf(DBG_WARNING, __VA_ARGS__);\
     osDbg_printf(DBG_WARNING, "\n");\
 } while(0);\
@@ -276,15 +330,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_NOTICE, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Notice", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_NOTICE, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Notice] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Notice] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_NOTICE, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_NOTICE, dstr); \
     osDbg_printf(DBG_NOTICE, __VA_ARGS__);\
     osDbg_printf(DBG_NOTICE, "\n");\
 } while(0);\
@@ -294,15 +349,16 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_INFO, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE("Info", false); \
+    OS_DBG_RATE_LIMIT(); \
+    OS_DBG_BIN_LOG(DBG_INFO, module, osDbgSuppressed, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, Info] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d, Info] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_INFO, dstr); \
+    OS_DBG_SUPPRESSED_LOG(DBG_INFO, dstr); \
     osDbg_printf(DBG_INFO, __VA_ARGS__);\
     osDbg_printf(DBG_INFO, "\n");\
 } while(0);\
@@ -312,14 +368,13 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_DEBUG, module)) \
         continue;   \
-    struct timespec tp; \
-    struct tm d; \
-    clock_gettime(CLOCK_REALTIME, &tp); \
+    OS_DBG_SITE(NULL, false); \
+    OS_DBG_BIN_LOG(DBG_DEBUG, module, 0, __VA_ARGS__); \
+    const osTimeCache_t* pTimeCache = osTime_updateCache(); \
     pthread_t tid = pthread_self(); \
-    gmtime_r(&tp.tv_sec, &d); \
     char dstr[200];  \
     char filename[]=__FILE__;   \
-    sprintf(dstr, "%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, tp.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
+    sprintf(dstr, "%s.%-6ld:0x%lx[%s:%s:%d] ", pTimeCache->dateStr, pTimeCache->ts.tv_nsec/1000, tid, filename, __func__, __LINE__);  \
     osDbg_printf(DBG_DEBUG, dstr); \
     osDbg_printf(DBG_DEBUG, __VA_ARGS__);\
     osDbg_printf(DBG_DEBUG, "\n");\
@@ -330,6 +385,8 @@ do {\
 do {\
     if(osDbg_isBypass(DBG_DEBUG, module)) \
         continue;   \
+    OS_DBG_SITE(NULL, true); \
+    OS_DBG_BIN_LOG(DBG_DEBUG, module, 0, __VA_ARGS__); \
     osDbg_printf(DBG_DEBUG, __VA_ARGS__);\
 } while(0);\
 
@@ -370,4 +427,14 @@ void osDbg_printf(int level, const char *fmt, ...);
 const char *osDbg_getLevelStr(int level);
 void osDbg_printStr(const char* str, size_t strlen);
 
+//binary log, see osDebugBin.h for the file format.  When a binary log file is set, logs are only written into the binary log file
+int  osDbg_setBinLogfile(const char *name);
+void osDbg_binClose(void);
+bool osDbg_isBinary(void);
+void osDbg_binPrintf(int level, osLogModule_e module, osDbgSite_t* pSite, const char *fmt, ...);
+
+//per call site log rate limiting, applied to all levels except emergency and debug.  Each call site may log burst logs at once, and ratePerSec logs per second after that.  ratePerSec=0 turns off the rate limiting
+void osDbg_setRateLimit(uint32_t ratePerSec, uint32_t burst);
+bool osDbg_isRateLimited(osDbgSite_t* pSite, uint32_t* pSuppressed);
+
 #endif
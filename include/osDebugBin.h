@@ -0,0 +1,58 @@
+/**
+ * @file osDebugBin.h  Binary log record format
+ *
+ * Copyright (C) 2020, Sean Dai
+ *
+ * A binary log file is a sequence of records.  Each record starts with osDbgBinRecHdr_t, followed by
+ * a record type specific payload.  All integers are stored in the host byte order.
+ *
+ * OS_DBG_BIN_REC_START:  written each time a binary log file is opened
+ *     char magic[8] = OS_DBG_BIN_MAGIC, uint32_t version, uint64_t realtime usec.  hdr.usec is the
+ *     monotonic time of the same moment, the decoder uses the pair to convert the monotonic time of
+ *     the following records to the wall clock
+ * OS_DBG_BIN_REC_SITE:   written the first time a call site logs into the file
+ *     uint32_t line, then file, func, levelStr, fmt as (uint16_t len, chars), then uint8_t isNoPrefix
+ * OS_DBG_BIN_REC_THREAD: written the first time a thread logs into the file
+ *     uint64_t pthread id
+ * OS_DBG_BIN_REC_LOG:    the raw arguments of a log, in the order of the site fmt conversions.
+ *     %d %i %u %x %X %p %c %m: 8 bytes integer
+ *     %f %F:                   8 bytes double
+ *     %s %r %b %M:             uint16_t len, chars
+ * OS_DBG_BIN_REC_TEXT:   the already formatted log body, used when fmt has a conversion that can
+ *     not be stored raw, like %H, %v, %A, %w, or when the fmt is not the one recorded for the site.
+ *     uint16_t len, chars
+ */
+
+#ifndef _OS_DEBUG_BIN_H
+#define _OS_DEBUG_BIN_H
+
+#include <stdint.h>
+
+
+#define OS_DBG_BIN_MAGIC			"OSDBGBIN"
+#define OS_DBG_BIN_MAGIC_LEN		8
+#define OS_DBG_BIN_VERSION			1
+#define OS_DBG_BIN_MAX_REC_SIZE		2048	//a record larger than this size will have its string arguments truncated
+
+
+typedef enum {
+	OS_DBG_BIN_REC_START = 1,
+	OS_DBG_BIN_REC_SITE,
+	OS_DBG_BIN_REC_THREAD,
+	OS_DBG_BIN_REC_LOG,
+	OS_DBG_BIN_REC_TEXT,
+} osDbgBinRecType_e;
+
+
+typedef struct {
+	uint16_t recLen;		//the whole record length, including this header
+	uint8_t recType;		//osDbgBinRecType_e
+	uint8_t level;			//osDbgLevel_e
+	uint8_t module;			//osLogModule_e
+	uint16_t threadIdx;		//index of a OS_DBG_BIN_REC_THREAD record
+	uint32_t siteId;		//index of a OS_DBG_BIN_REC_SITE record
+	uint64_t usec;			//CLOCK_MONOTONIC in usec
+} __attribute__((packed)) osDbgBinRecHdr_t;
+
+
+#endif
@@ -10,6 +10,30 @@
 
 #include <stdarg.h>
 
+#include "osTypes.h"
+#include "osPL.h"
+
+
+#define OS_GENERIC_PARAM_SET_MAX_NUM	32		//max number of names in a osGenericParamSet_t
+#define OS_GENERIC_PARAM_SET_TABLE_SIZE	256		//must be power of 2
+
+
+/* a parameter of a semicolon separated parameter list, like ";transport=tcp;lr".  value.l=0 if the parameter
+ * has no value.  If a value is double quoted, the quotes are stripped */
+typedef struct osGenericParam {
+	osPointerLen_t name;
+	osPointerLen_t value;
+} osGenericParam_t;
+
+
+/* a set of known parameter names, looked up by a perfect hash, the name compare is case insensitive.
+ * The names are referred, not copied, and shall stay as long as the set is used */
+typedef struct osGenericParamSet {
+	uint8_t num;
+	uint32_t seed;
+	uint8_t table[OS_GENERIC_PARAM_SET_TABLE_SIZE];		//name index + 1, 0 for an empty slot
+	osPointerLen_t name[OS_GENERIC_PARAM_SET_MAX_NUM];
+} osGenericParamSet_t;
 
 
 /* param */
@@ -19,6 +43,16 @@ typedef void (osGParam_fmt_h)(const osPointerLen_t *name, const osPointerLen_t *
 bool osGenericParam_isExist(const osPointerLen_t *pl, const char *pname);
 bool osGenericParam_get(const osPointerLen_t *pl, const char *pname, osPointerLen_t *val);
 void osGenericParam_apply(const osPointerLen_t *pl, osGParam_fmt_h *ph, void *arg);
+//split pl into (name, value) pairs in one pass, return the number of pairs stored in param, at most paramMax
+int osGenericParam_tokenize(const osPointerLen_t *pl, osGenericParam_t *param, int paramMax);
+//build a perfect hash for the known names, return 0 if success, otherwise errorcode
+int osGenericParamSet_init(osGenericParamSet_t *pSet, const char *name[], int num);
+//return the index of name in the set, or -1 if name is not in the set
+int osGenericParamSet_lookup(const osGenericParamSet_t *pSet, const osPointerLen_t *name);
+/* fetch all parameters of the set in one scan.  param shall have pSet->num entries, param[i] is for the set
+ * name i, param[i].name.l=0 if the parameter does not exist.  If a name appears more than once, the first one
+ * is returned even if it has no value.  return the number of parameters found */
+int osGenericParam_getMulti(const osPointerLen_t *pl, const osGenericParamSet_t *pSet, osGenericParam_t *param);
 
 
 #endif
@@ -58,6 +58,17 @@ typedef struct osHashData {
 } osHashData_t;
 
 
+/* a intrusive hash node, embedded in a user data structure.  Adding it into a hash via osHash_addLink() does
+ * not allocate any memory, the hash element is hashLE, and hashLE.data points to hashData.  osHash_lookup*()
+ * returns &hashLE, use osList_entry(pHashLE, userType, member.hashLE) to get the user data structure back.
+ * A link shall be removed via osHash_removeLink() before the user data structure is freed.  osHash_clear() and
+ * osHash_delete() only unlink the links that are still in the hash, the user data structures are not freed */
+typedef struct osHashLink {
+	osListElement_t hashLE;
+	osHashData_t hashData;
+} osHashLink_t;
+
+
 //there are three memory allocation for a hash node, list_element as a hash node (osListElement_t), hashData(osHashData_t), and osHashData_t.pData (user data).
 typedef enum {
 	OS_HASH_DEL_NODE_TYPE_ALL,				//remove node from Hash, and free all memory
@@ -108,11 +119,21 @@ uint32_t osHash_getBucketElementsCountGlobal(osHash_t* pHash);
 void* osHash_getData(osListElement_t* pHashLE);
 //isFreeP: other than free pl, also free pl->p
 void osHash_freeKey(osListElement_t* pHashElement, bool isFreeP);
+//the caller fills pLink->hashData key, pLink->hashData.pData is set to pUserData
+osListElement_t* osHash_addLink(osHash_t *h, osHashLink_t* pLink, void* pUserData);
+//remove a link from the hash in O(1), no memory is freed
+void osHash_removeLink(osHashLink_t* pLink);
 void osHash_delete(osHash_t *h);
 void osHash_clear(osHash_t *h);
 uint32_t hash_valid_size(uint32_t size);
 
 
+static inline osHashLink_t* osHash_getLink(osListElement_t* pHashLE)
+{
+	return pHashLE ? osList_entry(pHashLE, osHashLink_t, hashLE) : NULL;
+}
+
+
 static inline void* osHash_getUserDataByLE(osListElement_t* pHashLE)
 {
 	return pHashLE ? ((osHashData_t*)pHashLE->data)->pData : NULL;
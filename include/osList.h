@@ -7,8 +7,11 @@
 #ifndef _OS_LIST_H
 #define _OS_LIST_H
 
+#include <stddef.h>
+
 #include "osTypes.h"
 #include "osDebug.h"
+#include "osVec.h"
 
 
 /** Linked-list element */
@@ -30,18 +33,16 @@ typedef struct osList {
 } osList_t;
 
 
+//the data is stored in a small vector, the first OS_VEC_INLINE_NUM data do not need memory allocation
 typedef struct {
-    size_t num;
 	bool isDataStatic;		//if true, the list element data is static or owned by other module, no need to dealloc after the osList is used, otherwise, the data needs to be freed after the list use
-    void* first;
-    osList_t more;
+	osVec_t vec;
 } osListPlus_t;
 
 
 typedef struct {
-	bool isFirst;			//if the current element uses "void* first" of osListPlus_t
 	bool isRetrieved;		//the osPlistPlus has done retrieval.  This is needed otherwise the retrieval will start from beginning automatically
-	osListElement_t* pLE;	//if the current element uses "osList_t more" of osListPlus_t
+	uint32_t idx;			//the idx of the next data to be retrieved
 } osListPlusElement_t;
 
 
@@ -66,7 +67,8 @@ typedef bool (*osListApply_h)(osListElement_t *le, void *arg);
  * @param le2  Next list element, the element originally appended after the current element
  * @param arg  Handler argument
  *
- * @return true if le1 and le2 needs to switch, otherwise false
+ * @return for osList_orderAppend()/osList_orderAppendBatch(), true if le1 and le2 needs to switch, otherwise false.
+ *         for osList_sort(), true if le1 can stay before le2, otherwise false
  */
 typedef bool (*osListSortHandler)(osListElement_t *le1, osListElement_t *le2, void *arg);
 
@@ -89,6 +91,8 @@ void osList_insertBefore(osList_t *list, osListElement_t *le, osListElement_t *i
 			void *data);
 void osList_insertAfter(osList_t *list, osListElement_t *le, osListElement_t *ile, void *data);
 void osList_orderAppend(osList_t *list, osListSortHandler sortHandler, void* data, void* sortArg); 
+//same as calling osList_orderAppend() for each of ppData[0..num-1], but the new data are sorted first and then merged into the list
+osStatus_e osList_orderAppendBatch(osList_t *list, osListSortHandler sortHandler, void* const* ppData, uint32_t num, void* sortArg);
 void osList_unlinkElement(osListElement_t *le);
 //delete a element based on the stored data.
 void* osList_deleteElement(osList_t* pList, osListApply_h applyHandler, void *arg);
@@ -109,10 +113,16 @@ uint32_t osList_getCount(const osList_t *list);
 osStatus_e osList_addString(osList_t *pList, char* nameParam, size_t nameLen);
 osListElement_t* osList_getNextElement(osListElement_t* pLE);
 void osListElement_delete(osListElement_t* pLE);
+//for a intrusive list, unlink all elements, the data structures that embed the elements are not touched
+void osList_unlinkAll(osList_t* pList);
+//for a intrusive list, unlink all elements and osfree() the data structures that embed the elements
+void osList_deleteLinked(osList_t* pList);
 
 void osListPlus_init(osListPlus_t* pList, bool isDataStatic);
 osStatus_e osListPlus_append(osListPlus_t* pList, void* pData);
 void* osListPlus_getNextData(osListPlus_t* pList, osListPlusElement_t* pPlusLE);
+//random access, return NULL if idx is beyond the list size
+void* osListPlus_getData(osListPlus_t* pList, uint32_t idx);
 void osListPlus_clear(osListPlus_t* pList);
 void osListPlus_delete(osListPlus_t* pList);
 void osListPlus_free(osListPlus_t* pList);
@@ -142,13 +152,17 @@ static inline bool osList_isEmpty(const osList_t *list)
 	return list ? list->head == NULL : true;
 }
 
+static inline uint32_t osListPlus_getCount(const osListPlus_t* pList)
+{
+	return pList ? osVec_getCount(&pList->vec) : 0;
+}
+
 static inline void osListPlusElement_init(osListPlusElement_t* pPlusLE)
 {
 	if(pPlusLE)
 	{
-		pPlusLE->isFirst = true;
 		pPlusLE->isRetrieved = false;
-		pPlusLE->pLE = NULL;
+		pPlusLE->idx = 0;
 	}
 }
 
@@ -156,4 +170,47 @@ static inline void osListPlusElement_init(osListPlusElement_t* pPlusLE)
 	for ((le) = list_head((list)); (le); (le) = (le)->next)
 
 
+/* intrusive list.  A osListElement_t is embedded in a user data structure as a link, the data structure is added
+ * into a list via osList_appendLE()/osList_prependLE() with its own address as the element data, so that no
+ * memory is allocated when it is added, and it is unlinked in O(1) via osList_unlinkElement().  All lookup/apply
+ * functions work on a intrusive list as on a normal list.  A intrusive list shall be cleaned via osList_unlinkAll()
+ * or osList_deleteLinked(), not osList_clear()/osList_delete() that osfree() the list elements.
+ *
+ * typedef struct {
+ *     int x;
+ *     osListElement_t link;
+ * } myData_t;
+ *
+ * osList_appendEntry(&list, pMyData, link);
+ * osListElement_t* pLE = osList_popHead(&list);
+ * myData_t* pMyData = osList_entry(pLE, myData_t, link);
+ */
+#define osList_entry(pLE, type, member)	((type*)((char*)(pLE) - offsetof(type, member)))
+
+#define osList_appendEntry(list, pEntry, member)	osList_appendLE(list, &(pEntry)->member, pEntry)
+#define osList_prependEntry(list, pEntry, member)	osList_prependLE(list, &(pEntry)->member, pEntry)
+#define osList_unlinkEntry(pEntry, member)			osList_unlinkElement(&(pEntry)->member)
+
+//iterate the data structures of a intrusive list, pEntry may be unlinked during the iteration, pNextLE is a osListElement_t* for temporary use
+#define OS_LIST_FOREACH_ENTRY(list, pEntry, type, member, pNextLE)		\
+	for ((pNextLE) = (list)->head; (pNextLE) && ((pEntry) = osList_entry((pNextLE), type, member), (pNextLE) = (pNextLE)->next, true); )
+
+
+static inline void osListElement_init(osListElement_t* le)
+{
+	if(le)
+	{
+		le->prev = le->next = NULL;
+		le->list = NULL;
+		le->data = NULL;
+	}
+}
+
+
+static inline bool osListElement_isLinked(const osListElement_t* le)
+{
+	return le ? le->list != NULL : false;
+}
+
+
 #endif
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include "osTypes.h"
 #include "osPL.h"
+#include "osScan.h"
 
 
 #ifndef RELEASE
@@ -38,6 +39,7 @@
 
 
 #define OSMBUF_CHAR(mb, delta)	mb->buf[mb->pos + delta]
+#define OS_MBUF_STREAM_CHUNK_SIZE	65536	//default chunk size of osMBuf_streamFile()
 
 
 /** Defines a memory buffer, the buf has to be allocated via one of osMemory methods */
@@ -49,6 +51,10 @@ typedef struct osMBuf {
 } osMBuf_t;
 
 
+//consumer of osMBuf_streamFile(), offset is the file offset of data.  return false to stop the reading
+typedef bool (*osMBufStreamCallback_h)(const uint8_t* data, size_t len, size_t offset, void* pData);
+
+
 //struct osPointerLen;
 //struct osPrintf;
 
@@ -74,6 +80,10 @@ int      osMBuf_writeBuf(osMBuf_t *mb, const uint8_t *buf, size_t size, bool isA
 int 	osMBuf_writeBufRange(osMBuf_t *destmb, const osMBuf_t *srcmb, size_t startPos, size_t stopPos, bool isAdvancePos);
 int 	osMBuf_setZero(osMBuf_t *mb, size_t size, bool isAdvancePos);
 osMBuf_t* osMBuf_readFile(char* file, size_t initBufSize);
+//map a file read only into a mbuf, buf is NUL terminated, and shall not be modified or osmemref'd
+osMBuf_t* osMBuf_mapFile(const char* file);
+//read a file in chunkSize windows, each window is passed to consumer, return the total bytes passed, or -1 if error
+ssize_t   osMBuf_streamFile(const char* file, size_t chunkSize, osMBufStreamCallback_h consumer, void* pData);
 int      osMBuf_writeU8(osMBuf_t *mb, uint8_t v, bool isAdvancePos);
 int      osMBuf_writeU16(osMBuf_t *mb, uint16_t v, bool isAdvancePos);
 int      osMBuf_writeU32(osMBuf_t *mb, uint32_t v, bool isAdvancePos);
@@ -110,13 +120,8 @@ static inline void osMBuf_skipUntil(osMBuf_t *mb, char mark)
 		return;
 	}
 
-	for(mb->pos; mb->pos < mb->end; mb->pos++)
-	{
-		if(mb->buf[mb->pos] == mark)
-		{
-			break;
-		}
-	}
+	ssize_t pos = osScan_findChar(&mb->buf[mb->pos], mb->end - mb->pos, mark);
+	mb->pos = pos < 0 ? mb->end : mb->pos + pos;
 }
 
 
@@ -0,0 +1,100 @@
+/**
+ * @file osMBufChain.h  Interface to chained memory buffers
+ *
+ * Copyright (C) 2020, Sean Dai
+ *
+ * A chained buffer is an ordered set of segments.  Each segment is a osMBuf_t whose buf holds a
+ * reference (osmemref) to the memory of the appended mbuf, the segment data is buf[pos, end).  Appending
+ * a segment does not copy the data, a message can be assembled from the slices of the received/parsed
+ * mbufs and sent by writev()/sendmsg() via osMBufChain_toIovec().
+ *
+ * Since a segment refers the memory instead of a copy, the referred memory shall not be modified after
+ * it is appended into a chain.
+ */
+
+
+#ifndef _OS_MBUF_CHAIN_H
+#define _OS_MBUF_CHAIN_H
+
+#include <sys/uio.h>
+
+#include "osTypes.h"
+#include "osPL.h"
+#include "osMBuf.h"
+
+
+#define OS_MBUF_CHAIN_INIT_SEG_NUM		16		//the initial segment slots, doubled when used up
+#define OS_MBUF_CHAIN_COPY_BUF_SIZE		512		//the size of the chain owned buffer used by osMBufChain_appendCopy()
+
+
+typedef struct osMBufChain {
+	osMBuf_t* seg;			//segment array, seg[i].buf holds a memory reference, the segment data is seg[i].buf[pos, end)
+	uint32_t segNum;		//the number of segments in use
+	uint32_t segMax;		//the number of segment slots of the seg array
+	size_t len;				//total data length of all segments
+	osMBuf_t* pCopyBuf;		//chain owned buffer for the small pieces that are appended by copy
+} osMBufChain_t;
+
+
+//a read cursor that walks through the segments of a chain
+typedef struct osMBufChainCursor {
+	const osMBufChain_t* pChain;
+	uint32_t segIdx;		//the current segment
+	size_t segPos;			//the read position inside the current segment, relative to seg[segIdx].pos
+	size_t pos;				//the read position from the beginning of the chain
+} osMBufChainCursor_t;
+
+
+osMBufChain_t* osMBufChain_alloc(void);
+void osMBufChain_dealloc(osMBufChain_t* pChain);
+//release all segments, the chain can be reused afterwards
+void osMBufChain_reset(osMBufChain_t* pChain);
+//append pMBuf->buf[startPos, startPos+len) by reference.  pMBuf->buf must be allocated by osmalloc
+int osMBufChain_appendRef(osMBufChain_t* pChain, const osMBuf_t* pMBuf, size_t startPos, size_t len);
+//append pMBuf->buf[0, end) by reference
+int osMBufChain_appendMBuf(osMBufChain_t* pChain, const osMBuf_t* pMBuf);
+//append a pl by reference, the pl must point inside pMBuf->buf
+int osMBufChain_appendPL(osMBufChain_t* pChain, const osMBuf_t* pMBuf, const osPointerLen_t* pl);
+//append a small piece of data by copying it into a chain owned buffer, like the "\r\n" or a generated header
+int osMBufChain_appendCopy(osMBufChain_t* pChain, const void* data, size_t len);
+//append all segments of pSrcChain by reference
+int osMBufChain_appendChain(osMBufChain_t* pChain, const osMBufChain_t* pSrcChain);
+//fill the iov with the segments, return the number of iov entries, or -1 if iovMax is not big enough
+int osMBufChain_toIovec(const osMBufChain_t* pChain, struct iovec* iov, int iovMax);
+//copy the whole chain into a new contiguous mbuf
+osMBuf_t* osMBufChain_flatten(const osMBufChain_t* pChain);
+
+void osMBufChainCursor_init(osMBufChainCursor_t* pCursor, const osMBufChain_t* pChain);
+//copy up to len bytes across the segment boundaries, return the number of bytes copied
+size_t osMBufChainCursor_read(osMBufChainCursor_t* pCursor, void* buf, size_t len);
+//return the next byte and advance, or -1 if the end of the chain is reached
+int osMBufChainCursor_readU8(osMBufChainCursor_t* pCursor);
+//return the next byte without advance, or -1 if the end of the chain is reached
+int osMBufChainCursor_peekU8(const osMBufChainCursor_t* pCursor);
+//advance up to n bytes, return the number of bytes advanced
+size_t osMBufChainCursor_advance(osMBufChainCursor_t* pCursor, size_t n);
+//advance until the mark character, the cursor points to the mark.  return the chain position of the mark, or -1 if no match, the cursor is at the end of the chain
+ssize_t osMBufChainCursor_skipUntil(osMBufChainCursor_t* pCursor, char mark);
+//get the contiguous data from the cursor to the end of the current segment, without advance
+osPointerLen_t osMBufChainCursor_getCurSeg(const osMBufChainCursor_t* pCursor);
+
+
+static inline size_t osMBufChain_getLen(const osMBufChain_t* pChain)
+{
+	return pChain ? pChain->len : 0;
+}
+
+
+static inline uint32_t osMBufChain_getSegNum(const osMBufChain_t* pChain)
+{
+	return pChain ? pChain->segNum : 0;
+}
+
+
+static inline size_t osMBufChainCursor_getRemaining(const osMBufChainCursor_t* pCursor)
+{
+	return (pCursor && pCursor->pChain && pCursor->pChain->len > pCursor->pos) ? pCursor->pChain->len - pCursor->pos : 0;
+}
+
+
+#endif
@@ -43,6 +43,15 @@ int osUInt2Str16(uint16_t n, char* s);
 int osUInt2Str32(uint32_t n, char* s);
 //return null terminated string, the return value is the string len
 int osUInt2Str64(uint64_t n, char* s);
+//the number of decimal digits of n
+int osUInt64DigitNum(uint64_t n);
+//write n as decimal digits to s, s is not null terminated and shall have at least OS_MAX_UINT64_STR_LEN-1 bytes.  the return value is the string len
+int osUInt2DecStr(uint64_t n, char* s);
+//same as osUInt2DecStr(), padded with leading '0' to at least width digits
+int osUInt2DecStrPad(uint64_t n, int width, char* s);
+/* convert len decimal digits in p to *pValue.  return false if any char is not a digit.  If the value exceeds
+ * UINT64_MAX, *pIsOverflow is set to true and *pValue is wrapped around modulo 2^64.  pIsOverflow may be NULL */
+bool osDecStr2UInt(const char* p, size_t len, uint64_t* pValue, bool* pIsOverflow);
 
 char* osGetNodeId();
 
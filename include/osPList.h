@@ -2,15 +2,13 @@
 #define _OS_P_LIST_H
 
 #include "osTypes.h"
-#include "osList.h"
+#include "osVec.h"
 
 
+//the data is stored in a small vector, the first OS_VEC_INLINE_NUM data do not need memory allocation
 typedef struct osPList {
-	size_t count;
-	void* pFirstData;
-	osList_t list;
-	osListElement_t* pCurLE;//for retrieval, store the current retrieval LE, initiated to be 0;
-	size_t retCount;		//for retrieval, if retCount = 0, osPList_getNext() shall return pFirstData, if retCount == count, return NULL. 
+	osVec_t vec;
+	size_t retCount;		//for retrieval, the number of data that have been retrieved by osPList_getNext()
 } osPList_t;
 
 
@@ -19,8 +17,12 @@ void* osPLIst_getTopData(osPList_t* ple);
 void* osPList_getBottomData(osPList_t* ple);
 //each time when retrieving a whole PLE, the first call must set isRetInit=true, then must set isRetInit=false, otherwise, thi function may not return correct data
 void* osPList_getNext(osPList_t* ple, bool isRetInit);
+//random access, return NULL if idx is beyond the list size
+void* osPList_getData(osPList_t* ple, size_t idx);
 void* osPList_add(osPList_t* ple, void* data);
 void* osPList_deleteTop(osPList_t* ple);
+//remove all data from the list, the data is not touched
+void osPList_clear(osPList_t* ple);
 
 
 
@@ -11,6 +11,11 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#include "osTypes.h"
+
+
+#define OS_PRINTF_MAX_ARG	32		//max number of conversions of a compiled format executed without falling back to osPrintf_onMBuf()
+
 
 struct osMBuf;
 
@@ -41,6 +46,30 @@ typedef struct osPrintf {
  */
 typedef int(*osPrintfHandlerName_t)(osPrintf_t* pf, void *arg);
 
+
+/** A literal run or a conversion of a compiled format */
+typedef struct osPrintfSpec {
+	char conv;			/**< conversion char, 0 for a literal run, '?' for a unknown conversion */
+	char pch;			/**< pad char, ' ' or '0' */
+	bool plr;			/**< left aligned */
+	uint8_t lenmod;		/**< number of 'l', 42 for 'z' */
+	size_t pad;
+	size_t fpad;		/**< the pad before '.', (size_t)-1 if there is no '.' */
+	uint32_t litPos;	/**< a literal run is fmt[litPos, litPos+litLen) */
+	uint32_t litLen;
+} osPrintfSpec_t;
+
+/** A format string pre-parsed by osPrintf_compile() */
+typedef struct osPrintfFmt {
+	const char *fmt;	/**< referred, not copied */
+	bool isFallback;	/**< has a conversion that is only supported by osPrintf_onHandler(), like %H, %v, %m, %A */
+	uint32_t argNum;	/**< number of conversions that take arguments */
+	size_t litLen;		/**< total len of the literal runs */
+	uint32_t specNum;
+	osPrintfSpec_t spec[];
+} osPrintfFmt_t;
+
+
 int osPrintf_onHandler(const char *fmt, va_list ap, osPrintf_h pHandler, void *arg);
 int osPrintf_onFile(FILE *stream, const char *fmt, va_list ap);
 int osPrintf_onStdout(const char *fmt, va_list ap);
@@ -57,4 +86,19 @@ int osPrintf_mbuf(struct osMBuf *mb, const char *fmt, ...);
 
 int osPrintfHandler_debug(const char *p, size_t size, void* arg);
 
+//pre-parse fmt, fmt shall stay as long as the returned format is used.  osfree() the returned format when it is not needed
+osPrintfFmt_t *osPrintf_compile(const char *fmt);
+//return *ppFmt, compile fmt into *ppFmt first if *ppFmt=NULL.  thread safe
+osPrintfFmt_t *osPrintf_getCompiled(osPrintfFmt_t **ppFmt, const char *fmt);
+//print a compiled format to mb, mb is expanded at most once
+int osPrintf_execMBuf(struct osMBuf *mb, const osPrintfFmt_t *pFmt, ...);
+int osPrintf_vexecMBuf(struct osMBuf *mb, const osPrintfFmt_t *pFmt, va_list ap);
+
+/* print a constant fmt to mb, fmt is compiled on the first call of each call site, and kept for the process life time.
+ * fmt shall be a string literal.  The macro locals are prefixed with _osPrintfC, mb and the arguments shall not use such names */
+#define osPrintf_mbufC(mb, fmt, ...) ({ \
+	static osPrintfFmt_t *_osPrintfCFmt = NULL; \
+	osPrintfFmt_t *_osPrintfCCompiled = osPrintf_getCompiled(&_osPrintfCFmt, fmt); \
+	_osPrintfCCompiled ? osPrintf_execMBuf(mb, _osPrintfCCompiled, ##__VA_ARGS__) : osPrintf_mbuf(mb, fmt, ##__VA_ARGS__); })
+
 #endif
@@ -10,8 +10,48 @@
 
 #include <stdarg.h>
 
+#include "osTypes.h"
+#include "osPL.h"
 
-/* Regular expressions 
+
+#define OS_REGEX_MAX_ELEM			32		//max number of literal chars sequences and character classes of a expression
+#define OS_REGEX_MAX_LITERAL_LEN	128		//max total length of the literal chars of a expression
+#define OS_REGEX_MAX_RANGE			64		//max number of chars and ranges of a character class
+
+
+typedef enum {
+	OS_REGEX_ELEM_LITERAL,		//a sequence of literal chars, compared case insensitive unless the expression is compiled with isCase=true
+	OS_REGEX_ELEM_CLASS,		//a character class with a repetition, each class is a capture
+} osRegexElemType_e;
+
+
+typedef struct osRegexElem {
+	osRegexElemType_e type;
+	bool isQuoteEsc;			//the class is negated by '~', the chars inside the double quotes and the escaped chars are always matched
+	uint32_t nmin;
+	uint32_t nmax;				//(uint32_t)-1 for no limit
+	uint16_t litPos;			//the literal chars are stored in osRegexProg_t.literal[litPos, litPos+litLen), lower cased unless isCase=true
+	uint16_t litLen;
+	uint8_t map[32];			//bitmap of the input chars a class matches, the case folding and the negation are already applied
+} osRegexElem_t;
+
+
+/* a compiled expression.  It is immutable after osRegex_compile(), and may be shared by multiple threads.
+ * The expression is matched one pass: each class greedily takes the longest run, there is no backtracking
+ */
+typedef struct osRegexProg {
+	int err;					//0 if the expression is compiled successfully, otherwise errorcode
+	bool isCase;				//the literal chars and the classes are case sensitive
+	uint8_t elemNum;
+	uint8_t captureNum;			//the number of character classes, each class takes one osPointerLen_t* from the exec argument list
+	bool isAnyStart;			//a match may start with any char, otherwise, only with the chars in startMap
+	uint8_t startMap[32];
+	char literal[OS_REGEX_MAX_LITERAL_LEN];
+	osRegexElem_t elem[OS_REGEX_MAX_ELEM];
+} osRegexProg_t;
+
+
+/* Regular expressions
  * Parse a string using basic regular expressions. Any number of matching
  * expressions can be given, and each match will be stored in a pointerLen_t
  * pointer-length type.  The pointerLen_t variables passed into the function
@@ -19,7 +59,16 @@
  * pl1 and pl2 are the pointer variables of pointerLen_t type;
 */
 int osRegex(const char *ptr, size_t len, const char *expr, ...);
-
+//compile expr into pProg, return 0 if success, otherwise errorcode.  pProg can be used by osRegex_exec() many times
+int osRegex_compile(osRegexProg_t* pProg, const char *expr);
+//the same as osRegex_compile(), if isCase=true, the literal chars and the class chars and ranges are matched case sensitive
+int osRegex_compileCase(osRegexProg_t* pProg, const char *expr, bool isCase);
+//match a compiled expression in linear time of len, the captures are the same as osRegex(), and are only set when there is a match.
+//a '~' class is rescanned from an offset inside its double quotes, so a string with many quoted parts is not linear
+int osRegex_exec(const osRegexProg_t* pProg, const char *ptr, size_t len, ...);
+int osRegex_vexec(const osRegexProg_t* pProg, const char *ptr, size_t len, va_list ap);
+//match a compiled expression against the whole string instead of searching a match from each offset
+int osRegex_matchAll(const osRegexProg_t* pProg, const char *ptr, size_t len);
 
 
 
@@ -0,0 +1,64 @@
+/**
+ * @file osScan.h  Interface to the byte scan kernels
+ *
+ * Copyright (C) 2020, Sean Dai
+ *
+ * The kernels search a byte buffer for a character, any character of a small set, or a substring.  Each
+ * search has a scalar, a SSE2 and an AVX2 implementation, the fastest one supported by the running cpu
+ * is selected the first time a search is called.  All find functions return the offset of the first match
+ * from buf, or -1 if there is no match.
+ */
+
+
+#ifndef _OS_SCAN_H
+#define _OS_SCAN_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "osTypes.h"
+
+
+#define OS_SCAN_SET_MAX_NUM		16		//a set with more chars is still searched correctly, but by the scalar kernel
+
+
+typedef enum {
+	OS_SCAN_LEVEL_AUTO,		//the best level supported by the cpu
+	OS_SCAN_LEVEL_SCALAR,
+	OS_SCAN_LEVEL_SSE2,
+	OS_SCAN_LEVEL_AVX2,
+} osScanLevel_e;
+
+
+typedef struct osScanSet {
+	uint8_t num;
+	uint8_t c[OS_SCAN_SET_MAX_NUM];
+	uint8_t map[32];		//bitmap of all chars in the set, used by the scalar kernel
+} osScanSet_t;
+
+
+//build a char set, like osScan_initSet(&set, "<>\"/", 4).  if num=0, chars is a null terminated string
+void osScan_initSet(osScanSet_t* pSet, const char* chars, size_t num);
+//set the kernel level, used for test and benchmark, return the level in use, which is lower than the requested one if the cpu does not support it
+osScanLevel_e osScan_setLevel(osScanLevel_e level);
+//the kernel level in use, other simd kernels, like osUtf8, follow the same level
+osScanLevel_e osScan_getLevel(void);
+
+ssize_t osScan_findChar(const void* buf, size_t len, char c);
+ssize_t osScan_findSet(const void* buf, size_t len, const osScanSet_t* pSet);
+ssize_t osScan_findStr(const void* buf, size_t len, const char* pattern, size_t patternLen);
+ssize_t osScan_findStrCase(const void* buf, size_t len, const char* pattern, size_t patternLen);
+//the first exactLen chars of the pattern are compared case sensitive, the remaining chars are compared case insensitive
+ssize_t osScan_findStrPartialCase(const void* buf, size_t len, const char* pattern, size_t patternLen, size_t exactLen);
+/* mark all chars of the set in one pass, bit (i & 63) of pBitmap[i >> 6] is set if buf[i] is in the set.  pBitmap shall
+ * have at least (len + 63) / 64 words, the bits beyond len in the last word are cleared */
+void osScan_buildBitmap(const void* buf, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap);
+
+
+static inline bool osScan_isInSet(const osScanSet_t* pSet, uint8_t c)
+{
+	return pSet->map[c >> 3] & (1 << (c & 0x7));
+}
+
+
+#endif
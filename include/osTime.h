@@ -9,12 +9,32 @@
 #define _OS_TIME_H
 
 #include <stdarg.h>
+#include <time.h>
+#include "osTypes.h"
 #include "osPrintf.h"
 
 
+#define OS_TIME_DATE_STR_SIZE	24		//enough for "yyyy/mm/dd hh:mm:ss"
+
+
+/* per thread cached time.  The clock is refreshed with ms resolution, the broken down gmt time and the
+ * formatted date string are only rebuilt when the second rolls over */
+typedef struct osTimeCache {
+	struct timespec ts;						//the cached CLOCK_REALTIME
+	uint64_t msec;							//ts in msec
+	time_t dateSec;							//the second the tm and dateStr were built for
+	struct tm tm;							//gmt broken down time of dateSec
+	char dateStr[OS_TIME_DATE_STR_SIZE];	//"yyyy/mm/dd hh:mm:ss" of dateSec
+	size_t dateStrLen;
+} osTimeCache_t;
+
+
 /* time */
 int  osGMTtime(osPrintf_t *pf, void *ts);
 int  osHumanTime(osPrintf_t *pf, const uint32_t *seconds);
 
+//read the clock and refresh the calling thread's time cache, the date is only reformatted when the second changes
+const osTimeCache_t* osTime_updateCache(void);
+
 
 #endif
@@ -9,16 +9,31 @@
 #define _OS_UTF8_H
 
 #include <stdarg.h>
+#include <sys/types.h>
 #include "osPrintf.h"
 #include "osPL.h"
 
 
+struct osMBuf;
+
+
 /* unicode */
 /* encode a string to a utf8 array and output via pf */
 int osUtf8Encode(osPrintf_t *pf, const char *str);
 /* decode a utf8 array into a string and output via pf */
 int osUtf8Decode(osPrintf_t *pf, const osPointerLen_t *pl);
 size_t osUtf8EncodeByteseq(char u[4], unsigned cp);
+//same as osUtf8Encode()/osUtf8Decode(), but output to mb directly
+int osUtf8_encodeMBuf(struct osMBuf *mb, const osPointerLen_t *pl);
+int osUtf8_decodeMBuf(struct osMBuf *mb, const osPointerLen_t *pl);
+//return -1 if buf is a valid utf8 sequence, otherwise the offset of the first invalid byte sequence
+ssize_t osUtf8_validate(const void *buf, size_t len);
+
+
+static inline bool osUtf8_isValid(const void *buf, size_t len)
+{
+	return osUtf8_validate(buf, len) < 0;
+}
 
 
 #endif
@@ -0,0 +1,104 @@
+/**
+ * @file osVec.h  Interface to a small vector of pointers
+ *
+ * Copyright (C) 2020, Sean Dai
+ *
+ * A contiguous, growable array of data pointers.  The first OS_VEC_INLINE_NUM pointers are stored inside
+ * osVec_t itself, a vector that grows beyond that spills to a heap array that doubles when it is full.  Most
+ * vectors in a message (header values, xml attributes, etc.) are small, they are stored without any memory
+ * allocation.  Random access is O(1), and the iteration does not chase pointers.
+ *
+ * The heap array is referred by osVec_t, a osVec_t that has spilled shall not be copied by value.
+ */
+
+#ifndef _OS_VEC_H
+#define _OS_VEC_H
+
+#include <stdint.h>
+
+#include "osTypes.h"
+
+
+#define OS_VEC_INLINE_NUM	4		//number of data pointers stored inline before spilling to the heap
+
+
+typedef struct osVec {
+	uint32_t num;					//number of data pointers in the vector
+	uint32_t capacity;				//OS_VEC_INLINE_NUM when inline, otherwise the size of pHeapData
+	union {
+		void* inlineData[OS_VEC_INLINE_NUM];
+		void** pHeapData;
+	};
+} osVec_t;
+
+
+/** Vector Initializer */
+#define OS_VEC_INIT {0, OS_VEC_INLINE_NUM, {{NULL}}}
+
+
+//for a osVec_t that is not initialized by OS_VEC_INIT or osVec_init(), a zeroed osVec_t is also a valid empty vector
+void osVec_init(osVec_t* pVec);
+osStatus_e osVec_append(osVec_t* pVec, void* pData);
+//append num data pointers at once, the vector is expanded at most once
+osStatus_e osVec_appendBulk(osVec_t* pVec, void* const* ppData, uint32_t num);
+osStatus_e osVec_insert(osVec_t* pVec, uint32_t idx, void* pData);
+//make sure the vector can hold capacity data pointers without further expansion
+osStatus_e osVec_reserve(osVec_t* pVec, uint32_t capacity);
+//remove the data pointer at idx, the following data pointers are moved forward, return the removed data pointer
+void* osVec_remove(osVec_t* pVec, uint32_t idx);
+//remove the first data pointer that equals to pData, return pData if found, otherwise NULL
+void* osVec_removeData(osVec_t* pVec, void* pData);
+//remove all data pointers and free the heap array, the data is not touched
+void osVec_clear(osVec_t* pVec);
+//remove all data pointers and free the heap array, osfree() the data
+void osVec_delete(osVec_t* pVec);
+
+
+static inline void** osVec_getArray(const osVec_t* pVec)
+{
+	return pVec->capacity > OS_VEC_INLINE_NUM ? pVec->pHeapData : (void**)pVec->inlineData;
+}
+
+
+static inline uint32_t osVec_getCount(const osVec_t* pVec)
+{
+	return pVec ? pVec->num : 0;
+}
+
+
+static inline bool osVec_isEmpty(const osVec_t* pVec)
+{
+	return pVec ? pVec->num == 0 : true;
+}
+
+
+static inline void* osVec_get(const osVec_t* pVec, uint32_t idx)
+{
+	return (pVec && idx < pVec->num) ? osVec_getArray(pVec)[idx] : NULL;
+}
+
+
+static inline void* osVec_getHead(const osVec_t* pVec)
+{
+	return osVec_get(pVec, 0);
+}
+
+
+static inline void* osVec_getTail(const osVec_t* pVec)
+{
+	return (pVec && pVec->num) ? osVec_getArray(pVec)[pVec->num - 1] : NULL;
+}
+
+
+static inline void* osVec_popTail(osVec_t* pVec)
+{
+	return (pVec && pVec->num) ? osVec_getArray(pVec)[--pVec->num] : NULL;
+}
+
+
+//iterate all data pointers, idx is a uint32_t, pData is the data pointer of type
+#define OS_VEC_FOREACH(pVec, idx, pData)		\
+	for ((idx) = 0; (idx) < (pVec)->num && (((pData) = osVec_getArray(pVec)[idx]), true); (idx)++)
+
+
+#endif
@@ -8,7 +8,9 @@
 #include "osTypes.h"
 #include "osPL.h"
 #include "osList.h"
+#include "osVec.h"
 #include "osMBuf.h"
+#include "osMBufChain.h"
 
 
 #define OS_XML_INVALID_EDATA_NAME	0x7FFFFFFF
@@ -35,7 +37,7 @@ typedef struct {
     osXmlDataType_e dataType;	 //for simpleType, this is set to OS_XML_DATA_TYPE_SIMPLE by user, and when callback, set to the XS type (like int, etc.)by the xmlparser
     bool isEOT;             //INOUT, app indicates to xml if it wants to receive tag EOT info, when the parser meets EOT, like </publicId>, xmlParser indicates to app if the callback data is a EOT.
 	osPointerLen_t nsAlias;
-	const osList_t* pNoXmlnsAttrList;	//no xmlns attributes
+	const osVec_t* pNoXmlnsAttrList;	//no xmlns attributes, each vector entry contains osXmlNameValue_t
     union {	//controlled by dataType
         bool xmlIsTrue;
         uint64_t xmlInt;
@@ -63,6 +65,38 @@ typedef struct {
 } osXmlDataCallbackInfo_t;
 
 
+//the context of a incremental xml parse, see osXml_parseFeedStart()
+typedef struct osXmlParseCtx osXmlParseCtx_t;
+
+
+//a document for osXml_parseMany()
+typedef struct {
+	osMBuf_t* pXmlBuf;		//IN, the xml document
+	osXmlDataCallbackInfo_t* callbackInfo;	//IN, the callback info of this document, shall not be shared with other documents since xmlData is written during the parse
+	osStatus_e status;		//OUT, the parse result
+} osXmlParseDoc_t;
+
+
+//a element path for osXml_compilePaths()
+typedef struct {
+	osPointerLen_t path;	//element names from the root element separated by '/', without ns alias, like "Sh-Data/RepositoryData/ServiceData"
+	int eDataName;			//reported in osXmlData_t.eDataName when the element of the path is found
+	bool isMulti;			//if false, only the first matching element is reported, otherwise all matching elements are reported
+} osXmlPath_t;
+
+
+//a compiled set of element paths, see osXml_compilePaths()
+typedef struct osXmlPathSet osXmlPathSet_t;
+
+
+//a streaming xml writer, see osXmlWriter_create()
+typedef struct osXmlWriter osXmlWriter_t;
+
+
+//a element name precompiled for osXmlWriter, see osXmlWriter_compileTag()
+typedef struct osXmlWriterTag osXmlWriterTag_t;
+
+
 typedef struct osXmlNameValue {
     osPointerLen_t name;
     osPointerLen_t value;
@@ -75,7 +109,43 @@ osStatus_e osXml_getElemValue(osPointerLen_t* xsdName, osMBuf_t* xsdMBuf, osMBuf
 osStatus_e osXml_getLeafValue(char* fileFolder, char* xsdFileName, char* xmlFileName, osXmlDataCallbackInfo_t* callbackInfo);
 //parse xml without checking against xsd.
 osStatus_e osXml_parse(osMBuf_t* pXmlBuf, osMBuf_t* pXsdBuf, osPointerLen_t* xsdName, osXmlDataCallbackInfo_t* callbackInfo);
+//start a incremental xml parse, the xml document is fed piece by piece via osXml_parseFeed().  the xsd must have been parsed
+osXmlParseCtx_t* osXml_parseFeedStart(osPointerLen_t* xsdName, osXmlDataCallbackInfo_t* callbackInfo);
+//parse the next piece of a xml document, the callbacks of the completed elements are called before the function returns
+osStatus_e osXml_parseFeed(osXmlParseCtx_t* pCtx, const osPointerLen_t* pChunk);
+//finish a incremental xml parse and free pCtx, return error if a feed failed or the document is not complete
+osStatus_e osXml_parseFeedEnd(osXmlParseCtx_t* pCtx);
+//parse independent xml documents on nThread threads (0: one per online cpu) against a parsed xsd, the xsd is shared read only by all threads
+osStatus_e osXml_parseMany(osXmlParseDoc_t* docs, uint32_t docNum, osPointerLen_t* xsdName, uint32_t nThread);
+//compile a set of element paths for osXml_extract(), xsdName may be NULL, otherwise the values are converted per the xsd.  free the returned set via osfree()
+osXmlPathSet_t* osXml_compilePaths(const osXmlPath_t* pPath, uint32_t pathNum, osPointerLen_t* xsdName);
+//report the values of the elements on the compiled paths, the other elements are skipped without xsd check, stop when all paths are found
+osStatus_e osXml_extract(osMBuf_t* pXmlBuf, const osXmlPathSet_t* pPathSet, osXmlDataCallback_h callback, void* appData);
+//create a xml writer that writes into pBuf from pBuf->pos, or appends to pChain if pBuf is NULL.  if xsdName is not NULL, the elements are checked against the xsd as they are written
+osXmlWriter_t* osXmlWriter_create(osMBuf_t* pBuf, osMBufChain_t* pChain, osPointerLen_t* xsdName, bool isXmlDecl);
+//complete the document and free pWriter, return error if any write failed or the document is not complete
+osStatus_e osXmlWriter_finish(osXmlWriter_t* pWriter);
+//precompile the start and end tags of a element, nsAlias can be NULL.  a tag can be used by multiple writers at the same time.  free it via osfree()
+osXmlWriterTag_t* osXmlWriter_compileTag(const osPointerLen_t* nsAlias, const osPointerLen_t* name);
+osStatus_e osXmlWriter_startElem(osXmlWriter_t* pWriter, const osXmlWriterTag_t* pTag);
+osStatus_e osXmlWriter_endElem(osXmlWriter_t* pWriter);
+//add a attribute to the element that is just started, the name may have one prefix like xsi:type, the value is escaped
+osStatus_e osXmlWriter_attr(osXmlWriter_t* pWriter, const osPointerLen_t* name, const osPointerLen_t* value);
+//declare a namespace in the element that is just started, nsAlias=NULL for the default namespace
+osStatus_e osXmlWriter_nsDecl(osXmlWriter_t* pWriter, const osPointerLen_t* nsAlias, const osPointerLen_t* ns);
+//write the value of the current element, a string value is escaped
+osStatus_e osXmlWriter_str(osXmlWriter_t* pWriter, const osPointerLen_t* value);
+osStatus_e osXmlWriter_int(osXmlWriter_t* pWriter, int64_t value);
+osStatus_e osXmlWriter_bool(osXmlWriter_t* pWriter, bool value);
+//write <tag>value</tag>, the value is taken from pXmlData per pXmlData->dataType
+osStatus_e osXmlWriter_leaf(osXmlWriter_t* pWriter, const osXmlWriterTag_t* pTag, const osXmlData_t* pXmlData);
+//write the leaf children of the current element in the xsd order, each xmlData[i] is a child value named by xmlData[i].dataName.  only for a writer with xsd
+osStatus_e osXmlWriter_writeData(osXmlWriter_t* pWriter, const osXmlData_t* xmlData, uint32_t dataNum);
 osMBuf_t* osXsd_initNS(char* fileFolder, char* xsdFileName);
+//export a parsed xsd (xsdName is the target namespace, or the xsd file name if the xsd has no target namespace) to a precompiled binary file
+osStatus_e osXsd_exportBin(osPointerLen_t* xsdName, char* fileFolder, char* binFileName);
+//load a precompiled binary xsd file created by osXsd_exportBin(), the file is mapped and used in place, no xsd text is parsed or kept
+osStatus_e osXsd_initNSBin(char* fileFolder, char* binFileName);
 bool osXsd_isExistSchema(osPointerLen_t* pTargetNS);
 osPointerLen_t* osXml_getnsInfo(void* pnsAliasInfo);
 bool osXsd_isValid(osMBuf_t* pXsdBuf, osPointerLen_t* xsdName, bool isKeepNsList);
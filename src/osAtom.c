@@ -0,0 +1,314 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osAtom.c  String interning
+ ********************************************************/
+
+#include <string.h>
+#include <pthread.h>
+
+#include "osTypes.h"
+#include "osPL.h"
+#include "osMemory.h"
+#include "osDebug.h"
+#include "osAtom.h"
+
+
+typedef struct osAtomInfo {
+	osPointerLen_t pl;		//canonical string, pl.p is NUL terminated
+	uint32_t hash;
+} osAtomInfo_t;
+
+
+typedef struct osAtomSlot {
+	uint32_t hash;
+	osAtom_t atom;			//OS_ATOM_NONE for a empty slot
+} osAtomSlot_t;
+
+
+/* the atom info is kept in pages that are never moved or freed, so that osAtom_getPL() can read it
+ * without lock.  The canonical strings are carved from string blocks, since atoms are never freed, there
+ * is no need to take a memory block for each of them.  The hash table is protected by rwlock, it is rehashed
+ * when it grows */
+static struct {
+	pthread_rwlock_t lock;
+	osAtomSlot_t* slot;
+	uint32_t slotNum;			//power of 2
+	uint32_t atomNum;			//the number of atoms, atom value 1..atomNum are in use
+	char* pStrBlock;			//the current string block
+	size_t strBlockPos;			//the first unused byte of pStrBlock
+	osAtomInfo_t* page[OS_ATOM_MAX_PAGE];
+} osAtomTable = {PTHREAD_RWLOCK_INITIALIZER};
+
+
+static osAtom_t osAtom_lookup(const osPointerLen_t* pl, bool isCaseFold, uint32_t hash);
+static osAtom_t osAtom_add(const osPointerLen_t* pl, bool isCaseFold, uint32_t hash);
+static bool osAtom_grow(void);
+static char* osAtom_allocStr(size_t len);
+
+
+static inline uint8_t osAtom_lower(uint8_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+
+//FNV-1a, of the lower cased string if isCaseFold = true
+static inline uint32_t osAtom_hash(const osPointerLen_t* pl, bool isCaseFold)
+{
+	uint32_t h = 2166136261u;
+	for(size_t i=0; i<pl->l; i++)
+	{
+		h ^= isCaseFold ? osAtom_lower(pl->p[i]) : (uint8_t)pl->p[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+
+static inline osAtomInfo_t* osAtom_getInfo(osAtom_t atom)
+{
+	return &osAtomTable.page[(atom-1) / OS_ATOM_PAGE_SIZE][(atom-1) % OS_ATOM_PAGE_SIZE];
+}
+
+
+osAtom_t osAtom_intern(const osPointerLen_t* pl, bool isCaseFold)
+{
+	if(!pl || (!pl->p && pl->l))
+	{
+		logError("null pointer, pl=%p.", pl);
+		return OS_ATOM_NONE;
+	}
+
+	uint32_t hash = osAtom_hash(pl, isCaseFold);
+
+	pthread_rwlock_rdlock(&osAtomTable.lock);
+	osAtom_t atom = osAtom_lookup(pl, isCaseFold, hash);
+	pthread_rwlock_unlock(&osAtomTable.lock);
+	if(atom != OS_ATOM_NONE)
+	{
+		return atom;
+	}
+
+	//check again after the write lock, another thread may have added it
+	pthread_rwlock_wrlock(&osAtomTable.lock);
+	atom = osAtom_lookup(pl, isCaseFold, hash);
+	if(atom == OS_ATOM_NONE)
+	{
+		atom = osAtom_add(pl, isCaseFold, hash);
+	}
+	pthread_rwlock_unlock(&osAtomTable.lock);
+
+	return atom;
+}
+
+
+osAtom_t osAtom_find(const osPointerLen_t* pl, bool isCaseFold)
+{
+	if(!pl || (!pl->p && pl->l))
+	{
+		return OS_ATOM_NONE;
+	}
+
+	uint32_t hash = osAtom_hash(pl, isCaseFold);
+
+	pthread_rwlock_rdlock(&osAtomTable.lock);
+	osAtom_t atom = osAtom_lookup(pl, isCaseFold, hash);
+	pthread_rwlock_unlock(&osAtomTable.lock);
+
+	return atom;
+}
+
+
+const osPointerLen_t* osAtom_getPL(osAtom_t atom)
+{
+	if(atom == OS_ATOM_NONE || atom > __atomic_load_n(&osAtomTable.atomNum, __ATOMIC_ACQUIRE))
+	{
+		return NULL;
+	}
+
+	return &osAtom_getInfo(atom)->pl;
+}
+
+
+uint32_t osAtom_getHash(osAtom_t atom)
+{
+	if(atom == OS_ATOM_NONE || atom > __atomic_load_n(&osAtomTable.atomNum, __ATOMIC_ACQUIRE))
+	{
+		return 0;
+	}
+
+	return osAtom_getInfo(atom)->hash;
+}
+
+
+uint32_t osAtom_getNum(void)
+{
+	return __atomic_load_n(&osAtomTable.atomNum, __ATOMIC_ACQUIRE);
+}
+
+
+//the caller shall hold the lock
+static osAtom_t osAtom_lookup(const osPointerLen_t* pl, bool isCaseFold, uint32_t hash)
+{
+	if(!osAtomTable.slot)
+	{
+		return OS_ATOM_NONE;
+	}
+
+	uint32_t mask = osAtomTable.slotNum - 1;
+	for(uint32_t i = hash & mask; osAtomTable.slot[i].atom != OS_ATOM_NONE; i = (i + 1) & mask)
+	{
+		if(osAtomTable.slot[i].hash != hash)
+		{
+			continue;
+		}
+
+		const osPointerLen_t* pCanonical = &osAtom_getInfo(osAtomTable.slot[i].atom)->pl;
+		if(pCanonical->l != pl->l)
+		{
+			continue;
+		}
+
+		size_t j;
+		for(j=0; j<pl->l; j++)
+		{
+			if((uint8_t)pCanonical->p[j] != (isCaseFold ? osAtom_lower(pl->p[j]) : (uint8_t)pl->p[j]))
+			{
+				break;
+			}
+		}
+
+		if(j == pl->l)
+		{
+			return osAtomTable.slot[i].atom;
+		}
+	}
+
+	return OS_ATOM_NONE;
+}
+
+
+//the caller shall hold the write lock
+static osAtom_t osAtom_add(const osPointerLen_t* pl, bool isCaseFold, uint32_t hash)
+{
+	if(osAtomTable.atomNum + 1 >= OS_ATOM_PAGE_SIZE * OS_ATOM_MAX_PAGE)
+	{
+		logError("the number of atoms exceeds the limit(%d).", OS_ATOM_PAGE_SIZE * OS_ATOM_MAX_PAGE - 1);
+		return OS_ATOM_NONE;
+	}
+
+	if(2 * (osAtomTable.atomNum + 1) > osAtomTable.slotNum && !osAtom_grow())
+	{
+		return OS_ATOM_NONE;
+	}
+
+	osAtom_t atom = osAtomTable.atomNum + 1;
+	uint32_t pageIdx = (atom-1) / OS_ATOM_PAGE_SIZE;
+	if(!osAtomTable.page[pageIdx])
+	{
+		osAtomTable.page[pageIdx] = osmalloc(OS_ATOM_PAGE_SIZE * sizeof(osAtomInfo_t), NULL);
+		if(!osAtomTable.page[pageIdx])
+		{
+			logError("fails to allocate atom page %d.", pageIdx);
+			return OS_ATOM_NONE;
+		}
+	}
+
+	char* p = osAtom_allocStr(pl->l + 1);
+	if(!p)
+	{
+		logError("fails to allocate memory for atom string, len=%ld.", pl->l);
+		return OS_ATOM_NONE;
+	}
+
+	for(size_t i=0; i<pl->l; i++)
+	{
+		p[i] = isCaseFold ? osAtom_lower(pl->p[i]) : pl->p[i];
+	}
+	p[pl->l] = 0;
+
+	osAtomInfo_t* pInfo = osAtom_getInfo(atom);
+	pInfo->pl.p = p;
+	pInfo->pl.l = pl->l;
+	pInfo->hash = hash;
+
+	uint32_t mask = osAtomTable.slotNum - 1;
+	uint32_t i = hash & mask;
+	while(osAtomTable.slot[i].atom != OS_ATOM_NONE)
+	{
+		i = (i + 1) & mask;
+	}
+	osAtomTable.slot[i].hash = hash;
+	osAtomTable.slot[i].atom = atom;
+
+	//publish the atom info before the atom number, for osAtom_getPL() that does not take the lock
+	__atomic_store_n(&osAtomTable.atomNum, atom, __ATOMIC_RELEASE);
+
+	return atom;
+}
+
+
+//the caller shall hold the write lock
+static bool osAtom_grow(void)
+{
+	uint32_t slotNum = osAtomTable.slotNum ? 2 * osAtomTable.slotNum : OS_ATOM_INIT_TABLE_SIZE;
+	osAtomSlot_t* slot = oszalloc(slotNum * sizeof(osAtomSlot_t), NULL);
+	if(!slot)
+	{
+		logError("fails to allocate atom hash table, slotNum=%d.", slotNum);
+		return false;
+	}
+
+	uint32_t mask = slotNum - 1;
+	for(uint32_t j=0; j<osAtomTable.slotNum; j++)
+	{
+		if(osAtomTable.slot[j].atom == OS_ATOM_NONE)
+		{
+			continue;
+		}
+
+		uint32_t i = osAtomTable.slot[j].hash & mask;
+		while(slot[i].atom != OS_ATOM_NONE)
+		{
+			i = (i + 1) & mask;
+		}
+		slot[i] = osAtomTable.slot[j];
+	}
+
+	osfree(osAtomTable.slot);
+	osAtomTable.slot = slot;
+	osAtomTable.slotNum = slotNum;
+
+	return true;
+}
+
+
+//the caller shall hold the write lock
+static char* osAtom_allocStr(size_t len)
+{
+	//a long string takes its own memory, so that a string block is not wasted
+	if(len > OS_ATOM_STR_BLOCK_SIZE / 4)
+	{
+		return osmalloc(len, NULL);
+	}
+
+	if(!osAtomTable.pStrBlock || osAtomTable.strBlockPos + len > OS_ATOM_STR_BLOCK_SIZE)
+	{
+		//the old block is not freed, it is still used by the existing atoms
+		char* pStrBlock = osmalloc(OS_ATOM_STR_BLOCK_SIZE, NULL);
+		if(!pStrBlock)
+		{
+			return NULL;
+		}
+
+		osAtomTable.pStrBlock = pStrBlock;
+		osAtomTable.strBlockPos = 0;
+	}
+
+	char* p = &osAtomTable.pStrBlock[osAtomTable.strBlockPos];
+	osAtomTable.strBlockPos += len;
+
+	return p;
+}
@@ -9,9 +9,18 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <time.h>
+#include <string.h>
 #include "osTypes.h"
 #include "osPrintf.h"
 #include "osDebug.h"
+#include "osDebugBin.h"
+#include "osPL.h"
+#include "osMBuf.h"
+#include "osString.h"
+
+
+#define OS_DBG_DEFAULT_RATE_PER_SEC	200
+#define OS_DBG_DEFAULT_RATE_BURST	1000
 
 
 /** Debug configuration */
@@ -32,8 +41,33 @@ static struct osDbg {
 };
 
 
+/** Binary log configuration, protected by osDbgInfo.mutex */
+static struct osDbgBin {
+	FILE *f;               /**< Binary logfile, NULL if binary log is off */
+	uint32_t fileGen;      /**< Increased each time a binary logfile is opened */
+	uint32_t siteCount;    /**< The last assigned call site id */
+	uint16_t threadCount;  /**< The last assigned thread idx */
+} osDbgBinInfo;
+
+/** Per call site log rate limiting configuration */
+static struct osDbgRate {
+	uint64_t intervalUsec;  /**< 1 second / ratePerSec, 0 if the rate limiting is off */
+	uint64_t burstUsec;     /**< burst * intervalUsec */
+} osDbgRateInfo = {
+	1000000 / OS_DBG_DEFAULT_RATE_PER_SEC,
+	1000000 / OS_DBG_DEFAULT_RATE_PER_SEC * OS_DBG_DEFAULT_RATE_BURST,
+};
+
+static __thread uint16_t osDbgBinThreadIdx;
+static __thread uint32_t osDbgBinThreadGen;
+
+
 static osDbgLevel_e osDbgMLevel[LM_ALL+1];
 
+static void osDbgBin_writeRec(uint8_t* rec, size_t len, osDbgBinRecType_e recType, int level, osLogModule_e module, uint32_t siteId, uint64_t usec);
+static bool osDbgBin_putStr(uint8_t* buf, size_t size, size_t* pLen, const char* str, size_t strLen);
+static int osDbgBin_encodeArgs(uint8_t* buf, size_t size, const char *fmt, va_list ap);
+
 
 
 static inline void osDbg_lock(void)
@@ -311,3 +345,448 @@ void osDbg_printStr(const char* str, size_t strlen)
 		free(pStr);
 	}
 }
+
+
+/**
+ * Set the per call site log rate limiting
+ *
+ * @param ratePerSec The number of logs a call site may log per second after a burst, 0 to turn off the rate limiting.  Capped at 1000000
+ * @param burst      The number of logs a call site may log at once
+ */
+void osDbg_setRateLimit(uint32_t ratePerSec, uint32_t burst)
+{
+	osDbg_lock();
+	if (!ratePerSec)
+	{
+		osDbgRateInfo.intervalUsec = 0;
+		osDbgRateInfo.burstUsec = 0;
+	}
+	else
+	{
+		//the bucket has usec resolution, a rate above 1000000 per second is limited to 1000000 per second, instead of a 0 interval that would turn off the rate limiting
+		osDbgRateInfo.intervalUsec = ratePerSec > 1000000 ? 1 : 1000000 / ratePerSec;
+		osDbgRateInfo.burstUsec = osDbgRateInfo.intervalUsec * (burst ? burst : 1);
+	}
+	osDbg_unlock();
+}
+
+
+/**
+ * Check a log against its call site token bucket.  The bucket is kept as the theoretical arrival
+ * time (GCRA) of the site, updated with a CAS, so no lock is taken
+ *
+ * @param pSite       The log call site
+ * @param pSuppressed The number of logs of the site suppressed since the last logged one, only set when the log is not limited
+ *
+ * @return true if the log shall be suppressed
+ */
+bool osDbg_isRateLimited(osDbgSite_t* pSite, uint32_t* pSuppressed)
+{
+	uint64_t intervalUsec = osDbgRateInfo.intervalUsec;
+	uint64_t nowUsec, tat, newTat;
+	const osTimeCache_t* pTime;
+
+	if (!intervalUsec || !pSite)
+	{
+		return false;
+	}
+
+	pTime = osTime_updateCache();
+	nowUsec = (uint64_t)pTime->ts.tv_sec * 1000000 + pTime->ts.tv_nsec / 1000;
+
+	tat = __atomic_load_n(&pSite->tatUsec, __ATOMIC_RELAXED);
+	do {
+		newTat = (tat > nowUsec ? tat : nowUsec) + intervalUsec;
+		if (newTat - nowUsec > osDbgRateInfo.burstUsec)
+		{
+			__atomic_fetch_add(&pSite->suppressed, 1, __ATOMIC_RELAXED);
+			return true;
+		}
+	} while (!__atomic_compare_exchange_n(&pSite->tatUsec, &tat, newTat, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	if (pSuppressed && __atomic_load_n(&pSite->suppressed, __ATOMIC_RELAXED))
+	{
+		*pSuppressed = __atomic_exchange_n(&pSite->suppressed, 0, __ATOMIC_RELAXED);
+	}
+
+	return false;
+}
+
+
+/**
+ * Close the binary logfile, the logs are formatted into the text log again
+ */
+void osDbg_binClose(void)
+{
+	osDbg_lock();
+	if (osDbgBinInfo.f) {
+		(void)fclose(osDbgBinInfo.f);
+		osDbgBinInfo.f = NULL;
+	}
+	osDbg_unlock();
+}
+
+
+/**
+ * Set binary logfile.  When set, the log macros write the raw log arguments into the binary logfile,
+ * and do not format the text log.  Use the oslogdecode tool to render a binary logfile to text
+ *
+ * @param name Name of the binary logfile, NULL to close
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osDbg_setBinLogfile(const char *name)
+{
+	struct timespec rt, mt;
+	uint8_t rec[sizeof(osDbgBinRecHdr_t) + OS_DBG_BIN_MAGIC_LEN + sizeof(uint32_t) + sizeof(uint64_t)];
+	size_t len = sizeof(osDbgBinRecHdr_t);
+	uint32_t version = OS_DBG_BIN_VERSION;
+	uint64_t usec;
+	FILE *f;
+
+	osDbg_binClose();
+
+	if (!name)
+		return 0;
+
+	f = fopen(name, "ab");
+	if (!f)
+	{
+		return errno;
+	}
+
+	osDbg_lock();
+
+	osDbgBinInfo.f = f;
+	//a new generation makes each thread and call site to be written into the new file again
+	osDbgBinInfo.fileGen++;
+
+	clock_gettime(CLOCK_REALTIME, &rt);
+	clock_gettime(CLOCK_MONOTONIC, &mt);
+
+	memcpy(&rec[len], OS_DBG_BIN_MAGIC, OS_DBG_BIN_MAGIC_LEN);
+	len += OS_DBG_BIN_MAGIC_LEN;
+	memcpy(&rec[len], &version, sizeof(uint32_t));
+	len += sizeof(uint32_t);
+	usec = (uint64_t)rt.tv_sec * 1000000 + rt.tv_nsec / 1000;
+	memcpy(&rec[len], &usec, sizeof(uint64_t));
+	len += sizeof(uint64_t);
+
+	osDbgBin_writeRec(rec, len, OS_DBG_BIN_REC_START, DBG_EMERG, LM_ALL, 0, (uint64_t)mt.tv_sec * 1000000 + mt.tv_nsec / 1000);
+	(void)fflush(osDbgBinInfo.f);
+
+	osDbg_unlock();
+
+	return 0;
+}
+
+
+bool osDbg_isBinary(void)
+{
+	return osDbgBinInfo.f != NULL;
+}
+
+
+/**
+ * Write a log into the binary logfile
+ *
+ * @param level  Debug level
+ * @param module Log module
+ * @param pSite  The log call site
+ * @param fmt    Formatted string
+ */
+void osDbg_binPrintf(int level, osLogModule_e module, osDbgSite_t* pSite, const char *fmt, ...)
+{
+	uint8_t rec[OS_DBG_BIN_MAX_REC_SIZE];
+	size_t len;
+	struct timespec tp;
+	va_list ap;
+	int argLen = -1;
+
+	if (level > osDbgInfo.level || !pSite || !fmt)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+
+	osDbg_lock();
+
+	if (!osDbgBinInfo.f)
+		goto out;
+
+	//the first log of a thread into the file, write the thread record
+	if (osDbgBinThreadGen != osDbgBinInfo.fileGen)
+	{
+		pthread_t tid = pthread_self();
+		uint64_t tid64 = (uint64_t)tid;
+
+		if (!osDbgBinThreadIdx)
+		{
+			osDbgBinThreadIdx = ++osDbgBinInfo.threadCount;
+		}
+		osDbgBinThreadGen = osDbgBinInfo.fileGen;
+
+		len = sizeof(osDbgBinRecHdr_t);
+		memcpy(&rec[len], &tid64, sizeof(uint64_t));
+		len += sizeof(uint64_t);
+		osDbgBin_writeRec(rec, len, OS_DBG_BIN_REC_THREAD, level, module, 0, 0);
+	}
+
+	//the first log of a call site into the file, write the site record
+	if (!pSite->siteId)
+	{
+		pSite->siteId = ++osDbgBinInfo.siteCount;
+		pSite->fmt = fmt;
+	}
+	if (pSite->fileGen != osDbgBinInfo.fileGen)
+	{
+		uint32_t line = pSite->line;
+
+		pSite->fileGen = osDbgBinInfo.fileGen;
+
+		len = sizeof(osDbgBinRecHdr_t);
+		memcpy(&rec[len], &line, sizeof(uint32_t));
+		len += sizeof(uint32_t);
+		(void)osDbgBin_putStr(rec, sizeof(rec), &len, pSite->file, osStrLen(pSite->file));
+		(void)osDbgBin_putStr(rec, sizeof(rec), &len, pSite->func, osStrLen(pSite->func));
+		(void)osDbgBin_putStr(rec, sizeof(rec), &len, pSite->levelStr, osStrLen(pSite->levelStr));
+		(void)osDbgBin_putStr(rec, sizeof(rec), &len, pSite->fmt, osStrLen(pSite->fmt));
+		if (len < sizeof(rec))
+		{
+			rec[len++] = pSite->isNoPrefix;
+		}
+		osDbgBin_writeRec(rec, len, OS_DBG_BIN_REC_SITE, level, module, pSite->siteId, 0);
+	}
+
+	len = sizeof(osDbgBinRecHdr_t);
+
+	//the raw arguments can only be decoded by the site fmt
+	if (fmt == pSite->fmt)
+	{
+		va_start(ap, fmt);
+		argLen = osDbgBin_encodeArgs(&rec[len], sizeof(rec) - len, fmt, ap);
+		va_end(ap);
+	}
+
+	if (argLen >= 0)
+	{
+		osDbgBin_writeRec(rec, len + argLen, OS_DBG_BIN_REC_LOG, level, module, pSite->siteId, (uint64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000);
+	}
+	else
+	{
+		//fall back to the formatted log body, the 2 bytes before the text are for the text len
+		char* text = (char*)&rec[len + sizeof(uint16_t)];
+		uint16_t textLen;
+
+		va_start(ap, fmt);
+		(void)osPrintf_onBuffer(text, sizeof(rec) - len - sizeof(uint16_t), fmt, ap);
+		va_end(ap);
+
+		textLen = strlen(text);
+		memcpy(&rec[len], &textLen, sizeof(uint16_t));
+		osDbgBin_writeRec(rec, len + sizeof(uint16_t) + textLen, OS_DBG_BIN_REC_TEXT, level, module, pSite->siteId, (uint64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000);
+	}
+
+	//do not flush each debug log, that is the bulk of the logs
+	if (level <= DBG_WARNING)
+	{
+		(void)fflush(osDbgBinInfo.f);
+	}
+
+ out:
+	osDbg_unlock();
+}
+
+
+/* fill the record header and write the record into the binary logfile.  The caller shall hold the lock */
+static void osDbgBin_writeRec(uint8_t* rec, size_t len, osDbgBinRecType_e recType, int level, osLogModule_e module, uint32_t siteId, uint64_t usec)
+{
+	osDbgBinRecHdr_t* pHdr = (osDbgBinRecHdr_t*)rec;
+
+	pHdr->recLen = len;
+	pHdr->recType = recType;
+	pHdr->level = level;
+	pHdr->module = module;
+	pHdr->threadIdx = osDbgBinThreadIdx;
+	pHdr->siteId = siteId;
+	pHdr->usec = usec;
+
+	(void)fwrite(rec, 1, len, osDbgBinInfo.f);
+}
+
+
+/* put a string as (uint16_t len, chars), the string is truncated if there is not enough space.  return false if even the len can not be put */
+static bool osDbgBin_putStr(uint8_t* buf, size_t size, size_t* pLen, const char* str, size_t strLen)
+{
+	uint16_t l;
+
+	if (*pLen + sizeof(uint16_t) > size)
+	{
+		return false;
+	}
+
+	l = min(strLen, size - *pLen - sizeof(uint16_t));
+	if (!str)
+	{
+		l = 0;
+	}
+
+	memcpy(&buf[*pLen], &l, sizeof(uint16_t));
+	*pLen += sizeof(uint16_t);
+	if (l)
+	{
+		memcpy(&buf[*pLen], str, l);
+		*pLen += l;
+	}
+
+	return true;
+}
+
+
+#define OS_DBG_BIN_PUT(buf, size, len, v) \
+	do { \
+		if (len + sizeof(v) > size) \
+			return -1; \
+		memcpy(&buf[len], &v, sizeof(v)); \
+		len += sizeof(v); \
+	} while(0)
+
+
+/* store the raw arguments following the fmt conversions, the same conversions as osPrintf_onHandler().
+ * return the encoded length, or -1 if a conversion can not be stored raw or if there is not enough space */
+static int osDbgBin_encodeArgs(uint8_t* buf, size_t size, const char *fmt, va_list ap)
+{
+	const osPointerLen_t *pl;
+	const osMBuf_t *pMbuf;
+	const char *str, *p;
+	bool fm = false;
+	int lenmod = 0;		//the number of 'l', -1 for 'z'
+	size_t len = 0, strLen;
+	int64_t n;
+	double dbl;
+
+	for (p = fmt; *p; p++)
+	{
+		if (!fm)
+		{
+			if (*p == '%')
+			{
+				fm = true;
+				lenmod = 0;
+			}
+			continue;
+		}
+
+		fm = false;
+
+		switch (*p)
+		{
+			case '-':
+			case '.':
+			case '0' ... '9':
+				fm = true;
+				break;
+
+			case 'l':
+				++lenmod;
+				fm = true;
+				break;
+
+			case 'z':
+				lenmod = -1;
+				fm = true;
+				break;
+
+			case '%':
+				break;
+
+			case 'd':
+			case 'i':
+				switch (lenmod)
+				{
+					case -1:
+						n = va_arg(ap, ssize_t);
+						break;
+					case 0:
+						n = va_arg(ap, signed);
+						break;
+					case 1:
+						n = va_arg(ap, signed long);
+						break;
+					default:
+						n = va_arg(ap, signed long long);
+						break;
+				}
+				OS_DBG_BIN_PUT(buf, size, len, n);
+				break;
+
+			case 'u':
+			case 'x':
+			case 'X':
+				switch (lenmod)
+				{
+					case -1:
+						n = va_arg(ap, size_t);
+						break;
+					case 0:
+						n = va_arg(ap, unsigned);
+						break;
+					case 1:
+						n = va_arg(ap, unsigned long);
+						break;
+					default:
+						n = va_arg(ap, unsigned long long);
+						break;
+				}
+				OS_DBG_BIN_PUT(buf, size, len, n);
+				break;
+
+			case 'c':
+			case 'm':
+				n = va_arg(ap, int);
+				OS_DBG_BIN_PUT(buf, size, len, n);
+				break;
+
+			case 'p':
+				n = (intptr_t)va_arg(ap, void *);
+				OS_DBG_BIN_PUT(buf, size, len, n);
+				break;
+
+			case 'f':
+			case 'F':
+				dbl = va_arg(ap, double);
+				OS_DBG_BIN_PUT(buf, size, len, dbl);
+				break;
+
+			case 's':
+				str = va_arg(ap, const char *);
+				if (!osDbgBin_putStr(buf, size, &len, str, osStrLen(str)))
+					return -1;
+				break;
+
+			case 'r':
+				pl = va_arg(ap, const osPointerLen_t *);
+				if (!osDbgBin_putStr(buf, size, &len, pl ? pl->p : NULL, pl ? pl->l : 0))
+					return -1;
+				break;
+
+			case 'b':
+				str = va_arg(ap, const char *);
+				strLen = va_arg(ap, size_t);
+				if (!osDbgBin_putStr(buf, size, &len, str, strLen))
+					return -1;
+				break;
+
+			case 'M':
+				pMbuf = va_arg(ap, const osMBuf_t *);
+				if (!osDbgBin_putStr(buf, size, &len, pMbuf ? (const char*)pMbuf->buf : NULL, pMbuf ? pMbuf->end : 0))
+					return -1;
+				break;
+
+			default:
+				//%H, %v, %A, %w, etc., fall back to the text log
+				return -1;
+		}
+	}
+
+	return len;
+}
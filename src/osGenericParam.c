@@ -9,13 +9,42 @@
  * Copyright (C) 2010 Creytiv.com
  ********************************************************/
 
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
 #include "osTypes.h"
-#include "osPrintf.h"
-#include "osRegex.h"
 #include "osPL.h"
+#include "osDebug.h"
 #include "osGenericParam.h"
 
 
+#define OS_GPARAM_CHAR_WS		0x1
+#define OS_GPARAM_CHAR_SEMI		0x2
+#define OS_GPARAM_CHAR_EQ		0x4
+#define OS_GPARAM_CHAR_QUOTE	0x8
+#define OS_GPARAM_CHAR_ESC		0x10
+
+#define OS_GPARAM_MAX_SEED_TRY	10000
+
+
+static const uint8_t osGParamCharType[256] = {
+	[' '] = OS_GPARAM_CHAR_WS,
+	['\t'] = OS_GPARAM_CHAR_WS,
+	['\r'] = OS_GPARAM_CHAR_WS,
+	['\n'] = OS_GPARAM_CHAR_WS,
+	[';'] = OS_GPARAM_CHAR_SEMI,
+	['='] = OS_GPARAM_CHAR_EQ,
+	['"'] = OS_GPARAM_CHAR_QUOTE,
+	['\\'] = OS_GPARAM_CHAR_ESC,
+};
+
+
+static const char* osGenericParam_next(const char *p, const char *end, osGenericParam_t *pParam);
+static const char* osGenericParam_skipValue(const char *p, const char *end, uint8_t stopType);
+static inline uint32_t osGenericParam_hash(const char *p, size_t l, uint32_t seed);
+
+
 /**
  * Check if a semicolon separated parameter is present
  *
@@ -26,31 +55,28 @@
  */
 bool osGenericParam_isExist(const osPointerLen_t *pl, const char *pname)
 {
-	osPointerLen_t semi, eop;
-	char expr[128];
+	osGenericParam_t param;
 
 	if (!pl || !pname)
 		return false;
 
-	//create a reg expression
-	(void)osPrintf_buffer(expr, sizeof(expr), "[;]*[ \t\r\n]*%s[ \t\r\n;=]*", pname);
-
-	if (osRegex(pl->p, pl->l, expr, &semi, NULL, &eop))
+	size_t nameLen = strlen(pname);
+	const char *p = pl->p, *end = pl->p + pl->l;
+	while ((p = osGenericParam_next(p, end, &param)))
 	{
-		return false;
-	}
-
-	if (!eop.l && eop.p < pl->p + pl->l)
-	{
-		return false;
+		if (param.name.l == nameLen && !strncasecmp(param.name.p, pname, nameLen))
+		{
+			return true;
+		}
 	}
 
-	return semi.l > 0 || pl->p == semi.p;
+	return false;
 }
 
 
 /**
- * Fetch a semicolon separated parameter from a PL string
+ * Fetch a semicolon separated parameter from a PL string.  If the parameter appears more than once, the
+ * first one with a value is returned
  *
  * @param pl    PL string to search
  * @param pname Parameter name
@@ -60,20 +86,32 @@ bool osGenericParam_isExist(const osPointerLen_t *pl, const char *pname)
  */
 bool osGenericParam_get(const osPointerLen_t *pl, const char *pname, osPointerLen_t *val)
 {
-	osPointerLen_t semi;
-	char expr[128];
+	osGenericParam_t param;
 
 	if (!pl || !pname)
 		return false;
 
-	(void)osPrintf_buffer(expr, sizeof(expr), "[;]*[ \t\r\n]*%s[ \t\r\n]*=[ \t\r\n]*[~ \t\r\n;]+", pname);
-
-	if (osRegex(pl->p, pl->l, expr, &semi, NULL, NULL, NULL, val))
+	size_t nameLen = strlen(pname);
+	const char *p = pl->p, *end = pl->p + pl->l;
+	while ((p = osGenericParam_next(p, end, &param)))
 	{
-		return false;
+		if (param.name.l == nameLen && !strncasecmp(param.name.p, pname, nameLen))
+		{
+			//a parameter without value is not a match, like "lr" in ";lr;transport=tcp", keep looking for a same named one with value
+			if (!param.value.l)
+			{
+				continue;
+			}
+
+			if (val)
+			{
+				*val = param.value;
+			}
+			return true;
+		}
 	}
 
-	return semi.l > 0 || pl->p == semi.p;
+	return false;
 }
 
 
@@ -86,25 +124,222 @@ bool osGenericParam_get(const osPointerLen_t *pl, const char *pname, osPointerLe
  */
 void osGenericParam_apply(const osPointerLen_t *pl, osGParam_fmt_h *ph, void *arg)
 {
-	osPointerLen_t prmv, prm, semi, name, val;
+	osGenericParam_t param;
 
 	if (!pl || !ph)
 	{
 		return;
 	}
 
-	prmv = *pl;
+	const char *p = pl->p, *end = pl->p + pl->l;
+	while ((p = osGenericParam_next(p, end, &param)))
+	{
+		ph(&param.name, &param.value, arg);
+	}
+}
+
+
+int osGenericParam_tokenize(const osPointerLen_t *pl, osGenericParam_t *param, int paramMax)
+{
+	if (!pl || !param)
+	{
+		logError("null pointer, pl=%p, param=%p.", pl, param);
+		return 0;
+	}
+
+	int num = 0;
+	const char *p = pl->p, *end = pl->p + pl->l;
+	while (num < paramMax && (p = osGenericParam_next(p, end, &param[num])))
+	{
+		num++;
+	}
+
+	return num;
+}
+
+
+/* find a seed that maps all names into different table slots.  With at most 32 names in 256 slots, a seed
+ * is normally found in a few tries */
+int osGenericParamSet_init(osGenericParamSet_t *pSet, const char *name[], int num)
+{
+	if (!pSet || !name)
+	{
+		logError("null pointer, pSet=%p, name=%p.", pSet, name);
+		return EINVAL;
+	}
+
+	if (num > OS_GENERIC_PARAM_SET_MAX_NUM)
+	{
+		logError("num(%d) exceeds OS_GENERIC_PARAM_SET_MAX_NUM(%d).", num, OS_GENERIC_PARAM_SET_MAX_NUM);
+		return EINVAL;
+	}
 
-	while (!osRegex(prmv.p, prmv.l, "[ \t\r\n]*[~;]+[;]*", NULL, &prm, &semi)) 
+	memset(pSet, 0, sizeof(osGenericParamSet_t));
+	pSet->num = num;
+	for (int i=0; i<num; i++)
 	{
+		pSet->name[i].p = name[i];
+		pSet->name[i].l = strlen(name[i]);
+	}
 
-		osPL_advance(&prmv, semi.p + semi.l - prmv.p);
+	for (uint32_t seed=0; seed<OS_GPARAM_MAX_SEED_TRY; seed++)
+	{
+		int i;
+		memset(pSet->table, 0, sizeof(pSet->table));
+		for (i=0; i<num; i++)
+		{
+			uint32_t slot = osGenericParam_hash(pSet->name[i].p, pSet->name[i].l, seed);
+			if (pSet->table[slot])
+			{
+				break;
+			}
+			pSet->table[slot] = i + 1;
+		}
 
-		if (osRegex(prm.p, prm.l, "[^ \t\r\n=]+[ \t\r\n]*[=]*[ \t\r\n]*[~ \t\r\n]*", &name, NULL, NULL, NULL, &val))
+		if (i == num)
 		{
-			break;
+			pSet->seed = seed;
+			return 0;
 		}
+	}
+
+	logError("fails to find a perfect hash seed, there may be duplicate names.");
+	return EINVAL;
+}
+
 
-		ph(&name, &val, arg);
+int osGenericParamSet_lookup(const osGenericParamSet_t *pSet, const osPointerLen_t *name)
+{
+	if (!pSet || !name || !pSet->num)
+	{
+		return -1;
+	}
+
+	uint8_t idx = pSet->table[osGenericParam_hash(name->p, name->l, pSet->seed)];
+	if (!idx || osPL_casecmp(&pSet->name[idx-1], name))
+	{
+		return -1;
 	}
+
+	return idx - 1;
+}
+
+
+int osGenericParam_getMulti(const osPointerLen_t *pl, const osGenericParamSet_t *pSet, osGenericParam_t *param)
+{
+	osGenericParam_t nv;
+
+	if (!pl || !pSet || !param)
+	{
+		logError("null pointer, pl=%p, pSet=%p, param=%p.", pl, pSet, param);
+		return 0;
+	}
+
+	memset(param, 0, pSet->num * sizeof(osGenericParam_t));
+
+	int found = 0;
+	const char *p = pl->p, *end = pl->p + pl->l;
+	while (found < pSet->num && (p = osGenericParam_next(p, end, &nv)))
+	{
+		int idx = osGenericParamSet_lookup(pSet, &nv.name);
+		//the first one wins if a parameter appears more than once
+		if (idx >= 0 && !param[idx].name.l)
+		{
+			param[idx] = nv;
+			found++;
+		}
+	}
+
+	return found;
+}
+
+
+/* get the next parameter from p.  A parameter is "name[ws][=][ws][value]" separated by ';' and optional
+ * white spaces, a double quoted value may have ';' and white spaces, and '\\' escapes the next char.
+ * the chars of a parameter after the value, or a parameter without name, are ignored.
+ * return the position after the parameter, or NULL if there is no more parameter
+ */
+static const char* osGenericParam_next(const char *p, const char *end, osGenericParam_t *pParam)
+{
+	while (p < end)
+	{
+		while (p < end && (osGParamCharType[(uint8_t)*p] & (OS_GPARAM_CHAR_WS | OS_GPARAM_CHAR_SEMI)))
+			p++;
+
+		if (p == end)
+			return NULL;
+
+		pParam->name.p = p;
+		while (p < end && !(osGParamCharType[(uint8_t)*p] & (OS_GPARAM_CHAR_WS | OS_GPARAM_CHAR_SEMI | OS_GPARAM_CHAR_EQ)))
+			p++;
+		pParam->name.l = p - pParam->name.p;
+
+		while (p < end && (osGParamCharType[(uint8_t)*p] & (OS_GPARAM_CHAR_WS | OS_GPARAM_CHAR_EQ)))
+			p++;
+
+		pParam->value.p = p;
+		p = osGenericParam_skipValue(p, end, OS_GPARAM_CHAR_WS | OS_GPARAM_CHAR_SEMI);
+		pParam->value.l = p - pParam->value.p;
+
+		/* Strip quotes */
+		if (pParam->value.l > 1 && pParam->value.p[0] == '"' && pParam->value.p[pParam->value.l - 1] == '"')
+		{
+			pParam->value.p++;
+			pParam->value.l -= 2;
+		}
+
+		//skip whatever is left until the next ';'
+		p = osGenericParam_skipValue(p, end, OS_GPARAM_CHAR_SEMI);
+
+		if (pParam->name.l)
+			return p;
+	}
+
+	return NULL;
+}
+
+
+//move p until a char of stopType that is not inside double quotes or escaped
+static const char* osGenericParam_skipValue(const char *p, const char *end, uint8_t stopType)
+{
+	bool quote = false;
+
+	for (; p < end; p++)
+	{
+		uint8_t type = osGParamCharType[(uint8_t)*p];
+		if (!type)
+			continue;
+
+		if (type & OS_GPARAM_CHAR_ESC)
+		{
+			if (++p == end)
+				break;
+			continue;
+		}
+
+		if (type & OS_GPARAM_CHAR_QUOTE)
+		{
+			quote = !quote;
+			continue;
+		}
+
+		if (!quote && (type & stopType))
+			break;
+	}
+
+	return p;
+}
+
+
+//FNV-1a of the lower cased name
+static inline uint32_t osGenericParam_hash(const char *p, size_t l, uint32_t seed)
+{
+	uint32_t h = 2166136261u ^ seed;
+	for (size_t i=0; i<l; i++)
+	{
+		h ^= (uint8_t)p[i] | 0x20;
+		h *= 16777619u;
+	}
+
+	return h & (OS_GENERIC_PARAM_SET_TABLE_SIZE - 1);
 }
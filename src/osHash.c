@@ -25,6 +25,7 @@
 static uint32_t osHash_getKeyStr(const char* str, size_t len, bool isCase);
 //static uint32_t osHash_getKeyPL(const osPointerLen_t* pPL,bool isCase);
 static bool osHashCompare(osListElement_t *le, void *data);
+static void osHash_clearBucket(osList_t* pList, bool isFreeData);
 
 
 static void osHash_destructor(void *data)
@@ -411,6 +412,67 @@ osListElement_t* osHash_addElement(osHash_t *h, uint32_t key, void *hashData, os
 }
 
 
+/**
+ * Add a intrusive hash node to the hashmap table, no memory is allocated
+ *
+ * @param h         Hashmap table
+ * @param pLink     Hash node embedded in the user data structure, the hash key shall have been set in pLink->hashData
+ * @param pUserData User data, normally the data structure that embeds pLink
+ */
+osListElement_t* osHash_addLink(osHash_t *h, osHashLink_t* pLink, void* pUserData)
+{
+	if(!h || !pLink)
+	{
+		logError("null pointer, h=%p, pLink=%p.", h, pLink);
+		return NULL;
+	}
+
+	if(pLink->hashLE.list)
+	{
+		logError("pLink(%p) is already in a hash.", pLink);
+		return NULL;
+	}
+
+	uint32_t key;
+	osHashData_t* pHashData = &pLink->hashData;
+	switch (pHashData->hashKeyType)
+	{
+		case OSHASHKEY_STR:
+			key = osHash_getKeyStr(pHashData->hashKeyStr.pl.p, pHashData->hashKeyStr.pl.l, pHashData->hashKeyStr.isCase);
+			break;
+		case OSHASHKEY_INT:
+			key = pHashData->hashKeyInt;
+			break;
+		case OSHASHKEY_PL:
+			key = osHash_getKeyPL(pHashData->hashKeyPL.pPL, pHashData->hashKeyPL.isCase);
+			break;
+		default:
+			logError("invalid hashKeyType (%d)", pHashData->hashKeyType);
+			return NULL;
+	}
+
+	pHashData->pData = pUserData;
+
+	return osHash_addElement(h, key, pHashData, &pLink->hashLE);
+}
+
+
+/**
+ * Remove a intrusive hash node from the hashmap table, no memory is freed
+ *
+ * @param pLink  Hash node embedded in the user data structure
+ */
+void osHash_removeLink(osHashLink_t* pLink)
+{
+	if(!pLink || !pLink->hashLE.list)
+	{
+		return;
+	}
+
+	osHash_deleteNode(&pLink->hashLE, OS_HASH_DEL_NODE_TYPE_NONE);
+}
+
+
 /**
  * Remove a hash element from the hashmap table, it is caller's responsibility to free the element
  *
@@ -712,7 +774,7 @@ void osHash_delete(osHash_t *h)
 	for (i=0; i<h->bsize; i++)
 	{
 		pthread_mutex_lock(&h->bucket[i].bucketMutex);
-		osList_delete(&h->bucket[i].bucketList);
+		osHash_clearBucket(&h->bucket[i].bucketList, true);
 		pthread_mutex_unlock(&h->bucket[i].bucketMutex);
 	}
 }
@@ -735,7 +797,7 @@ void osHash_clear(osHash_t *h)
 	for (i=0; i<h->bsize; i++)
 	{
 		pthread_mutex_lock(&h->bucket[i].bucketMutex);
-		osList_clear(&h->bucket[i].bucketList);
+		osHash_clearBucket(&h->bucket[i].bucketList, false);
 		pthread_mutex_unlock(&h->bucket[i].bucketMutex);
 	}
 }
@@ -856,6 +918,45 @@ void* osHash_getData(osListElement_t* pHashLE)
 }
 
 
+/* a hash link is added with pLE->data pointing to the hashData right after pLE in the same osHashLink_t.  A hash
+ * element allocated by osHash_add*() has its hashData allocated separately, which can not start right after the
+ * element since each osmalloc() memory has its own header */
+static inline bool osHash_isLink(const osListElement_t* pLE)
+{
+	return pLE->data == &osHash_getLink((osListElement_t*)pLE)->hashData;
+}
+
+
+/* unlink all elements of a bucket.  A allocated element is freed, together with its hashData if isFreeData=true.
+ * A hash link is only unlinked, its memory is part of the user data structure */
+static void osHash_clearBucket(osList_t* pList, bool isFreeData)
+{
+	osListElement_t* pLE = pList->head;
+	while (pLE)
+	{
+		osListElement_t* pNext = pLE->next;
+		void* data = pLE->data;
+		bool isLink = osHash_isLink(pLE);
+
+		pLE->list = NULL;
+		pLE->prev = pLE->next = NULL;
+		if (!isLink)
+		{
+			pLE->data = NULL;
+			osfree(pLE);
+			if (isFreeData)
+			{
+				osfree(data);
+			}
+		}
+
+		pLE = pNext;
+	}
+
+	osList_init(pList);
+}
+
+
 static bool osHashCompare(osListElement_t *le, void *data)
 {
     if(!data || ! le)
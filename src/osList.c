@@ -128,6 +128,63 @@ void osList_clear(osList_t* pList)
 }
 
 
+/**
+ * Unlink all elements of a intrusive list, the data structures that embed the elements are not touched
+ *
+ * @param pList Linked list
+ */
+void osList_unlinkAll(osList_t* pList)
+{
+	if (!pList)
+	{
+		return;
+	}
+
+	osListElement_t* pLE = pList->head;
+	while (pLE)
+	{
+		osListElement_t* pNext = pLE->next;
+		pLE->list = NULL;
+		pLE->prev = pLE->next = NULL;
+
+		pLE = pNext;
+	}
+
+	osList_init(pList);
+}
+
+
+/**
+ * Unlink all elements of a intrusive list, and free the data structures that embed the elements.  The element
+ * data must be the address of the data structure that embeds the element
+ *
+ * @param pList Linked list
+ */
+void osList_deleteLinked(osList_t* pList)
+{
+	if (!pList)
+	{
+		return;
+	}
+
+	mdebug(LM_MEM, "delete a intrusive list, pList=%p.", pList);
+	osListElement_t* pLE = pList->head;
+	while (pLE)
+	{
+		osListElement_t* pNext = pLE->next;
+		void* data = pLE->data;
+		pLE->list = NULL;
+		pLE->prev = pLE->next = NULL;
+
+		//the element is part of data, it is gone after data is freed
+		osfree(data);
+		pLE = pNext;
+	}
+
+	osList_init(pList);
+}
+
+
 /**
  * Append a list element to a linked list
  *
@@ -432,56 +489,131 @@ void osList_deleteElementAll(osListElement_t* pLE, bool isFreeData)
 }
 
 
-/**
- * Sort a linked list in an order defined by the sort handler
- *
- * @param list  Linked list
- * @param sh    Sort handler
- * @param arg   Handler argument
- */
-void osList_sort(osList_t *list, osListSortHandler sortHandler, void *arg)
+/* bottom up merge sort of a chain of elements linked by next, stable and without extra memory.  If isSwitchHandler
+ * = true, the sortHandler returns true when a element from the right run shall be placed before a element from the
+ * left run (osList_orderAppend() semantics), otherwise, the sortHandler returns true when the left one can stay
+ * before the right one (osList_sort() semantics).  return the new head, and the new tail in ppTail */
+static osListElement_t* osList_mergeSort(osListElement_t* pHead, osListSortHandler sortHandler, void* arg, bool isSwitchHandler, osListElement_t** ppTail)
 {
-	osListElement_t *le;
-	void* data = NULL;
-	bool sort;
-	uint32_t itCount=1;
+	osListElement_t* pTail = pHead;
+	size_t runLen = 1;
 
-	if (!list || !sortHandler)
-		return;
+	while (pHead)
+	{
+		osListElement_t* pLeft = pHead;
+		size_t mergeNum = 0;
 
-	uint32_t totalLE = osList_getCount(list);
+		pHead = NULL;
+		pTail = NULL;
 
- retry:
-	le = list->head;
-	sort = false;
-	itCount = 1;
-	while (le && le->next)
-	{
-		if (!sortHandler(le, le->next, arg))
+		//merge each pair of runs of runLen elements
+		while (pLeft)
 		{
-			data = le->data;
-			le->data = le->next->data;
-			le->next->data = data;
-		}
+			osListElement_t* pRight = pLeft;
+			size_t leftLen = 0, rightLen = runLen;
 
-		if(totalLE == 2)
-		{
-			sort = true;
-			break;
+			mergeNum++;
+			while (leftLen < runLen && pRight)
+			{
+				leftLen++;
+				pRight = pRight->next;
+			}
+
+			while (leftLen || (rightLen && pRight))
+			{
+				osListElement_t* pLE;
+				bool isRightFirst;
+
+				if (!leftLen)
+				{
+					isRightFirst = true;
+				}
+				else if (!rightLen || !pRight)
+				{
+					isRightFirst = false;
+				}
+				else
+				{
+					isRightFirst = isSwitchHandler ? sortHandler(pLeft, pRight, arg) : !sortHandler(pLeft, pRight, arg);
+				}
+
+				if (isRightFirst)
+				{
+					pLE = pRight;
+					pRight = pRight->next;
+					rightLen--;
+				}
+				else
+				{
+					pLE = pLeft;
+					pLeft = pLeft->next;
+					leftLen--;
+				}
+
+				if (pTail)
+				{
+					pTail->next = pLE;
+				}
+				else
+				{
+					pHead = pLE;
+				}
+				pTail = pLE;
+			}
+
+			pLeft = pRight;
 		}
-		if(++itCount  == totalLE)
+
+		pTail->next = NULL;
+		if (mergeNum <= 1)
 		{
 			break;
 		}
-		le = le->next;
+
+		runLen *= 2;
 	}
 
-	if(totalLE-- <= 1 || sort)
+	if (ppTail)
 	{
-		return;
+		*ppTail = pTail;
+	}
+
+	return pHead;
+}
+
+
+//rebuild the prev pointers of a chain of elements linked by next
+static void osList_relinkPrev(osList_t* list, osListElement_t* pHead, osListElement_t* pTail)
+{
+	osListElement_t* pPrev = NULL;
+	for (osListElement_t* pLE = pHead; pLE; pLE = pLE->next)
+	{
+		pLE->prev = pPrev;
+		pLE->list = list;
+		pPrev = pLE;
 	}
 
-	goto retry;
+	list->head = pHead;
+	list->tail = pTail;
+}
+
+
+/**
+ * Sort a linked list in an order defined by the sort handler.  The sort is a stable merge sort, O(nlogn).  The
+ * elements are relinked, each data stays with its own element
+ *
+ * @param list  Linked list
+ * @param sh    Sort handler, returns true if le1 can stay before le2
+ * @param arg   Handler argument
+ */
+void osList_sort(osList_t *list, osListSortHandler sortHandler, void *arg)
+{
+	if (!list || !sortHandler || !list->head)
+		return;
+
+	osListElement_t* pTail = NULL;
+	osListElement_t* pHead = osList_mergeSort(list->head, sortHandler, arg, false, &pTail);
+	osList_relinkPrev(list, pHead, pTail);
 }
 
 
@@ -718,6 +850,111 @@ void osList_orderAppend(osList_t *list, osListSortHandler sortHandler, void* dat
 }
 
 
+/**
+ * Insert a batch of data into a ordered list, the result is the same as calling osList_orderAppend() for each data
+ * in ppData order, but the data are sorted first and then merged into the list, O(mlogm + n) instead of O(m*n)
+ *
+ * @param list        Linked list, ordered by sortHandler
+ * @param sortHandler Sort handler, returns true if the new data (le2) shall be placed before the existing data (le1)
+ * @param ppData      Data to be inserted
+ * @param num         Number of data in ppData
+ * @param sortArg     Handler argument
+ *
+ * @return OS_STATUS_OK if all data are inserted, otherwise no data is inserted.  A NULL entry in ppData fails the
+ *         whole batch with OS_ERROR_NULL_POINTER
+ */
+osStatus_e osList_orderAppendBatch(osList_t *list, osListSortHandler sortHandler, void* const* ppData, uint32_t num, void* sortArg)
+{
+	if(!list || !sortHandler || (!ppData && num))
+	{
+		logError("null pointer, list=%p, sortHandler=%p, ppData=%p.", list, sortHandler, ppData);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(num == 0)
+	{
+		return OS_STATUS_OK;
+	}
+
+	//reject a NULL data the same as osList_orderAppend(), before any element is allocated
+	for(uint32_t i=0; i<num; i++)
+	{
+		if(!ppData[i])
+		{
+			logError("null pointer, ppData[%d] is NULL, num=%d.", i, num);
+			return OS_ERROR_NULL_POINTER;
+		}
+	}
+
+	//chain the new elements in input order, so that the stable sort keeps the input order of equal data
+	osListElement_t* pNewHead = NULL;
+	osListElement_t* pNewTail = NULL;
+	for(uint32_t i=0; i<num; i++)
+	{
+		osListElement_t* pLE = osmalloc_r(sizeof(osListElement_t), NULL);
+		if(!pLE)
+		{
+			logError("osmalloc_r fails, num=%d.", num);
+			while(pNewHead)
+			{
+				pLE = pNewHead->next;
+				osfree(pNewHead);
+				pNewHead = pLE;
+			}
+			return OS_ERROR_MEMORY_ALLOC_FAILURE;
+		}
+
+		pLE->data = ppData[i];
+		pLE->next = NULL;
+		if(pNewTail)
+		{
+			pNewTail->next = pLE;
+		}
+		else
+		{
+			pNewHead = pLE;
+		}
+		pNewTail = pLE;
+	}
+
+	pNewHead = osList_mergeSort(pNewHead, sortHandler, sortArg, true, &pNewTail);
+
+	//merge, a new element goes before the first existing element that sortHandler(existing, new) returns true
+	osListElement_t* pOld = list->head;
+	osListElement_t* pHead = NULL;
+	osListElement_t* pTail = NULL;
+	while(pOld || pNewHead)
+	{
+		osListElement_t* pLE;
+		if(pNewHead && (!pOld || sortHandler(pOld, pNewHead, sortArg)))
+		{
+			pLE = pNewHead;
+			pNewHead = pNewHead->next;
+		}
+		else
+		{
+			pLE = pOld;
+			pOld = pOld->next;
+		}
+
+		if(pTail)
+		{
+			pTail->next = pLE;
+		}
+		else
+		{
+			pHead = pLE;
+		}
+		pTail = pLE;
+	}
+	pTail->next = NULL;
+
+	osList_relinkPrev(list, pHead, pTail);
+
+	return OS_STATUS_OK;
+}
+
+
 //combine list1 and list2, after the combination, list1 is the head.  pList2 is not freed, up for user to free it if necessary
 osList_t* osList_combine(osList_t* pList1, osList_t* pList2)
 {
@@ -762,41 +999,21 @@ void osListPlus_init(osListPlus_t* pList, bool isDataStatic)
 		return;
 	}
 
-	pList->num = 0;
 	pList->isDataStatic = isDataStatic;
-	pList->first = NULL;
-	osList_init(&pList->more);
+	osVec_init(&pList->vec);
 }
 
 
 osStatus_e osListPlus_append(osListPlus_t* pList, void* pData)
 {
-	osStatus_e status = OS_STATUS_OK;
 	if(!pList || !pData)
 	{
 		logError("null pointer, pList=%p, pData=%p.", pList, pData);
-		status = OS_ERROR_NULL_POINTER;
-		goto EXIT;
+		return OS_ERROR_NULL_POINTER;
 	}
 
-	mdebug(LM_MEM, "pList=%p, pList->num=%d, pData=%p", pList, pList->num, pData);
-	if(pList->num == 0)
-	{
-		pList->first = pData;
-	}
-	else 
-	{
-		if(!osList_append(&pList->more, pData))
-		{
-			status = OS_ERROR_SYSTEM_FAILURE;
-			goto EXIT;
-		}
-	}
-
-	++pList->num;
-
-EXIT:
-	return status;
+	mdebug(LM_MEM, "pList=%p, pList->num=%d, pData=%p", pList, pList->vec.num, pData);
+	return osVec_append(&pList->vec, pData);
 }
 
 
@@ -807,41 +1024,26 @@ void* osListPlus_getNextData(osListPlus_t* pList, osListPlusElement_t* pPlusLE)
 		return NULL;
 	}
 
-	void* pData = NULL;
-
-	if(pPlusLE->isFirst)
+	void* pData = osVec_get(&pList->vec, pPlusLE->idx);
+	if(pData)
 	{
-		pPlusLE->isFirst = false;
-		pPlusLE->pLE = NULL;
-		pData = pList->first;
+		pPlusLE->idx++;
 	}
 	else
 	{
-		osListElement_t* pLE;
-		if(pPlusLE->pLE)
-		{
-			pLE = pPlusLE->pLE->next;
-		}
-		else
-		{
-			pPlusLE->pLE = pList->more.head;
-			pLE = pPlusLE->pLE;
-		}
-
-		if(pLE)
-		{
-			pData = pLE->data;
-		}
-		else
-		{
-			pPlusLE->isRetrieved = true;
-		}
+		pPlusLE->isRetrieved = true;
 	}
 
 	return pData;
 }
 
 
+void* osListPlus_getData(osListPlus_t* pList, uint32_t idx)
+{
+	return pList ? osVec_get(&pList->vec, idx) : NULL;
+}
+
+
 void osListPlus_clear(osListPlus_t* pList)
 {
 	if(!pList)
@@ -849,15 +1051,10 @@ void osListPlus_clear(osListPlus_t* pList)
 		return;
 	}
 
-	pList->first = NULL;
-	if(pList->num > 1)
-	{
-		osList_clear(&pList->more);
-	}
-
-	pList->num = 0;
+	osVec_clear(&pList->vec);
 }
 
+
 void osListPlus_delete(osListPlus_t* pList)
 {
     if(!pList)
@@ -867,15 +1064,13 @@ void osListPlus_delete(osListPlus_t* pList)
 
 	if(pList->isDataStatic)
 	{
-        osList_clear(&pList->more);
+		osVec_clear(&pList->vec);
 	}
 	else
 	{
-		osfree(pList->first);
-		osList_delete(&pList->more);
+		osVec_delete(&pList->vec);
 	}
 
-	pList->first = NULL;
 	pList->isDataStatic = false;
 }
 
@@ -12,6 +12,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "osTypes.h"
 #include "osPL.h"
@@ -20,10 +25,14 @@
 #include "osPrintf.h"
 #include "osDebug.h"
 #include "osMisc.h"
+#include "osScan.h"
 
 
 enum {DEFAULT_SIZE=512};
 
+//a mapped mbuf reserves the file size + 1 for the NUL, rounded up to pages
+#define OS_MBUF_MAP_LEN(size)	(((size) + sysconf(_SC_PAGESIZE)) & ~(sysconf(_SC_PAGESIZE) - 1))
+
 static osMBuf_t* osMBuf_allocInternal(size_t size, bool isNeedMutex);
 static osMBuf_t *osMBuf_allocRefInternal(osMBuf_t *mbr, bool isNeedMutex);
 
@@ -343,56 +352,263 @@ logError("to-remove, mb->end=%ld, mb->pos=%ld", mb->end,  mb->pos);
 }
 	
 
+/* read the whole file into a new mbuf, buf is NUL terminated.  For a regular file the mbuf is sized
+ * from the file size up front, initBufSize is only used as the initial size when the file size is not
+ * known, like a pipe
+ */
 osMBuf_t* osMBuf_readFile(char* file, size_t initBufSize)
 {
 	osMBuf_t* pBuf = NULL;
-	FILE* fp = NULL;
+	int fd = -1;
 
 	if(!file)
 	{
 		goto EXIT;
 	}
 
-    fp = fopen(file, "rb");
-	if(!fp)
+	fd = open(file, O_RDONLY);
+	if(fd < 0)
 	{
 		goto EXIT;
 	}
 
-	pBuf = osMBuf_alloc(initBufSize);
+	struct stat st;
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= initBufSize)
+	{
+		initBufSize = st.st_size + 1;
+	}
+
+	pBuf = osMBuf_alloc(initBufSize ? initBufSize : DEFAULT_SIZE);
 	if(!pBuf)
 	{
 		goto EXIT;
 	}
 
-	char c;
-    while((c = getc(fp)) != EOF)
-    {
-		pBuf->buf[pBuf->pos++] = c;
-		if(pBuf->pos >= pBuf->size)
+	while(1)
+	{
+		//always keep one byte for the NUL
+		if(pBuf->end + 1 >= pBuf->size)
 		{
 			if(osMBuf_realloc(pBuf, 2*pBuf->size) != 0)
 			{
 				osMBuf_dealloc(pBuf);
+				pBuf = NULL;
 				goto EXIT;
 			}
 		}
+
+		ssize_t len = read(fd, &pBuf->buf[pBuf->end], pBuf->size - pBuf->end - 1);
+		if(len < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			logError("fails to read file(%s), errno=%d.", file, errno);
+			osMBuf_dealloc(pBuf);
+			pBuf = NULL;
+			goto EXIT;
+		}
+		else if(len == 0)
+		{
+			break;
+		}
+
+		pBuf->end += len;
 	}
 
-	pBuf->buf[pBuf->pos]='\0';
-	pBuf->end = pBuf->pos;
+	pBuf->buf[pBuf->end]='\0';
 	pBuf->pos = 0;
 
 EXIT:
-	if(fp)
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+
+	return pBuf;
+}
+
+
+static void osMBuf_mapDestructor(void *data)
+{
+	osMBuf_t *mb = data;
+
+	if(mb->buf)
+	{
+		munmap(mb->buf, OS_MBUF_MAP_LEN(mb->size));
+	}
+}
+
+
+/* map a file read only into a new mbuf, the mbuf size and end are the file size.  The mapping is
+ * reserved one byte larger than the file and the extra byte is zero, so buf is NUL terminated like the
+ * one from osMBuf_readFile().
+ *
+ * The buf of a mapped mbuf is not from osmalloc, it shall not be modified, reallocated or referred by
+ * osMBuf_allocRef()/osMBufChain_appendRef().  The mbuf itself may be osmemref'd, and it is unmapped
+ * by osMBuf_dealloc()
+ */
+osMBuf_t* osMBuf_mapFile(const char* file)
+{
+	osMBuf_t* pBuf = NULL;
+	int fd = -1;
+
+	if(!file)
+	{
+		logError("null pointer, file.");
+		goto EXIT;
+	}
+
+	fd = open(file, O_RDONLY);
+	if(fd < 0)
+	{
+		logError("fails to open file(%s), errno=%d.", file, errno);
+		goto EXIT;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		logError("file(%s) is not a regular file, use osMBuf_readFile() instead.", file);
+		goto EXIT;
+	}
+
+	pBuf = oszalloc(sizeof(osMBuf_t), osMBuf_mapDestructor);
+	if(!pBuf)
+	{
+		goto EXIT;
+	}
+
+	//reserve zeroed anonymous pages first, then map the file on top of it.  The byte after the file end
+	//is in the anonymous part if the file size is a multiple of the page size
+	size_t mapLen = OS_MBUF_MAP_LEN(st.st_size);
+	void* pMap = mmap(NULL, mapLen, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(pMap == MAP_FAILED)
+	{
+		logError("fails to mmap %ld bytes for file(%s), errno=%d.", mapLen, file, errno);
+		osfree(pBuf);
+		pBuf = NULL;
+		goto EXIT;
+	}
+
+	if(st.st_size && mmap(pMap, st.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		logError("fails to mmap file(%s), errno=%d.", file, errno);
+		munmap(pMap, mapLen);
+		osfree(pBuf);
+		pBuf = NULL;
+		goto EXIT;
+	}
+
+	madvise(pMap, mapLen, MADV_SEQUENTIAL);
+
+	pBuf->buf = pMap;
+	pBuf->size = st.st_size;
+	pBuf->end = st.st_size;
+
+EXIT:
+	if(fd >= 0)
 	{
-		fclose(fp);
+		close(fd);
 	}
 
 	return pBuf;
 }
 
 
+/* read a file chunk by chunk, each chunk is passed to the consumer.  All chunks are chunkSize long
+ * except the last one.  The consumer returns false to stop the reading.
+ *
+ * return the number of bytes passed to the consumer, or -1 if the file can not be read
+ */
+ssize_t osMBuf_streamFile(const char* file, size_t chunkSize, osMBufStreamCallback_h consumer, void* pData)
+{
+	ssize_t readLen = -1;
+	uint8_t* chunk = NULL;
+	int fd = -1;
+
+	if(!file || !consumer)
+	{
+		logError("null pointer, file=%p, consumer=%p.", file, consumer);
+		goto EXIT;
+	}
+
+	fd = open(file, O_RDONLY);
+	if(fd < 0)
+	{
+		logError("fails to open file(%s), errno=%d.", file, errno);
+		goto EXIT;
+	}
+
+	if(!chunkSize)
+	{
+		chunkSize = OS_MBUF_STREAM_CHUNK_SIZE;
+	}
+
+	chunk = osmalloc(chunkSize, NULL);
+	if(!chunk)
+	{
+		logError("fails to allocate chunk, chunkSize=%ld.", chunkSize);
+		goto EXIT;
+	}
+
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	readLen = 0;
+	bool isEOF = false;
+	while(!isEOF)
+	{
+		//fill the whole chunk unless the file ends
+		size_t len = 0;
+		while(len < chunkSize)
+		{
+			ssize_t n = read(fd, &chunk[len], chunkSize - len);
+			if(n < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+
+				logError("fails to read file(%s), errno=%d.", file, errno);
+				readLen = -1;
+				goto EXIT;
+			}
+			else if(n == 0)
+			{
+				isEOF = true;
+				break;
+			}
+
+			len += n;
+		}
+
+		if(!len)
+		{
+			break;
+		}
+
+		bool isContinue = consumer(chunk, len, readLen, pData);
+		readLen += len;
+		if(!isContinue)
+		{
+			break;
+		}
+	}
+
+EXIT:
+	osfree(chunk);
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+
+	return readLen;
+}
+
+
 /**
  * Write a block of memory to a memory buffer starting from the current mbuf position
  *
@@ -524,8 +740,8 @@ int osMBuf_writeU8(osMBuf_t *mb, uint8_t v, bool isAdvancePos)
 
 int osMBuf_writeU8Str(osMBuf_t *mb, uint8_t v, bool isAdvancePos)
 {
-	char str[OS_MAX_UINT64_STR_LEN];
-	int len = osUInt2Str8(v, str);
+    char str[OS_MAX_UINT64_STR_LEN];
+    int len = osUInt2DecStr(v, str);
     return osMBuf_writeBuf(mb, (uint8_t *)str, len, isAdvancePos);
 }
 
@@ -547,7 +763,7 @@ int osMBuf_writeU16(osMBuf_t *mb, uint16_t v, bool isAdvancePos)
 int osMBuf_writeU16Str(osMBuf_t *mb, uint16_t v, bool isAdvancePos)
 {
     char str[OS_MAX_UINT64_STR_LEN];
-    int len = osUInt2Str16(v, str);
+    int len = osUInt2DecStr(v, str);
     return osMBuf_writeBuf(mb, (uint8_t *)str, len, isAdvancePos);
 }
 
@@ -569,7 +785,7 @@ int osMBuf_writeU32(osMBuf_t *mb, uint32_t v, bool isAdvancePos)
 int osMBuf_writeU32Str(osMBuf_t *mb, uint32_t v, bool isAdvancePos)
 {
     char str[OS_MAX_UINT64_STR_LEN];
-    int len = osUInt2Str32(v, str);
+    int len = osUInt2DecStr(v, str);
     return osMBuf_writeBuf(mb, (uint8_t *)str, len, isAdvancePos);
 }
 
@@ -591,7 +807,7 @@ int osMBuf_writeU64(osMBuf_t *mb, uint64_t v, bool isAdvancePos)
 int osMBuf_writeU64Str(osMBuf_t *mb, uint64_t v, bool isAdvancePos)
 {
     char str[OS_MAX_UINT64_STR_LEN];
-    int len = osUInt2Str64(v, str);
+    int len = osUInt2DecStr(v, str);
     return osMBuf_writeBuf(mb, (uint8_t *)str, len, isAdvancePos);
 }
 
@@ -963,60 +1179,31 @@ void osMBuf_advance(osMBuf_t *mb, ssize_t n)
 }
 
 
-//return value, -1, no match found, otherwise, the beginning of the pattern in the string
+/* return value, -1, no match found, otherwise, the beginning of the pattern in the string.
+ * the first 2 chars of the pattern are compared case sensitive, the remaining chars are compared case insensitive
+ */
 ssize_t osMbuf_findMatch(osMBuf_t* pBuf, osPointerLen_t* pattern)
 {
 	if(!pBuf || !pattern || pattern->l == 0 || !pattern->p )
 	{
-		logError("null pointer, pBuf=%p, pattern=%p, pattern(%p:%ld).", pBuf, pattern, pattern->p, pattern->l);
+		logError("null pointer, pBuf=%p, pattern=%p.", pBuf, pattern);
 		return -1;
 	}
 
-	ssize_t pos = -1;
-	size_t end = pBuf->end - pattern->l;
-	while(pBuf->pos < end)
+	if(pBuf->pos >= pBuf->end || pBuf->end - pBuf->pos < pattern->l)
 	{
-		//check char for pos-0 and pos-1, if match, compare the whole pattern
-		if(pBuf->buf[pBuf->pos] == pattern->p[0])
-		{
-			pos = pBuf->pos++;
-			if(pattern->l == 1)
-			{
-				goto EXIT;
-			}
-			else if(pattern->l == 2)
-			{
-				if(pBuf->buf[pBuf->pos++] == pattern->p[1])
-				{
-					goto EXIT;
-				}
-			}
-			else
-			{
-				if(pBuf->buf[pBuf->pos++] == pattern->p[1])
-				{
-					if(strncasecmp(&pBuf->buf[pBuf->pos], &pattern->p[2], pattern->l-2) == 0)
-					{
-						goto EXIT;
-					}
-				}
-			}
-            pBuf->pos = pos + 1;
-		}
-		else
-		{
-			pBuf->pos++;
-		}
+		return -1;
 	}
 
-	pos = -1;
-
-EXIT:
-	if(pos != -1)
+	ssize_t pos = osScan_findStrPartialCase(&pBuf->buf[pBuf->pos], pBuf->end - pBuf->pos, pattern->p, pattern->l, 2);
+	if(pos < 0)
 	{
-		pBuf->pos = pos;
+		pBuf->pos = pBuf->end - pattern->l;
+		return -1;
 	}
-	return pos;
+
+	pBuf->pos += pos;
+	return pBuf->pos;
 }
 
 
@@ -0,0 +1,434 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osMBufChain.c  Chained memory buffers
+ ********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osTypes.h"
+#include "osPL.h"
+#include "osMemory.h"
+#include "osMBuf.h"
+#include "osMBufChain.h"
+#include "osDebug.h"
+
+
+static int osMBufChain_addSeg(osMBufChain_t* pChain, uint8_t* buf, size_t size, size_t startPos, size_t len);
+static void osMBufChain_releaseSeg(osMBufChain_t* pChain);
+
+
+static void osMBufChain_destructor(void* data)
+{
+	osMBufChain_t* pChain = data;
+
+	osMBufChain_releaseSeg(pChain);
+	osfree(pChain->seg);
+}
+
+
+osMBufChain_t* osMBufChain_alloc(void)
+{
+	osMBufChain_t* pChain = oszalloc(sizeof(osMBufChain_t), osMBufChain_destructor);
+	if(!pChain)
+	{
+		logError("fails to allocate osMBufChain_t.");
+		return NULL;
+	}
+
+	pChain->seg = osmalloc(OS_MBUF_CHAIN_INIT_SEG_NUM * sizeof(osMBuf_t), NULL);
+	if(!pChain->seg)
+	{
+		logError("fails to allocate segment array.");
+		osfree(pChain);
+		return NULL;
+	}
+	pChain->segMax = OS_MBUF_CHAIN_INIT_SEG_NUM;
+
+	return pChain;
+}
+
+
+void osMBufChain_dealloc(osMBufChain_t* pChain)
+{
+	osfree(pChain);
+}
+
+
+void osMBufChain_reset(osMBufChain_t* pChain)
+{
+	if(!pChain)
+	{
+		return;
+	}
+
+	osMBufChain_releaseSeg(pChain);
+}
+
+
+int osMBufChain_appendRef(osMBufChain_t* pChain, const osMBuf_t* pMBuf, size_t startPos, size_t len)
+{
+	if(!pChain || !pMBuf || !pMBuf->buf)
+	{
+		logError("null pointer, pChain=%p, pMBuf=%p.", pChain, pMBuf);
+		return -1;
+	}
+
+	if(startPos > pMBuf->size || len > pMBuf->size - startPos)
+	{
+		logError("startPos(%ld) + len(%ld) exceeds the mbuf size(%ld).", startPos, len, pMBuf->size);
+		return -1;
+	}
+
+	if(!len)
+	{
+		return 0;
+	}
+
+	//the new slice continues the last segment of the same memory, just extend the last segment
+	if(pChain->segNum && pChain->seg[pChain->segNum-1].buf == pMBuf->buf && pChain->seg[pChain->segNum-1].end == startPos)
+	{
+		pChain->seg[pChain->segNum-1].end += len;
+		pChain->len += len;
+		return 0;
+	}
+
+	return osMBufChain_addSeg(pChain, osmemref(pMBuf->buf), pMBuf->size, startPos, len);
+}
+
+
+int osMBufChain_appendMBuf(osMBufChain_t* pChain, const osMBuf_t* pMBuf)
+{
+	if(!pMBuf)
+	{
+		logError("null pointer, pMBuf.");
+		return -1;
+	}
+
+	return osMBufChain_appendRef(pChain, pMBuf, 0, pMBuf->end);
+}
+
+
+int osMBufChain_appendPL(osMBufChain_t* pChain, const osMBuf_t* pMBuf, const osPointerLen_t* pl)
+{
+	if(!pMBuf || !pMBuf->buf || !pl)
+	{
+		logError("null pointer, pMBuf=%p, pl=%p.", pMBuf, pl);
+		return -1;
+	}
+
+	if((uint8_t*)pl->p < pMBuf->buf || (uint8_t*)pl->p + pl->l > pMBuf->buf + pMBuf->size)
+	{
+		logError("pl(%p, %ld) is not inside pMBuf->buf.", pl->p, pl->l);
+		return -1;
+	}
+
+	return osMBufChain_appendRef(pChain, pMBuf, (uint8_t*)pl->p - pMBuf->buf, pl->l);
+}
+
+
+/* the data is copied into pChain->pCopyBuf.  The pCopyBuf->buf shall never be reallocated since
+ * the segments refer it, when it is used up, the chain drops its own reference and allocates a new
+ * one, the memory is freed when the last segment that refers it is released.
+ */
+int osMBufChain_appendCopy(osMBufChain_t* pChain, const void* data, size_t len)
+{
+	if(!pChain || !data)
+	{
+		logError("null pointer, pChain=%p, data=%p.", pChain, data);
+		return -1;
+	}
+
+	if(!len)
+	{
+		return 0;
+	}
+
+	if(!pChain->pCopyBuf || pChain->pCopyBuf->size - pChain->pCopyBuf->end < len)
+	{
+		osMBuf_dealloc(pChain->pCopyBuf);
+		pChain->pCopyBuf = osMBuf_alloc(len > OS_MBUF_CHAIN_COPY_BUF_SIZE ? len : OS_MBUF_CHAIN_COPY_BUF_SIZE);
+		if(!pChain->pCopyBuf)
+		{
+			logError("fails to allocate pCopyBuf, len=%ld.", len);
+			return -1;
+		}
+	}
+
+	osMBuf_t* pCopyBuf = pChain->pCopyBuf;
+	size_t startPos = pCopyBuf->end;
+	memcpy(&pCopyBuf->buf[startPos], data, len);
+	pCopyBuf->end += len;
+
+	return osMBufChain_appendRef(pChain, pCopyBuf, startPos, len);
+}
+
+
+int osMBufChain_appendChain(osMBufChain_t* pChain, const osMBufChain_t* pSrcChain)
+{
+	if(!pChain || !pSrcChain || pChain == pSrcChain)
+	{
+		logError("null pointer or the same chain, pChain=%p, pSrcChain=%p.", pChain, pSrcChain);
+		return -1;
+	}
+
+	for(uint32_t i=0; i<pSrcChain->segNum; i++)
+	{
+		const osMBuf_t* pSeg = &pSrcChain->seg[i];
+		if(osMBufChain_appendRef(pChain, pSeg, pSeg->pos, pSeg->end - pSeg->pos) != 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+int osMBufChain_toIovec(const osMBufChain_t* pChain, struct iovec* iov, int iovMax)
+{
+	if(!pChain || !iov)
+	{
+		logError("null pointer, pChain=%p, iov=%p.", pChain, iov);
+		return -1;
+	}
+
+	if(pChain->segNum > iovMax)
+	{
+		logError("iovMax(%d) is smaller than the number of segments(%d).", iovMax, pChain->segNum);
+		return -1;
+	}
+
+	for(uint32_t i=0; i<pChain->segNum; i++)
+	{
+		iov[i].iov_base = &pChain->seg[i].buf[pChain->seg[i].pos];
+		iov[i].iov_len = pChain->seg[i].end - pChain->seg[i].pos;
+	}
+
+	return pChain->segNum;
+}
+
+
+osMBuf_t* osMBufChain_flatten(const osMBufChain_t* pChain)
+{
+	if(!pChain)
+	{
+		logError("null pointer, pChain.");
+		return NULL;
+	}
+
+	osMBuf_t* pMBuf = osMBuf_alloc(pChain->len ? pChain->len : 1);
+	if(!pMBuf)
+	{
+		logError("fails to allocate pMBuf, len=%ld.", pChain->len);
+		return NULL;
+	}
+
+	for(uint32_t i=0; i<pChain->segNum; i++)
+	{
+		size_t segLen = pChain->seg[i].end - pChain->seg[i].pos;
+		memcpy(&pMBuf->buf[pMBuf->end], &pChain->seg[i].buf[pChain->seg[i].pos], segLen);
+		pMBuf->end += segLen;
+	}
+
+	return pMBuf;
+}
+
+
+void osMBufChainCursor_init(osMBufChainCursor_t* pCursor, const osMBufChain_t* pChain)
+{
+	if(!pCursor)
+	{
+		return;
+	}
+
+	pCursor->pChain = pChain;
+	pCursor->segIdx = 0;
+	pCursor->segPos = 0;
+	pCursor->pos = 0;
+}
+
+
+size_t osMBufChainCursor_read(osMBufChainCursor_t* pCursor, void* buf, size_t len)
+{
+	if(!pCursor || !pCursor->pChain || !buf)
+	{
+		logError("null pointer, pCursor=%p, buf=%p.", pCursor, buf);
+		return 0;
+	}
+
+	const osMBufChain_t* pChain = pCursor->pChain;
+	size_t readLen = 0;
+	while(readLen < len && pCursor->segIdx < pChain->segNum)
+	{
+		const osMBuf_t* pSeg = &pChain->seg[pCursor->segIdx];
+		size_t segLeft = pSeg->end - pSeg->pos - pCursor->segPos;
+		size_t n = (len - readLen) < segLeft ? (len - readLen) : segLeft;
+
+		memcpy((uint8_t*)buf + readLen, &pSeg->buf[pSeg->pos + pCursor->segPos], n);
+		readLen += n;
+		pCursor->segPos += n;
+		if(n == segLeft)
+		{
+			pCursor->segIdx++;
+			pCursor->segPos = 0;
+		}
+	}
+
+	pCursor->pos += readLen;
+	return readLen;
+}
+
+
+int osMBufChainCursor_peekU8(const osMBufChainCursor_t* pCursor)
+{
+	if(!pCursor || !pCursor->pChain || pCursor->segIdx >= pCursor->pChain->segNum)
+	{
+		return -1;
+	}
+
+	const osMBuf_t* pSeg = &pCursor->pChain->seg[pCursor->segIdx];
+	return pSeg->buf[pSeg->pos + pCursor->segPos];
+}
+
+
+int osMBufChainCursor_readU8(osMBufChainCursor_t* pCursor)
+{
+	int c = osMBufChainCursor_peekU8(pCursor);
+	if(c < 0)
+	{
+		return -1;
+	}
+
+	const osMBuf_t* pSeg = &pCursor->pChain->seg[pCursor->segIdx];
+	if(++pCursor->segPos == pSeg->end - pSeg->pos)
+	{
+		pCursor->segIdx++;
+		pCursor->segPos = 0;
+	}
+	pCursor->pos++;
+
+	return c;
+}
+
+
+size_t osMBufChainCursor_advance(osMBufChainCursor_t* pCursor, size_t n)
+{
+	if(!pCursor || !pCursor->pChain)
+	{
+		return 0;
+	}
+
+	const osMBufChain_t* pChain = pCursor->pChain;
+	size_t advLen = 0;
+	while(advLen < n && pCursor->segIdx < pChain->segNum)
+	{
+		size_t segLeft = pChain->seg[pCursor->segIdx].end - pChain->seg[pCursor->segIdx].pos - pCursor->segPos;
+		if(n - advLen < segLeft)
+		{
+			pCursor->segPos += n - advLen;
+			advLen = n;
+			break;
+		}
+
+		advLen += segLeft;
+		pCursor->segIdx++;
+		pCursor->segPos = 0;
+	}
+
+	pCursor->pos += advLen;
+	return advLen;
+}
+
+
+ssize_t osMBufChainCursor_skipUntil(osMBufChainCursor_t* pCursor, char mark)
+{
+	if(!pCursor || !pCursor->pChain)
+	{
+		return -1;
+	}
+
+	const osMBufChain_t* pChain = pCursor->pChain;
+	while(pCursor->segIdx < pChain->segNum)
+	{
+		const osMBuf_t* pSeg = &pChain->seg[pCursor->segIdx];
+		size_t segLeft = pSeg->end - pSeg->pos - pCursor->segPos;
+		uint8_t* p = memchr(&pSeg->buf[pSeg->pos + pCursor->segPos], mark, segLeft);
+		if(p)
+		{
+			size_t n = p - &pSeg->buf[pSeg->pos + pCursor->segPos];
+			pCursor->segPos += n;
+			pCursor->pos += n;
+			return pCursor->pos;
+		}
+
+		pCursor->pos += segLeft;
+		pCursor->segIdx++;
+		pCursor->segPos = 0;
+	}
+
+	return -1;
+}
+
+
+osPointerLen_t osMBufChainCursor_getCurSeg(const osMBufChainCursor_t* pCursor)
+{
+	osPointerLen_t pl = {NULL, 0};
+	if(!pCursor || !pCursor->pChain || pCursor->segIdx >= pCursor->pChain->segNum)
+	{
+		return pl;
+	}
+
+	const osMBuf_t* pSeg = &pCursor->pChain->seg[pCursor->segIdx];
+	pl.p = (char*)&pSeg->buf[pSeg->pos + pCursor->segPos];
+	pl.l = pSeg->end - pSeg->pos - pCursor->segPos;
+
+	return pl;
+}
+
+
+//buf is a memory reference owned by the new segment
+static int osMBufChain_addSeg(osMBufChain_t* pChain, uint8_t* buf, size_t size, size_t startPos, size_t len)
+{
+	if(pChain->segNum == pChain->segMax)
+	{
+		//not use osrealloc(), it frees the old array when fails, the segment references would be lost
+		osMBuf_t* pSeg = osmalloc(pChain->segMax * 2 * sizeof(osMBuf_t), NULL);
+		if(!pSeg)
+		{
+			logError("fails to allocate segment array, segMax=%d.", pChain->segMax * 2);
+			osfree(buf);
+			return -1;
+		}
+
+		memcpy(pSeg, pChain->seg, pChain->segNum * sizeof(osMBuf_t));
+		osfree(pChain->seg);
+		pChain->seg = pSeg;
+		pChain->segMax *= 2;
+	}
+
+	osMBuf_t* pSeg = &pChain->seg[pChain->segNum++];
+	pSeg->buf = buf;
+	pSeg->size = size;
+	pSeg->pos = startPos;
+	pSeg->end = startPos + len;
+	pChain->len += len;
+
+	return 0;
+}
+
+
+static void osMBufChain_releaseSeg(osMBufChain_t* pChain)
+{
+	for(uint32_t i=0; i<pChain->segNum; i++)
+	{
+		osfree(pChain->seg[i].buf);
+	}
+	pChain->segNum = 0;
+	pChain->len = 0;
+
+	osMBuf_dealloc(pChain->pCopyBuf);
+	pChain->pCopyBuf = NULL;
+}
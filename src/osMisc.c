@@ -5,11 +5,50 @@
  ********************************************************/
 
 #include <stdio.h>
+#include <string.h>
 
 #include "osMisc.h"
 #include "osTypes.h"
 
 
+//two ascii digits for each of 0..99, used to convert a integer two digits at a time
+static const char osDigitPair[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const uint64_t osPow10[20] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+	1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+
+/* convert 8 ascii digits loaded in little endian order (the first digit in the lowest byte) to integer.
+ * return false if any of the 8 chars is not a digit */
+static inline bool osDigit8_toUInt(uint64_t chunk, uint32_t* pValue)
+{
+	uint64_t v = chunk - 0x3030303030303030ULL;
+	//each byte shall be 0x30..0x39: the high nibble is 3, and adding 6 does not carry into the high nibble
+	if((chunk & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL || ((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL)
+	{
+		return false;
+	}
+
+	v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFULL;
+	v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFULL;
+	v = (v * 10000 + (v >> 32)) & 0xFFFFFFFFULL;
+
+	*pValue = v;
+	return true;
+}
+
+
 int osMinInt(int a, int b)
 {
 	return a > b ? b : a;
@@ -30,20 +69,13 @@ osStatus_e osStr2Int(char* ch, uint32_t len, int* value)
 		ch++;
 	}
 	
-	for(int i=0; i<len; i++)
+	uint64_t v;
+	if(!osDecStr2UInt(ch, len, &v, NULL))
 	{
-		if(*ch >= '0' && *ch <= '9')
-		{
-			*value = *value * 10 + (*ch - '0');
-			ch++;
-		}
-		else
-		{
-			return OS_ERROR_INVALID_VALUE;
-		}
+		return OS_ERROR_INVALID_VALUE;
 	}
 
-	*value *= sign;
+	*value = (int)v * sign;
 
 	return OS_STATUS_OK;
 }
@@ -68,20 +100,13 @@ osStatus_e osStr2Int64(const char* ch, uint32_t len, int64_t* value)
         ch++;
     }
 
-    for(int i=0; i<len; i++)
+    uint64_t v;
+    if(!osDecStr2UInt(ch, len, &v, NULL))
     {
-        if(*ch >= '0' && *ch <= '9')
-        {
-            *value = *value * 10 + (*ch - '0');
-            ch++;
-        }
-        else
-        {
-            return OS_ERROR_INVALID_VALUE;
-        }
+        return OS_ERROR_INVALID_VALUE;
     }
 
-    *value *= sign;
+    *value = (int64_t)v * sign;
 
     return OS_STATUS_OK;
 }
@@ -117,18 +142,14 @@ int osUInt2Str(void* pn, osIntType_e inttype, char* s, bool isNullTerm, bool isR
 			return 0;
 	}
 
-	int strlen = 0;
-	do 
-	{       
-		s[strlen++] = n % 10 + '0';   /* get next digit */
-	} while ((n /= 10) > 0);     /* delete it */
+	int strlen = osUInt2DecStr(n, s);
     
 	if(isNullTerm)
 	{ 
 		s[strlen] = '\0';
 	}
 
-	if(!isReverse)
+	if(isReverse)
 	{
 		int i, j;
 		char c;
@@ -147,23 +168,158 @@ int osUInt2Str(void* pn, osIntType_e inttype, char* s, bool isNullTerm, bool isR
 
 int osUInt2Str8(uint8_t n, char* s)
 {
-	return osUInt2Str(&n, OS_INT_TYPE_U8, s, true, false);
+	int len = osUInt2DecStr(n, s);
+	s[len] = '\0';
+	return len;
 }
 
 int osUInt2Str16(uint16_t n, char* s)
 {
-    return osUInt2Str(&n, OS_INT_TYPE_U16, s, true, false);
+	int len = osUInt2DecStr(n, s);
+	s[len] = '\0';
+	return len;
 }
 
 
 int osUInt2Str32(uint32_t n, char* s)
 {
-    return osUInt2Str(&n, OS_INT_TYPE_U32, s, true, false);
+	int len = osUInt2DecStr(n, s);
+	s[len] = '\0';
+	return len;
 }
 
 int osUInt2Str64(uint64_t n, char* s)
 {
-    return osUInt2Str(&n, OS_INT_TYPE_U64, s, true, false);
+	int len = osUInt2DecStr(n, s);
+	s[len] = '\0';
+	return len;
+}
+
+
+int osUInt64DigitNum(uint64_t n)
+{
+	if(n == 0)
+	{
+		return 1;
+	}
+
+	//log10(n) ~= log2(n) * 1233 / 4096, then corrected by the power of 10 table
+	int digitNum = ((64 - __builtin_clzll(n)) * 1233) >> 12;
+	return digitNum + (n >= osPow10[digitNum]);
+}
+
+
+/* the digits are written from the least significant end, two at a time from osDigitPair, so that there is
+ * no reverse and only half of the divisions */
+int osUInt2DecStr(uint64_t n, char* s)
+{
+	int len = osUInt64DigitNum(n);
+	char* p = s + len;
+
+	while(n >= 100)
+	{
+		const char* pPair = &osDigitPair[(n % 100) * 2];
+		n /= 100;
+		*--p = pPair[1];
+		*--p = pPair[0];
+	}
+
+	if(n >= 10)
+	{
+		*--p = osDigitPair[n * 2 + 1];
+		*--p = osDigitPair[n * 2];
+	}
+	else
+	{
+		*--p = '0' + n;
+	}
+
+	return len;
+}
+
+
+int osUInt2DecStrPad(uint64_t n, int width, char* s)
+{
+	int len = osUInt64DigitNum(n);
+	int padNum = width > len ? width - len : 0;
+	memset(s, '0', padNum);
+
+	return padNum + osUInt2DecStr(n, &s[padNum]);
+}
+
+
+/* the digits are converted 8 at a time with SWAR: the head digits (len % 8) are padded with leading '0' to 8,
+ * then each 8 digits chunk is loaded as a uint64_t.  The overflow is checked once per chunk */
+bool osDecStr2UInt(const char* p, size_t len, uint64_t* pValue, bool* pIsOverflow)
+{
+	uint64_t value = 0;
+	bool isOverflow = false;
+	uint32_t v8;
+
+	if(!p && len)
+	{
+		return false;
+	}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	size_t headLen = len % 8;
+	if(headLen)
+	{
+		char head[8] = {'0', '0', '0', '0', '0', '0', '0', '0'};
+		memcpy(&head[8 - headLen], p, headLen);
+
+		uint64_t chunk;
+		memcpy(&chunk, head, 8);
+		if(!osDigit8_toUInt(chunk, &v8))
+		{
+			return false;
+		}
+
+		value = v8;
+	}
+
+	for(size_t i=headLen; i<len; i+=8)
+	{
+		uint64_t chunk;
+		memcpy(&chunk, &p[i], 8);
+		if(!osDigit8_toUInt(chunk, &v8))
+		{
+			return false;
+		}
+
+		//when overflow, keep the value wrapped around modulo 2^64, the same as the digit by digit conversion
+		if(__builtin_mul_overflow(value, 100000000ULL, &value))
+		{
+			isOverflow = true;
+		}
+		if(__builtin_add_overflow(value, v8, &value))
+		{
+			isOverflow = true;
+		}
+	}
+#else
+	for(size_t i=0; i<len; i++)
+	{
+		uint8_t c = p[i] - '0';
+		if(c > 9)
+		{
+			return false;
+		}
+
+		if(__builtin_mul_overflow(value, 10, &value) || __builtin_add_overflow(value, c, &value))
+		{
+			isOverflow = true;
+		}
+	}
+#endif
+
+	*pValue = value;
+	if(pIsOverflow)
+	{
+		*pIsOverflow = isOverflow;
+	}
+
+	return true;
 }
 
 
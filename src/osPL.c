@@ -20,6 +20,7 @@
 #include "osMBuf.h"
 #include "osPL.h"
 #include "osMisc.h"
+#include "osScan.h"
 #include "osDebug.h"
 
 
@@ -101,25 +102,16 @@ void osPL_set(osPointerLen_t* pl, void* p, size_t l)
  */
 uint32_t osPL_str2u32(const osPointerLen_t *pl)
 {
-	uint32_t value=0, multiple=1;
-	const char *ptr;
+	uint64_t value;
 
 	if (!pl || !pl->p)
 	{
 		return 0;
 	}
 
-	ptr = &pl->p[pl->l];
-	while (ptr > pl->p) 
+	if(!osDecStr2UInt(pl->p, pl->l, &value, NULL))
 	{
-		const int c = *--ptr - '0';
-		if (c > 9 || c < 0)
-		{
-			return 0;
-		}
-
-		value += multiple * c;
-		multiple *= 10;
+		return 0;
 	}
 
 	return value;
@@ -135,22 +127,14 @@ osStatus_e osPL_convertStr2u32(const osPointerLen_t *pl, uint32_t* pValue)
     }
 
 	*pValue = 0;
-    uint32_t multiple=1;
-    const char *ptr;
-
-    ptr = &pl->p[pl->l];
-    while (ptr > pl->p)
+    uint64_t value;
+    bool isOverflow;
+    if(!osDecStr2UInt(pl->p, pl->l, &value, &isOverflow) || isOverflow || value > UINT32_MAX)
     {
-        const int c = *--ptr - '0';
-        if (c > 9 || c < 0)
-        {
-            return OS_ERROR_INVALID_VALUE;
-        }
-
-        *pValue += multiple * c;
-        multiple *= 10;
+        return OS_ERROR_INVALID_VALUE;
     }
 
+    *pValue = value;
     return OS_STATUS_OK;
 }
 
@@ -209,25 +193,16 @@ uint32_t osPL_hexstr2u32(const osPointerLen_t *pl)
  */
 uint64_t osPL_str2u64(const osPointerLen_t *pl)
 {
-	uint64_t value=0, multiple=1;
-	const char *ptr;
+	uint64_t value;
 
 	if (!pl || !pl->p)
 	{
 		return 0;
 	}
 
-	ptr = &pl->p[pl->l];
-	while (ptr > pl->p) 
+	if(!osDecStr2UInt(pl->p, pl->l, &value, NULL))
 	{
-		const int c = *--ptr - '0';
-		if (c > 9 || c < 0)
-		{
-			return 0;
-		}
-
-		value += multiple * c;
-		multiple *= 10;
+		return 0;
 	}
 
 	return value;
@@ -243,20 +218,11 @@ static osStatus_e osPL_convertStr2u64Internal(const osPointerLen_t *pl, uint64_t
     }
 
     *pValue = 0;
-    uint32_t multiple=1;
-    const char *ptr;
-
-    ptr = &pl->p[pl->l];
-    while (ptr > pl->p)
+    bool isOverflow;
+    if(!osDecStr2UInt(pl->p, pl->l, pValue, &isOverflow) || isOverflow)
     {
-        const int c = *--ptr - '0';
-        if (c > 9 || c < 0)
-        {
-            return OS_ERROR_INVALID_VALUE;
-        }
-
-        *pValue += multiple * c;
-        multiple *= 10;
+        *pValue = 0;
+        return OS_ERROR_INVALID_VALUE;
     }
 
     return OS_STATUS_OK;
@@ -740,24 +706,20 @@ osPointerLen_t osPL_clone(const osPointerLen_t* pl)
  */
 const char* osPL_findchar(const osPointerLen_t *pl, char c, size_t* pos)
 {
-	const char *p, *end;
-
 	if (!pl)
 	{
 		return NULL;
 	}
 
-	*pos=0;
-	end = pl->p + pl->l;
-	for (p = pl->p; p < end; p++, (*pos)++) 
+	ssize_t i = osScan_findChar(pl->p, pl->l, c);
+	if(i < 0)
 	{
-		if (*p == c)
-		{
-			return p;
-		}
+		*pos = pl->l;
+		return NULL;
 	}
 
-	return NULL;
+	*pos = i;
+	return pl->p + i;
 }
 
 
@@ -768,42 +730,10 @@ const char* osPL_findStr(const osPointerLen_t *pl, const char* pattern, size_t p
         return NULL;
     }
 
-	osPointerLen_t workPL = osPL_clone(pl);
-
 	patternLen = !patternLen ? strlen(pattern) : patternLen;
 
-	while (true)
-	{
-		size_t pos=0;
-		const char* p = osPL_findchar(&workPL, pattern[0], &pos);
-		if(!p)
-		{
-			return NULL;
-		}
-			
-		osPL_advance(&workPL, pos);
-	
-		if(workPL.l < patternLen)
-		{
-			return NULL;
-		}
-
-		if(memcmp(p, pattern, patternLen) == 0)
-		{
-			return p;
-		}
-
-		if(workPL.l >1)
-		{
-			osPL_advance(&workPL, 1);
-		}
-		else
-		{
-			return NULL;
-		}
-	}
-
-	return NULL;
+	ssize_t i = osScan_findStr(pl->p, pl->l, pattern, patternLen);
+	return i < 0 ? NULL : pl->p + i;
 }
 
 
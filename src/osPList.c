@@ -15,7 +15,7 @@ size_t osPList_getCount(osPList_t* ple)
 		return 0;
 	}
 
-	return ple->count;
+	return ple->vec.num;
 }
 
 
@@ -26,7 +26,7 @@ void* osPLIst_getTopData(osPList_t* ple)
         return NULL;
     }
 
-	return ple->pFirstData;
+	return osVec_getHead(&ple->vec);
 }
 
 
@@ -37,21 +37,12 @@ void* osPList_getBottomData(osPList_t* ple)
         return NULL;
     }
 
-	if(ple->count <= 1)
-	{
-		return ple->pFirstData;
-	}
-	else
-	{
-		return ple->list.tail ? ple->list.tail->data : NULL;
-	}
+	return osVec_getTail(&ple->vec);
 }
 
 
 void* osPList_getNext(osPList_t* ple, bool isRetInit)
 {
-	void* pData = NULL;
-
 	if(!ple)
     {
         return NULL;
@@ -59,34 +50,26 @@ void* osPList_getNext(osPList_t* ple, bool isRetInit)
 
 	if(isRetInit)
 	{
-		ple->count = 0;
-		ple->pCurLE = NULL;
+		ple->retCount = 0;
+	}
+
+	if(ple->retCount >= ple->vec.num)
+	{
+		return NULL;
 	}
 
-	if(ple->retCount++ < ple->count)
+	return osVec_get(&ple->vec, ple->retCount++);
+}
+
+
+void* osPList_getData(osPList_t* ple, size_t idx)
+{
+	if(!ple || idx >= ple->vec.num)
 	{
-		if(ple->retCount == 1)
-		{
-			pData = ple->pFirstData;
-		}
-		else
-		{
-			ple->pCurLE = ple->pCurLE ? ple->pCurLE->next : ple->list.head;
-			if(ple->pCurLE)
-			{
-				pData = ple->pCurLE->data;
-			}
-			else
-			{
-				//this shall never happen, just a safeguard
-				logError("pCurLE == NULL, this is unexpected."); 
-				ple->retCount = ple->count;
-				
-			}
-		}
+		return NULL;
 	}
 
-	return pData;
+	return osVec_get(&ple->vec, idx);
 }
 
 
@@ -97,18 +80,10 @@ void* osPList_add(osPList_t* ple, void* data)
         return NULL;
     }
 
-	if(ple->count++ == 0)
+	if(osVec_append(&ple->vec, data) != OS_STATUS_OK)
 	{
-		ple->pFirstData = data;
-		return ple->pFirstData;
-	} 
-	else
-	{
-		if(!osList_append(&ple->list, data))
-		{
-			logError("osList_append fails.");
-			return NULL;
-		}
+		logError("osVec_append fails.");
+		return NULL;
 	}
 
 	return data;
@@ -117,44 +92,22 @@ void* osPList_add(osPList_t* ple, void* data)
 
 void* osPList_deleteTop(osPList_t* ple)
 {
-	void* pData = NULL;
-
     if(!ple)
     {
         return NULL;
     }
 
-	if(ple->count == 0)
-	{
-		return NULL;
-	}
+	return osVec_remove(&ple->vec, 0);
+}
 
-	pData = ple->pFirstData;
-	if(ple->count-- == 1)
-	{
-		ple->pFirstData = NULL;
-	}
-	else
+
+void osPList_clear(osPList_t* ple)
+{
+	if(!ple)
 	{
-        osListElement_t* pLE = ple->list.head;
-		if(pLE)
-		{
-			ple->pFirstData = pLE->data;
-			osList_unlinkElement(pLE);
-			free(pLE);
-		}
-		else
-		{
-			logError("pLE == NULL while count=%d, unexpected.", ple->count+1);
-			ple->pFirstData = NULL;
-			pData = NULL;
-		}
+		return;
 	}
 
-	return pData;
+	osVec_clear(&ple->vec);
+	ple->retCount = 0;
 }
-
-	 
-			
-	
-
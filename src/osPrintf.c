@@ -19,6 +19,7 @@
 #include "osMBuf.h"
 #include "osPL.h"
 #include "osSockAddr.h"
+#include "osMisc.h"
 
 
 enum length_modifier {
@@ -90,6 +91,12 @@ static uint32_t local_itoa(char *buf, uint64_t n, uint8_t base, bool uc)
 	uint32_t len = 1;
 	const char a = uc ? 'A' : 'a';
 
+	if (base == 10) {
+		len = osUInt2DecStr(n, buf);
+		buf[len] = '\0';
+		return len;
+	}
+
 	*--p = '\0';
 	do {
 		const uint64_t dv  = n / base;
@@ -127,8 +134,22 @@ static size_t local_ftoa(char *buf, double n, size_t dp)
 
 	*p++ = '.';
 
-	/* decimal digits */
-	while (dp--) {
+	/* decimal digits, converted as one integer when it fits */
+	if (dp < OS_MAX_UINT64_STR_LEN - 2) {
+		double scale = 1;
+		for (size_t i=0; i<dp; i++)
+			scale *= 10;
+
+		uint64_t v = (uint64_t)(b * scale);
+
+		/* b * scale may be rounded up to scale */
+		if (dp && v >= (uint64_t)scale)
+			v = (uint64_t)scale - 1;
+
+		if (dp)
+			p += osUInt2DecStrPad(v, dp, p);
+	}
+	else while (dp--) {
 		char v;
 
 		b *= 10;
@@ -902,3 +923,597 @@ int osPrintf_mbuf(osMBuf_t *mb, const char *fmt, ...)
     return err;
 }
 
+
+
+/* a argument of a compiled format, fetched before the output is written */
+typedef union osPrintfArg {
+	int64_t sn;
+	uint64_t n;
+	double dbl;
+	struct {
+		const char *p;
+		size_t l;
+	} s;
+} osPrintfArg_t;
+
+
+static const char hex_lc[] = "0123456789abcdef";
+static const char hex_uc[] = "0123456789ABCDEF";
+
+
+/* add a literal run fmt[pos, pos+len) to pFmt, a run that follows the previous run is merged.  If pFmt=NULL, only count */
+static void osPrintf_addLiteral(osPrintfFmt_t *pFmt, uint32_t *pSpecNum, uint32_t pos, uint32_t len)
+{
+	if (!len)
+	{
+		return;
+	}
+
+	if (pFmt)
+	{
+		osPrintfSpec_t *pPrev = *pSpecNum ? &pFmt->spec[*pSpecNum - 1] : NULL;
+
+		pFmt->litLen += len;
+		if (pPrev && pPrev->conv == 0 && pPrev->litPos + pPrev->litLen == pos)
+		{
+			pPrev->litLen += len;
+			return;
+		}
+
+		pFmt->spec[*pSpecNum].conv = 0;
+		pFmt->spec[*pSpecNum].litPos = pos;
+		pFmt->spec[*pSpecNum].litLen = len;
+	}
+
+	++*pSpecNum;
+}
+
+
+/* parse fmt the same way as osPrintf_onHandler().  If pFmt=NULL, only count the specs (may be more than the merged
+ * specs).  return the number of specs */
+static uint32_t osPrintf_parseFmt(const char *fmt, osPrintfFmt_t *pFmt)
+{
+	uint32_t specNum = 0;
+	const char *p = fmt, *p0 = fmt;
+	bool fm = false, plr = false;
+	char pch = ' ';
+	size_t pad = 0, fpad = -1;
+	uint8_t lenmod = LENMOD_NONE;
+	osPrintfSpec_t *pSpec;
+
+	for (; *p; p++)
+	{
+		if (!fm)
+		{
+			if (*p != '%')
+			{
+				continue;
+			}
+
+			pch = ' ';
+			plr = false;
+			pad = 0;
+			fpad = -1;
+			lenmod = LENMOD_NONE;
+
+			osPrintf_addLiteral(pFmt, &specNum, p0 - fmt, p - p0);
+			fm = true;
+			continue;
+		}
+
+		fm = false;
+
+		switch (*p)
+		{
+			case '-':
+				plr = true;
+				fm = true;
+				break;
+
+			case '.':
+				fpad = pad;
+				pad = 0;
+				fm = true;
+				break;
+
+			case 'l':
+				++lenmod;
+				fm = true;
+				break;
+
+			case 'z':
+				lenmod = LENMOD_SIZE;
+				fm = true;
+				break;
+
+			case '0' ... '9':
+				if (!pad && ('0' == *p))
+				{
+					pch = '0';
+				}
+				else
+				{
+					pad *= 10;
+					pad += *p - '0';
+				}
+				fm = true;
+				break;
+
+			case '%':
+				osPrintf_addLiteral(pFmt, &specNum, p - fmt, 1);
+				break;
+
+			default:
+				if (pFmt)
+				{
+					pSpec = &pFmt->spec[specNum];
+					pSpec->pch = pch;
+					pSpec->plr = plr;
+					pSpec->lenmod = lenmod;
+					pSpec->pad = pad;
+					pSpec->fpad = fpad;
+
+					switch (*p)
+					{
+						case 'b': case 'c': case 'd': case 'i': case 'f': case 'F': case 'p': case 'r':
+						case 'M': case 's': case 'u': case 'x': case 'X': case 'w': case 'W':
+							pSpec->conv = *p;
+							pFmt->argNum++;
+							break;
+
+						case 'H': case 'v': case 'm': case 'A':
+							pSpec->conv = *p;
+							pFmt->argNum++;
+							pFmt->isFallback = true;
+							break;
+
+						default:
+							//a unknown conversion is printed as '?'
+							pSpec->conv = '?';
+							break;
+					}
+				}
+				specNum++;
+				break;
+		}
+
+		if (!fm)
+		{
+			p0 = p + 1;
+		}
+	}
+
+	if (!fm)
+	{
+		osPrintf_addLiteral(pFmt, &specNum, p0 - fmt, p - p0);
+	}
+
+	return specNum;
+}
+
+
+/**
+ * Pre-parse a format string into a list of literal runs and conversions, for osPrintf_execMBuf()
+ *
+ * @param fmt Formatted string, it is referred, not copied, and shall stay as long as the compiled format is used
+ *
+ * @return the compiled format, or NULL if error.  The caller shall osfree() it when it is not needed
+ */
+osPrintfFmt_t *osPrintf_compile(const char *fmt)
+{
+	osPrintfFmt_t *pFmt;
+	uint32_t specNum;
+
+	if (!fmt)
+	{
+		return NULL;
+	}
+
+	specNum = osPrintf_parseFmt(fmt, NULL);
+	pFmt = oszalloc(sizeof(osPrintfFmt_t) + specNum * sizeof(osPrintfSpec_t), NULL);
+	if (!pFmt)
+	{
+		return NULL;
+	}
+
+	pFmt->fmt = fmt;
+	pFmt->specNum = osPrintf_parseFmt(fmt, pFmt);
+
+	return pFmt;
+}
+
+
+/**
+ * Get the compiled format stored in *ppFmt, compile fmt into *ppFmt if it has not been compiled.  It is safe for
+ * multiple threads to share the same *ppFmt
+ *
+ * @param ppFmt Where the compiled format is stored, *ppFmt shall be initialized to NULL
+ * @param fmt   Formatted string
+ *
+ * @return the compiled format, or NULL if error
+ */
+osPrintfFmt_t *osPrintf_getCompiled(osPrintfFmt_t **ppFmt, const char *fmt)
+{
+	osPrintfFmt_t *pFmt, *pExpected = NULL;
+
+	if (!ppFmt)
+	{
+		return NULL;
+	}
+
+	pFmt = __atomic_load_n(ppFmt, __ATOMIC_ACQUIRE);
+	if (pFmt)
+	{
+		return pFmt;
+	}
+
+	pFmt = osPrintf_compile(fmt);
+	if (!pFmt)
+	{
+		return NULL;
+	}
+
+	//another thread may have compiled the same fmt, use that one
+	if (!__atomic_compare_exchange_n(ppFmt, &pExpected, pFmt, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	{
+		osfree(pFmt);
+		pFmt = pExpected;
+	}
+
+	return pFmt;
+}
+
+
+/* the same as write_padded(), but write to dst directly, the caller has made sure there is enough space.
+ * return the number of chars written */
+static size_t put_padded(char *dst, const char *p, size_t sz, size_t pad, char pch, bool plr, const char *prfx)
+{
+	const size_t prfx_len = osStrLen(prfx);
+	char *d = dst;
+
+	pad -= MIN(pad, prfx_len);
+
+	if (prfx && pch == '0')
+	{
+		memcpy(d, prfx, prfx_len);
+		d += prfx_len;
+	}
+
+	if (!plr && pad > sz)
+	{
+		memset(d, pch, pad - sz);
+		d += pad - sz;
+	}
+
+	if (prfx && pch != '0')
+	{
+		memcpy(d, prfx, prfx_len);
+		d += prfx_len;
+	}
+
+	if (p && sz)
+	{
+		memcpy(d, p, sz);
+		d += sz;
+	}
+
+	if (plr && pad > sz)
+	{
+		memset(d, pch, pad - sz);
+		d += pad - sz;
+	}
+
+	return d - dst;
+}
+
+
+/**
+ * Print a compiled format to a memory buffer.  The arguments are fetched first to get the max output size, the
+ * buffer is then expanded once, and the output is written directly into the buffer.  A format that has %H, %v, %m
+ * or %A, or has more than OS_PRINTF_MAX_ARG conversions falls back to osPrintf_onMBuf()
+ *
+ * @param mb   Memory buffer
+ * @param pFmt Compiled format
+ * @param ap   Variable argument list
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osPrintf_vexecMBuf(osMBuf_t *mb, const osPrintfFmt_t *pFmt, va_list ap)
+{
+	osPrintfArg_t arg[OS_PRINTF_MAX_ARG];
+	const osPrintfSpec_t *pSpec;
+	const osPointerLen_t *pl;
+	const osMBuf_t *pMbuf;
+	char num[NUM_SIZE], *dst, *d;
+	size_t size, width, dp, len, i;
+	uint32_t argIdx;
+	int err;
+
+	if (!mb || !pFmt)
+	{
+		return EINVAL;
+	}
+
+	if (pFmt->isFallback || pFmt->argNum > OS_PRINTF_MAX_ARG)
+	{
+		return osPrintf_onMBuf(mb, pFmt->fmt, ap);
+	}
+
+	//first pass, fetch the arguments, and add up the max output size
+	size = pFmt->litLen;
+	argIdx = 0;
+	for (pSpec = pFmt->spec; pSpec < &pFmt->spec[pFmt->specNum]; pSpec++)
+	{
+		osPrintfArg_t *pArg = &arg[argIdx];
+
+		switch (pSpec->conv)
+		{
+			case 0:
+				continue;
+
+			case '?':
+				size++;
+				continue;
+
+			case 'b':
+				pArg->s.p = va_arg(ap, const char *);
+				pArg->s.l = va_arg(ap, size_t);
+				pArg->s.l = pArg->s.p ? pArg->s.l : 0;
+				size += MAX(pArg->s.l, pSpec->pad);
+				break;
+
+			case 'c':
+				pArg->n = va_arg(ap, int);
+				size += MAX(1, pSpec->pad);
+				break;
+
+			case 'd':
+			case 'i':
+				switch (pSpec->lenmod)
+				{
+					case LENMOD_SIZE:
+						pArg->sn = va_arg(ap, ssize_t);
+						break;
+
+					default:
+					case LENMOD_LONG_LONG:
+						pArg->sn = va_arg(ap, signed long long);
+						break;
+
+					case LENMOD_LONG:
+						pArg->sn = va_arg(ap, signed long);
+						break;
+
+					case LENMOD_NONE:
+						pArg->sn = va_arg(ap, signed);
+						break;
+				}
+				size += MAX(NUM_SIZE, pSpec->pad);
+				break;
+
+			case 'u':
+			case 'x':
+			case 'X':
+				switch (pSpec->lenmod)
+				{
+					case LENMOD_SIZE:
+						pArg->n = va_arg(ap, size_t);
+						break;
+
+					default:
+					case LENMOD_LONG_LONG:
+						pArg->n = va_arg(ap, unsigned long long);
+						break;
+
+					case LENMOD_LONG:
+						pArg->n = va_arg(ap, unsigned long);
+						break;
+
+					case LENMOD_NONE:
+						pArg->n = va_arg(ap, unsigned);
+						break;
+				}
+				size += MAX(NUM_SIZE, pSpec->pad);
+				break;
+
+			case 'f':
+			case 'F':
+				pArg->dbl = va_arg(ap, double);
+				size += NUM_SIZE + pSpec->pad + (pSpec->fpad == (size_t)-1 ? 0 : pSpec->fpad);
+				break;
+
+			case 'p':
+				pArg->n = (uintptr_t)va_arg(ap, void *);
+				size += MAX(NUM_SIZE, pSpec->pad);
+				break;
+
+			case 'r':
+				pl = va_arg(ap, const osPointerLen_t *);
+				pArg->s.p = pl ? pl->p : NULL;
+				pArg->s.l = (pl && pl->p) ? pl->l : 0;
+				size += MAX(pArg->s.l, pSpec->pad);
+				break;
+
+			case 'M':
+				pMbuf = va_arg(ap, const osMBuf_t *);
+				pArg->s.p = pMbuf ? (const char *)pMbuf->buf : NULL;
+				pArg->s.l = (pMbuf && pMbuf->buf) ? pMbuf->end : 0;
+				size += MAX(pArg->s.l, pSpec->pad);
+				break;
+
+			case 's':
+				pArg->s.p = va_arg(ap, const char *);
+				pArg->s.l = osStrLen(pArg->s.p);
+				size += MAX(pArg->s.l, pSpec->pad);
+				break;
+
+			case 'w':
+			case 'W':
+				pArg->s.p = (const char *)va_arg(ap, uint8_t *);
+				pArg->s.l = va_arg(ap, size_t);
+				pArg->s.l = pArg->s.p ? pArg->s.l : 0;
+				size += MAX(pArg->s.l * 2, pSpec->pad);
+				break;
+
+			default:
+				break;
+		}
+
+		argIdx++;
+	}
+
+	//the only capacity check
+	if (mb->pos + size > mb->size)
+	{
+		err = osMBuf_realloc(mb, MAX(mb->pos + size, mb->size * 2));
+		if (err)
+		{
+			return err;
+		}
+	}
+
+	//second pass, write the output
+	dst = d = (char *)mb->buf + mb->pos;
+	argIdx = 0;
+	for (pSpec = pFmt->spec; pSpec < &pFmt->spec[pFmt->specNum]; pSpec++)
+	{
+		const osPrintfArg_t *pArg = &arg[argIdx];
+		const char pch = pSpec->plr ? ' ' : pSpec->pch;
+
+		switch (pSpec->conv)
+		{
+			case 0:
+				memcpy(d, &pFmt->fmt[pSpec->litPos], pSpec->litLen);
+				d += pSpec->litLen;
+				continue;
+
+			case '?':
+				*d++ = '?';
+				continue;
+
+			case 'b':
+			case 'r':
+			case 'M':
+			case 's':
+				d += put_padded(d, pArg->s.p, pArg->s.l, pSpec->pad, ' ', pSpec->plr, NULL);
+				break;
+
+			case 'c':
+				num[0] = (char)pArg->n;
+				d += put_padded(d, num, 1, pSpec->pad, ' ', pSpec->plr, NULL);
+				break;
+
+			case 'd':
+			case 'i':
+				len = osUInt2DecStr((pArg->sn < 0) ? -pArg->sn : pArg->sn, num);
+				d += put_padded(d, num, len, pSpec->pad, pch, pSpec->plr, (pArg->sn < 0) ? prfx_neg : NULL);
+				break;
+
+			case 'u':
+				len = osUInt2DecStr(pArg->n, num);
+				d += put_padded(d, num, len, pSpec->pad, pch, pSpec->plr, NULL);
+				break;
+
+			case 'x':
+			case 'X':
+				len = local_itoa(num, pArg->n, 16, pSpec->conv == 'X');
+				d += put_padded(d, num, len, pSpec->pad, pch, pSpec->plr, NULL);
+				break;
+
+			case 'f':
+			case 'F':
+				width = pSpec->fpad;
+				dp = pSpec->pad;
+				if (width == (size_t)-1)
+				{
+					width = pSpec->pad;
+					dp = 0;
+				}
+
+				if (isinf(pArg->dbl))
+				{
+					d += put_padded(d, "inf", 3, width, ' ', pSpec->plr, NULL);
+				}
+				else if (isnan(pArg->dbl))
+				{
+					d += put_padded(d, "nan", 3, width, ' ', pSpec->plr, NULL);
+				}
+				else
+				{
+					len = local_ftoa(num, pArg->dbl, dp ? min(dp, DEC_SIZE) : 6);
+					d += put_padded(d, num, len, width, pch, pSpec->plr, (pArg->dbl < 0) ? prfx_neg : NULL);
+				}
+				break;
+
+			case 'p':
+				if (pArg->n)
+				{
+					len = local_itoa(num, pArg->n, 16, false);
+					d += put_padded(d, num, len, pSpec->pad, pch, pSpec->plr, prfx_hex);
+				}
+				else
+				{
+					d += put_padded(d, str_nil, sizeof(str_nil) - 1, pSpec->pad, ' ', pSpec->plr, NULL);
+				}
+				break;
+
+			case 'w':
+			case 'W':
+			{
+				const char *hex = pSpec->conv == 'W' ? hex_uc : hex_lc;
+				const uint8_t *bptr = (const uint8_t *)pArg->s.p;
+				size_t padNum = pSpec->pad > pArg->s.l * 2 ? pSpec->pad - pArg->s.l * 2 : 0;
+
+				if (!pSpec->plr)
+				{
+					memset(d, pch, padNum);
+					d += padNum;
+				}
+
+				for (i=0; i<pArg->s.l; i++)
+				{
+					*d++ = hex[bptr[i] >> 4];
+					*d++ = hex[bptr[i] & 0xf];
+				}
+
+				if (pSpec->plr)
+				{
+					memset(d, pch, padNum);
+					d += padNum;
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		argIdx++;
+	}
+
+	mb->pos += d - dst;
+	mb->end = MAX(mb->end, mb->pos);
+
+	return 0;
+}
+
+
+/**
+ * Print a compiled format to a memory buffer
+ *
+ * @param mb   Memory buffer
+ * @param pFmt Compiled format
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osPrintf_execMBuf(osMBuf_t *mb, const osPrintfFmt_t *pFmt, ...)
+{
+	va_list ap;
+	int err;
+
+	va_start(ap, pFmt);
+	err = osPrintf_vexecMBuf(mb, pFmt, ap);
+	va_end(ap);
+
+	return err;
+}
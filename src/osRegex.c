@@ -11,8 +11,13 @@
 
 #include <ctype.h>
 #include <stdarg.h>
+#include <string.h>
 #include "osTypes.h"
 #include "osPL.h"
+#include "osRegex.h"
+
+
+#define OS_REGEX_NO_LIMIT	((uint32_t)-1)
 
 
 /** Defines a character range */
@@ -22,23 +27,50 @@ struct chr {
 };
 
 
-static bool expr_match(const struct chr *chrv, uint32_t n, uint8_t c, bool neg)
+//the last run a class matched, a later match from inside the run ends at the same place.  For a quote escape
+//class, the walk fields are the quote/escape state of the run at walkPos, a later match ends at the same place
+//only if it starts where the run is outside of the quotes and not right after a '\\'
+typedef struct osRegexRunCache {
+	bool isValid;
+	size_t from;
+	size_t end;
+	uint32_t nm;
+	osPointerLen_t pl;
+	size_t walkPos;
+	bool walkQuote;
+	bool walkEsc;
+} osRegexRunCache_t;
+
+
+static int osRegex_addClass(osRegexProg_t* pProg, const struct chr *chrv, uint32_t n, bool neg, bool qesc, char quantifier);
+static void osRegex_setStartMap(osRegexProg_t* pProg);
+static void osRegex_matchClass(const osRegexElem_t* pElem, const char* ptr, size_t len, size_t p, osRegexRunCache_t* pRun);
+static bool osRegex_isRunClean(const char* ptr, size_t p, osRegexRunCache_t* pRun);
+static void osRegex_stripQuote(const osRegexElem_t* pElem, osRegexRunCache_t* pRun);
+
+
+static inline uint8_t osRegex_lower(uint8_t c)
 {
-	uint32_t i;
-	
-	for (i=0; i<n; i++) {
-		printf("sean, i=%d, chrvmin=%d, chrvmax=%d, n=%d, c=%c, neg=%d\n", i, chrv[i].min, chrv[i].max, n, c, neg);
-		if (c < chrv[i].min)
-			continue;
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
 
-		if (c > chrv[i].max)
-			continue;
 
-		break;
-	}
+//the char as it is compared with the compiled literal chars and class ranges
+static inline uint8_t osRegex_fold(const osRegexProg_t* pProg, uint8_t c)
+{
+	return pProg->isCase ? c : osRegex_lower(c);
+}
+
 
-	printf("sean, expr_match, neg=%d, i=%d, n=%d, return=%d\n", neg, i, n, neg ? (i == n) : (i != n));
-	return neg ? (i == n) : (i != n);
+static inline bool osRegex_isInMap(const uint8_t* map, uint8_t c)
+{
+	return map[c >> 3] & (1 << (c & 0x7));
+}
+
+
+static inline void osRegex_addToMap(uint8_t* map, uint8_t c)
+{
+	map[c >> 3] |= 1 << (c & 0x7);
 }
 
 
@@ -70,32 +102,64 @@ static bool expr_match(const struct chr *chrv, uint32_t n, uint8_t c, bool neg)
  */
 int osRegex(const char *ptr, size_t len, const char *expr, ...)
 {
-	struct chr chrv[64];
-	const char *p, *ep;
-	bool fm, range = false, ec = false, neg = false, qesc = false;
-	uint32_t n = 0;
+	osRegexProg_t prog;
 	va_list ap;
-	bool eesc;
-	size_t l;
+	int err;
 
 	if (!ptr || !expr)
 		return EINVAL;
 
- again:
-	printf("sean, again\n");
-	eesc = false;
-	fm = false;
-	l  = len--;
-	p  = ptr++;
-	ep = expr;
+	err = osRegex_compile(&prog, expr);
+	if (err)
+		return err;
 
 	va_start(ap, expr);
+	err = osRegex_vexec(&prog, ptr, len, ap);
+	va_end(ap);
+
+	return err;
+}
+
+
+/**
+ * Compile a regular expression of the osRegex() syntax into a program, the literal chars and the
+ * classes are matched case insensitive
+ *
+ * @param pProg Program to compile into
+ * @param expr  Regular expressions string
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osRegex_compile(osRegexProg_t* pProg, const char *expr)
+{
+	return osRegex_compileCase(pProg, expr, false);
+}
+
+
+/**
+ * Compile a regular expression of the osRegex() syntax into a program
+ *
+ * @param pProg  Program to compile into
+ * @param expr   Regular expressions string
+ * @param isCase true if the literal chars and the classes are matched case sensitive
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osRegex_compileCase(osRegexProg_t* pProg, const char *expr, bool isCase)
+{
+	struct chr chrv[OS_REGEX_MAX_RANGE];
+	const char *ep;
+	bool fm = false, range = false, ec = false, neg = false, qesc = false, eesc = false;
+	osRegexElem_t* pLit = NULL;
+	uint32_t n = 0;
 
-	if (!l)
-		goto out;
+	if (!pProg || !expr)
+		return EINVAL;
 
-	for (; *ep; ep++) {
-		printf("sean, first *ep loop, *ep=%c, n=%d\n", *ep, n);
+	memset(pProg, 0, sizeof(osRegexProg_t));
+	pProg->isCase = isCase;
+
+	for (ep = expr; *ep && !pProg->err; ep++) {
 		if ('\\' == *ep && !eesc) {
 			eesc = true;
 			continue;
@@ -111,102 +175,35 @@ int osRegex(const char *ptr, size_t len, const char *expr, ...)
 				neg   = false;
 				range = false;
 				qesc  = false;
+				pLit  = NULL;
 				continue;
 			}
 
-			if (!l)
-				break;
+			/* Literal char, consecutive literal chars are kept in one element */
+			if (!pLit) {
+				if (pProg->elemNum >= OS_REGEX_MAX_ELEM) {
+					pProg->err = ENOMEM;
+					break;
+				}
 
-			if (tolower(*ep) != tolower(*p)) {
-				printf("sean, 111, *ep=0x%x, *p=0x%x\n", *ep, *p);
-				va_end(ap);
-				goto again;
+				pLit = &pProg->elem[pProg->elemNum++];
+				pLit->type = OS_REGEX_ELEM_LITERAL;
+				pLit->litPos = pLit > pProg->elem ? (pLit-1)->litPos + (pLit-1)->litLen : 0;
+			}
+
+			if (pLit->litPos + pLit->litLen >= OS_REGEX_MAX_LITERAL_LEN) {
+				pProg->err = ENOMEM;
+				break;
 			}
 
+			pProg->literal[pLit->litPos + pLit->litLen++] = osRegex_fold(pProg, *ep);
 			eesc = false;
-			++p;
-			--l;
 			continue;
 		}
 		/* End of character class */
 		else if (ec) {
-			printf("sean, enter ec=true\n");
-			uint32_t nm, nmin, nmax;
-			osPointerLen_t lpl, *pl = va_arg(ap, osPointerLen_t *);
-			printf("sean, get a pl\n");
-			bool quote = false, esc = false;
-
-			/* Match 0 or more times */
-			if ('*' == *ep) {
-				nmin = 0;
-				nmax = -1;
-			}
-			/* Match 1 or more times */
-			else if ('+' == *ep) {
-				nmin = 1;
-				nmax = -1;
-			}
-			/* Match exactly n times */
-			else if ('1' <= *ep && *ep <= '9') {
-				nmin = *ep - '0';
-				nmax = *ep - '0';
-			}
-			else
-				break;
-
+			pProg->err = osRegex_addClass(pProg, chrv, n, neg, qesc, *ep);
 			fm = false;
-
-			lpl.p = p;
-			lpl.l = 0;
-
-			for (nm = 0; l && nm < nmax; nm++, p++, l--, lpl.l++) {
-				printf("sean, nm=%d, *p=%c,l=%ld,  lpl.l=%ld\n", nm, *p, l, lpl.l);
-				if (qesc) {
-
-					if (esc) {
-						esc = false;
-						continue;
-					}
-
-					switch (*p) {
-
-					case '\\':
-						esc = true;
-						continue;
-
-					case '"':
-						quote = !quote;
-						continue;
-					}
-
-					if (quote)
-						continue;
-				}
-
-				if (!expr_match(chrv, n, tolower(*p), neg))
-				{
-					printf("sean, to break\n");
-					break;
-				}
-			}
-
-			/* Strip quotes */
-			if (qesc && lpl.l > 1 &&
-			    lpl.p[0] == '"' && lpl.p[lpl.l - 1] == '"') {
-
-				lpl.p += 1;
-				lpl.l -= 2;
-				nm    -= 2;
-			}
-
-			if ((nm < nmin) || (nm > nmax)) {
-				va_end(ap);
-				goto again;
-			}
-
-			if (pl)
-				*pl = lpl;
-
 			eesc = false;
 			continue;
 		}
@@ -216,12 +213,10 @@ int osRegex(const char *ptr, size_t len, const char *expr, ...)
 			goto chr;
 		}
 
-		printf("sean, *ep=%c\n", *ep);
 		switch (*ep) {
 			/* End of character class */
 		case ']':
 			ec = true;
-			printf("sean, set ec=true\n");
 			continue;
 
 			/* Negate with quote escape */
@@ -252,26 +247,359 @@ int osRegex(const char *ptr, size_t len, const char *expr, ...)
 		}
 
 	chr:
-		printf("sean, inside char, n=%d, max=%d, min=%d, *ep=%c\n", n, chrv[n].max, chrv[n].min, *ep);
-		if (n >= ARRAY_SIZE(chrv))
+		if (n >= ARRAY_SIZE(chrv)) {
+			pProg->err = EINVAL;
 			break;
+		}
 
-		chrv[n].max = tolower(*ep);
+		chrv[n].max = osRegex_fold(pProg, *ep);
 
 		if (range)
 			range = false;
 		else
-			chrv[n].min = tolower(*ep);
+			chrv[n].min = osRegex_fold(pProg, *ep);
 
 		++n;
-
-		printf("sean, end of char, n=%d, max=%d, min=%d, *ep=%c\n", n, chrv[n-1].max, chrv[n-1].min, *ep);
 	}
- out:
+
+	if (fm && !pProg->err)
+		pProg->err = EINVAL;
+
+	if (!pProg->err)
+		osRegex_setStartMap(pProg);
+
+	return pProg->err;
+}
+
+
+int osRegex_exec(const osRegexProg_t* pProg, const char *ptr, size_t len, ...)
+{
+	va_list ap;
+	int err;
+
+	va_start(ap, len);
+	err = osRegex_vexec(pProg, ptr, len, ap);
 	va_end(ap);
 
-	if (fm)
+	return err;
+}
+
+
+/**
+ * Match a compiled expression.  A match is tried from each offset of the string like osRegex().  Since
+ * a class matches greedily, the position after each element never decreases from one offset to the next,
+ * a class run is scanned once and reused by the following offsets that start inside the run, which keeps
+ * the match linear to len instead of restarting the whole match from each offset.  A quote escape class
+ * ('~') run is reused only from a position the run has outside of the double quotes and not right after a
+ * '\\', since a match that starts inside the quotes sees them reversed.  A match from such a position
+ * scans again, so a string with many quoted parts inside one run is not linear.
+ *
+ * @param pProg Compiled program
+ * @param ptr   String to parse
+ * @param len   Length of string
+ * @param ap    osPointerLen_t pointers, one for each character class, may be NULL
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osRegex_vexec(const osRegexProg_t* pProg, const char *ptr, size_t len, va_list ap)
+{
+	osRegexRunCache_t run[OS_REGEX_MAX_ELEM];
+	osPointerLen_t capture[OS_REGEX_MAX_ELEM];
+
+	if (!pProg || !ptr)
 		return EINVAL;
 
-	return *ep ? ENOENT : 0;
+	if (pProg->err)
+		return pProg->err;
+
+	if (!pProg->elemNum)
+		return 0;
+
+	memset(run, 0, pProg->elemNum * sizeof(osRegexRunCache_t));
+
+	for (size_t start = 0; start < len; start++) {
+		if (!pProg->isAnyStart && !osRegex_isInMap(pProg->startMap, ptr[start]))
+			continue;
+
+		size_t p = start;
+		uint32_t nCapture = 0;
+		uint8_t i;
+		for (i = 0; i < pProg->elemNum; i++) {
+			const osRegexElem_t* pElem = &pProg->elem[i];
+
+			if (pElem->type == OS_REGEX_ELEM_LITERAL) {
+				const char* lit = &pProg->literal[pElem->litPos];
+				uint16_t j;
+				for (j = 0; j < pElem->litLen; j++, p++) {
+					/* no more chars for the literal, a later offset would not have more */
+					if (p >= len)
+						return ENOENT;
+
+					if (osRegex_fold(pProg, ptr[p]) != (uint8_t)lit[j])
+						break;
+				}
+
+				if (j < pElem->litLen)
+					break;
+
+				continue;
+			}
+
+			osRegex_matchClass(pElem, ptr, len, p, &run[i]);
+			if ((run[i].nm < pElem->nmin) || (run[i].nm > pElem->nmax))
+				break;
+
+			capture[nCapture++] = run[i].pl;
+			p = run[i].end;
+		}
+
+		if (i < pProg->elemNum)
+			continue;
+
+		for (i = 0; i < nCapture; i++) {
+			osPointerLen_t *pl = va_arg(ap, osPointerLen_t *);
+			if (pl)
+				*pl = capture[i];
+		}
+
+		return 0;
+	}
+
+	return ENOENT;
+}
+
+
+/**
+ * Match a compiled expression against the whole string, the match must start at
+ * the first char and end at the last char, no other offset is tried.  The classes
+ * match greedily the same as osRegex_vexec(), there is no capture.
+ *
+ * @param pProg Compiled program
+ * @param ptr   String to match
+ * @param len   Length of string
+ *
+ * @return 0 if the whole string matches, otherwise errorcode
+ */
+int osRegex_matchAll(const osRegexProg_t* pProg, const char *ptr, size_t len)
+{
+	osRegexRunCache_t run;
+	size_t p = 0;
+
+	if (!pProg || (!ptr && len))
+		return EINVAL;
+
+	if (pProg->err)
+		return pProg->err;
+
+	for (uint8_t i = 0; i < pProg->elemNum; i++) {
+		const osRegexElem_t* pElem = &pProg->elem[i];
+
+		if (pElem->type == OS_REGEX_ELEM_LITERAL) {
+			const char* lit = &pProg->literal[pElem->litPos];
+			if (len - p < pElem->litLen)
+				return ENOENT;
+
+			for (uint16_t j = 0; j < pElem->litLen; j++, p++) {
+				if (osRegex_fold(pProg, ptr[p]) != (uint8_t)lit[j])
+					return ENOENT;
+			}
+
+			continue;
+		}
+
+		run.isValid = false;
+		osRegex_matchClass(pElem, ptr, len, p, &run);
+		if ((run.nm < pElem->nmin) || (run.nm > pElem->nmax))
+			return ENOENT;
+
+		p = run.end;
+	}
+
+	return p == len ? 0 : ENOENT;
+}
+
+
+static int osRegex_addClass(osRegexProg_t* pProg, const struct chr *chrv, uint32_t n, bool neg, bool qesc, char quantifier)
+{
+	uint32_t nmin, nmax;
+
+	/* Match 0 or more times */
+	if ('*' == quantifier) {
+		nmin = 0;
+		nmax = OS_REGEX_NO_LIMIT;
+	}
+	/* Match 1 or more times */
+	else if ('+' == quantifier) {
+		nmin = 1;
+		nmax = OS_REGEX_NO_LIMIT;
+	}
+	/* Match exactly n times */
+	else if ('1' <= quantifier && quantifier <= '9') {
+		nmin = quantifier - '0';
+		nmax = quantifier - '0';
+	}
+	else
+		return EINVAL;
+
+	if (pProg->elemNum >= OS_REGEX_MAX_ELEM)
+		return ENOMEM;
+
+	osRegexElem_t* pElem = &pProg->elem[pProg->elemNum++];
+	pElem->type = OS_REGEX_ELEM_CLASS;
+	pElem->isQuoteEsc = qesc;
+	pElem->nmin = nmin;
+	pElem->nmax = nmax;
+	pElem->litPos = pElem > pProg->elem ? (pElem-1)->litPos + (pElem-1)->litLen : 0;
+
+	for (uint32_t c = 0; c < 256; c++) {
+		uint8_t lc = osRegex_fold(pProg, c);
+		uint32_t i;
+		for (i = 0; i < n; i++) {
+			if (lc >= chrv[i].min && lc <= chrv[i].max)
+				break;
+		}
+
+		if (neg ? (i == n) : (i != n))
+			osRegex_addToMap(pElem->map, c);
+	}
+
+	pProg->captureNum++;
+
+	return 0;
+}
+
+
+//the chars a match may start with: the first chars of the elements until the first element that must match at least one char
+static void osRegex_setStartMap(osRegexProg_t* pProg)
+{
+	for (uint8_t i = 0; i < pProg->elemNum; i++) {
+		const osRegexElem_t* pElem = &pProg->elem[i];
+
+		if (pElem->type == OS_REGEX_ELEM_LITERAL) {
+			uint8_t c = pProg->literal[pElem->litPos];
+			osRegex_addToMap(pProg->startMap, c);
+			if (!pProg->isCase)
+				osRegex_addToMap(pProg->startMap, toupper(c));
+			return;
+		}
+
+		for (int j = 0; j < 32; j++)
+			pProg->startMap[j] |= pElem->map[j];
+
+		if (pElem->isQuoteEsc) {
+			osRegex_addToMap(pProg->startMap, '\\');
+			osRegex_addToMap(pProg->startMap, '"');
+		}
+
+		if (pElem->nmin)
+			return;
+	}
+
+	pProg->isAnyStart = true;
+}
+
+
+static void osRegex_matchClass(const osRegexElem_t* pElem, const char* ptr, size_t len, size_t p, osRegexRunCache_t* pRun)
+{
+	if (pRun->isValid) {
+		if (pRun->from == p)
+			return;
+
+		/* without count limit, a run from inside the last run ends at the same place */
+		if (pElem->nmax == OS_REGEX_NO_LIMIT && p > pRun->from && p < pRun->end &&
+		    (!pElem->isQuoteEsc || osRegex_isRunClean(ptr, p, pRun))) {
+			pRun->from = p;
+			pRun->nm = pRun->end - p;
+			pRun->pl.p = &ptr[p];
+			pRun->pl.l = pRun->nm;
+			osRegex_stripQuote(pElem, pRun);
+			return;
+		}
+	}
+
+	uint32_t nm;
+	size_t l = len - p;
+	bool quote = false, esc = false;
+
+	pRun->isValid = true;
+	pRun->from = p;
+	pRun->pl.p = &ptr[p];
+	pRun->pl.l = 0;
+	pRun->walkPos = p;
+	pRun->walkQuote = false;
+	pRun->walkEsc = false;
+
+	for (nm = 0; l && nm < pElem->nmax; nm++, p++, l--, pRun->pl.l++) {
+		if (pElem->isQuoteEsc) {
+
+			if (esc) {
+				esc = false;
+				continue;
+			}
+
+			switch (ptr[p]) {
+
+			case '\\':
+				esc = true;
+				continue;
+
+			case '"':
+				quote = !quote;
+				continue;
+			}
+
+			if (quote)
+				continue;
+		}
+
+		if (!osRegex_isInMap(pElem->map, ptr[p]))
+			break;
+	}
+
+	pRun->end = p;
+	pRun->nm = nm;
+	osRegex_stripQuote(pElem, pRun);
+}
+
+
+/* advance the quote/escape state of a quote escape run to p.  p normally increases for the same run, so the
+ * run is walked once in total.  Return true if the run is outside of the quotes and not escaped at p.
+ */
+static bool osRegex_isRunClean(const char* ptr, size_t p, osRegexRunCache_t* pRun)
+{
+	/* the state before walkPos is not kept, scan the run again */
+	if (p < pRun->walkPos)
+		return false;
+
+	for (; pRun->walkPos < p; pRun->walkPos++) {
+		if (pRun->walkEsc) {
+			pRun->walkEsc = false;
+			continue;
+		}
+
+		switch (ptr[pRun->walkPos]) {
+
+		case '\\':
+			pRun->walkEsc = true;
+			break;
+
+		case '"':
+			pRun->walkQuote = !pRun->walkQuote;
+			break;
+		}
+	}
+
+	return !pRun->walkQuote && !pRun->walkEsc;
+}
+
+
+static void osRegex_stripQuote(const osRegexElem_t* pElem, osRegexRunCache_t* pRun)
+{
+	if (pElem->isQuoteEsc && pRun->pl.l > 1 &&
+	    pRun->pl.p[0] == '"' && pRun->pl.p[pRun->pl.l - 1] == '"') {
+
+		pRun->pl.p += 1;
+		pRun->pl.l -= 2;
+		pRun->nm   -= 2;
+	}
 }
@@ -0,0 +1,585 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osScan.c  Byte scan kernels
+ ********************************************************/
+
+#include <string.h>
+
+#include "osTypes.h"
+#include "osScan.h"
+#include "osDebug.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OS_SCAN_X86		1
+#include <immintrin.h>
+#endif
+
+
+typedef ssize_t (*osScanFindChar_h)(const uint8_t* p, size_t len, uint8_t c);
+typedef ssize_t (*osScanFindSet_h)(const uint8_t* p, size_t len, const osScanSet_t* pSet);
+typedef ssize_t (*osScanFindStr_h)(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen);
+typedef void (*osScanBuildBitmap_h)(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap);
+
+typedef struct osScanKernel {
+	osScanLevel_e level;
+	osScanFindChar_h findChar;
+	osScanFindSet_h findSet;
+	osScanFindStr_h findStr;
+	osScanBuildBitmap_h buildBitmap;
+} osScanKernel_t;
+
+
+//the two chars a pattern char may match, they are the same for a char compared case sensitive
+typedef struct osScanAnchor {
+	uint8_t first[2];
+	uint8_t last[2];
+} osScanAnchor_t;
+
+
+static ssize_t osScan_findCharScalar(const uint8_t* p, size_t len, uint8_t c);
+static ssize_t osScan_findSetScalar(const uint8_t* p, size_t len, const osScanSet_t* pSet);
+static ssize_t osScan_findStrScalar(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen);
+static void osScan_buildBitmapScalar(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap);
+#ifdef OS_SCAN_X86
+static ssize_t osScan_findCharSse2(const uint8_t* p, size_t len, uint8_t c);
+static ssize_t osScan_findSetSse2(const uint8_t* p, size_t len, const osScanSet_t* pSet);
+static ssize_t osScan_findStrSse2(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen);
+static void osScan_buildBitmapSse2(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap);
+static ssize_t osScan_findCharAvx2(const uint8_t* p, size_t len, uint8_t c);
+static ssize_t osScan_findSetAvx2(const uint8_t* p, size_t len, const osScanSet_t* pSet);
+static ssize_t osScan_findStrAvx2(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen);
+static void osScan_buildBitmapAvx2(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap);
+#endif
+static inline const osScanKernel_t* osScan_getKernel(void);
+
+
+static const osScanKernel_t osScanKernelScalar = {OS_SCAN_LEVEL_SCALAR, osScan_findCharScalar, osScan_findSetScalar, osScan_findStrScalar, osScan_buildBitmapScalar};
+#ifdef OS_SCAN_X86
+static const osScanKernel_t osScanKernelSse2 = {OS_SCAN_LEVEL_SSE2, osScan_findCharSse2, osScan_findSetSse2, osScan_findStrSse2, osScan_buildBitmapSse2};
+static const osScanKernel_t osScanKernelAvx2 = {OS_SCAN_LEVEL_AVX2, osScan_findCharAvx2, osScan_findSetAvx2, osScan_findStrAvx2, osScan_buildBitmapAvx2};
+#endif
+static const osScanKernel_t* pOsScanKernel = NULL;
+
+
+void osScan_initSet(osScanSet_t* pSet, const char* chars, size_t num)
+{
+	if(!pSet || !chars)
+	{
+		logError("null pointer, pSet=%p, chars=%p.", pSet, chars);
+		return;
+	}
+
+	memset(pSet, 0, sizeof(osScanSet_t));
+	num = num ? num : strlen(chars);
+	for(size_t i=0; i<num; i++)
+	{
+		uint8_t c = chars[i];
+		if(osScan_isInSet(pSet, c))
+		{
+			continue;
+		}
+
+		pSet->map[c >> 3] |= 1 << (c & 0x7);
+		if(pSet->num < OS_SCAN_SET_MAX_NUM)
+		{
+			pSet->c[pSet->num] = c;
+		}
+		if(pSet->num <= OS_SCAN_SET_MAX_NUM)
+		{
+			pSet->num++;
+		}
+	}
+}
+
+
+osScanLevel_e osScan_setLevel(osScanLevel_e level)
+{
+	const osScanKernel_t* pKernel = &osScanKernelScalar;
+
+#ifdef OS_SCAN_X86
+	__builtin_cpu_init();
+	if((level == OS_SCAN_LEVEL_AUTO || level == OS_SCAN_LEVEL_AVX2) && __builtin_cpu_supports("avx2"))
+	{
+		pKernel = &osScanKernelAvx2;
+	}
+	else if(level != OS_SCAN_LEVEL_SCALAR && __builtin_cpu_supports("sse2"))
+	{
+		pKernel = &osScanKernelSse2;
+	}
+#endif
+
+	__atomic_store_n(&pOsScanKernel, pKernel, __ATOMIC_RELEASE);
+
+	return pKernel->level;
+}
+
+
+osScanLevel_e osScan_getLevel(void)
+{
+	return osScan_getKernel()->level;
+}
+
+
+ssize_t osScan_findChar(const void* buf, size_t len, char c)
+{
+	if(!buf)
+	{
+		return -1;
+	}
+
+	return osScan_getKernel()->findChar(buf, len, c);
+}
+
+
+ssize_t osScan_findSet(const void* buf, size_t len, const osScanSet_t* pSet)
+{
+	if(!buf || !pSet)
+	{
+		return -1;
+	}
+
+	//too many chars for the simd kernels, the scalar kernel uses the bitmap
+	if(pSet->num > OS_SCAN_SET_MAX_NUM)
+	{
+		return osScan_findSetScalar(buf, len, pSet);
+	}
+
+	return osScan_getKernel()->findSet(buf, len, pSet);
+}
+
+
+ssize_t osScan_findStr(const void* buf, size_t len, const char* pattern, size_t patternLen)
+{
+	return osScan_findStrPartialCase(buf, len, pattern, patternLen, patternLen);
+}
+
+
+ssize_t osScan_findStrCase(const void* buf, size_t len, const char* pattern, size_t patternLen)
+{
+	return osScan_findStrPartialCase(buf, len, pattern, patternLen, 0);
+}
+
+
+ssize_t osScan_findStrPartialCase(const void* buf, size_t len, const char* pattern, size_t patternLen, size_t exactLen)
+{
+	if(!buf || !pattern)
+	{
+		return -1;
+	}
+
+	if(!patternLen)
+	{
+		return 0;
+	}
+
+	if(patternLen > len)
+	{
+		return -1;
+	}
+
+	return osScan_getKernel()->findStr(buf, len, (const uint8_t*)pattern, patternLen, exactLen > patternLen ? patternLen : exactLen);
+}
+
+
+void osScan_buildBitmap(const void* buf, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap)
+{
+	if(!buf || !pSet || !pBitmap)
+	{
+		logError("null pointer, buf=%p, pSet=%p, pBitmap=%p.", buf, pSet, pBitmap);
+		return;
+	}
+
+	if(pSet->num > OS_SCAN_SET_MAX_NUM)
+	{
+		osScan_buildBitmapScalar(buf, len, pSet, pBitmap);
+		return;
+	}
+
+	osScan_getKernel()->buildBitmap(buf, len, pSet, pBitmap);
+}
+
+
+static inline const osScanKernel_t* osScan_getKernel(void)
+{
+	const osScanKernel_t* pKernel = __atomic_load_n(&pOsScanKernel, __ATOMIC_ACQUIRE);
+	if(!pKernel)
+	{
+		osScan_setLevel(OS_SCAN_LEVEL_AUTO);
+		pKernel = __atomic_load_n(&pOsScanKernel, __ATOMIC_ACQUIRE);
+	}
+
+	return pKernel;
+}
+
+
+static inline uint8_t osScan_lower(uint8_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+
+static inline uint8_t osScan_upper(uint8_t c)
+{
+	return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+
+static inline void osScan_getAnchor(const uint8_t* pattern, size_t patternLen, size_t exactLen, osScanAnchor_t* pAnchor)
+{
+	uint8_t c = pattern[0];
+	pAnchor->first[0] = exactLen > 0 ? c : osScan_lower(c);
+	pAnchor->first[1] = exactLen > 0 ? c : osScan_upper(c);
+
+	c = pattern[patternLen-1];
+	pAnchor->last[0] = exactLen >= patternLen ? c : osScan_lower(c);
+	pAnchor->last[1] = exactLen >= patternLen ? c : osScan_upper(c);
+}
+
+
+//p has at least patternLen chars
+static inline bool osScan_isStrMatch(const uint8_t* p, const uint8_t* pattern, size_t patternLen, size_t exactLen)
+{
+	if(memcmp(p, pattern, exactLen) != 0)
+	{
+		return false;
+	}
+
+	for(size_t i=exactLen; i<patternLen; i++)
+	{
+		if(osScan_lower(p[i]) != osScan_lower(pattern[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static ssize_t osScan_findCharScalar(const uint8_t* p, size_t len, uint8_t c)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		if(p[i] == c)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+static ssize_t osScan_findSetScalar(const uint8_t* p, size_t len, const osScanSet_t* pSet)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		if(osScan_isInSet(pSet, p[i]))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+//the last word is filled with 0 beyond len
+static void osScan_buildBitmapScalar(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap)
+{
+	for(size_t i=0; i<len; i+=64)
+	{
+		uint64_t word = 0;
+		size_t n = len - i < 64 ? len - i : 64;
+		for(size_t k=0; k<n; k++)
+		{
+			if(osScan_isInSet(pSet, p[i+k]))
+			{
+				word |= 1ULL << k;
+			}
+		}
+		pBitmap[i >> 6] = word;
+	}
+}
+
+
+//scan from startPos, used by the simd kernels for the tail
+static inline ssize_t osScan_findStrTail(const uint8_t* p, size_t len, size_t startPos, const uint8_t* pattern, size_t patternLen, size_t exactLen, const osScanAnchor_t* pAnchor)
+{
+	size_t last = patternLen - 1;
+	for(size_t i=startPos; i+patternLen<=len; i++)
+	{
+		if((p[i] == pAnchor->first[0] || p[i] == pAnchor->first[1]) && (p[i+last] == pAnchor->last[0] || p[i+last] == pAnchor->last[1]))
+		{
+			if(osScan_isStrMatch(&p[i], pattern, patternLen, exactLen))
+			{
+				return i;
+			}
+		}
+	}
+
+	return -1;
+}
+
+
+static ssize_t osScan_findStrScalar(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen)
+{
+	osScanAnchor_t anchor;
+	osScan_getAnchor(pattern, patternLen, exactLen, &anchor);
+
+	return osScan_findStrTail(p, len, 0, pattern, patternLen, exactLen, &anchor);
+}
+
+
+#ifdef OS_SCAN_X86
+
+__attribute__((target("sse2")))
+static ssize_t osScan_findCharSse2(const uint8_t* p, size_t len, uint8_t c)
+{
+	const __m128i vc = _mm_set1_epi8(c);
+	size_t i = 0;
+	for(; i+16 <= len; i+=16)
+	{
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&p[i]), vc));
+		if(mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	ssize_t pos = osScan_findCharScalar(&p[i], len - i, c);
+	return pos < 0 ? -1 : i + pos;
+}
+
+
+__attribute__((target("sse2")))
+static ssize_t osScan_findSetSse2(const uint8_t* p, size_t len, const osScanSet_t* pSet)
+{
+	__m128i vc[OS_SCAN_SET_MAX_NUM];
+	for(int k=0; k<pSet->num; k++)
+	{
+		vc[k] = _mm_set1_epi8(pSet->c[k]);
+	}
+
+	size_t i = 0;
+	for(; pSet->num && i+16 <= len; i+=16)
+	{
+		__m128i data = _mm_loadu_si128((const __m128i*)&p[i]);
+		__m128i match = _mm_cmpeq_epi8(data, vc[0]);
+		for(int k=1; k<pSet->num; k++)
+		{
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(data, vc[k]));
+		}
+
+		int mask = _mm_movemask_epi8(match);
+		if(mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	ssize_t pos = osScan_findSetScalar(&p[i], len - i, pSet);
+	return pos < 0 ? -1 : i + pos;
+}
+
+
+/* compare the first and the last pattern char of 16 candidates at once, only the candidates that match
+ * both are compared with the whole pattern
+ */
+__attribute__((target("sse2")))
+static ssize_t osScan_findStrSse2(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen)
+{
+	osScanAnchor_t anchor;
+	osScan_getAnchor(pattern, patternLen, exactLen, &anchor);
+
+	const __m128i first0 = _mm_set1_epi8(anchor.first[0]);
+	const __m128i first1 = _mm_set1_epi8(anchor.first[1]);
+	const __m128i last0 = _mm_set1_epi8(anchor.last[0]);
+	const __m128i last1 = _mm_set1_epi8(anchor.last[1]);
+	size_t last = patternLen - 1;
+
+	size_t i = 0;
+	for(; i+last+16 <= len; i+=16)
+	{
+		__m128i dataFirst = _mm_loadu_si128((const __m128i*)&p[i]);
+		__m128i dataLast = _mm_loadu_si128((const __m128i*)&p[i+last]);
+		__m128i matchFirst = _mm_or_si128(_mm_cmpeq_epi8(dataFirst, first0), _mm_cmpeq_epi8(dataFirst, first1));
+		__m128i matchLast = _mm_or_si128(_mm_cmpeq_epi8(dataLast, last0), _mm_cmpeq_epi8(dataLast, last1));
+
+		unsigned mask = _mm_movemask_epi8(_mm_and_si128(matchFirst, matchLast));
+		while(mask)
+		{
+			int bit = __builtin_ctz(mask);
+			if(osScan_isStrMatch(&p[i+bit], pattern, patternLen, exactLen))
+			{
+				return i + bit;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return osScan_findStrTail(p, len, i, pattern, patternLen, exactLen, &anchor);
+}
+
+
+//match 16 bytes against all chars of the set
+__attribute__((target("sse2")))
+static inline unsigned osScan_matchSetSse2(const uint8_t* p, const __m128i* vc, int num)
+{
+	__m128i data = _mm_loadu_si128((const __m128i*)p);
+	__m128i match = _mm_cmpeq_epi8(data, vc[0]);
+	for(int k=1; k<num; k++)
+	{
+		match = _mm_or_si128(match, _mm_cmpeq_epi8(data, vc[k]));
+	}
+
+	return (unsigned)_mm_movemask_epi8(match);
+}
+
+
+//each 64 bytes are matched in 4 blocks of 16 bytes, the 4 masks make a bitmap word
+__attribute__((target("sse2")))
+static void osScan_buildBitmapSse2(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap)
+{
+	__m128i vc[OS_SCAN_SET_MAX_NUM];
+	for(int k=0; k<pSet->num; k++)
+	{
+		vc[k] = _mm_set1_epi8(pSet->c[k]);
+	}
+
+	size_t i = 0;
+	for(; pSet->num && i+64 <= len; i+=64)
+	{
+		uint64_t m0 = osScan_matchSetSse2(&p[i], vc, pSet->num);
+		uint64_t m1 = osScan_matchSetSse2(&p[i+16], vc, pSet->num);
+		uint64_t m2 = osScan_matchSetSse2(&p[i+32], vc, pSet->num);
+		uint64_t m3 = osScan_matchSetSse2(&p[i+48], vc, pSet->num);
+		pBitmap[i >> 6] = m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+	}
+
+	osScan_buildBitmapScalar(&p[i], len - i, pSet, &pBitmap[i >> 6]);
+}
+
+
+__attribute__((target("avx2")))
+static ssize_t osScan_findCharAvx2(const uint8_t* p, size_t len, uint8_t c)
+{
+	const __m256i vc = _mm256_set1_epi8(c);
+	size_t i = 0;
+	for(; i+32 <= len; i+=32)
+	{
+		uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&p[i]), vc));
+		if(mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	ssize_t pos = osScan_findCharSse2(&p[i], len - i, c);
+	return pos < 0 ? -1 : i + pos;
+}
+
+
+__attribute__((target("avx2")))
+static ssize_t osScan_findSetAvx2(const uint8_t* p, size_t len, const osScanSet_t* pSet)
+{
+	__m256i vc[OS_SCAN_SET_MAX_NUM];
+	for(int k=0; k<pSet->num; k++)
+	{
+		vc[k] = _mm256_set1_epi8(pSet->c[k]);
+	}
+
+	size_t i = 0;
+	for(; pSet->num && i+32 <= len; i+=32)
+	{
+		__m256i data = _mm256_loadu_si256((const __m256i*)&p[i]);
+		__m256i match = _mm256_cmpeq_epi8(data, vc[0]);
+		for(int k=1; k<pSet->num; k++)
+		{
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(data, vc[k]));
+		}
+
+		uint32_t mask = _mm256_movemask_epi8(match);
+		if(mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	ssize_t pos = osScan_findSetSse2(&p[i], len - i, pSet);
+	return pos < 0 ? -1 : i + pos;
+}
+
+
+__attribute__((target("avx2")))
+static ssize_t osScan_findStrAvx2(const uint8_t* p, size_t len, const uint8_t* pattern, size_t patternLen, size_t exactLen)
+{
+	osScanAnchor_t anchor;
+	osScan_getAnchor(pattern, patternLen, exactLen, &anchor);
+
+	const __m256i first0 = _mm256_set1_epi8(anchor.first[0]);
+	const __m256i first1 = _mm256_set1_epi8(anchor.first[1]);
+	const __m256i last0 = _mm256_set1_epi8(anchor.last[0]);
+	const __m256i last1 = _mm256_set1_epi8(anchor.last[1]);
+	size_t last = patternLen - 1;
+
+	size_t i = 0;
+	for(; i+last+32 <= len; i+=32)
+	{
+		__m256i dataFirst = _mm256_loadu_si256((const __m256i*)&p[i]);
+		__m256i dataLast = _mm256_loadu_si256((const __m256i*)&p[i+last]);
+		__m256i matchFirst = _mm256_or_si256(_mm256_cmpeq_epi8(dataFirst, first0), _mm256_cmpeq_epi8(dataFirst, first1));
+		__m256i matchLast = _mm256_or_si256(_mm256_cmpeq_epi8(dataLast, last0), _mm256_cmpeq_epi8(dataLast, last1));
+
+		uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(matchFirst, matchLast));
+		while(mask)
+		{
+			int bit = __builtin_ctz(mask);
+			if(osScan_isStrMatch(&p[i+bit], pattern, patternLen, exactLen))
+			{
+				return i + bit;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return osScan_findStrTail(p, len, i, pattern, patternLen, exactLen, &anchor);
+}
+
+
+__attribute__((target("avx2")))
+static inline uint32_t osScan_matchSetAvx2(const uint8_t* p, const __m256i* vc, int num)
+{
+	__m256i data = _mm256_loadu_si256((const __m256i*)p);
+	__m256i match = _mm256_cmpeq_epi8(data, vc[0]);
+	for(int k=1; k<num; k++)
+	{
+		match = _mm256_or_si256(match, _mm256_cmpeq_epi8(data, vc[k]));
+	}
+
+	return (uint32_t)_mm256_movemask_epi8(match);
+}
+
+
+__attribute__((target("avx2")))
+static void osScan_buildBitmapAvx2(const uint8_t* p, size_t len, const osScanSet_t* pSet, uint64_t* pBitmap)
+{
+	__m256i vc[OS_SCAN_SET_MAX_NUM];
+	for(int k=0; k<pSet->num; k++)
+	{
+		vc[k] = _mm256_set1_epi8(pSet->c[k]);
+	}
+
+	size_t i = 0;
+	for(; pSet->num && i+64 <= len; i+=64)
+	{
+		uint64_t lo = osScan_matchSetAvx2(&p[i], vc, pSet->num);
+		uint64_t hi = osScan_matchSetAvx2(&p[i+32], vc, pSet->num);
+		pBitmap[i >> 6] = lo | (hi << 32);
+	}
+
+	osScan_buildBitmapScalar(&p[i], len - i, pSet, &pBitmap[i >> 6]);
+}
+
+#endif
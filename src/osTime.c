@@ -9,6 +9,7 @@
  * Copyright (C) 2010 Creytiv.com
  ********************************************************/
 
+#include <stdio.h>
 #include <time.h>
 #include "osTypes.h"
 #include "osTime.h"
@@ -18,6 +19,8 @@ static const char *dayv[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
 
 static const char *monv[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 
+static __thread osTimeCache_t osTimeCache;
+
 
 /**
  * Print Greenwich Mean Time
@@ -30,18 +33,20 @@ static const char *monv[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "A
 int osGMTtime(osPrintf_t *pf, void *ts)
 {
 	const struct tm *tm;
-	time_t t;
+	struct tm tmBuf;
 
 	if (!ts) 
 	{
-		t  = time(NULL);
-		ts = &t;
+		//reuse the thread time cache instead of converting the current time again
+		tm = &osTime_updateCache()->tm;
 	}
-
-	tm = gmtime(ts);
-	if (!tm)
+	else
 	{
-		return EINVAL;
+		tm = gmtime_r(ts, &tmBuf);
+		if (!tm)
+		{
+			return EINVAL;
+		}
 	}
 
 	return osPrintf_handler(pf, "%s, %02u %s %u %02u:%02u:%02u GMT",
@@ -92,3 +97,32 @@ int osHumanTime(osPrintf_t *pf, const uint32_t *seconds)
 
 	return err;
 }
+
+
+/**
+ * Refresh the calling thread's time cache
+ *
+ * The clock is read each time (clock_gettime is served by vDSO), gmtime_r()
+ * and the date formatting only happen when the second changes.
+ *
+ * @return the calling thread's time cache
+ */
+const osTimeCache_t* osTime_updateCache(void)
+{
+	osTimeCache_t* pCache = &osTimeCache;
+
+	clock_gettime(CLOCK_REALTIME, &pCache->ts);
+	pCache->msec = (uint64_t)pCache->ts.tv_sec * 1000 + pCache->ts.tv_nsec / 1000000;
+
+	if (pCache->ts.tv_sec != pCache->dateSec || !pCache->dateStrLen)
+	{
+		pCache->dateSec = pCache->ts.tv_sec;
+		gmtime_r(&pCache->dateSec, &pCache->tm);
+		pCache->dateStrLen = snprintf(pCache->dateStr, OS_TIME_DATE_STR_SIZE, "%d/%02d/%02d %02d:%02d:%02d",
+			pCache->tm.tm_year+1900, pCache->tm.tm_mon+1, pCache->tm.tm_mday,
+			pCache->tm.tm_hour, pCache->tm.tm_min, pCache->tm.tm_sec);
+	}
+
+	return pCache;
+}
+
@@ -18,6 +18,7 @@
 #include "osDebug.h"
 #include "osMemory.h"
 #include "osList.h"
+#include "osTime.h"
 
 
 
@@ -228,8 +229,8 @@ static uint64_t osStartTimerInternal(time_t msec, timeoutCallBackFunc_t callback
 		return 0;
     }
 
-    struct timespec tp;
-    clock_gettime(CLOCK_REALTIME, &tp);
+    //read the clock through the thread time cache, so it also refreshes the date prefix of the log lines that follow
+    struct timespec tp = osTime_updateCache()->ts;
 
     if(pTimerChain->nodeTimeSec ==0)
     {
@@ -333,8 +334,8 @@ static int osTimerTickExpire()
 	}
 #endif
 
-	struct timespec tp;
-	clock_gettime(CLOCK_REALTIME, &tp);
+	//read the clock through the thread time cache, the same as osStartTimerInternal()
+	struct timespec tp = osTime_updateCache()->ts;
 	time_t diffSec = tp.tv_sec - pTimerChain->nodeTimeSec;
 	time_t diffMsec;
 	osTimerChainNode_t* pNewNode;
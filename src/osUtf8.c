@@ -10,14 +10,30 @@
  ********************************************************/
 
 #include <ctype.h>
+#include <string.h>
 #include "osTypes.h"
 #include "osPrintf.h"
 #include "osUtf8.h"
 #include "osString.h"
+#include "osMBuf.h"
+#include "osScan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OS_UTF8_X86		1
+#include <immintrin.h>
+#endif
 
 
 static const char *hex_chars = "0123456789ABCDEF";
 
+static int osUtf8_encode(osPrintf_t* pf, const uint8_t *p, size_t len);
+static inline size_t osUtf8_getPlainLen(const uint8_t *p, size_t len);
+static ssize_t osUtf8_validateScalar(const uint8_t *p, size_t len);
+#ifdef OS_UTF8_X86
+static bool osUtf8_isValidSsse3(const uint8_t *p, size_t len);
+static bool osUtf8_isValidAvx2(const uint8_t *p, size_t len);
+#endif
+
 
 /**
  * UTF-8 encode
@@ -29,8 +45,6 @@ static const char *hex_chars = "0123456789ABCDEF";
  */
 int osUtf8Encode(osPrintf_t* pf, const char *str)
 {
-	char ubuf[6] = "\\u00", ebuf[2] = "\\";
-
 	if (!pf)
 	{
 		return EINVAL;
@@ -41,9 +55,35 @@ int osUtf8Encode(osPrintf_t* pf, const char *str)
 		return 0;
 	}
 
-	while (*str) 
+	return osUtf8_encode(pf, (const uint8_t *)str, strlen(str));
+}
+
+
+/* the chars that do not need escape are output as one run */
+static int osUtf8_encode(osPrintf_t* pf, const uint8_t *p, size_t len)
+{
+	char ubuf[6] = "\\u00", ebuf[2] = "\\";
+	size_t i = 0;
+
+	while (i < len) 
 	{
-		const uint8_t c = *str++;  /* NOTE: must be unsigned 8-bit */
+		size_t runLen = osUtf8_getPlainLen(&p[i], len - i);
+		if (runLen)
+		{
+			int err = pf->pHandler((const char *)&p[i], runLen, pf->arg);
+			if (err)
+			{
+				return err;
+			}
+
+			i += runLen;
+			if (i >= len)
+			{
+				break;
+			}
+		}
+
+		const uint8_t c = p[i++];  /* NOTE: must be unsigned 8-bit */
 		bool unicode = false;
 		char ec = 0;
 		int err;
@@ -124,6 +164,23 @@ int osUtf8Decode(osPrintf_t *pf, const osPointerLen_t *pl)
 		char ch = pl->p[i];
 		int err;
 
+		//output the chars before the next escape as one run
+		if (ch != '\\')
+		{
+			ssize_t runLen = osScan_findChar(&pl->p[i], pl->l - i, '\\');
+			runLen = runLen < 0 ? pl->l - i : runLen;
+
+			uhi = -1;
+			err = pf->pHandler(&pl->p[i], runLen, pf->arg);
+			if (err)
+			{
+				return err;
+			}
+
+			i += runLen - 1;
+			continue;
+		}
+
 		if (ch == '\\')
 		{
 			unsigned u = 0;
@@ -267,3 +324,451 @@ size_t osUtf8EncodeByteseq(char u[4], unsigned cp)
 		return 3;
 	}
 }
+
+
+static int osUtf8Handler_mbuf(const char *p, size_t size, void *arg)
+{
+	return osMBuf_writeBuf((osMBuf_t *)arg, (const uint8_t *)p, size, true);
+}
+
+
+/**
+ * UTF-8 encode into a memory buffer, the same encoding as osUtf8Encode()
+ *
+ * @param mb Memory buffer for output
+ * @param pl Input string to encode
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osUtf8_encodeMBuf(osMBuf_t *mb, const osPointerLen_t *pl)
+{
+	osPrintf_t pf = {osUtf8Handler_mbuf, mb};
+
+	if (!mb)
+	{
+		return EINVAL;
+	}
+
+	if (!pl || !pl->p)
+	{
+		return 0;
+	}
+
+	//most strings do not need escape, reserve the space once
+	if (mb->pos + pl->l > mb->size)
+	{
+		int err = osMBuf_realloc(mb, mb->pos + pl->l);
+		if (err)
+		{
+			return err;
+		}
+	}
+
+	return osUtf8_encode(&pf, (const uint8_t *)pl->p, pl->l);
+}
+
+
+/**
+ * UTF-8 decode into a memory buffer, the same decoding as osUtf8Decode()
+ *
+ * @param mb Memory buffer for output
+ * @param pl Input buffer to decode
+ *
+ * @return 0 if success, otherwise errorcode
+ */
+int osUtf8_decodeMBuf(osMBuf_t *mb, const osPointerLen_t *pl)
+{
+	osPrintf_t pf = {osUtf8Handler_mbuf, mb};
+
+	if (!mb)
+	{
+		return EINVAL;
+	}
+
+	if (!pl || !pl->p)
+	{
+		return 0;
+	}
+
+	//the decoded string is never longer than the input
+	if (mb->pos + pl->l > mb->size)
+	{
+		int err = osMBuf_realloc(mb, mb->pos + pl->l);
+		if (err)
+		{
+			return err;
+		}
+	}
+
+	return osUtf8Decode(&pf, pl);
+}
+
+
+/* the number of leading chars that are output as is by osUtf8Encode(), i.e., not a control char, '"', '\\' or '/'.
+ * 16 chars are checked at a time */
+static inline size_t osUtf8_getPlainLen(const uint8_t *p, size_t len)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i vQuote = _mm_set1_epi8('"');
+	const __m128i vBackSlash = _mm_set1_epi8('\\');
+	const __m128i vSlash = _mm_set1_epi8('/');
+	const __m128i vSpace = _mm_set1_epi8(' ');
+
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)&p[i]);
+		//c < ' ' unsigned, if max(c, ' ') != c
+		__m128i vCtrl = _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, vSpace), v), _mm_set1_epi8(-1));
+		__m128i vEsc = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vQuote), _mm_cmpeq_epi8(v, vBackSlash)), _mm_or_si128(_mm_cmpeq_epi8(v, vSlash), vCtrl));
+		int mask = _mm_movemask_epi8(vEsc);
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++)
+	{
+		const uint8_t c = p[i];
+		if (c < ' ' || c == '"' || c == '\\' || c == '/')
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
+
+/**
+ * Validate a UTF-8 byte sequence.  The simd kernels check 16 or 32 bytes at a time, using the lookup algorithm by
+ * Keiser and Lemire, the overlong, surrogate, too large, too short and too long sequences are all rejected
+ *
+ * @param buf UTF-8 byte sequence
+ * @param len Length of buf
+ *
+ * @return -1 if buf is valid, otherwise the offset of the first invalid sequence
+ */
+ssize_t osUtf8_validate(const void *buf, size_t len)
+{
+	if (!buf)
+	{
+		return len ? 0 : -1;
+	}
+
+#ifdef OS_UTF8_X86
+	osScanLevel_e level = osScan_getLevel();
+	if (level == OS_SCAN_LEVEL_AVX2)
+	{
+		//the simd kernels only tell if there is any error, locate it by the scalar kernel
+		return osUtf8_isValidAvx2(buf, len) ? -1 : osUtf8_validateScalar(buf, len);
+	}
+	else if (level == OS_SCAN_LEVEL_SSE2 && __builtin_cpu_supports("ssse3"))
+	{
+		return osUtf8_isValidSsse3(buf, len) ? -1 : osUtf8_validateScalar(buf, len);
+	}
+#endif
+
+	return osUtf8_validateScalar(buf, len);
+}
+
+
+static inline bool osUtf8_isCont(uint8_t c)
+{
+	return (c & 0xc0) == 0x80;
+}
+
+
+static ssize_t osUtf8_validateScalar(const uint8_t *p, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len)
+	{
+		//ascii, 8 bytes at a time
+		if (i + 8 <= len)
+		{
+			uint64_t v;
+			memcpy(&v, &p[i], 8);
+			if (!(v & 0x8080808080808080ULL))
+			{
+				i += 8;
+				continue;
+			}
+		}
+
+		const uint8_t c = p[i];
+		if (c < 0x80)
+		{
+			i++;
+			continue;
+		}
+
+		size_t n;
+		uint8_t min2 = 0x80, max2 = 0xbf;	//the range of the second byte
+		if (c >= 0xc2 && c <= 0xdf)
+		{
+			n = 2;
+		}
+		else if (c >= 0xe0 && c <= 0xef)
+		{
+			n = 3;
+			if (c == 0xe0)
+			{
+				min2 = 0xa0;	//overlong
+			}
+			else if (c == 0xed)
+			{
+				max2 = 0x9f;	//surrogate
+			}
+		}
+		else if (c >= 0xf0 && c <= 0xf4)
+		{
+			n = 4;
+			if (c == 0xf0)
+			{
+				min2 = 0x90;	//overlong
+			}
+			else if (c == 0xf4)
+			{
+				max2 = 0x8f;	//too large
+			}
+		}
+		else
+		{
+			return i;
+		}
+
+		if (i + n > len || p[i+1] < min2 || p[i+1] > max2)
+		{
+			return i;
+		}
+
+		for (size_t j=2; j<n; j++)
+		{
+			if (!osUtf8_isCont(p[i+j]))
+			{
+				return i;
+			}
+		}
+
+		i += n;
+	}
+
+	return -1;
+}
+
+
+#ifdef OS_UTF8_X86
+
+/* the error classes of the Keiser-Lemire lookup algorithm, a 2 bytes sequence (prev1, input) is invalid if the
+ * classes looked up by the high nibble of prev1, the low nibble of prev1, and the high nibble of input overlap */
+#define OS_UTF8_TOO_SHORT		(1<<0)		//11______ 0_______, 11______ 11______
+#define OS_UTF8_TOO_LONG		(1<<1)		//0_______ 10______
+#define OS_UTF8_OVERLONG_3		(1<<2)		//11100000 100_____
+#define OS_UTF8_TOO_LARGE		(1<<3)		//11110100 1001____, 11110100 101_____, 11110101+ 10______
+#define OS_UTF8_SURROGATE		(1<<4)		//11101101 101_____
+#define OS_UTF8_OVERLONG_2		(1<<5)		//1100000_ 10______
+#define OS_UTF8_TOO_LARGE_1000	(1<<6)		//11110101+ 1000____
+#define OS_UTF8_OVERLONG_4		(1<<6)		//11110000 1000____
+#define OS_UTF8_TWO_CONTS		(1<<7)		//10______ 10______
+#define OS_UTF8_CARRY			(OS_UTF8_TOO_SHORT | OS_UTF8_TOO_LONG | OS_UTF8_TWO_CONTS)
+
+#define OS_UTF8_BYTE_1_HIGH \
+	OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, \
+	OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, OS_UTF8_TOO_LONG, \
+	OS_UTF8_TWO_CONTS, OS_UTF8_TWO_CONTS, OS_UTF8_TWO_CONTS, OS_UTF8_TWO_CONTS, \
+	OS_UTF8_TOO_SHORT | OS_UTF8_OVERLONG_2, \
+	OS_UTF8_TOO_SHORT, \
+	OS_UTF8_TOO_SHORT | OS_UTF8_OVERLONG_3 | OS_UTF8_SURROGATE, \
+	OS_UTF8_TOO_SHORT | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000 | OS_UTF8_OVERLONG_4
+
+#define OS_UTF8_BYTE_1_LOW \
+	OS_UTF8_CARRY | OS_UTF8_OVERLONG_3 | OS_UTF8_OVERLONG_2 | OS_UTF8_OVERLONG_4, \
+	OS_UTF8_CARRY | OS_UTF8_OVERLONG_2, \
+	OS_UTF8_CARRY, \
+	OS_UTF8_CARRY, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000 | OS_UTF8_SURROGATE, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000, \
+	OS_UTF8_CARRY | OS_UTF8_TOO_LARGE | OS_UTF8_TOO_LARGE_1000
+
+#define OS_UTF8_BYTE_2_HIGH \
+	OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, \
+	OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, \
+	OS_UTF8_TOO_LONG | OS_UTF8_OVERLONG_2 | OS_UTF8_TWO_CONTS | OS_UTF8_OVERLONG_3 | OS_UTF8_TOO_LARGE_1000 | OS_UTF8_OVERLONG_4, \
+	OS_UTF8_TOO_LONG | OS_UTF8_OVERLONG_2 | OS_UTF8_TWO_CONTS | OS_UTF8_OVERLONG_3 | OS_UTF8_TOO_LARGE, \
+	OS_UTF8_TOO_LONG | OS_UTF8_OVERLONG_2 | OS_UTF8_TWO_CONTS | OS_UTF8_SURROGATE | OS_UTF8_TOO_LARGE, \
+	OS_UTF8_TOO_LONG | OS_UTF8_OVERLONG_2 | OS_UTF8_TWO_CONTS | OS_UTF8_SURROGATE | OS_UTF8_TOO_LARGE, \
+	OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT, OS_UTF8_TOO_SHORT
+
+
+__attribute__((target("ssse3")))
+static inline __m128i osUtf8_checkBlockSsse3(__m128i input, __m128i prev)
+{
+	const __m128i vLowNibble = _mm_set1_epi8(0x0f);
+	const __m128i byte1High = _mm_setr_epi8(OS_UTF8_BYTE_1_HIGH);
+	const __m128i byte1Low = _mm_setr_epi8(OS_UTF8_BYTE_1_LOW);
+	const __m128i byte2High = _mm_setr_epi8(OS_UTF8_BYTE_2_HIGH);
+
+	__m128i prev1 = _mm_alignr_epi8(input, prev, 16 - 1);
+	__m128i sc = _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), vLowNibble));
+	sc = _mm_and_si128(sc, _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, vLowNibble)));
+	sc = _mm_and_si128(sc, _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), vLowNibble)));
+
+	//the third and fourth bytes of a 3 or 4 bytes sequence shall be continuations, they are the only TWO_CONTS allowed
+	__m128i prev2 = _mm_alignr_epi8(input, prev, 16 - 2);
+	__m128i prev3 = _mm_alignr_epi8(input, prev, 16 - 3);
+	__m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80)), _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0 - 0x80)));
+	__m128i must23_80 = _mm_and_si128(must23, _mm_set1_epi8(0x80));
+
+	return _mm_xor_si128(must23_80, sc);
+}
+
+
+//non zero if the last bytes of v start a sequence that is not completed in v
+__attribute__((target("ssse3")))
+static inline __m128i osUtf8_isIncompleteSsse3(__m128i v)
+{
+	const __m128i maxValue = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1);
+	return _mm_subs_epu8(v, maxValue);
+}
+
+
+__attribute__((target("ssse3")))
+static bool osUtf8_isValidSsse3(const uint8_t *p, size_t len)
+{
+	__m128i error = _mm_setzero_si128();
+	__m128i prev = _mm_setzero_si128();
+	__m128i prevIncomplete = _mm_setzero_si128();
+	uint8_t tail[16];
+	size_t i = 0;
+
+	while (i < len)
+	{
+		__m128i input;
+		if (i + 16 <= len)
+		{
+			input = _mm_loadu_si128((const __m128i *)&p[i]);
+		}
+		else
+		{
+			//the tail is padded with 0, an incomplete sequence at the end is then caught as TOO_SHORT
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, &p[i], len - i);
+			input = _mm_loadu_si128((const __m128i *)tail);
+		}
+
+		if (!_mm_movemask_epi8(input))
+		{
+			//ascii block, only the sequence left by the previous block may be an error
+			error = _mm_or_si128(error, prevIncomplete);
+		}
+		else
+		{
+			error = _mm_or_si128(error, osUtf8_checkBlockSsse3(input, prev));
+			prevIncomplete = osUtf8_isIncompleteSsse3(input);
+		}
+
+		prev = input;
+		i += 16;
+
+		//stop early on a error, the scalar kernel locates it
+		if ((i & 0x3ff) == 0 && _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xffff)
+		{
+			return false;
+		}
+	}
+
+	//the input ends in the middle of a sequence
+	error = _mm_or_si128(error, prevIncomplete);
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+}
+
+
+__attribute__((target("avx2")))
+static inline __m256i osUtf8_checkBlockAvx2(__m256i input, __m256i prev)
+{
+	const __m256i vLowNibble = _mm256_set1_epi8(0x0f);
+	const __m256i byte1High = _mm256_setr_epi8(OS_UTF8_BYTE_1_HIGH, OS_UTF8_BYTE_1_HIGH);
+	const __m256i byte1Low = _mm256_setr_epi8(OS_UTF8_BYTE_1_LOW, OS_UTF8_BYTE_1_LOW);
+	const __m256i byte2High = _mm256_setr_epi8(OS_UTF8_BYTE_2_HIGH, OS_UTF8_BYTE_2_HIGH);
+
+	//the upper half of prev and the lower half of input, for alignr to shift across the 128 bits lanes
+	__m256i prevInput = _mm256_permute2x128_si256(prev, input, 0x21);
+	__m256i prev1 = _mm256_alignr_epi8(input, prevInput, 16 - 1);
+	__m256i sc = _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), vLowNibble));
+	sc = _mm256_and_si256(sc, _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, vLowNibble)));
+	sc = _mm256_and_si256(sc, _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), vLowNibble)));
+
+	__m256i prev2 = _mm256_alignr_epi8(input, prevInput, 16 - 2);
+	__m256i prev3 = _mm256_alignr_epi8(input, prevInput, 16 - 3);
+	__m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80)), _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80)));
+	__m256i must23_80 = _mm256_and_si256(must23, _mm256_set1_epi8(0x80));
+
+	return _mm256_xor_si256(must23_80, sc);
+}
+
+
+__attribute__((target("avx2")))
+static bool osUtf8_isValidAvx2(const uint8_t *p, size_t len)
+{
+	const __m256i maxValue = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1);
+	__m256i error = _mm256_setzero_si256();
+	__m256i prev = _mm256_setzero_si256();
+	__m256i prevIncomplete = _mm256_setzero_si256();
+	uint8_t tail[32];
+	size_t i = 0;
+
+	while (i < len)
+	{
+		__m256i input;
+		if (i + 32 <= len)
+		{
+			input = _mm256_loadu_si256((const __m256i *)&p[i]);
+		}
+		else
+		{
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, &p[i], len - i);
+			input = _mm256_loadu_si256((const __m256i *)tail);
+		}
+
+		if (!_mm256_movemask_epi8(input))
+		{
+			error = _mm256_or_si256(error, prevIncomplete);
+		}
+		else
+		{
+			error = _mm256_or_si256(error, osUtf8_checkBlockAvx2(input, prev));
+			prevIncomplete = _mm256_subs_epu8(input, maxValue);
+		}
+
+		prev = input;
+		i += 32;
+
+		if ((i & 0x3ff) == 0 && !_mm256_testz_si256(error, error))
+		{
+			return false;
+		}
+	}
+
+	error = _mm256_or_si256(error, prevIncomplete);
+
+	return _mm256_testz_si256(error, error);
+}
+
+#endif
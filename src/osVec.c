@@ -0,0 +1,230 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osVec.c  small vector of pointers
+ ********************************************************/
+
+#include <string.h>
+
+#include "osTypes.h"
+#include "osVec.h"
+#include "osMemory.h"
+#include "osDebug.h"
+
+
+static osStatus_e osVec_grow(osVec_t* pVec, uint32_t capacity);
+
+
+//a zeroed osVec_t has capacity=0, it is treated the same as a inline vector
+static inline uint32_t osVec_getCapacity(const osVec_t* pVec)
+{
+	return pVec->capacity > OS_VEC_INLINE_NUM ? pVec->capacity : OS_VEC_INLINE_NUM;
+}
+
+
+void osVec_init(osVec_t* pVec)
+{
+	if(!pVec)
+	{
+		return;
+	}
+
+	pVec->num = 0;
+	pVec->capacity = OS_VEC_INLINE_NUM;
+	memset(pVec->inlineData, 0, sizeof(pVec->inlineData));
+}
+
+
+osStatus_e osVec_append(osVec_t* pVec, void* pData)
+{
+	if(!pVec)
+	{
+		logError("null pointer, pVec.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pVec->num == osVec_getCapacity(pVec))
+	{
+		osStatus_e status = osVec_grow(pVec, pVec->num + 1);
+		if(status != OS_STATUS_OK)
+		{
+			return status;
+		}
+	}
+
+	osVec_getArray(pVec)[pVec->num++] = pData;
+
+	return OS_STATUS_OK;
+}
+
+
+osStatus_e osVec_appendBulk(osVec_t* pVec, void* const* ppData, uint32_t num)
+{
+	if(!pVec || (!ppData && num))
+	{
+		logError("null pointer, pVec=%p, ppData=%p.", pVec, ppData);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pVec->num + num > osVec_getCapacity(pVec))
+	{
+		osStatus_e status = osVec_grow(pVec, pVec->num + num);
+		if(status != OS_STATUS_OK)
+		{
+			return status;
+		}
+	}
+
+	memcpy(&osVec_getArray(pVec)[pVec->num], ppData, num * sizeof(void*));
+	pVec->num += num;
+
+	return OS_STATUS_OK;
+}
+
+
+osStatus_e osVec_insert(osVec_t* pVec, uint32_t idx, void* pData)
+{
+	if(!pVec)
+	{
+		logError("null pointer, pVec.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(idx > pVec->num)
+	{
+		logError("idx(%d) is beyond the vector size(%d).", idx, pVec->num);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	if(pVec->num == osVec_getCapacity(pVec))
+	{
+		osStatus_e status = osVec_grow(pVec, pVec->num + 1);
+		if(status != OS_STATUS_OK)
+		{
+			return status;
+		}
+	}
+
+	void** pArray = osVec_getArray(pVec);
+	memmove(&pArray[idx+1], &pArray[idx], (pVec->num - idx) * sizeof(void*));
+	pArray[idx] = pData;
+	pVec->num++;
+
+	return OS_STATUS_OK;
+}
+
+
+osStatus_e osVec_reserve(osVec_t* pVec, uint32_t capacity)
+{
+	if(!pVec)
+	{
+		logError("null pointer, pVec.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(capacity <= osVec_getCapacity(pVec))
+	{
+		return OS_STATUS_OK;
+	}
+
+	return osVec_grow(pVec, capacity);
+}
+
+
+void* osVec_remove(osVec_t* pVec, uint32_t idx)
+{
+	if(!pVec || idx >= pVec->num)
+	{
+		return NULL;
+	}
+
+	void** pArray = osVec_getArray(pVec);
+	void* pData = pArray[idx];
+	memmove(&pArray[idx], &pArray[idx+1], (pVec->num - idx - 1) * sizeof(void*));
+	pVec->num--;
+
+	return pData;
+}
+
+
+void* osVec_removeData(osVec_t* pVec, void* pData)
+{
+	if(!pVec)
+	{
+		return NULL;
+	}
+
+	void** pArray = osVec_getArray(pVec);
+	for(uint32_t i=0; i<pVec->num; i++)
+	{
+		if(pArray[i] == pData)
+		{
+			return osVec_remove(pVec, i);
+		}
+	}
+
+	return NULL;
+}
+
+
+void osVec_clear(osVec_t* pVec)
+{
+	if(!pVec)
+	{
+		return;
+	}
+
+	if(pVec->capacity > OS_VEC_INLINE_NUM)
+	{
+		osfree(pVec->pHeapData);
+	}
+
+	osVec_init(pVec);
+}
+
+
+void osVec_delete(osVec_t* pVec)
+{
+	if(!pVec)
+	{
+		return;
+	}
+
+	void** pArray = osVec_getArray(pVec);
+	for(uint32_t i=0; i<pVec->num; i++)
+	{
+		osfree(pArray[i]);
+	}
+
+	osVec_clear(pVec);
+}
+
+
+/* spill to or expand the heap array, the capacity is at least doubled.  The current array is kept if the
+ * allocation fails */
+static osStatus_e osVec_grow(osVec_t* pVec, uint32_t capacity)
+{
+	uint32_t newCapacity = 2 * osVec_getCapacity(pVec);
+	if(newCapacity < capacity)
+	{
+		newCapacity = capacity;
+	}
+
+	void** pHeapData = osmalloc(newCapacity * sizeof(void*), NULL);
+	if(!pHeapData)
+	{
+		logError("fails to allocate memory for %d data pointers.", newCapacity);
+		return OS_ERROR_MEMORY_ALLOC_FAILURE;
+	}
+
+	memcpy(pHeapData, osVec_getArray(pVec), pVec->num * sizeof(void*));
+	if(pVec->capacity > OS_VEC_INLINE_NUM)
+	{
+		osfree(pVec->pHeapData);
+	}
+
+	pVec->pHeapData = pHeapData;
+	pVec->capacity = newCapacity;
+
+	return OS_STATUS_OK;
+}
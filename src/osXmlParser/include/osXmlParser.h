@@ -9,22 +9,49 @@
 #include "osTypes.h"
 #include "osMBuf.h"
 #include "osPL.h"
+#include "osAtom.h"
 
 #include "osXmlParserData.h"
 
 
 #define OSXML_IS_LWS(a) (!(a^0x20) || !(a^0x9) || !(a^0xa))
 #define OS_XML_MAX_FILE_NAME_SIZE	160		//the maximum xml and xsd file name length
+#define OS_XML_FEED_INIT_PEND_BUF_SIZE	1024	//the initial size of the buffer that keeps the partial tag/value between osXml_parseFeed() calls
+#define OS_XML_PARSE_MANY_MAX_THREAD	64		//the maximum number of threads osXml_parseMany() uses
+#define OS_XML_PATH_MAX_NUM			64		//the maximum number of paths in a osXmlPathSet_t, a path is tracked by a bit of a uint64_t
+#define OS_XML_PATH_MAX_DEPTH		32		//the maximum number of element names in a path
+#define OS_XML_STYPE_MAX_PATTERN_LEN	64	//the maximum length of a xsd pattern facet that is compiled, a longer pattern is not checked
+#define OS_XML_NS_MAX_DECL			32		//the maximum number of xmlns declarations in scope at the same time, including the overridden ones
+#define OS_XML_WRITER_MAX_DEPTH		32		//the maximum element depth of a document written by osXmlWriter
+#define OS_XML_WRITER_SEG_SIZE		2048	//the size of a buffer osXmlWriter allocates for a chain target, a bigger piece of data gets a buffer of its own size
 
 
+//a xmlns declaration of a xml element
 typedef struct {
-	bool isDefaultNSXsdName;	//if true, the defaultNS is assigned with xsd name
-    osList_t nsAliasList;       //each entry contains osXsd_nsAliasInfo_t
-    osPointerLen_t defaultNS;
-} osXml_nsInfo_t;
+	osAtom_t nsAliasAtom;		//osAtom_find() of nsAlias, a xml alias is not interned to keep the atom table bounded, OS_ATOM_NONE if not found
+	bool isXsdName;				//the default namespace is not declared in the xml, ns is the xsd name
+	osPointerLen_t nsAlias;		//empty for the default namespace
+	osPointerLen_t ns;
+} osXml_nsDecl_t;
 
 
-osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, const osList_t* pNoXmlnsAttrList, bool isEOT, osXmlDataCallbackInfo_t* callbackInfo, void* pCurXmlInfo);
+//the xmlns declarations in scope of a xml element, refers osXml_nsStack_t.decl[]
+typedef struct {
+	uint16_t declNum;			//decl[0, declNum) are in scope, a later declaration of the same alias overrides an earlier one
+	int16_t defaultIdx;			//the idx in decl[] of the default namespace in scope, -1 if no default namespace
+} osXml_nsScope_t;
+
+
+/* the xmlns declarations of the elements being parsed.  The declarations of a element are pushed after the ones of its
+ * parent, and the element's scope covers both.  A element without xmlns attribute shares its parent's scope, and a
+ * sibling element reuses the slots of the previous sibling, so no memory is allocated for a scope */
+typedef struct {
+	osXml_nsScope_t cur;		//the scope of the element being parsed
+	osXml_nsDecl_t decl[OS_XML_NS_MAX_DECL];
+} osXml_nsStack_t;
+
+
+osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, const osVec_t* pNoXmlnsAttrList, bool isEOT, osXmlDataCallbackInfo_t* callbackInfo, void* pCurXmlInfo);
 
 
 
@@ -19,7 +19,7 @@ typedef struct ctPointer {
 
 
 osXmlComplexType_t* osXsdComplexType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pCtTagInfo, osXsdElement_t* pParentElem);
-//osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplexType_t* pCtInfo);
+//osStatus_e osXsdComplexType_getAttrInfo(osVec_t* pAttrList, osXmlComplexType_t* pCtInfo);
 osStatus_e osXsdComplexType_getSubTagInfo(osXmlComplexType_t* pCtInfo, osXmlTagInfo_t* pTagInfo, osXsd_choiceInfo_t* pChoiceInfo);
 osStatus_e osXsd_transverseCT(osXsd_ctPointer_t* pCTPointer, osXmlDataCallbackInfo_t* callbackInfo);
 void osXmlComplexType_cleanup(void* data);
@@ -48,10 +48,25 @@ typedef struct osXsd_elemPointer {
 
 osStatus_e osXml_parseFirstTag(osMBuf_t* pXmlBuf);
 osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirstTag, osXmlTagInfo_t** ppTagInfo, size_t* tagStartPos);
+//the same as osXml_parseTag(), but the tag info is filled in a caller owned pTagDesc without memory allocation for a tag that has no more than OS_XML_TAG_INLINE_ATTR_NUM attributes
+osStatus_e osXml_scanTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirstTag, osXmlTagDesc_t* pTagDesc, size_t* tagStartPos);
+//free the spilled attributes of pTagDesc, shall be called after the last osXml_scanTag() of pTagDesc
+void osXmlTagDesc_reset(osXmlTagDesc_t* pTagDesc);
+//bind a structural index to pBuf, the bitmap is built lazily by osXmlStructIdx_next()
+void osXmlStructIdx_init(osXmlStructIdx_t* pIdx, const osMBuf_t* pBuf);
+//return the position of the first structural char at or after pos, or pBuf->end if there is none
+size_t osXmlStructIdx_next(osXmlStructIdx_t* pIdx, size_t pos);
 osStatus_e osXml_getNSAlias(osXmlNameValue_t* pAttrNameValue, osPointerLen_t* pDefaultNS, osXsd_nsAliasInfo_t** ppnsAlias, bool* isXSAliasFound, osPointerLen_t* pXsAlias);
 osStatus_e osXmlXSType_convertData(osPointerLen_t* elemName, osPointerLen_t* value, osXmlDataType_e dataType, osXmlData_t* pXmlData);
 osXsdElement_t* osXsd_createAnyElem(osPointerLen_t* pTag, bool isRootAnyElem);
 bool osXml_isXsdElemSimpleType(osXsdElement_t* pXsdElem);
+/* build a atom index for the data in pList.  atomOffset and plOffset are the offsets of the atom and the name inside the data,
+ * i.e., offsetof(osXsdElement_t, elemNameAtom) and offsetof(osXsdElement_t, elemName).  A data without name (like xs:any) is
+ * skipped, if multiple data have the same name, the first one is indexed.  Return NULL if a named data is not interned or
+ * there is no memory, the caller shall fall back to walk the list */
+osXsd_atomIndex_t* osXsd_atomIndex_create(osList_t* pList, size_t atomOffset, size_t plOffset);
+//return the data that has atom, and its list position in pListIdx (-1 if not found).  pListIdx can be NULL
+void* osXsd_atomIndex_get(const osXsd_atomIndex_t* pIndex, osAtom_t atom, int* pListIdx);
 
 
 #endif
@@ -8,6 +8,8 @@
 #include "osList.h"
 #include "osTypes.h"
 #include "osMBuf.h"
+#include "osAtom.h"
+#include "osScan.h"
 
 #include "osXmlParserIntf.h"
 
@@ -79,18 +81,37 @@ typedef enum {
 } osXmlElemDispType_e;
 
 
+/* a open addressing index that maps a interned name to a xsd object and its position in the list the index is built
+ * from.  It is built once when the xsd tree is linked, and is read only afterwards */
+typedef struct {
+	osAtom_t atom;				//OS_ATOM_NONE for a empty slot
+	int listIdx;				//the position of pData in the list
+	void* pData;				//osXsdElement_t, osXmlComplexType_t or osXmlSimpleType_t, depending on the list
+} osXsd_atomIndexSlot_t;
+
+
+typedef struct {
+	uint32_t mask;				//number of slots - 1, the number of slots is a power of 2 and at least twice of the number of entries
+	osXsd_atomIndexSlot_t slot[];
+} osXsd_atomIndex_t;
+
+
 typedef struct osXml_complexTypeInfo {
     osPointerLen_t typeName;	//must be in the beginning of this data structure, for the use in osXsd_getTypeByname()
+	osAtom_t typeNameAtom;		//must follow typeName, for the use in osXsd_getTypeByname()
     bool isMixed;
 	osXmlElemDispType_e elemDispType;
 	osList_t elemList;		//each element is comprised of osXsdElement_t
+	osXsd_atomIndex_t* pChildIndex;	//elemNameAtom -> child element in elemList, built in osXsd_elemLinkChild(), NULL if not built
 } osXmlComplexType_t;
 
 
 typedef struct {
     osPointerLen_t typeName;    //must be in the beginning of this data structure, for the use in osXsd_getTypeByname()
+	osAtom_t typeNameAtom;		//must follow typeName, for the use in osXsd_getTypeByname()
     osXmlDataType_e baseType;
     osList_t facetList;         //each element is a osXmlRestrictionFacet_t
+	struct osXmlSTypeValidator* pValidator;	//compiled from facetList by osXmlSimpleType_compile(), the xml values are validated against it
 } osXmlSimpleType_t;
 
 
@@ -110,6 +131,7 @@ typedef struct {
 	short nsUseLabel;	//-1: used as default ns, 0: explicitly use alias only, 1: used as both default and alias ns (it is possible in a XSD, a namespace is assigned as default as well as alias)
 	osPointerLen_t ns;
 	osPointerLen_t nsAlias;
+	osAtom_t nsAliasAtom;
 } osXsd_nsAliasInfo_t;
 
 
@@ -140,8 +162,10 @@ typedef struct {
 typedef struct osXsdElement {
 	bool isRootElement;
 	osPointerLen_t elemName;
+	osAtom_t elemNameAtom;		//the interned elemName, elements and xml tags are compared by atom
 	osXsd_schemaInfo_t* pSchema;
 	osPointerLen_t elemTypeName;
+	osAtom_t elemTypeNameAtom;
 	osXsd_choiceInfo_t* pChoiceInfo;
 	int minOccurs;			//>=0
 	int maxOccurs;			// -1 means unbounded
@@ -166,6 +190,9 @@ typedef struct {
     osList_t gElementList;      //a list of global element for a schema of a namespace, each entry contains osXsdElement_t
     osList_t gComplexList;      //a list of global complexType for a schema of a namespace, each entry contains osXmlComplexType_t
     osList_t gSimpleList;       //a list of global simpleType for a schema of a namespace, each entry contains osXmlSimpleType_t
+	osXsd_atomIndex_t* pGElemIndex;	//elemNameAtom -> global element in gElementList
+	osXsd_atomIndex_t* pCTypeIndex;	//typeNameAtom -> global complexType in gComplexList
+	osXsd_atomIndex_t* pSTypeIndex;	//typeNameAtom -> global simpleType in gSimpleList
 	osMBuf_t* pXsdBuf;			//keep a reference to xsdBuf so that it can be freed when needed
 } osXsdSchema_t;
 
@@ -183,11 +210,35 @@ typedef struct {
     bool isEndTag;                  //the line is the end of tag, i.e., </tag>
     bool isPElement;                //if the union data is pElement, this value is true.  That happens in <xs:element> xxx </element> <xs:choice> xxx </choice> or <xs:any> xxx </xs:any>
     union {
-        osList_t attrNVList;        //each list element contains osXmlNameValue_t, for <xs:element xxx />, <xs:any xxx /> and other xs:xxx cases
+        osVec_t attrNVList;         //each vector entry contains osXmlNameValue_t, for <xs:element xxx />, <xs:any xxx /> and other xs:xxx cases
         osXsdElement_t* pElement;   //if tag is xs:element or xs:any, and contains sub tags (i.e., the element and any do not end in one line), this data structure will be used
     };
 } osXmlTagInfo_t;
 
 
+#define OS_XML_STRUCT_IDX_WIN_WORDS	64		//the bitmap words of a osXmlStructIdx_t window, each word covers 64 bytes
+#define OS_XML_TAG_INLINE_ATTR_NUM	OS_VEC_INLINE_NUM	//the attributes stored in osXmlTagDesc_t, the same as the inline size of attrNVList so that both spill at the same time
+
+
+/* the structural index of a xml buffer, the positions of '<', '>', '"' and '\'' are marked in a bitmap by a simd pass
+ * over a window of the buffer, the window moves forward when osXmlStructIdx_next() passes its end.  The index is on
+ * stack, no memory is allocated no matter how big the buffer is */
+typedef struct {
+	const osMBuf_t* pBuf;
+	size_t winStart;			//the buffer position of bit 0 of bitmap[0], always a multiple of 64
+	size_t winEnd;				//the window covers [winStart, winEnd), empty if winStart == winEnd
+	osScanSet_t set;
+	uint64_t bitmap[OS_XML_STRUCT_IDX_WIN_WORDS];
+} osXmlStructIdx_t;
+
+
+//a caller owned tag info for osXml_scanTag(), usually on stack and reused for all tags of a document
+typedef struct {
+	osXmlTagInfo_t tagInfo;		//tagInfo.attrNVList refers attrInline[], and the spilled attributes if a tag has more than OS_XML_TAG_INLINE_ATTR_NUM attributes
+	osXmlNameValue_t attrInline[OS_XML_TAG_INLINE_ATTR_NUM];
+	osXmlStructIdx_t* pStructIdx;	//if not NULL, osXml_scanTag() jumps between the structural chars of the buffer instead of checking every byte
+} osXmlTagDesc_t;
+
+
 
 #endif
@@ -14,7 +14,12 @@
 
 osXmlSimpleType_t* osXsdSimpleType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pSimpleTagInfo, osXsdElement_t* pParentElem);
 //osStatus_e osXsdSimpleType_getSubTagInfo(osXmlSimpleType_t* pSimpleInfo, osXmlTagInfo_t* pTagInfo);
+//compile the facets of a simpleType into a validator, shall be called once all facets of pSimple are added
+osStatus_e osXmlSimpleType_compile(osXmlSimpleType_t* pSimple);
 osStatus_e osXmlSimpleType_convertData(osXmlSimpleType_t* pSimple, osPointerLen_t* pValue, osXmlData_t* pXmlData);
+//whether a data type is a XS numerical type, the facets of a numerical type store value instead of string
+bool osXml_isDigitType(osXmlDataType_e dataType);
+void osXmlSimpleType_cleanup(void* data);
 
 
 
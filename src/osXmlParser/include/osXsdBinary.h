@@ -0,0 +1,149 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osXsdBinary.h
+ * the on-disk format of a precompiled xsd, see osXsd_exportBin() and osXsd_initNSBin()
+ ********************************************************/
+
+#ifndef _OS_XSD_BINARY_H
+#define _OS_XSD_BINARY_H
+
+#include <stdint.h>
+
+#include "osTypes.h"
+
+
+/* A precompiled xsd file is position independent, all references are offsets or table indexes, no pointer is stored.
+ *
+ *   +------------------------+  offset 0
+ *   | osXsdBin_header_t      |  magic, version, file size, and the offset/number of each table
+ *   +------------------------+
+ *   | schema table           |  osXsdBin_schema_t, one per schema of the namespace
+ *   | nsAlias table          |  osXsdBin_nsAlias_t
+ *   | element table          |  osXsdBin_element_t, the global elements of each schema, then the child elements of each complexType
+ *   | complexType table      |  osXsdBin_complexType_t, the global complexTypes of each schema first, then the embedded ones
+ *   | simpleType table       |  osXsdBin_simpleType_t, the global simpleTypes of each schema first, then the embedded ones
+ *   | facet table            |  osXsdBin_facet_t
+ *   | choice table           |  osXsdBin_choice_t
+ *   +------------------------+
+ *   | string pool            |  all names/values, each is NUL terminated
+ *   +------------------------+
+ *
+ * The elements of a list (schema's global element list, a complexType's child element list, etc.) are stored contiguously
+ * in their table, a list is referred by a osXsdBin_range_t.  Each table starts at a 8 byte boundary.  The file is in the
+ * host byte order, it is meant to be generated and used on the same platform.
+ */
+
+#define OS_XSD_BIN_MAGIC		0x4253584f		//"OXSB"
+#define OS_XSD_BIN_VERSION		1
+#define OS_XSD_BIN_NO_IDX		-1				//no reference, like a element without choice
+
+
+typedef enum {
+	OS_XSD_BIN_TABLE_SCHEMA,
+	OS_XSD_BIN_TABLE_NS_ALIAS,
+	OS_XSD_BIN_TABLE_ELEMENT,
+	OS_XSD_BIN_TABLE_COMPLEX_TYPE,
+	OS_XSD_BIN_TABLE_SIMPLE_TYPE,
+	OS_XSD_BIN_TABLE_FACET,
+	OS_XSD_BIN_TABLE_CHOICE,
+	OS_XSD_BIN_TABLE_STRING,		//the string pool, num is the pool size in bytes
+	OS_XSD_BIN_TABLE_NUM,
+} osXsdBinTable_e;
+
+
+typedef struct {
+	uint32_t off;		//offset from the beginning of the string pool
+	uint32_t len;		//string length, not including the ending NUL
+} osXsdBin_str_t;
+
+
+typedef struct {
+	uint32_t start;		//the first entry idx in a table
+	uint32_t num;
+} osXsdBin_range_t;
+
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t fileSize;
+	uint32_t reserved;
+	osXsdBin_range_t table[OS_XSD_BIN_TABLE_NUM];		//start is the table offset in the file, num is the number of entries
+} osXsdBin_header_t;
+
+
+typedef struct {
+	osXsdBin_str_t targetNS;		//the xsd name if isEmptyTargetNS = true
+	osXsdBin_str_t defaultNS;
+	osXsdBin_str_t xsAlias;
+	osXsdBin_range_t nsAlias;		//in the nsAlias table
+	osXsdBin_range_t gElement;		//in the element table
+	osXsdBin_range_t gComplex;		//in the complexType table
+	osXsdBin_range_t gSimple;		//in the simpleType table
+	uint32_t isEmptyTargetNS;
+} osXsdBin_schema_t;
+
+
+typedef struct {
+	int32_t nsUseLabel;
+	osXsdBin_str_t ns;
+	osXsdBin_str_t nsAlias;
+} osXsdBin_nsAlias_t;
+
+
+typedef struct {
+	osXsdBin_str_t elemName;
+	osXsdBin_str_t elemTypeName;
+	osXsdBin_str_t elemDefault;
+	osXsdBin_str_t fixed;
+	int32_t schemaIdx;			//OS_XSD_BIN_NO_IDX if the element does not refer a schema
+	int32_t choiceIdx;			//OS_XSD_BIN_NO_IDX if the element is not in a choice
+	int32_t typeIdx;			//complexType idx if dataType = OS_XML_DATA_TYPE_COMPLEX, simpleType idx if OS_XML_DATA_TYPE_SIMPLE, otherwise OS_XSD_BIN_NO_IDX
+	int32_t minOccurs;
+	int32_t maxOccurs;
+	uint8_t dataType;
+	uint8_t isRootElement;
+	uint8_t isQualified;
+	uint8_t isXmlAnyElem;		//for dataType = OS_XML_DATA_TYPE_ANY
+	uint8_t anyElemNS;			//isXmlAnyElem = false
+	uint8_t anyElemPS;			//isXmlAnyElem = false
+	uint8_t isLeaf;				//isXmlAnyElem = true
+	uint8_t isRootAnyElem;		//isXmlAnyElem = true
+} osXsdBin_element_t;
+
+
+typedef struct {
+	osXsdBin_str_t typeName;
+	osXsdBin_range_t elem;		//child elements in the element table
+	uint32_t isMixed;
+	uint32_t elemDispType;
+} osXsdBin_complexType_t;
+
+
+typedef struct {
+	osXsdBin_str_t typeName;
+	osXsdBin_range_t facet;		//in the facet table
+	uint32_t baseType;
+	uint32_t reserved;
+} osXsdBin_simpleType_t;
+
+
+typedef struct {
+	uint32_t facet;
+	uint32_t isString;			//if true, string is used, otherwise value is used
+	uint64_t value;
+	osXsdBin_str_t string;
+} osXsdBin_facet_t;
+
+
+typedef struct {
+	int32_t minOccurs;
+	int32_t maxOccurs;
+	uint32_t tag;
+	uint32_t reserved;
+} osXsdBin_choice_t;
+
+
+#endif
@@ -8,15 +8,20 @@
 
 osXsdElement_t* osXsd_parseElement(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pTagInfo);
 osXsdElement_t* osXsd_parseElementAny(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pElemTagInfo);
-osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElement);
+osStatus_e osXmlElement_getAttrInfo(osVec_t* pAttrList, osXsdElement_t* pElement);
 osXsdElement_t* osXsd_getNSRootElem(osPointerLen_t* pTargetNS, bool isEmptyTargetNS, osPointerLen_t* pElemTag);
 osXmlDataType_e osXsd_getElemDataType(osPointerLen_t* typeValue);
 osStatus_e osXsd_elemCallback(osXsdElement_t* pXsdElem, osXmlDataCallbackInfo_t* callbackInfo);
 osStatus_e osXsd_browseNode(osXsdElement_t* pXsdElem, osXmlDataCallbackInfo_t* callbackInfo);
 osXsdNamespace_t* osXsd_parse(osMBuf_t* pXmlBuf, osPointerLen_t* xsdName);
+//add a parsed or loaded schema into the global NS list, xsdName is used when the schema has no target namespace
+osXsdNamespace_t* osXsd_addSchema(osXsdSchema_t* pSchema, osPointerLen_t* xsdName);
+//get the schemas of a target namespace, or the schema of a xsd name if the xsd has no target namespace
+osStatus_e osXsd_getSchemas(osPointerLen_t* pName, osVec_t* pSchemaVec, bool* pIsEmptyTargetNS);
 osPointerLen_t* osXsd_getXSAlias();
 void osXsd_setXSAlias(osPointerLen_t* pXsAlias);
 void osXsdElement_cleanup(void* data);
+void osXsdSchema_cleanup(void* data);
 void osXsd_freeNsList(osPointerLen_t* pTarget);
 void osXsd_dbgListTargetNS();
 
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "osMBuf.h"
 #include "osPL.h"
@@ -48,7 +50,8 @@ typedef struct osXsd_elemPointer {
     int curIdx;                     //which idx in assignedChildIdx[] that the xsd element is current processing, used in for the ordering presence of sequence deposition
     osXml_assignedChildInfo_t  assignedChildIdx[OS_XSD_COMPLEX_TYPE_MAX_ALLOWED_CHILD_ELEM]; //if true, the list idx corresponding child element value has been assigned
 	osList_t xmlChoiceList;			//each entry contains osXml_choiceInfo_t, repesents a choice block within a complex element (the choce blocks of child elements)
-	osXml_nsInfo_t* pXmlnsInfo;	//would not use osXsd_schemaInfo_t.targetNS here
+	osXml_nsScope_t nsScope;		//the xmlns declarations in scope of the element, would not use osXsd_schemaInfo_t.targetNS here
+	osListElement_t stackLE;		//link in osXml_parseStateInfo_t.xsdElemPointerList, the xsdPointer stack is a intrusive list
 } osXsd_elemPointer_t;
 
 
@@ -66,8 +69,7 @@ typedef struct {
  	
 typedef struct {
     bool isXmlParseDone;			//indicate if xml parsing is done
-	osList_t gNSList;				//each entry contains osXml_nsInfo_t(pXmlnsInfo), or osXsd_nsAliasInfo_t(pnsAlias) that are allocated during a xml parsing for the purpose of freeing them when parsng is done
-	osXml_nsInfo_t* pCurXmlInfo;	//the current pXmlnsInfo for a xml under parse
+	osXml_nsStack_t nsStack;		//the xmlns declarations of the elements being parsed, nsStack.cur is the scope for a xml under parse
 	osList_t xsdElemPointerList;	//xsdPointer stack.  Each <element>'s xsdPointer will be pushed into the stack, and pop out in </element> handling
     osXsd_elemPointer_t* pParentXsdPointer;
 	osXmlTagPosInfo_t tagPosInfo;	// used to get the value between <element>value</element>
@@ -79,18 +81,28 @@ typedef struct {
 } osXml_parseStateInfo_t;
 
 
+//shared by the workers of osXml_parseMany()
+typedef struct {
+	osXmlParseDoc_t* docs;
+	uint32_t docNum;
+	uint32_t nextDoc;				//the next doc to be parsed, taken by the workers via atomic increase
+	osPointerLen_t* xsdName;
+} osXml_parseManyInfo_t;
+
+
 static bool isExistXsdAnyElem(osXsd_elemPointer_t* pXsdPointer);
 static osXsdElement_t* osXml_getChildXsdElemByTag(osPointerLen_t* pTag, osXsd_elemPointer_t* pXsdPointer, osXmlElemDispType_e* pParentXsdDispType, int* listIdx);
 static osXml_choiceInfo_t* osXml_getChoiceInfo(osXsd_elemPointer_t* pParentXsdPointer, uint32_t choiceTag);
 static osXmlComplexType_t* osXsdPointer_getCT(osXsd_elemPointer_t* pXsdPointer);
-static osStatus_e osXml_getNsInfo(osList_t* pAttrNVList, osXml_nsInfo_t** ppNsInfo, osList_t* pNoXmlnsAttrList, osList_t* pgNSList);
-static bool osXml_isAliasExist(osPointerLen_t* pRootAlias, osList_t* pAliasList, osPointerLen_t** pRootNS);
-static void osXml_updateNsInfo(osXml_nsInfo_t* pNewNsInfo, osXml_nsInfo_t* pXsdPointerXmlnsInfo);
-static osListElement_t* osXml_isAliasMatch(osList_t* nsAliasList, osPointerLen_t* pnsAlias);
-static void osXmlNsInfo_cleanup(void* data);
+static osStatus_e osXml_getNsInfo(osVec_t* pAttrNVList, osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osVec_t* pNoXmlnsAttrList);
+static osXml_nsDecl_t* osXml_pushNsDecl(osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osPointerLen_t* pnsAlias, osPointerLen_t* pNS);
+static osXml_nsDecl_t* osXml_getNsDecl(osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osPointerLen_t* pnsAlias);
 static void osXsd_elemPointer_cleanup(void* data);
 
 static osStatus_e osXml_parseInternal(osMBuf_t* pBuf, osPointerLen_t* xsdName, osXmlDataCallbackInfo_t* callbackInfo);
+static osStatus_e osXml_parseElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo);
+static void osXml_parseStateInfo_cleanup(osXml_parseStateInfo_t* pStateInfo);
+static void* osXml_parseManyWorker(void* pArg);
 static osStatus_e osXml_parseRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo);
 static osStatus_e osXml_parseSOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo);	//Start Of Tag	<xs:aaa>
 static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo);	//End Of Tag	</xs:aaa>
@@ -128,6 +140,99 @@ osStatus_e osXml_parse(osMBuf_t* pXmlBuf, osMBuf_t* pXsdBuf, osPointerLen_t* xsd
 	return osXml_parseInternal(pXmlBuf, xsdName, callbackInfo);
 }
 
+
+/* parse multiple independent xml documents against a already parsed xsd in parallel.  The xsd is shared read only by all
+ * workers, each document is parsed with its own parse state and callbackInfo, so a callback may be called from any worker
+ * thread, and the callbacks of different documents may be called at the same time.
+ *
+ * docs:    INOUT, the documents, docs[i].status is set to the parse result of docs[i].pXmlBuf
+ * docNum:  IN, the number of documents
+ * xsdName: IN, the name of a xsd that has been parsed, see osXml_parse()
+ * nThread: IN, the number of threads to parse, including the calling thread.  0 means one thread per online cpu
+ *
+ * return OS_STATUS_OK if all documents are parsed successfully, otherwise the status of the first failed document
+ */
+osStatus_e osXml_parseMany(osXmlParseDoc_t* docs, uint32_t docNum, osPointerLen_t* xsdName, uint32_t nThread)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(!docs || !xsdName)
+	{
+		logError("null pointer, docs=%p, xsdName=%p.", docs, xsdName);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(nThread == 0)
+	{
+		long cpuNum = sysconf(_SC_NPROCESSORS_ONLN);
+		nThread = cpuNum > 0 ? cpuNum : 1;
+	}
+	if(nThread > docNum)
+	{
+		nThread = docNum;
+	}
+	if(nThread > OS_XML_PARSE_MANY_MAX_THREAD)
+	{
+		nThread = OS_XML_PARSE_MANY_MAX_THREAD;
+	}
+
+	osXml_parseManyInfo_t info = {docs, docNum, 0, xsdName};
+	pthread_t thread[OS_XML_PARSE_MANY_MAX_THREAD];
+	uint32_t threadNum = 0;
+	//the calling thread is one of the workers
+	for(; threadNum+1 < nThread; threadNum++)
+	{
+		if(pthread_create(&thread[threadNum], NULL, osXml_parseManyWorker, &info) != 0)
+		{
+			logError("fails to create a worker thread, continue with %d threads.", threadNum+1);
+			break;
+		}
+	}
+
+	osXml_parseManyWorker(&info);
+
+	for(uint32_t i=0; i<threadNum; i++)
+	{
+		pthread_join(thread[i], NULL);
+	}
+
+	for(uint32_t i=0; i<docNum; i++)
+	{
+		if(docs[i].status != OS_STATUS_OK)
+		{
+			logError("fails to parse doc(%d), status=%d.", i, docs[i].status);
+			if(status == OS_STATUS_OK)
+			{
+				status = docs[i].status;
+			}
+		}
+	}
+
+	return status;
+}
+
+
+static void* osXml_parseManyWorker(void* pArg)
+{
+	osXml_parseManyInfo_t* pInfo = pArg;
+
+	uint32_t i;
+	while((i = __atomic_fetch_add(&pInfo->nextDoc, 1, __ATOMIC_RELAXED)) < pInfo->docNum)
+	{
+		osXmlParseDoc_t* pDoc = &pInfo->docs[i];
+		if(!pDoc->pXmlBuf)
+		{
+			logError("null pointer, docs[%d].pXmlBuf.", i);
+			pDoc->status = OS_ERROR_NULL_POINTER;
+			continue;
+		}
+
+		pDoc->status = osXml_parseInternal(pDoc->pXmlBuf, pInfo->xsdName, pDoc->callbackInfo);
+	}
+
+	return NULL;
+}
+
 	
 /* parse a xml input based on xsd.  Expect the top element is also the xsd root element, i.e., the xml implements the whole xsd  
  * when parsing a element of a input xml, if the element is a complex type, and the complex type contains multiple other elements, if
@@ -181,7 +286,9 @@ osStatus_e osXml_parse(osMBuf_t* pXmlBuf, osMBuf_t* pXsdBuf, osPointerLen_t* xsd
 static osStatus_e osXml_parseInternal(osMBuf_t* pBuf, osPointerLen_t* xsdName, osXmlDataCallbackInfo_t* callbackInfo)
 {
     osStatus_e status = OS_STATUS_OK;
-    osXmlTagInfo_t* pElemInfo = NULL;
+	osXmlTagDesc_t tagDesc = {};	//reused for all tags, no memory allocation per tag
+    osXmlTagInfo_t* pElemInfo = &tagDesc.tagInfo;
+	osXmlStructIdx_t structIdx;
 	osXml_parseStateInfo_t stateInfo = {};
 	stateInfo.xsdName = xsdName;
 	stateInfo.callbackInfo = callbackInfo;
@@ -211,10 +318,13 @@ static osStatus_e osXml_parseInternal(osMBuf_t* pBuf, osPointerLen_t* xsdName, o
         goto EXIT;
     }
 
-    status = osXml_parseTag(pBuf, false, false, &pElemInfo, &stateInfo.tagPosInfo.tagStartPos);
-    if(status != OS_STATUS_OK || !pElemInfo)
+	osXmlStructIdx_init(&structIdx, pBuf);
+	tagDesc.pStructIdx = &structIdx;
+
+    status = osXml_scanTag(pBuf, false, false, &tagDesc, &stateInfo.tagPosInfo.tagStartPos);
+    if(status != OS_STATUS_OK)
     {
-        logError("fails to osXml_parseTag for xml, pos=%ld.", pBuf->pos);
+        logError("fails to osXml_scanTag for xml, pos=%ld.", pBuf->pos);
         goto EXIT;
     }
 
@@ -224,9 +334,6 @@ static osStatus_e osXml_parseInternal(osMBuf_t* pBuf, osPointerLen_t* xsdName, o
 		logError("fails to osXml_parseRootElem.");
 		goto EXIT;
 	}
-	
-	//done with pElemInfo for the rootElem, free it.
-	pElemInfo = osfree(pElemInfo);
 
     while(pBuf->pos < pBuf->end)
     {
@@ -241,70 +348,494 @@ static osStatus_e osXml_parseInternal(osMBuf_t* pBuf, osPointerLen_t* xsdName, o
             continue;
         }
 
-        status = osXml_parseTag(pBuf, false, false, &pElemInfo, &stateInfo.tagPosInfo.tagStartPos);
-        if(status != OS_STATUS_OK || !pElemInfo)
+        status = osXml_scanTag(pBuf, false, false, &tagDesc, &stateInfo.tagPosInfo.tagStartPos);
+        if(status != OS_STATUS_OK)
         {
-            logError("fails to osXml_parseTag for xml, pos=%ld.", pBuf->pos);
+            logError("fails to osXml_scanTag for xml, pos=%ld.", pBuf->pos);
             goto EXIT;
         }
 
-		if(stateInfo.isProcessAnyElem)
+		status = osXml_parseElem(pBuf, pElemInfo, &stateInfo);
+	    if(status != OS_STATUS_OK)
+    	{
+        	goto EXIT;
+    	}
+	}
+
+EXIT:
+	osXml_parseStateInfo_cleanup(&stateInfo);
+	osXmlTagDesc_reset(&tagDesc);
+    return status;
+} //osXml_parse()
+
+
+/* process a tag after the root element, dispatch to the start/end/done handlers based on the tag type */
+static osStatus_e osXml_parseElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(pStateInfo->isProcessAnyElem)
+	{
+       	if(pElemInfo->isEndTag)
 		{
-        	if(pElemInfo->isEndTag)
-			{
-				status =osXml_parseAnyElemEOT(pBuf, pElemInfo, &stateInfo);
-			}
-			else if(pElemInfo->isTagDone)
-			{
-				status = osXml_parseAnyElemDOT(pBuf, pElemInfo, &stateInfo);
-			}
-			else
-			{
-				status = osXml_parseAnyElemSOT(pBuf, pElemInfo, &stateInfo);
-			}
+			status =osXml_parseAnyElemEOT(pBuf, pElemInfo, pStateInfo);
+		}
+		else if(pElemInfo->isTagDone)
+		{
+			status = osXml_parseAnyElemDOT(pBuf, pElemInfo, pStateInfo);
 		}
 		else
 		{
-            if(pElemInfo->isEndTag)
-            {
-                status = osXml_parseEOT(pBuf, pElemInfo, &stateInfo);
-            }
-            else if(pElemInfo->isTagDone)
-            {
-                status = osXml_parseDOT(pBuf, pElemInfo, &stateInfo);
-            }
-            else
+			status = osXml_parseAnyElemSOT(pBuf, pElemInfo, pStateInfo);
+		}
+	}
+	else
+	{
+        if(pElemInfo->isEndTag)
+        {
+            status = osXml_parseEOT(pBuf, pElemInfo, pStateInfo);
+        }
+        else if(pElemInfo->isTagDone)
+        {
+            status = osXml_parseDOT(pBuf, pElemInfo, pStateInfo);
+        }
+        else
+        {
+            status = osXml_parseSOT(pBuf, pElemInfo, pStateInfo);
+        }
+    }
+
+    if(status != OS_STATUS_OK)
+    {
+       	logError("fails to osXml_parse element(%r), isProcessAnyElem=%d, isEndTag=%d, isTagDone=%d.", &pElemInfo->tag, pStateInfo->isProcessAnyElem, pElemInfo->isEndTag, pElemInfo->isTagDone);
+    }
+
+	return status;
+}
+
+
+static void osXml_parseStateInfo_cleanup(osXml_parseStateInfo_t* pStateInfo)
+{
+    osList_deleteLinked(&pStateInfo->xsdElemPointerList);
+}
+
+
+/* incremental (push) parse.  A xml document may arrive in pieces (from a socket, a pipe, etc.), instead of collecting the
+ * whole document before calling osXml_parse(), each piece is fed to osXml_parseFeed() as soon as it arrives, the parse
+ * state (osXml_parseStateInfo_t) is kept in osXmlParseCtx_t between feeds, and the callback for a element is called as
+ * soon as the element's tag is complete.
+ *
+ * A piece is parsed in place.  Only the bytes after the last complete tag (a partial tag, or a partial leaf value) are
+ * copied to pendBuf and joined with the next piece.  The tag PLs (element name, xmlns attributes) that are referred after
+ * a tag is processed, i.e., the tags of the root element and the <xs:any> elements, are copied to tagCopyList and kept
+ * until the parse is done.
+ */
+typedef enum {
+	OS_XML_FEED_SCAN_TEXT,			//outside of a tag
+	OS_XML_FEED_SCAN_TEXT_QUOTE,	//inside a double quote before a tag, same as OS_XSD_TAG_INFO_BEFORE_TAG_INSIDE_QUOTE in osXml_parseTag()
+	OS_XML_FEED_SCAN_LT,			//a '<' is met, not sure yet if it is a comment
+	OS_XML_FEED_SCAN_COMMENT,
+	OS_XML_FEED_SCAN_TAG,
+	OS_XML_FEED_SCAN_TAG_QUOTE,		//inside a attribute value
+} osXmlFeedScanState_e;
+
+
+struct osXmlParseCtx {
+	osXml_parseStateInfo_t stateInfo;
+	osPointerLen_t xsdName;
+	osStatus_e status;				//once a feed fails, all following feeds fail with the same status
+	bool isFirstTagDone;			//<?xml version="1.0" encoding="UTF-8"?> is parsed
+	bool isRootElemDone;
+	osMBuf_t* pPendBuf;				//the bytes that have not been consumed by the previous feeds, pos is always 0
+	osList_t tagCopyList;			//each entry contains a tag copy, see above
+	//the scanner state that is used to determine if a complete tag is available without parsing the tag, so that a partial tag is not scanned again in the next feed
+	osXmlFeedScanState_e scanState;
+	size_t scanPos;
+	int commentCount;
+	bool commentIsInsideQuote;
+	char quoteChar;
+};
+
+
+static void osXmlParseCtx_cleanup(void* data)
+{
+	if(!data)
+	{
+		return;
+	}
+
+	osXmlParseCtx_t* pCtx = data;
+	osXml_parseStateInfo_cleanup(&pCtx->stateInfo);
+	osList_delete(&pCtx->tagCopyList);
+	osMBuf_dealloc(pCtx->pPendBuf);
+}
+
+
+/* xsdName:      IN, the name of xsd file, the same as in osXml_parse().  The xsd must have been parsed, and xsdName->p must be kept until osXml_parseFeedEnd()
+ * callbackInfo: IN, instruction to perform xml parse, must be kept until osXml_parseFeedEnd()
+ */
+osXmlParseCtx_t* osXml_parseFeedStart(osPointerLen_t* xsdName, osXmlDataCallbackInfo_t* callbackInfo)
+{
+	if(!xsdName || !callbackInfo)
+	{
+		logError("null pointer, xsdName=%p, callbackInfo=%p.", xsdName, callbackInfo);
+		return NULL;
+	}
+
+	osXmlParseCtx_t* pCtx = oszalloc(sizeof(osXmlParseCtx_t), osXmlParseCtx_cleanup);
+	if(!pCtx)
+	{
+		logError("fails to allocate osXmlParseCtx_t.");
+		return NULL;
+	}
+
+	pCtx->xsdName = *xsdName;
+	pCtx->stateInfo.xsdName = &pCtx->xsdName;
+	pCtx->stateInfo.callbackInfo = callbackInfo;
+	pCtx->pPendBuf = osMBuf_alloc(OS_XML_FEED_INIT_PEND_BUF_SIZE);
+	if(!pCtx->pPendBuf)
+	{
+		logError("fails to allocate pPendBuf, size=%d.", OS_XML_FEED_INIT_PEND_BUF_SIZE);
+		osfree(pCtx);
+		return NULL;
+	}
+	pCtx->pPendBuf->end = 0;
+
+	return pCtx;
+}
+
+
+/* scan pBuf from pCtx->scanPos, return true if a complete tag (the comments before the tag are skipped) ends in pBuf.
+ * the scanner follows the same rules as osXml_parseTag() to determine the end of a tag.  When false is returned, the
+ * scanner state is kept in pCtx, the next scan continues from where it stopped.
+ */
+static bool osXml_feedScanTag(osXmlParseCtx_t* pCtx, osMBuf_t* pBuf)
+{
+	size_t i = pCtx->scanPos;
+	while(i < pBuf->end)
+	{
+		char c = pBuf->buf[i];
+		switch(pCtx->scanState)
+		{
+			case OS_XML_FEED_SCAN_TEXT:
+				if(c == '<')
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_LT;
+					//do not move i, a comment is checked starting from '<'
+					continue;
+				}
+				else if(c == '"')
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TEXT_QUOTE;
+				}
+				break;
+			case OS_XML_FEED_SCAN_TEXT_QUOTE:
+				if(c == '"')
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TEXT;
+				}
+				break;
+			case OS_XML_FEED_SCAN_LT:
+				//needs "<!--" to tell if it is a comment
+				if(i + 4 > pBuf->end)
+				{
+					goto EXIT;
+				}
+
+				if(pBuf->buf[i+1] == '!' && pBuf->buf[i+2] == '-' && pBuf->buf[i+3] == '-')
+				{
+					i += 3;
+					pCtx->commentCount = 0;
+					pCtx->commentIsInsideQuote = false;
+					pCtx->scanState = OS_XML_FEED_SCAN_COMMENT;
+				}
+				else
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TAG;
+				}
+				break;
+			case OS_XML_FEED_SCAN_COMMENT:
+				if(c == '"')
+				{
+					pCtx->commentIsInsideQuote = !pCtx->commentIsInsideQuote;
+				}
+				if(pCtx->commentCount >= 3 && !pCtx->commentIsInsideQuote && c == '>' && pBuf->buf[i-1] == '-' && pBuf->buf[i-2] == '-')
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TEXT;
+				}
+				pCtx->commentCount++;
+				break;
+			case OS_XML_FEED_SCAN_TAG:
+				if(c == '"' || c == '\'')
+				{
+					pCtx->quoteChar = c;
+					pCtx->scanState = OS_XML_FEED_SCAN_TAG_QUOTE;
+				}
+				else if(c == '>')
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TEXT;
+					pCtx->scanPos = i + 1;
+					return true;
+				}
+				break;
+			case OS_XML_FEED_SCAN_TAG_QUOTE:
+				if(c == pCtx->quoteChar)
+				{
+					pCtx->scanState = OS_XML_FEED_SCAN_TAG;
+				}
+				break;
+			default:
+				break;
+		}
+
+		i++;
+	}
+
+EXIT:
+	pCtx->scanPos = i;
+	return false;
+}
+
+
+/* make the PLs of a parsed tag pointing to a copy of the tag, pOrig is where the tag copy starts in the original buffer */
+static void osXmlTagInfo_relocate(osXmlTagInfo_t* pTagInfo, const uint8_t* pOrig, char* pCopy)
+{
+	pTagInfo->tag.p = pCopy + ((uint8_t*)pTagInfo->tag.p - pOrig);
+	for(uint32_t i=0; i<osVec_getCount(&pTagInfo->attrNVList); i++)
+	{
+		osXmlNameValue_t* pNV = osVec_get(&pTagInfo->attrNVList, i);
+		if(pNV->name.p)
+		{
+			pNV->name.p = pCopy + ((uint8_t*)pNV->name.p - pOrig);
+		}
+		if(pNV->value.p)
+		{
+			pNV->value.p = pCopy + ((uint8_t*)pNV->value.p - pOrig);
+		}
+	}
+}
+
+
+/* if a start tag is referred after it is processed, copy it to tagCopyList.  This is the case for the root element (the xmlns
+ * alias list) and <xs:any> elements (the element name and the xmlns alias list).  A start tag that is not in the xsd is treated
+ * as a <xs:any> root element by osXml_parseSOT()
+ */
+static osStatus_e osXml_feedKeepTag(osXmlParseCtx_t* pCtx, osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo)
+{
+	if(pElemInfo->isEndTag || pElemInfo->isTagDone)
+	{
+		return OS_STATUS_OK;
+	}
+
+	if(pCtx->isRootElemDone && !pCtx->stateInfo.isProcessAnyElem)
+	{
+		int listIdx = -1;
+		if(!pCtx->stateInfo.pParentXsdPointer || osXml_getChildXsdElemByTag(&pElemInfo->tag, pCtx->stateInfo.pParentXsdPointer, NULL, &listIdx))
+		{
+			return OS_STATUS_OK;
+		}
+	}
+
+	size_t tagStartPos = pCtx->stateInfo.tagPosInfo.tagStartPos;
+	char* pCopy = osmalloc(pBuf->pos - tagStartPos, NULL);
+	if(!pCopy)
+	{
+		logError("fails to osmalloc a tag copy, size=%ld.", pBuf->pos - tagStartPos);
+		return OS_ERROR_MEMORY_ALLOC_FAILURE;
+	}
+
+	memcpy(pCopy, &pBuf->buf[tagStartPos], pBuf->pos - tagStartPos);
+	if(!osList_append(&pCtx->tagCopyList, pCopy))
+	{
+		logError("fails to osList_append a tag copy.");
+		osfree(pCopy);
+		return OS_ERROR_MEMORY_ALLOC_FAILURE;
+	}
+
+	//relocate after the copy is kept, pElemInfo still refers pBuf if the copy fails
+	osXmlTagInfo_relocate(pElemInfo, &pBuf->buf[tagStartPos], pCopy);
+	return OS_STATUS_OK;
+}
+
+
+//parse all complete tags in pBuf starting from pBuf->pos.  When returns, pBuf->pos points to the first byte that is not consumed
+static osStatus_e osXml_feedProcess(osXmlParseCtx_t* pCtx, osMBuf_t* pBuf)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXmlTagDesc_t tagDesc = {};
+	osXmlTagInfo_t* pElemInfo = &tagDesc.tagInfo;
+	osXml_parseStateInfo_t* pStateInfo = &pCtx->stateInfo;
+	osXmlStructIdx_t structIdx;
+
+	//pBuf is fixed during the call, the index is only built for the windows that are scanned
+	osXmlStructIdx_init(&structIdx, pBuf);
+	tagDesc.pStructIdx = &structIdx;
+
+	while(pBuf->pos < pBuf->end)
+	{
+        //handling the trailing section to make sure there is no LWS content
+        if(pStateInfo->isXmlParseDone)
+        {
+            if(!OSXML_IS_LWS(pBuf->buf[pBuf->pos]))
             {
-                status = osXml_parseSOT(pBuf, pElemInfo, &stateInfo);
+                logError("content in the trailing section, it shall not be allowed, we just ignore it. pos=%ld", pBuf->pos);
             }
+            pBuf->pos++;
+            continue;
         }
 
-	    if(status != OS_STATUS_OK)
-    	{
-        	logError("fails to osXml_parse element(%r), isProcessAnyElem=%d, isEndTag=%d, isTagDone=%d.", &pElemInfo->tag, stateInfo.isProcessAnyElem, pElemInfo->isEndTag, pElemInfo->isTagDone);
-        	goto EXIT;
-    	}
+		if(!osXml_feedScanTag(pCtx, pBuf))
+		{
+			break;
+		}
+
+		if(!pCtx->isFirstTagDone)
+		{
+    		//parse <?xml version="1.0" encoding="UTF-8"?>, it always starts from pos 0 since nothing is consumed before it
+    		if((status = osXml_parseFirstTag(pBuf)) != OS_STATUS_OK)
+    		{
+        		logError("xml parse the first line failure.");
+        		goto EXIT;
+    		}
+
+			pCtx->isFirstTagDone = true;
+			continue;
+		}
+
+        status = osXml_scanTag(pBuf, false, false, &tagDesc, &pStateInfo->tagPosInfo.tagStartPos);
+        if(status != OS_STATUS_OK)
+        {
+            logError("fails to osXml_scanTag for xml, pos=%ld.", pBuf->pos);
+            goto EXIT;
+        }
+
+		status = osXml_feedKeepTag(pCtx, pBuf, pElemInfo);
+		if(status != OS_STATUS_OK)
+		{
+			goto EXIT;
+		}
 
-		//done with pElemInfo for this tag, free it.
-		pElemInfo = osfree(pElemInfo);
+		if(!pCtx->isRootElemDone)
+		{
+			status = osXml_parseRootElem(pBuf, pElemInfo, pStateInfo);
+			if(status != OS_STATUS_OK)
+			{
+				logError("fails to osXml_parseRootElem.");
+				goto EXIT;
+			}
+
+			pCtx->isRootElemDone = true;
+		}
+		else
+		{
+			status = osXml_parseElem(pBuf, pElemInfo, pStateInfo);
+	    	if(status != OS_STATUS_OK)
+    		{
+        		goto EXIT;
+    		}
+		}
 	}
 
 EXIT:
-    osList_delete(&stateInfo.xsdElemPointerList);
-	osList_delete(&stateInfo.gNSList);
-    if(pElemInfo)
-    {
-        osfree(pElemInfo);
-    }
-    return status;
-} //osXml_parse()
+	osXmlTagDesc_reset(&tagDesc);
+	return status;
+}
+
+
+/* feed the next piece of a xml document.  The callbacks of the elements that are completed by this piece are called before
+ * this function returns.  The piece can be reused by the caller after the function returns.
+ * pCtx:   IN, the context created by osXml_parseFeedStart()
+ * pChunk: IN, the next piece of the xml document, can be as small as one byte
+ */
+osStatus_e osXml_parseFeed(osXmlParseCtx_t* pCtx, const osPointerLen_t* pChunk)
+{
+	if(!pCtx || !pChunk)
+	{
+		logError("null pointer, pCtx=%p, pChunk=%p.", pCtx, pChunk);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pCtx->status != OS_STATUS_OK)
+	{
+		return pCtx->status;
+	}
+
+	//if nothing is pending, parse the piece in place, otherwise, join the piece with the pending bytes
+	osMBuf_t chunkBuf = {(uint8_t*)pChunk->p, pChunk->l, 0, pChunk->l};
+	osMBuf_t* pBuf = &chunkBuf;
+	if(pCtx->pPendBuf->end)
+	{
+		pCtx->pPendBuf->pos = pCtx->pPendBuf->end;
+		if(osMBuf_writeBuf(pCtx->pPendBuf, (const uint8_t*)pChunk->p, pChunk->l, true) != 0)
+		{
+			logError("fails to osMBuf_writeBuf for a piece of %ld bytes.", pChunk->l);
+			pCtx->status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			return pCtx->status;
+		}
+		pCtx->pPendBuf->pos = 0;
+		pBuf = pCtx->pPendBuf;
+	}
+
+	pCtx->status = osXml_feedProcess(pCtx, pBuf);
+	if(pCtx->status != OS_STATUS_OK)
+	{
+		return pCtx->status;
+	}
+
+	//keep the bytes that are not consumed, and rebase the positions that refer them
+	size_t consumed = pBuf->pos;
+	size_t remaining = pBuf->end - pBuf->pos;
+	if(pBuf == pCtx->pPendBuf)
+	{
+		memmove(pBuf->buf, &pBuf->buf[consumed], remaining);
+		pBuf->end = remaining;
+	}
+	else if(remaining)
+	{
+		pCtx->pPendBuf->pos = 0;
+		if(osMBuf_writeBuf(pCtx->pPendBuf, &pBuf->buf[consumed], remaining, true) != 0)
+		{
+			logError("fails to osMBuf_writeBuf for %ld pending bytes.", remaining);
+			pCtx->status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			return pCtx->status;
+		}
+	}
+	pCtx->pPendBuf->pos = 0;
+
+	pCtx->scanPos = pCtx->scanPos >= consumed ? pCtx->scanPos - consumed : 0;
+	osXmlTagPosInfo_t* pTagPosInfo = &pCtx->stateInfo.tagPosInfo;
+	pTagPosInfo->openTagEndPos = pTagPosInfo->openTagEndPos >= consumed ? pTagPosInfo->openTagEndPos - consumed : 0;
+
+	return OS_STATUS_OK;
+}
+
+
+/* finish a incremental parse and free pCtx.  Returns error if any feed failed or the document is not complete */
+osStatus_e osXml_parseFeedEnd(osXmlParseCtx_t* pCtx)
+{
+	if(!pCtx)
+	{
+		logError("null pointer, pCtx.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	osStatus_e status = pCtx->status;
+	if(status == OS_STATUS_OK && !pCtx->stateInfo.isXmlParseDone)
+	{
+		logError("the xml document is not complete, %ld bytes are pending.", pCtx->pPendBuf->end);
+		status = OS_ERROR_INVALID_VALUE;
+	}
+
+	osfree(pCtx);
+	return status;
+}
 
 
 /* process the root element. find the xmlns alias list, and the corresponding xsd rootElem */
 static osStatus_e osXml_parseRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo)
 {
 	osStatus_e status = OS_STATUS_OK;
-    osList_t noXmlnsAttrList={};
+    osVec_t noXmlnsAttrList={};
 
 	osXsd_elemPointer_t* pXsdPointer = oszalloc(sizeof(osXsd_elemPointer_t), osXsd_elemPointer_cleanup);
     pXsdPointer->pParentXsdPointer = NULL;
@@ -315,64 +846,50 @@ static osStatus_e osXml_parseRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo,
     osXml_singleDelimitParse(&pElemInfo->tag, ':', &rootAlias, &rootElemName);
 
     //get the xmlns alias and attribute info based the parsed element tag (pElemInfo)
-    status = osXml_getNsInfo(&pElemInfo->attrNVList, &pXsdPointer->pXmlnsInfo, &noXmlnsAttrList, &pStateInfo->gNSList);
+    pXsdPointer->nsScope = (osXml_nsScope_t){0, -1};
+    status = osXml_getNsInfo(&pElemInfo->attrNVList, &pStateInfo->nsStack, &pXsdPointer->nsScope, &noXmlnsAttrList);
     if(status != OS_STATUS_OK)
     {
     	logError("fails to osXml_getNsInfo() for element(%r).", &pElemInfo->tag);
         goto EXIT;
     }
 
-    //sanity check the rootAlias and pXsdPointer->pXmlnsInfo
-    if(osList_getCount(&pXsdPointer->pXmlnsInfo->nsAliasList))
+    //sanity check the rootAlias and pXsdPointer->nsScope
+    osXml_nsDecl_t* pRootDecl = NULL;
+    if(rootAlias.l)
     {
-    	//if rootAlias exists, needs to match one in the pXsdPointer->pXmlnsInfo->nsAliasList
-        if(rootAlias.l)
-        {
-        	if(!osXml_isAliasExist(&rootAlias, &pXsdPointer->pXmlnsInfo->nsAliasList, &pRootNS))
-            {
-            	logError("rootAlias(%r) is not defined.", &rootAlias);
-                status = OS_ERROR_INVALID_VALUE;
-                goto EXIT;
-            }
-        }
-        else
-        {
-        	//the default NS does not exist, use the input xsd as the default one
-            if(!pXsdPointer->pXmlnsInfo->defaultNS.l)
-            {
-            	pXsdPointer->pXmlnsInfo->defaultNS = *pStateInfo->xsdName;  //take the input xsd as the default xsd
-                pXsdPointer->pXmlnsInfo->isDefaultNSXsdName = true;
-            }
-        }
-    }
-    else
-    {
-    	if(rootAlias.l)
+    	//if rootAlias exists, needs to match one declared in the root element
+    	pRootDecl = osXml_getNsDecl(&pStateInfo->nsStack, &pXsdPointer->nsScope, &rootAlias);
+        if(!pRootDecl)
         {
         	logError("rootAlias(%r) is not defined.", &rootAlias);
             status = OS_ERROR_INVALID_VALUE;
             goto EXIT;
         }
-        else
+    }
+    else if(pXsdPointer->nsScope.defaultIdx < 0)
+    {
+    	//the default NS does not exist, use the input xsd as the default one
+        osPointerLen_t noAlias = {};
+        pRootDecl = osXml_pushNsDecl(&pStateInfo->nsStack, &pXsdPointer->nsScope, &noAlias, pStateInfo->xsdName);
+        if(!pRootDecl)
         {
-        	//if there is no xmlns info, create a default one using the input xsdName
-            pXsdPointer->pXmlnsInfo->defaultNS = *pStateInfo->xsdName;  //take the input xsd as the default xsd
-            pXsdPointer->pXmlnsInfo->isDefaultNSXsdName = true;
+        	status = OS_ERROR_INVALID_VALUE;
+            goto EXIT;
         }
+        pRootDecl->isXsdName = true;
     }
-
-    if(!pRootNS)
+    else
     {
-    	pRootNS = &pXsdPointer->pXmlnsInfo->defaultNS;
+    	pRootDecl = &pStateInfo->nsStack.decl[pXsdPointer->nsScope.defaultIdx];
     }
 
+    pRootNS = &pRootDecl->ns;
 	mdebug(LM_XMLP, "rootNS=%r", pRootNS);
-//    //save the nsInfoList in the global list for the purpose of memory free when the parse is done
-//    osList_append(&pStateInfo->gNSList, pXsdPointer->pXmlnsInfo);
-    pStateInfo->pCurXmlInfo = pXsdPointer->pXmlnsInfo;
+    pStateInfo->nsStack.cur = pXsdPointer->nsScope;
 
     //now get the rootElem
-    pXsdPointer->pCurElem = osXsd_getNSRootElem(pRootNS, pXsdPointer->pXmlnsInfo->isDefaultNSXsdName, &pElemInfo->tag);
+    pXsdPointer->pCurElem = osXsd_getNSRootElem(pRootNS, pRootDecl->isXsdName, &pElemInfo->tag);
     pStateInfo->anyElemStateInfo.pXsdRootElem = pXsdPointer->pCurElem;
     if(!pXsdPointer->pCurElem)
     {
@@ -397,13 +914,13 @@ static osStatus_e osXml_parseRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo,
     if(pStateInfo->callbackInfo->isAllowNoLeaf && (!osXml_isXsdElemSimpleType(pXsdPointer->pCurElem) || pXsdPointer->pCurElem->dataType == OS_XML_DATA_TYPE_ANY))
     {
     	//The data sanity check is performed by callback()
-        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &noXmlnsAttrList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &noXmlnsAttrList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
 
-    osList_append(&pStateInfo->xsdElemPointerList, pXsdPointer);
+    osList_appendEntry(&pStateInfo->xsdElemPointerList, pXsdPointer, stackLE);
 
 EXIT:
-	osList_clear(&noXmlnsAttrList);
+	osVec_clear(&noXmlnsAttrList);
     return status;
 } //osXml_parseRootElem
 
@@ -440,7 +957,7 @@ static osStatus_e osXml_parseSOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
     osXsd_elemPointer_t* pXsdPointer = oszalloc(sizeof(osXsd_elemPointer_t), NULL);
     pXsdPointer->pParentXsdPointer = pParentXsdPointer;
     //each child xsdPointer inherent from parent.
-    pXsdPointer->pXmlnsInfo = pXsdPointer->pParentXsdPointer->pXmlnsInfo;
+    pXsdPointer->nsScope = pXsdPointer->pParentXsdPointer->nsScope;
 	pXsdPointer->pCurElem = pCurElem;
 
 	//check OS_XML_ELEMENT_DISP_TYPE_SEQUENCE case to make sure the element is ordered.  the maxOccurs will be checked later in this function.  the minOccurs will be checked in EOT function
@@ -585,11 +1102,11 @@ static osStatus_e osXml_parseSOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
     	if(pStateInfo->callbackInfo->isAllowNoLeaf)
     	{
         	//The data sanity check is performed by callback()
-        	status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        	status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     	}
 	}
 
-    osList_append(&pStateInfo->xsdElemPointerList, pXsdPointer);
+    osList_appendEntry(&pStateInfo->xsdElemPointerList, pXsdPointer, stackLE);
 
 EXIT:
     return status;
@@ -601,6 +1118,7 @@ EXIT:
 static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo)
 {
 	osStatus_e status = OS_STATUS_OK;
+	//pLE is embedded in the xsdPointer (pLE->data), freeing the xsdPointer frees pLE as well
 	osListElement_t* pLE = osList_popTail(&pStateInfo->xsdElemPointerList);
     if(!pLE)
     {
@@ -623,7 +1141,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
         if(!pParentCT)
         {
         	logError("Parent xsd element is not a Complex type.");
-            osListElement_delete(pLE);
+            osfree(pLE->data);
             status = OS_ERROR_INVALID_VALUE;
             goto EXIT;
         }
@@ -637,7 +1155,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
             if(!pXsdElem)
             {
               	logError("elemList idx(%d) does not have xsd element data, this shall never happen.", i);
-                osListElement_delete(pLE);
+                osfree(pLE->data);
                 goto EXIT;
             }
 
@@ -647,7 +1165,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
 				if(pXsdElem->pChoiceInfo->minOccurs > 0 && (!pXmlChoiceInfo || pXmlChoiceInfo->choiceElemCount < pXsdElem->pChoiceInfo->minOccurs))
         		{
             		logError("the choice block that contains element(%r) occurance(%d) is less than the minOccurs(%d).", &pXsdElem->elemName, pXmlChoiceInfo ? pXmlChoiceInfo->choiceElemCount : -888, pXsdElem->pChoiceInfo->minOccurs);
-					osListElement_delete(pLE);
+					osfree(pLE->data);
             		status = OS_ERROR_INVALID_VALUE;
             		goto EXIT;
 				}
@@ -657,7 +1175,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
 				if(pParentXsdPointer->assignedChildIdx[i].childCount < pXsdElem->minOccurs)
 				{
                     logError("the element(%r) occurance(%d) is less than the minOccurs(%d).", &pXsdElem->elemName, pParentXsdPointer->assignedChildIdx[i].childCount, pXsdElem->minOccurs);
-                    osListElement_delete(pLE);
+                    osfree(pLE->data);
                     status = OS_ERROR_INVALID_VALUE;
                     goto EXIT;
                 }
@@ -672,7 +1190,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
                   	status = osXsd_browseNode(pXsdElem, pStateInfo->callbackInfo);
                     if(status != OS_STATUS_OK)
                     {
-                      	osListElement_delete(pLE);
+                      	osfree(pLE->data);
                         goto EXIT;
                     }
                 }
@@ -682,11 +1200,11 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
         pStateInfo->pParentXsdPointer = ((osXsd_elemPointer_t*)pLE->data)->pParentXsdPointer;
         if(pStateInfo->pParentXsdPointer)
         {
-            //pCurXmlInfo is always updated after processing </element> (in case there is pParentXsdPointer change)
-            //pCurXmlInfo will also be updated when <element> is processed and nsAlias may change
-            //note pCurXmlInfo is introduced to simplify the setting of nsalias in osXml_xmlCallback().  it is also the reason it is
+            //nsStack.cur is always updated after processing </element> (in case there is pParentXsdPointer change)
+            //nsStack.cur will also be updated when <element> is processed and nsAlias may change
+            //note nsStack.cur is introduced to simplify the setting of nsalias in osXml_xmlCallback().  it is also the reason it is
             //reassigned at the end of processing </element>
-            pStateInfo->pCurXmlInfo = pStateInfo->pParentXsdPointer->pXmlnsInfo;
+            pStateInfo->nsStack.cur = pStateInfo->pParentXsdPointer->nsScope;
 
             //if !pParentXsdPointer, meaning the end of schema, that will be processed a little bit later
      	}
@@ -695,7 +1213,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
     if(osPL_cmp(&pElemInfo->tag, &pCurXsdElem->elemName) != 0)
     {
         logError("element(%r) close does not match open(%r), pos=%ld.", &pElemInfo->tag, &pCurXsdElem->elemName, pBuf->pos);
-        osListElement_delete(pLE);
+        osfree(pLE->data);
         status = OS_ERROR_INVALID_VALUE;
         goto EXIT;
     }
@@ -704,18 +1222,18 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
     if(osXml_isXsdElemSimpleType(pCurXsdElem))
     {
 		osPointerLen_t value = {&pBuf->buf[pStateInfo->tagPosInfo.openTagEndPos], pStateInfo->tagPosInfo.tagStartPos - pStateInfo->tagPosInfo.openTagEndPos}; 
-        status = osXml_xmlCallback(pCurXsdElem, &value, NULL, true, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pCurXsdElem, &value, NULL, true, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
 	else if(pStateInfo->callbackInfo->isAllowNoLeaf)
 	{
 		//The data sanity check is performed by callback()
-		status = osXml_xmlCallback(pCurXsdElem, NULL, NULL, true, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+		status = osXml_xmlCallback(pCurXsdElem, NULL, NULL, true, pStateInfo->callbackInfo, &pStateInfo->nsStack);
 	}
 
     if(status != OS_STATUS_OK)
     {
         logError("fails to validate xml for element(%r).", &pCurXsdElem->elemName);
-        osListElement_delete(pLE);
+        osfree(pLE->data);
         goto EXIT;
     }
 
@@ -726,7 +1244,7 @@ static osStatus_e osXml_parseEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
         pStateInfo->isXmlParseDone = true;
     }
 
-    osListElement_delete(pLE);
+    osfree(pLE->data);
 
 EXIT:
     return status;
@@ -752,7 +1270,7 @@ static osStatus_e osXml_parseDOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXm
 	//to-do, this may need to be modified to follow the same as in SOT, to chek if there is gap for OS_XML_ELEMENT_DISP_TYPE_SEQUENCE case 
     ++pStateInfo->pParentXsdPointer->assignedChildIdx[listIdx].childCount;
 
-    status = osXml_xmlCallback(pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+    status = osXml_xmlCallback(pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
 
 EXIT:
     return status;
@@ -763,7 +1281,7 @@ EXIT:
 static osStatus_e osXml_parseAnyRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInfo, osXml_parseStateInfo_t* pStateInfo)
 {
 	osStatus_e status = OS_STATUS_OK;
-    osList_t noXmlnsAttrList={};
+    osVec_t noXmlnsAttrList={};
 
     mdebug(LM_XMLP, "case <%r>, pParentXsdPointer=%p, pParentXsdPointer.elem=%r", &pElemInfo->tag, pStateInfo->pParentXsdPointer, &pStateInfo->pParentXsdPointer->pCurElem->elemName);
 
@@ -779,35 +1297,27 @@ static osStatus_e osXml_parseAnyRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemIn
     osXsd_elemPointer_t* pXsdPointer = oszalloc(sizeof(osXsd_elemPointer_t), NULL);
     pXsdPointer->pParentXsdPointer = pStateInfo->pParentXsdPointer;
     //each child xsdPointer inherent from parent.
-    pXsdPointer->pXmlnsInfo = pXsdPointer->pParentXsdPointer->pXmlnsInfo;
+    pXsdPointer->nsScope = pXsdPointer->pParentXsdPointer->nsScope;
 
 	//for the root <xs:any> element, needs to rebuild xmlns alias list
 	osPointerLen_t rootAlias, rootElemName;
 	osXml_singleDelimitParse(&pElemInfo->tag, ':', &rootAlias, &rootElemName);
 
-	//get the xmlns alias
-	osXml_nsInfo_t* pnsInfo = NULL;
-	status = osXml_getNsInfo(&pElemInfo->attrNVList, &pnsInfo, &noXmlnsAttrList, &pStateInfo->gNSList);
+	//get the xmlns alias, the new declarations are added to the scope inherited from the parent, and override the parent ones with the same alias
+	status = osXml_getNsInfo(&pElemInfo->attrNVList, &pStateInfo->nsStack, &pXsdPointer->nsScope, &noXmlnsAttrList);
 	if(status != OS_STATUS_OK)
 	{
 		logError("fails to osXml_getNsInfo() for element(%r).", &pElemInfo->tag);
 		goto EXIT;
 	}
 
-	//combine the parent nsInfo with new one
-	if(pnsInfo)
-	{
-		osXml_updateNsInfo(pnsInfo, pXsdPointer->pXmlnsInfo);
-	}
-
-	/* sanity check the rootAlias and pXsdPointer->pXmlnsInfo.  2 cases: rootAlias(Exist, no exist), 
-	pXsdPointer->pXmlnsInfo always exists (in the root elem processing, if xmlns does not exists, xsd name 
-	will be used to create a pXsdPointer->pXmlnsInfo).
-	if rootAlias exists, needs to match one in the pXsdPointer->pXmlnsInfo->nsAliasList
+	/* sanity check the rootAlias and pXsdPointer->nsScope.  2 cases: rootAlias(Exist, no exist).
+	if rootAlias exists, needs to match one declared in scope, otherwise, a default ns must be in scope (in the root elem
+	processing, if xmlns does not exists, xsd name is used as the default ns)
 	*/
 	if(rootAlias.l)
 	{
-		if(!osXml_isAliasExist(&rootAlias, &pXsdPointer->pXmlnsInfo->nsAliasList, NULL))
+		if(!osXml_getNsDecl(&pStateInfo->nsStack, &pXsdPointer->nsScope, &rootAlias))
 		{
 			logError("rootAlias(%r) is not defined.", &rootAlias);
 			status = OS_ERROR_INVALID_VALUE;
@@ -817,7 +1327,7 @@ static osStatus_e osXml_parseAnyRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemIn
 	else
 	{
 		//the default NS does not exist in the new element.
-		if(!pXsdPointer->pXmlnsInfo->defaultNS.l)
+		if(pXsdPointer->nsScope.defaultIdx < 0)
 		{
 			logError("defaultNS does not exist in the new element(%r), neither does the element has alias.", &pElemInfo->tag);
 			status = OS_ERROR_INVALID_VALUE;
@@ -825,12 +1335,7 @@ static osStatus_e osXml_parseAnyRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemIn
 		}
 	}
 
-//	//save the nsInfoList in the global list for the purpose of memory free when the parse is done
-	if(pnsInfo)
-	{
-//		osList_append(&pStateInfo->gNSList, pXsdPointer->pXmlnsInfo);
-		pStateInfo->pCurXmlInfo = pXsdPointer->pXmlnsInfo;
-	}
+	pStateInfo->nsStack.cur = pXsdPointer->nsScope;
 
 	//no need to get rootElem as we do not check xml elem against a xsd for <xs:any>.  In the future, we may check if processContents="strict" or "lax"
 	pXsdPointer->pCurElem = osXsd_createAnyElem(&pElemInfo->tag, true); //true here indicate it is the root anyElem, isRootAnyElem = true
@@ -849,13 +1354,13 @@ static osStatus_e osXml_parseAnyRootElem(osMBuf_t* pBuf, osXmlTagInfo_t* pElemIn
     if(pStateInfo->callbackInfo->isAllowNoLeaf)
     {
         //The data sanity check is performed by callback()
-        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &noXmlnsAttrList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &noXmlnsAttrList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
 
-    osList_append(&pStateInfo->xsdElemPointerList, pXsdPointer);
+    osList_appendEntry(&pStateInfo->xsdElemPointerList, pXsdPointer, stackLE);
 
 EXIT:
-	osList_clear(&noXmlnsAttrList);
+	osVec_clear(&noXmlnsAttrList);
     return status;
 }
 
@@ -877,7 +1382,7 @@ static osStatus_e osXml_parseAnyElemSOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
     mdebug(LM_XMLP, "case <%r>, pParentXsdPointer=%p, pParentXsdPointer.elem=%r", &pElemInfo->tag, pXsdPointer->pParentXsdPointer, &pXsdPointer->pParentXsdPointer->pCurElem->elemName);
 
 	//each child xsdPointer inherent from parent.
-	pXsdPointer->pXmlnsInfo = pXsdPointer->pParentXsdPointer->pXmlnsInfo;
+	pXsdPointer->nsScope = pXsdPointer->pParentXsdPointer->nsScope;
 
 	pXsdPointer->pCurElem = osXsd_createAnyElem(&pElemInfo->tag, false);
 
@@ -897,10 +1402,10 @@ static osStatus_e osXml_parseAnyElemSOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
     if(pStateInfo->callbackInfo->isAllowNoLeaf)
     {
         //The data sanity check is performed by callback()
-        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pXsdPointer->pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
 
-    osList_append(&pStateInfo->xsdElemPointerList, pXsdPointer);
+    osList_appendEntry(&pStateInfo->xsdElemPointerList, pXsdPointer, stackLE);
 
 EXIT:
     return status;
@@ -922,7 +1427,7 @@ static osStatus_e osXml_parseAnyElemDOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
 	osXsdElement_t* pCurElem = osXsd_createAnyElem(&pElemInfo->tag, false);
 	pCurElem->anyElem.xmlAnyElem.isLeaf = false;
 
-    status = osXml_xmlCallback(pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+    status = osXml_xmlCallback(pCurElem, NULL, &pElemInfo->attrNVList, false, pStateInfo->callbackInfo, &pStateInfo->nsStack);
 
 EXIT:
     return status;
@@ -934,6 +1439,7 @@ static osStatus_e osXml_parseAnyElemEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
 {
     osStatus_e status = OS_STATUS_OK;
 
+	//pLE is embedded in the xsdPointer (pLE->data), freeing the xsdPointer frees pLE as well
 	osListElement_t* pLE = osList_popTail(&pStateInfo->xsdElemPointerList);
     if(!pLE)
     {
@@ -948,7 +1454,7 @@ static osStatus_e osXml_parseAnyElemEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
     if(osPL_cmp(&pElemInfo->tag, &pCurXsdElem->elemName) != 0)
     {
         logError("element(%r) close does not match open(%r), pos=%ld.", &pElemInfo->tag, &pCurXsdElem->elemName, pBuf->pos);
-        osListElement_delete(pLE);
+        osfree(pLE->data);
         status = OS_ERROR_INVALID_VALUE;
         goto EXIT;
     }
@@ -957,12 +1463,12 @@ static osStatus_e osXml_parseAnyElemEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
     if(pCurXsdElem->anyElem.xmlAnyElem.isLeaf)
     {
         osPointerLen_t value = {&pBuf->buf[pStateInfo->tagPosInfo.openTagEndPos], pStateInfo->tagPosInfo.tagStartPos - pStateInfo->tagPosInfo.openTagEndPos};
-        status = osXml_xmlCallback(pCurXsdElem, &value, NULL, true, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pCurXsdElem, &value, NULL, true, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
     else if(pStateInfo->callbackInfo->isAllowNoLeaf)
     {
         //The data sanity check is performed by callback()
-        status = osXml_xmlCallback(pCurXsdElem, NULL, NULL, true, pStateInfo->callbackInfo, pStateInfo->pCurXmlInfo);
+        status = osXml_xmlCallback(pCurXsdElem, NULL, NULL, true, pStateInfo->callbackInfo, &pStateInfo->nsStack);
     }
 
     //for any element, it is not part of xsd, and was dynamically allocated, need to free when it is not needed any more
@@ -971,13 +1477,15 @@ static osStatus_e osXml_parseAnyElemEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
     if(pCurXsdElem->anyElem.xmlAnyElem.isRootAnyElem)
     {
         pStateInfo->isProcessAnyElem = false;
+        //the xmlns declared in the root <xs:any> element go out of scope
+        pStateInfo->nsStack.cur = pStateInfo->pParentXsdPointer->nsScope;
     }
     osfree(pCurXsdElem);
 
     if(status != OS_STATUS_OK)
     {
         logError("fails to validate xml for element(%r).", &pCurXsdElem->elemName);
-        osListElement_delete(pLE);
+        osfree(pLE->data);
         goto EXIT;
     }
 
@@ -988,7 +1496,7 @@ static osStatus_e osXml_parseAnyElemEOT(osMBuf_t* pBuf, osXmlTagInfo_t* pElemInf
         pStateInfo->isXmlParseDone = true;
     }
 
-    osListElement_delete(pLE);
+    osfree(pLE->data);
 
 EXIT:
     return status;
@@ -1060,7 +1568,7 @@ osStatus_e osXml_getLeafValue(char* fileFolder, char* xsdFileName, char* xmlFile
         goto EXIT;
     }
 
-    xsdMBuf = osMBuf_readFile(xsdFile, 8000);
+    xsdMBuf = osMBuf_mapFile(xsdFile);
     if(!xsdMBuf)
     {
         logError("read xsdMBuf fails, xsdFile=%s", xsdFile);
@@ -1068,8 +1576,7 @@ osStatus_e osXml_getLeafValue(char* fileFolder, char* xsdFileName, char* xmlFile
         goto EXIT;
     }
 
-    //8000 is the initial mBuf size.  If the reading needs more than 8000, the function will realloc new memory
-    xmlBuf = osMBuf_readFile(xmlFile, 8000);
+    xmlBuf = osMBuf_mapFile(xmlFile);
     if(!xmlBuf)
     {
         logError("read xmlBuf fails.");
@@ -1147,7 +1654,7 @@ EXIT:
  * a default value in xsd only when in xml instance, <element /> is used.  So it shall not be a problem to restrict the ns alias use
  * for isUseDefault=true.  Just need to be careful what xsd is used and to include ns alias in osXmlData_t.dataname for isUseDefault=true.
  */
-osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, const osList_t* pNoXmlnsAttrList, bool isEOT, osXmlDataCallbackInfo_t* callbackInfo, void* pCurXmlInfo)
+osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, const osVec_t* pNoXmlnsAttrList, bool isEOT, osXmlDataCallbackInfo_t* callbackInfo, void* pCurXmlInfo)
 {
 	osStatus_e status = OS_STATUS_OK;
 	bool isLeaf = true;
@@ -1159,6 +1666,9 @@ osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, co
 		return OS_ERROR_NULL_POINTER;
 	}
 
+	//the xsd element is shared by all parses and is not modified, a <xs:any> leaf value is reported as a xs:string
+	osXmlDataType_e leafDataType = pElement->dataType == OS_XML_DATA_TYPE_ANY ? OS_XML_DATA_TYPE_XS_STRING : pElement->dataType;
+
 	mdebug(LM_XMLP, "for element(%r), value=%r, isEOT=%d.", &pElement->elemName, value, isEOT);
  
 	//leaf related check
@@ -1197,12 +1707,7 @@ osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, co
 
 	    if(isLeaf && value)
         {
-			if(pElement->dataType == OS_XML_DATA_TYPE_ANY)
-            {
-                pElement->dataType = OS_XML_DATA_TYPE_XS_STRING;
-            }
-                
-			switch(pElement->dataType)
+			switch(leafDataType)
             {
                 case OS_XML_DATA_TYPE_XS_BOOLEAN:
                 case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
@@ -1210,13 +1715,13 @@ osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, co
                 case OS_XML_DATA_TYPE_XS_INTEGER:
                 case OS_XML_DATA_TYPE_XS_LONG:
                 case OS_XML_DATA_TYPE_XS_STRING:
-                    status = osXmlXSType_convertData(&pElement->elemName, value, pElement->dataType, &xmlData);
+                    status = osXmlXSType_convertData(&pElement->elemName, value, leafDataType, &xmlData);
                     break;
                 case OS_XML_DATA_TYPE_SIMPLE:
                     status = osXmlSimpleType_convertData(pElement->pSimple, value, &xmlData);
                     break;
                 default:
-                    logError("unexpected data type(%d) for element(%r).", pElement->dataType, &pElement->elemName);
+                    logError("unexpected data type(%d) for element(%r).", leafDataType, &pElement->elemName);
                     return OS_ERROR_INVALID_VALUE;
                     break;
             }
@@ -1276,21 +1781,14 @@ osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, co
 
 			if(isLeaf && value)
 			{
-				if(pElement->dataType == OS_XML_DATA_TYPE_ANY)
+				//check the dataType
+				if(pElement->dataType != OS_XML_DATA_TYPE_ANY && pElement->dataType != callbackInfo->xmlData[i].dataType)
 				{
-					pElement->dataType = OS_XML_DATA_TYPE_XS_STRING;
-				}
-				else
-				{
-					//check the dataType
-            		if(pElement->dataType != callbackInfo->xmlData[i].dataType)
-            		{
-                		logError("the element(%r) data type=%d, but the user expects data type=%d", &pElement->elemName, pElement->dataType, callbackInfo->xmlData[i].dataType);
-                		return OS_ERROR_INVALID_VALUE;
-            		}
+					logError("the element(%r) data type=%d, but the user expects data type=%d", &pElement->elemName, pElement->dataType, callbackInfo->xmlData[i].dataType);
+					return OS_ERROR_INVALID_VALUE;
 				}
 
-    			switch(pElement->dataType)
+    			switch(leafDataType)
     			{
         			case OS_XML_DATA_TYPE_XS_BOOLEAN:
         			case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
@@ -1298,13 +1796,13 @@ osStatus_e osXml_xmlCallback(osXsdElement_t* pElement, osPointerLen_t* value, co
         			case OS_XML_DATA_TYPE_XS_INTEGER:
         			case OS_XML_DATA_TYPE_XS_LONG:
         			case OS_XML_DATA_TYPE_XS_STRING:
-                		status = osXmlXSType_convertData(&pElement->elemName, value, pElement->dataType, &callbackInfo->xmlData[i]);
+                		status = osXmlXSType_convertData(&pElement->elemName, value, leafDataType, &callbackInfo->xmlData[i]);
             			break;
         			case OS_XML_DATA_TYPE_SIMPLE: 
 						status = osXmlSimpleType_convertData(pElement->pSimple, value, &callbackInfo->xmlData[i]);
 						break;
 					default: 
-                    	logError("unexpected data type(%d) for element(%r).", pElement->dataType, &pElement->elemName);
+                    	logError("unexpected data type(%d) for element(%r).", leafDataType, &pElement->elemName);
                     	return OS_ERROR_INVALID_VALUE;
                     	break;
             	}
@@ -1374,10 +1872,25 @@ static osXsdElement_t* osXml_getChildXsdElemByTag(osPointerLen_t* pTag, osXsd_el
 	}
     osListElement_t* pLE = pCT->elemList.head;
     *listIdx = -1;
+
+    //all xsd element names are interned, a tag that is not interned can not match any of them
+    osAtom_t tagAtom = osAtom_find(pTag, false);
+    if(tagAtom == OS_ATOM_NONE)
+    {
+        goto EXIT;
+    }
+
+    //the child index is built when the xsd tree is linked, walk the list only if the index is not available
+    if(pCT->pChildIndex)
+    {
+        pChildXsdElem = osXsd_atomIndex_get(pCT->pChildIndex, tagAtom, listIdx);
+        goto EXIT;
+    }
+
     while(pLE)
     {
 		(*listIdx)++;
-        if(osPL_cmp(pTag, &((osXsdElement_t*)pLE->data)->elemName) == 0)
+        if(osAtom_isPLEqual(tagAtom, pTag, ((osXsdElement_t*)pLE->data)->elemNameAtom, &((osXsdElement_t*)pLE->data)->elemName))
         {
             pChildXsdElem = pLE->data;
             goto EXIT;
@@ -1445,159 +1958,87 @@ EXIT:
 }
 
 
-static osStatus_e osXml_getNsInfo(osList_t* pAttrNVList, osXml_nsInfo_t** ppNsInfo, osList_t* pNoXmlnsAttrList, osList_t* pgNSList)
+/* push the xmlns declarations in pAttrNVList to pNsStack after pScope, pScope is extended to cover the new declarations.
+ * pScope: INOUT, in, the scope inherited from the parent element, out, the scope of the element
+ * pNoXmlnsAttrList: OUT, the attributes that are not xmlns declaration, may be NULL
+ */
+static osStatus_e osXml_getNsInfo(osVec_t* pAttrNVList, osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osVec_t* pNoXmlnsAttrList)
 {
-	osStatus_e status = OS_STATUS_OK;
-	
-	if(!pAttrNVList || !ppNsInfo || !pgNSList)
+	if(!pAttrNVList || !pNsStack || !pScope)
 	{
-		logError("null pointer, pAttrNVList=%p, ppNsInfo=%p, pgNSList=%p.", pAttrNVList, ppNsInfo, pgNSList);
+		logError("null pointer, pAttrNVList=%p, pNsStack=%p, pScope=%p.", pAttrNVList, pNsStack, pScope);
 		return OS_ERROR_NULL_POINTER;
 	}
 
-	*ppNsInfo = oszalloc(sizeof(osXml_nsInfo_t), osXmlNsInfo_cleanup);
-
+	uint16_t parentDeclNum = pScope->declNum;
 	osPointerLen_t nsAlias;
-	osXsd_nsAliasInfo_t* pnsAlias;
-	osListElement_t* pLE = pAttrNVList->head;
-	while(pLE)
+	for(uint32_t i=0; i<osVec_getCount(pAttrNVList); i++)
 	{
-        if(osXml_singleDelimitMatch("xmlns", 5, ':', &((osXmlNameValue_t*)pLE->data)->name, false, &nsAlias))
+        osXmlNameValue_t* pNV = osVec_get(pAttrNVList, i);
+        if(osXml_singleDelimitMatch("xmlns", 5, ':', &pNV->name, false, &nsAlias))
 		{
-			pnsAlias = oszalloc(sizeof(osXsd_nsAliasInfo_t), NULL);
-			pnsAlias->nsAlias = nsAlias;
-			pnsAlias->ns = ((osXmlNameValue_t*)pLE->data)->value;
-			if(!pnsAlias->nsAlias.l)
+			if(!nsAlias.l && pScope->defaultIdx >= parentDeclNum)
 			{
-				if((*ppNsInfo)->defaultNS.l)
-				{
-					logError("more than one default namespaces. The existing one(%r), the new one(%r).", &(*ppNsInfo)->defaultNS, &((osXmlNameValue_t*)pLE->data)->value);
-					osfree(pnsAlias);
-					status = OS_ERROR_INVALID_VALUE;
-					goto EXIT;
-				}
-
-				pnsAlias->nsUseLabel = -1;
-				(*ppNsInfo)->defaultNS = pnsAlias->ns;
+				logError("more than one default namespaces. The existing one(%r), the new one(%r).", &pNsStack->decl[pScope->defaultIdx].ns, &pNV->value);
+				return OS_ERROR_INVALID_VALUE;
 			}
 
-			osList_append(&(*ppNsInfo)->nsAliasList, pnsAlias);
-			//store each nsalias in pnsAlias so that it can be freed when the aprser is done.  Do nor want to store ppNsInfo, because in the course of xml parsing, multiple ppNsInfo may use the same pnsAlias.
-			osList_append(pgNSList, pnsAlias);
+			if(!osXml_pushNsDecl(pNsStack, pScope, &nsAlias, &pNV->value))
+			{
+				return OS_ERROR_INVALID_VALUE;
+			}
 		}
 		else if(pNoXmlnsAttrList)
 		{
-			//pNoXmlnsAttrList shall not outlive pAttrNVList, so no need to copy pLE->data, just use it
-			osList_append(pNoXmlnsAttrList, pLE->data);
+			//pNoXmlnsAttrList shall not outlive pAttrNVList, so no need to copy pNV, just use it
+			osVec_append(pNoXmlnsAttrList, pNV);
 		}
-
-		pLE = pLE->next;
-	}
-		
-	//it is possible a ns is default, at the same time is assigned a alias. pnsAlias->nsUseLabel=1 is for this case.  Here we do not check this case and do not combine 2 entries into 1, to save the check time.  i.e., pnsAlias->nsUseLabel will never be 1 when this function is used.	
-EXIT:
-	if(status != OS_STATUS_OK)
-	{
-		*ppNsInfo = osfree(*ppNsInfo);	
 	}
 
-	//also store ppNsInfo in pgNSList, as ppNsInfo will be pointed by each child element.
-	osList_append(pgNSList, *ppNsInfo);
-	return status;
+	return OS_STATUS_OK;
 }
 
 
-/* pNewNsInfo: 			 IN,  the new xmlns info from the element been parsing
- * pXsdPointerXmlnsInfo: INOUT, in, the existing parent xsdPointer nsInfo, out, combined/updated nsInfo for the element
- * 
- * The combined nsInfo will be a combination of the aprent nsInfo and the new gotten nsInfo.  If there is alias name overlap, 
- * the new one will override the parent one.  
- */ 
-static void osXml_updateNsInfo(osXml_nsInfo_t* pNewNsInfo, osXml_nsInfo_t* pXsdPointerXmlnsInfo)
+//add a xmlns declaration to the end of pScope, the slots after pScope belong to no active element and are reused
+static osXml_nsDecl_t* osXml_pushNsDecl(osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osPointerLen_t* pnsAlias, osPointerLen_t* pNS)
 {
-	if(!pNewNsInfo)
+	if(pScope->declNum >= OS_XML_NS_MAX_DECL)
 	{
-		return;
-	}
-
-	if(!pXsdPointerXmlnsInfo)
-	{
-		logError("null pointer, pXsdPointerXmlnsInfo.");
-		return;
-	}
-
-	//check if there is nsAlias overlap.  Bypass if pXsdPointerXmlnsInfo->nsAliasList has no entry
-	osListElement_t* pLE = osList_getCount(&pXsdPointerXmlnsInfo->nsAliasList) ? pNewNsInfo->nsAliasList.head : NULL;
-	while(pLE)
-	{
-		osListElement_t* pMatchLE = osXml_isAliasMatch(&pXsdPointerXmlnsInfo->nsAliasList, &((osXsd_nsAliasInfo_t*)pLE->data)->nsAlias);
-		if(pMatchLE)
-		{
-			osList_deleteElementAll(pMatchLE, true);
-		}
-
-		pLE = pLE->next;
-	}
-
-	if(pNewNsInfo->defaultNS.l)
-	{
-		pXsdPointerXmlnsInfo->isDefaultNSXsdName = false;
-		pXsdPointerXmlnsInfo->defaultNS = pNewNsInfo->defaultNS;
-	}
-
-	osList_combine(&pXsdPointerXmlnsInfo->nsAliasList, &pNewNsInfo->nsAliasList);
-}
-		
-
-static bool osXml_isAliasExist(osPointerLen_t* pRootAlias, osList_t* pAliasList, osPointerLen_t** ppRootNS)
-{
-	if(!pRootAlias || !pAliasList)
-	{
-		logError("null pointer, pRootAlias=%p, pAliasList=%p.", pRootAlias, pAliasList);
-		return false;
-	}
-
-	osListElement_t* pLE = pAliasList->head;
-	while(pLE)
-	{
-		if(osPL_cmp(&((osXsd_nsAliasInfo_t*)pLE->data)->nsAlias, pRootAlias) == 0)
-		{
-			if(ppRootNS)
-			{
-				*ppRootNS = &((osXsd_nsAliasInfo_t*)pLE->data)->ns;
-			}
-			return true;
-		}
-	
-		pLE = pLE->next;
+		logError("too many xmlns declarations in scope, the new one(%r=%r) exceeds OS_XML_NS_MAX_DECL(%d).", pnsAlias, pNS, OS_XML_NS_MAX_DECL);
+		return NULL;
 	}
 
-	if(ppRootNS)
+	osXml_nsDecl_t* pDecl = &pNsStack->decl[pScope->declNum];
+	pDecl->nsAlias = *pnsAlias;
+	pDecl->nsAliasAtom = pnsAlias->l ? osAtom_find(pnsAlias, false) : OS_ATOM_NONE;
+	pDecl->ns = *pNS;
+	pDecl->isXsdName = false;
+	if(!pnsAlias->l)
 	{
-		*ppRootNS = NULL;
+		pScope->defaultIdx = pScope->declNum;
 	}
 
-	return false;
+	pScope->declNum++;
+	return pDecl;
 }
 
 
-static osListElement_t* osXml_isAliasMatch(osList_t* nsAliasList, osPointerLen_t* pnsAlias)
+//find the declaration of a alias in pScope, the latest declaration wins
+static osXml_nsDecl_t* osXml_getNsDecl(osXml_nsStack_t* pNsStack, osXml_nsScope_t* pScope, osPointerLen_t* pnsAlias)
 {
-	if(!nsAliasList || !pnsAlias)
+	if(!pnsAlias->l)
 	{
-		logError("null pointer, nsAliasList=%p, pnsAlias=%p.", nsAliasList, pnsAlias);
-		return NULL;
+		return pScope->defaultIdx < 0 ? NULL : &pNsStack->decl[pScope->defaultIdx];
 	}
 
-	osListElement_t* pLE = nsAliasList->head;
-	while(pLE)
+	osAtom_t nsAliasAtom = osAtom_find(pnsAlias, false);
+	for(int i=pScope->declNum-1; i>=0; i--)
 	{
-		if(osPL_cmp(&((osXsd_nsAliasInfo_t*)pLE->data)->nsAlias, pnsAlias) == 0)	
+		osXml_nsDecl_t* pDecl = &pNsStack->decl[i];
+		if(pDecl->nsAlias.l && osAtom_isPLEqual(pDecl->nsAliasAtom, &pDecl->nsAlias, nsAliasAtom, pnsAlias))
 		{
-			return pLE;
+			return pDecl;
 		}
-
-		pLE = pLE->next;
 	}
 
 	return NULL;
@@ -1627,19 +2068,6 @@ static osXml_choiceInfo_t* osXml_getChoiceInfo(osXsd_elemPointer_t* pParentXsdPo
 }
 
 
-static void osXmlNsInfo_cleanup(void* data)
-{
-	if(!data)
-	{
-		return;
-	}
-
-	osXml_nsInfo_t* pnsInfo = data;
-	//do not use osList_delete(), as nsAlias is seperately stored in gNSList
-	osList_clear(&pnsInfo->nsAliasList);
-}
-
-
 static void osXsd_elemPointer_cleanup(void* data)
 {
     if(!data)
@@ -1650,5 +2078,5 @@ static void osXsd_elemPointer_cleanup(void* data)
 	osXsd_elemPointer_t* pElemPointer = data;
 	osList_delete(&pElemPointer->xmlChoiceList);
 
-	//this data structure only refers pXmlnsInfo, no need to free it.  Instead, the object that pXmlnsInfo points to is appended in a gNSList and will be freed over there 
+	//nsScope refers the slots of osXml_parseStateInfo_t.nsStack, nothing to free
 }
@@ -23,8 +23,8 @@
 
 
 
-static osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplexType_t* pCtInfo);
-static osStatus_e osXsdChoice_getAttrInfo(osList_t* pAttrList, osXsd_choiceInfo_t* pChoiceInfo);
+static osStatus_e osXsdComplexType_getAttrInfo(osVec_t* pAttrList, osXmlComplexType_t* pCtInfo);
+static osStatus_e osXsdChoice_getAttrInfo(osVec_t* pAttrList, osXsd_choiceInfo_t* pChoiceInfo);
 
 
 
@@ -164,7 +164,7 @@ osXmlComplexType_t* osXsdComplexType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pC
         goto EXIT;
     }
 
-    pCtInfo = osmalloc(sizeof(osXmlComplexType_t), osXmlComplexType_cleanup);
+    pCtInfo = oszalloc(sizeof(osXmlComplexType_t), osXmlComplexType_cleanup);
     osXsdComplexType_getAttrInfo(&pCtTagInfo->attrNVList, pCtInfo);
 
     while(pXmlBuf->pos < pXmlBuf->end)
@@ -201,7 +201,7 @@ osXmlComplexType_t* osXsdComplexType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pC
                     if(pParentElem)
                     {
                     	//if the complexType is embedded inside a element, directly assign the complexType to the parent element
-                        if(osPL_cmp(&pParentElem->elemTypeName, &pCtInfo->typeName) == 0 || pParentElem->elemTypeName.l == 0)
+                        if(osAtom_isPLEqual(pParentElem->elemTypeNameAtom, &pParentElem->elemTypeName, pCtInfo->typeNameAtom, &pCtInfo->typeName) || pParentElem->elemTypeName.l == 0)
                         {
                         	pParentElem->dataType = OS_XML_DATA_TYPE_COMPLEX;
                             pParentElem->pComplex = pCtInfo;
@@ -276,7 +276,7 @@ osXmlComplexType_t* osXsdComplexType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pC
 				}
 
 				//reuse the pTagInfo allocated during <xs:element xxx> parsing
-                osList_delete(&pTagInfo->attrNVList);
+                osVec_delete(&pTagInfo->attrNVList);
                 pTagInfo->isPElement = true;
                 pTagInfo->pElement = pElem;
 
@@ -312,7 +312,7 @@ osXmlComplexType_t* osXsdComplexType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pC
                 }
 
 				//reuse the pTagInfo allocated during <xs:element xxx> parsing
-                osList_delete(&pTagInfo->attrNVList);
+                osVec_delete(&pTagInfo->attrNVList);
                 pTagInfo->isPElement = true;
                 pTagInfo->pElement = pElem;
 
@@ -419,10 +419,11 @@ void osXmlComplexType_cleanup(void* data)
 
 	osXmlComplexType_t* pCT = data;
 	osList_delete(&pCT->elemList);
+	pCT->pChildIndex = osfree(pCT->pChildIndex);
 }
 
 
-static osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplexType_t* pCtInfo)
+static osStatus_e osXsdComplexType_getAttrInfo(osVec_t* pAttrList, osXmlComplexType_t* pCtInfo)
 {
     osStatus_e status = OS_STATUS_OK;
     if(!pCtInfo || !pAttrList)
@@ -432,10 +433,9 @@ static osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplex
         goto EXIT;
     }
 
-    osListElement_t* pLE = pAttrList->head;
-    while(pLE)
+    for(uint32_t i=0; i<osVec_getCount(pAttrList); i++)
     {
-        osXmlNameValue_t* pNV = pLE->data;
+        osXmlNameValue_t* pNV = osVec_get(pAttrList, i);
         if(!pNV)
         {
             logError("pNV is NULL, this shall never happen.");
@@ -449,6 +449,7 @@ static osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplex
                 if(pNV->name.l == 4 && strncmp("name", pNV->name.p, pNV->name.l) == 0)
                 {
                     pCtInfo->typeName = pNV->value;
+                    pCtInfo->typeNameAtom = osAtom_intern(&pCtInfo->typeName, false);
                     isIgnored = false;
                 }
                 break;
@@ -479,8 +480,6 @@ static osStatus_e osXsdComplexType_getAttrInfo(osList_t* pAttrList, osXmlComplex
         {
             mlogInfo(LM_XMLP, "attribute(%r) is ignored.", &pNV->name);
         }
-
-        pLE = pLE->next;
     }
 
 EXIT:
@@ -488,7 +487,7 @@ EXIT:
 }
 
 
-static osStatus_e osXsdChoice_getAttrInfo(osList_t* pAttrList, osXsd_choiceInfo_t* pChoiceInfo)
+static osStatus_e osXsdChoice_getAttrInfo(osVec_t* pAttrList, osXsd_choiceInfo_t* pChoiceInfo)
 {
     osStatus_e status = OS_STATUS_OK;
     if(!pChoiceInfo || !pAttrList)
@@ -502,10 +501,9 @@ static osStatus_e osXsdChoice_getAttrInfo(osList_t* pAttrList, osXsd_choiceInfo_
 	pChoiceInfo->minOccurs = 1;
 	pChoiceInfo->maxOccurs = 1;
 
-    osListElement_t* pLE = pAttrList->head;
-    while(pLE)
+    for(uint32_t i=0; i<osVec_getCount(pAttrList); i++)
     {
-        osXmlNameValue_t* pNV = pLE->data;
+        osXmlNameValue_t* pNV = osVec_get(pAttrList, i);
         if(!pNV)
         {
             logError("pNV is NULL, this shall never happen.");
@@ -567,8 +565,6 @@ static osStatus_e osXsdChoice_getAttrInfo(osList_t* pAttrList, osXsd_choiceInfo_
                 logError("unexpected element attribute, ignore.");
                 break;
         }
-
-        pLE = pLE->next;
     }
 
 EXIT:
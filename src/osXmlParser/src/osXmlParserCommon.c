@@ -13,6 +13,7 @@
 #include "osXmlParser.h"
 #include "osXsdParser.h"
 #include "osXmlMisc.h"
+#include "osUtf8.h"
 
 
 #define OSXML_IS_COMMENT_START(p) (*p=='<' && *(p+1)=='!' && *(p+2)=='-' && *(p+3)=='-')
@@ -21,11 +22,10 @@
 #define OS_XML_NS_XS_LEN       32
 
 
+static osStatus_e osXml_scanTagInternal(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirstTag, osXmlTagInfo_t* pTagInfo, osXmlNameValue_t* pInlineAttr, osXmlStructIdx_t* pStructIdx, size_t* tagStartPos);
 static void osXmlTagInfo_cleanup(void* data);
 
 
-static __thread bool gIsDoubleQuote;
-
 /* this function parse a information inside quote <...> in XSD or XML
  * isTagNameChecked = true, parse starts after tag name, = false, parse starts before <
  * isTagDone == true, the tag is wrapped in one line, i.e., <tag, tag-content />
@@ -50,6 +50,130 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
     }
 
     pTagInfo = oszalloc(sizeof(osXmlTagInfo_t), osXmlTagInfo_cleanup);
+    status = osXml_scanTagInternal(pBuf, isTagNameChecked, isXsdFirstTag, pTagInfo, NULL, NULL, tagStartPos);
+    if(status != OS_STATUS_OK)
+    {
+    //to-do, cleanup memory if error case
+        pTagInfo = osfree(pTagInfo);
+    }
+
+EXIT:
+    *ppTagInfo = pTagInfo;
+
+    return status;
+}
+
+
+/* the same as osXml_parseTag(), except that the tag info is filled in a caller owned pTagDesc, the attributes are stored in
+ * pTagDesc->attrInline[], no memory is allocated unless the tag has more than OS_XML_TAG_INLINE_ATTR_NUM attributes.
+ * pTagDesc is reset before the scan, so the same pTagDesc can be used for all tags of a document, the caller shall call
+ * osXmlTagDesc_reset() after the last use.  pTagDesc shall not be moved or copied while its tagInfo is in use, since
+ * tagInfo.attrNVList refers pTagDesc->attrInline[].  If pTagDesc->pStructIdx is set, it shall be bound to pBuf, the text
+ * before a tag, the attribute values and the comments are skipped via the index
+ */
+osStatus_e osXml_scanTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirstTag, osXmlTagDesc_t* pTagDesc, size_t* tagStartPos)
+{
+    if(!pBuf || !pTagDesc)
+    {
+        logError("null pointer, pBuf=%p, pTagDesc=%p.", pBuf, pTagDesc);
+        return OS_ERROR_NULL_POINTER;
+    }
+
+    osXmlTagDesc_reset(pTagDesc);
+    osStatus_e status = osXml_scanTagInternal(pBuf, isTagNameChecked, isXsdFirstTag, &pTagDesc->tagInfo, pTagDesc->attrInline, pTagDesc->pStructIdx, tagStartPos);
+    if(status != OS_STATUS_OK)
+    {
+        osXmlTagDesc_reset(pTagDesc);
+    }
+
+    return status;
+}
+
+
+//free the attributes that spilled to the heap, pTagDesc can be reused afterwards
+void osXmlTagDesc_reset(osXmlTagDesc_t* pTagDesc)
+{
+    if(!pTagDesc)
+    {
+        return;
+    }
+
+    osVec_t* pAttrNVList = &pTagDesc->tagInfo.attrNVList;
+    for(uint32_t i=OS_XML_TAG_INLINE_ATTR_NUM; i<osVec_getCount(pAttrNVList); i++)
+    {
+        osfree(osVec_get(pAttrNVList, i));
+    }
+    osVec_clear(pAttrNVList);
+
+    pTagDesc->tagInfo.tag.p = NULL;
+    pTagDesc->tagInfo.tag.l = 0;
+    pTagDesc->tagInfo.isTagDone = false;
+    pTagDesc->tagInfo.isEndTag = false;
+    pTagDesc->tagInfo.isPElement = false;
+}
+
+
+void osXmlStructIdx_init(osXmlStructIdx_t* pIdx, const osMBuf_t* pBuf)
+{
+    if(!pIdx || !pBuf)
+    {
+        logError("null pointer, pIdx=%p, pBuf=%p.", pIdx, pBuf);
+        return;
+    }
+
+    pIdx->pBuf = pBuf;
+    pIdx->winStart = 0;
+    pIdx->winEnd = 0;
+    osScan_initSet(&pIdx->set, "<>\"'", 4);
+}
+
+
+size_t osXmlStructIdx_next(osXmlStructIdx_t* pIdx, size_t pos)
+{
+    size_t end = pIdx->pBuf->end;
+    while(pos < end)
+    {
+        //build the bitmap for the window that starts at pos
+        if(pos < pIdx->winStart || pos >= pIdx->winEnd)
+        {
+            pIdx->winStart = pos & ~(size_t)63;
+            pIdx->winEnd = end - pIdx->winStart > OS_XML_STRUCT_IDX_WIN_WORDS * 64 ? pIdx->winStart + OS_XML_STRUCT_IDX_WIN_WORDS * 64 : end;
+            osScan_buildBitmap(&pIdx->pBuf->buf[pIdx->winStart], pIdx->winEnd - pIdx->winStart, &pIdx->set, pIdx->bitmap);
+        }
+
+        size_t offset = pos - pIdx->winStart;
+        size_t wordNum = (pIdx->winEnd - pIdx->winStart + 63) >> 6;
+        uint64_t word = pIdx->bitmap[offset >> 6] & (~0ULL << (offset & 63));
+        for(size_t i = offset >> 6; ; )
+        {
+            if(word)
+            {
+                return pIdx->winStart + (i << 6) + __builtin_ctzll(word);
+            }
+
+            if(++i >= wordNum)
+            {
+                break;
+            }
+            word = pIdx->bitmap[i];
+        }
+
+        //nothing in the rest of the window, move to the next window
+        pos = pIdx->winEnd;
+    }
+
+    return end;
+}
+
+
+/* the tag parse shared by osXml_parseTag() and osXml_scanTag().  pTagInfo is empty when the function is called.  if
+ * pInlineAttr != NULL, the first OS_XML_TAG_INLINE_ATTR_NUM attributes are stored in pInlineAttr[], otherwise, all
+ * attributes are allocated.  if pStructIdx != NULL, the states that only wait for a structural char jump to the next
+ * one, the other chars are not relevant to these states
+ */
+static osStatus_e osXml_scanTagInternal(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirstTag, osXmlTagInfo_t* pTagInfo, osXmlNameValue_t* pInlineAttr, osXmlStructIdx_t* pStructIdx, size_t* tagStartPos)
+{
+    osStatus_e status = OS_STATUS_OK;
 
     if(isXsdFirstTag && pBuf->pos != 0)
     {
@@ -61,6 +185,7 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
     bool isTagDone = false;
     bool isEndTag = false;
     bool isGetTagInfoDone = false;
+    bool isDoubleQuote = false;     //the attribute value is inside double quote, otherwise single quote
     osXmlNameValue_t* pnvPair = NULL;
     size_t tagPos = 0, nvStartPos = 0;
     osXsdCheckTagInfoState_e state = OS_XSD_TAG_INFO_START;
@@ -96,6 +221,11 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
                 }
                 else
                 {
+                    if(pStructIdx && (pBuf->pos = osXmlStructIdx_next(pStructIdx, pBuf->pos)) >= pBuf->end)
+                    {
+                        continue;
+                    }
+
                     if(pBuf->buf[pBuf->pos] == '<')
                     {
                         //remove the comment part
@@ -120,6 +250,17 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
                 }
                 break;
             case OS_XSD_TAG_INFO_TAG_COMMENT:
+                if(pStructIdx)
+                {
+                    size_t nextPos = osXmlStructIdx_next(pStructIdx, pBuf->pos);
+                    commentCount += nextPos - pBuf->pos;
+                    pBuf->pos = nextPos;
+                    if(pBuf->pos >= pBuf->end)
+                    {
+                        continue;
+                    }
+                }
+
                 if(pBuf->buf[pBuf->pos] == '"')
                 {
                     commentIsInsideQuote = commentIsInsideQuote ? false : true;
@@ -133,9 +274,13 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
                     }
                 }
                 commentCount++;
-                pBuf->pos++;
                 break;
             case OS_XSD_TAG_INFO_BEFORE_TAG_INSIDE_QUOTE:
+                if(pStructIdx && (pBuf->pos = osXmlStructIdx_next(pStructIdx, pBuf->pos)) >= pBuf->end)
+                {
+                    continue;
+                }
+
                 if(pBuf->buf[pBuf->pos] == '"')
                 {
                     state = OS_XSD_TAG_INFO_START;
@@ -200,12 +345,21 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
                 }
                 else if(!OSXML_IS_LWS(pBuf->buf[pBuf->pos]))
                 {
-                    pnvPair = oszalloc(sizeof(osXmlNameValue_t), NULL);
+                    if(pInlineAttr && osVec_getCount(&pTagInfo->attrNVList) < OS_XML_TAG_INLINE_ATTR_NUM)
+                    {
+                        pnvPair = &pInlineAttr[osVec_getCount(&pTagInfo->attrNVList)];
+                        pnvPair->value.p = NULL;
+                        pnvPair->value.l = 0;
+                    }
+                    else
+                    {
+                        pnvPair = oszalloc(sizeof(osXmlNameValue_t), NULL);
+                    }
                     pnvPair->name.p = &pBuf->buf[pBuf->pos];
                     nvStartPos = pBuf->pos;
 
                     //insert into pTagInfo->attrNVList
-                    osList_append(&pTagInfo->attrNVList, pnvPair);
+                    osVec_append(&pTagInfo->attrNVList, pnvPair);
                     state = OS_XSD_TAG_INFO_CONTENT_NAME;
                 }
                 break;
@@ -243,7 +397,7 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
             case OS_XSD_TAG_INFO_CONTENT_VALUE_START:
                 if(pBuf->buf[pBuf->pos] == '"' || pBuf->buf[pBuf->pos] == '\'')
                 {
-					gIsDoubleQuote = pBuf->buf[pBuf->pos] == '"' ? true : false;
+					isDoubleQuote = pBuf->buf[pBuf->pos] == '"' ? true : false;
                     pnvPair->value.p = &pBuf->buf[pBuf->pos+1];     //+1 to start after the current char "
                     nvStartPos = pBuf->pos + 1;                     //+1 to start after the current char "
 
@@ -256,7 +410,12 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
                 }
                 break;
             case OS_XSD_TAG_INFO_CONTENT_VALUE:
-                if((pBuf->buf[pBuf->pos] == '"' && gIsDoubleQuote) || (pBuf->buf[pBuf->pos] == '\'' && !gIsDoubleQuote))
+                if(pStructIdx && (pBuf->pos = osXmlStructIdx_next(pStructIdx, pBuf->pos)) >= pBuf->end)
+                {
+                    continue;
+                }
+
+                if((pBuf->buf[pBuf->pos] == '"' && isDoubleQuote) || (pBuf->buf[pBuf->pos] == '\'' && !isDoubleQuote))
                 {
                     pnvPair->value.l = pBuf->pos - nvStartPos;
                     state = OS_XSD_TAG_INFO_CONTENT_NAME_START;
@@ -289,23 +448,12 @@ osStatus_e osXml_parseTag(osMBuf_t* pBuf, bool isTagNameChecked, bool isXsdFirst
     }
 
 EXIT:
-    if(status != OS_STATUS_OK)
+    if(status == OS_STATUS_OK)
     {
-    //to-do, cleanup memory if error case
-        osfree(pTagInfo);
-        pTagInfo = NULL;
+        pTagInfo->isTagDone = isTagDone;
+        pTagInfo->isEndTag = isEndTag;
+        mdebug(LM_XMLP, "tag=%r is parsed, isTagDone=%d, isEndTag=%d, pos=%ld", &pTagInfo->tag, pTagInfo->isTagDone, pTagInfo->isEndTag, pBuf->pos);
     }
-    else
-    {
-        if(pTagInfo)
-        {
-            pTagInfo->isTagDone = isTagDone;
-            pTagInfo->isEndTag = isEndTag;
-            mdebug(LM_XMLP, "tag=%r is parsed, isTagDone=%d, isEndTag=%d, pos=%ld", &pTagInfo->tag, pTagInfo->isTagDone, pTagInfo->isEndTag, pBuf->pos);
-        }
-    }
-
-    *ppTagInfo = pTagInfo;
 
     return status;
 }
@@ -315,7 +463,8 @@ EXIT:
 osStatus_e osXml_parseFirstTag(osMBuf_t* pXmlBuf)
 {
     osStatus_e status = OS_STATUS_OK;
-    osXmlTagInfo_t* pTagInfo = NULL;
+    osXmlTagDesc_t tagDesc = {};
+    osXmlTagInfo_t* pTagInfo = &tagDesc.tagInfo;
 
     if(!pXmlBuf)
     {
@@ -325,23 +474,25 @@ osStatus_e osXml_parseFirstTag(osMBuf_t* pXmlBuf)
     }
 
     //get tag info for the immediate next tag
-    status = osXml_parseTag(pXmlBuf, false, true, &pTagInfo, NULL);
+    status = osXml_scanTag(pXmlBuf, false, true, &tagDesc, NULL);
     if(status != OS_STATUS_OK)
     {
-        logError("fails to osXml_parseTag for the first xsd line.");
+        logError("fails to osXml_scanTag for the first xsd line.");
         goto EXIT;
     }
 
-    if(!pTagInfo->isTagDone)
+    //the scan succeeds without a tag for an empty buffer
+    if(!pTagInfo->tag.p || !pTagInfo->tag.l)
     {
-        logError("isTagDone = false for the first xsd line parsing.");
+        logError("no tag is found for the first xsd line.");
         status = OS_ERROR_INVALID_VALUE;
         goto EXIT;
     }
 
-    if(!pTagInfo)
+    if(!pTagInfo->isTagDone)
     {
-        mlogInfo(LM_XMLP, "all tags are parsed.");
+        logError("isTagDone = false for the first xsd line parsing.");
+        status = OS_ERROR_INVALID_VALUE;
         goto EXIT;
     }
 
@@ -355,29 +506,27 @@ osStatus_e osXml_parseFirstTag(osMBuf_t* pXmlBuf)
     for(int i=0; i<2; i++)
     {
         bool isMatch = false;
-        osListElement_t* pLE = pTagInfo->attrNVList.head;
-        while(pLE)
+        for(uint32_t j=0; j<osVec_getCount(&pTagInfo->attrNVList); j++)
         {
-            if(strncmp(attrName[i], ((osXmlNameValue_t*)pLE->data)->name.p, ((osXmlNameValue_t*)pLE->data)->name.l) == 0)
+            osXmlNameValue_t* pNV = osVec_get(&pTagInfo->attrNVList, j);
+            if(strncmp(attrName[i], pNV->name.p, pNV->name.l) == 0)
             {
                 if(i==0)
                 {
-                    if(strncmp("1.0", ((osXmlNameValue_t*)pLE->data)->value.p, ((osXmlNameValue_t*)pLE->data)->value.l) == 0)
+                    if(strncmp("1.0", pNV->value.p, pNV->value.l) == 0)
                     {
                         isMatch = true;
                     }
                 }
                 else if(i == 1)
                 {
-                    if(strncmp("UTF-8", ((osXmlNameValue_t*)pLE->data)->value.p, ((osXmlNameValue_t*)pLE->data)->value.l) == 0)
+                    if(strncmp("UTF-8", pNV->value.p, pNV->value.l) == 0)
                     {
                         isMatch = true;
                     }
                 }
                 break;
             }
-
-            pLE = pLE->next;
         }
 
         if(!isMatch)
@@ -389,7 +538,7 @@ osStatus_e osXml_parseFirstTag(osMBuf_t* pXmlBuf)
     }
 
 EXIT:
-    osfree(pTagInfo);
+    osXmlTagDesc_reset(&tagDesc);
 
     return status;
 }
@@ -432,9 +581,19 @@ osStatus_e osXmlXSType_convertData(osPointerLen_t* elemName, osPointerLen_t* val
             mlogInfo(LM_XMLP, "xmlData.dataName = %r, value=%ld", elemName, pXmlData->xmlInt);
             break;
         case OS_XML_DATA_TYPE_XS_STRING:
+        {
+            //xs:string shall be a sequence of valid utf8 chars
+            ssize_t errPos = osUtf8_validate(value->p, value->l);
+            if(errPos >= 0)
+            {
+                logError("element(%r) value has invalid utf8 sequence at offset %ld.", elemName, errPos);
+                return OS_ERROR_INVALID_VALUE;
+            }
+
             pXmlData->xmlStr = *value;
             mlogInfo(LM_XMLP, "xmlData.dataName =%r, value= %r", elemName, &pXmlData->xmlStr);
             break;
+        }
         default:
             logError("unexpected data type(%d) for element(%r).", dataType, elemName);
             return OS_ERROR_INVALID_VALUE;
@@ -462,6 +621,7 @@ osXsdElement_t* osXsd_createAnyElem(osPointerLen_t* pTag, bool isRootAnyElem)
 	}
 
 	pXsdElem->elemName = *pTag;
+	pXsdElem->elemNameAtom = osAtom_find(pTag, false);	//a xml tag, not interned to keep the atom table bounded
 	pXsdElem->dataType = OS_XML_DATA_TYPE_ANY;	//for a <xs:any> element, ALWAYS treat it as a OS_XML_DATA_TYPE_ANY
 	pXsdElem->anyElem.isXmlAnyElem = true;
 	pXsdElem->anyElem.xmlAnyElem.isLeaf = true;
@@ -495,6 +655,105 @@ bool osXml_isXsdElemSimpleType(osXsdElement_t* pXsdElem)
 }
 
 
+osXsd_atomIndex_t* osXsd_atomIndex_create(osList_t* pList, size_t atomOffset, size_t plOffset)
+{
+	if(!pList)
+	{
+		logError("null pointer, pList.");
+		return NULL;
+	}
+
+	uint32_t num = 0;
+	osListElement_t* pLE = pList->head;
+	while(pLE)
+	{
+		osAtom_t atom = *(osAtom_t*)((char*)pLE->data + atomOffset);
+		if(atom == OS_ATOM_NONE && ((osPointerLen_t*)((char*)pLE->data + plOffset))->l)
+		{
+			mdebug(LM_XMLP, "name(%r) is not interned, the list can not be indexed.", (osPointerLen_t*)((char*)pLE->data + plOffset));
+			return NULL;
+		}
+
+		num++;
+		pLE = pLE->next;
+	}
+
+	//keep the load factor at most 1/2, so that a probe sequence is short
+	uint32_t slotNum = 4;
+	while(slotNum < 2 * num)
+	{
+		slotNum <<= 1;
+	}
+
+	osXsd_atomIndex_t* pIndex = oszalloc(sizeof(osXsd_atomIndex_t) + slotNum * sizeof(osXsd_atomIndexSlot_t), NULL);
+	if(!pIndex)
+	{
+		logError("fails to oszalloc() for pIndex, slotNum=%d.", slotNum);
+		return NULL;
+	}
+	pIndex->mask = slotNum - 1;
+
+	int listIdx = 0;
+	pLE = pList->head;
+	while(pLE)
+	{
+		osAtom_t atom = *(osAtom_t*)((char*)pLE->data + atomOffset);
+		if(atom != OS_ATOM_NONE)
+		{
+			uint32_t i = osAtom_getHash(atom) & pIndex->mask;
+			while(pIndex->slot[i].atom != OS_ATOM_NONE && pIndex->slot[i].atom != atom)
+			{
+				i = (i + 1) & pIndex->mask;
+			}
+
+			//for the duplicate names, the first one wins, the same as walking the list
+			if(pIndex->slot[i].atom == OS_ATOM_NONE)
+			{
+				pIndex->slot[i].atom = atom;
+				pIndex->slot[i].listIdx = listIdx;
+				pIndex->slot[i].pData = pLE->data;
+			}
+		}
+
+		listIdx++;
+		pLE = pLE->next;
+	}
+
+	return pIndex;
+}
+
+
+void* osXsd_atomIndex_get(const osXsd_atomIndex_t* pIndex, osAtom_t atom, int* pListIdx)
+{
+	if(pListIdx)
+	{
+		*pListIdx = -1;
+	}
+
+	if(!pIndex || atom == OS_ATOM_NONE)
+	{
+		return NULL;
+	}
+
+	uint32_t i = osAtom_getHash(atom) & pIndex->mask;
+	while(pIndex->slot[i].atom != OS_ATOM_NONE)
+	{
+		if(pIndex->slot[i].atom == atom)
+		{
+			if(pListIdx)
+			{
+				*pListIdx = pIndex->slot[i].listIdx;
+			}
+			return pIndex->slot[i].pData;
+		}
+
+		i = (i + 1) & pIndex->mask;
+	}
+
+	return NULL;
+}
+
+
 //isXSAliasFound and pXsAlias shall not be NULL when called by XSD.  For xml instance parsing, these 2 parameters are not needed, can be NULL
 osStatus_e osXml_getNSAlias(osXmlNameValue_t* pAttrNameValue, osPointerLen_t* pDefaultNS, osXsd_nsAliasInfo_t** ppnsAlias, bool* isXSAliasFound, osPointerLen_t* pXsAlias)
 {
@@ -533,10 +792,11 @@ osStatus_e osXml_getNSAlias(osXmlNameValue_t* pAttrNameValue, osPointerLen_t* pD
 	}
     else
     {
-    	*ppnsAlias = osmalloc(sizeof(osXsd_nsAliasInfo_t), NULL);
+    	*ppnsAlias = oszalloc(sizeof(osXsd_nsAliasInfo_t), NULL);
         (*ppnsAlias)->ns = pAttrNameValue->value;
         (*ppnsAlias)->nsAlias.p = &pAttrNameValue->name.p[6];   //the first char after "xmlns:"
         (*ppnsAlias)->nsAlias.l = pAttrNameValue->name.l - 6; 	//6 here =strlen("xmlns:")
+        (*ppnsAlias)->nsAliasAtom = osAtom_intern(&(*ppnsAlias)->nsAlias, false);
 #if 0
         //for no default namespace, change '=' to ':' in pXmlBuf for the alias to make later comparison easier.  It is OK since pXmlBuf would not be parsed any more
 		((char*)pAttrNameValue->name.p)[pAttrNameValue->name.l] = ':';  //change name=value to name:value in pXmlBuf
@@ -568,7 +828,7 @@ static void osXmlTagInfo_cleanup(void* data)
     }
     else
     {
-        osList_delete(&pTagInfo->attrNVList);
+        osVec_delete(&pTagInfo->attrNVList);
     }
 }
 
@@ -14,6 +14,7 @@
 #include "osDebug.h"
 #include "osMemory.h"
 #include "osMisc.h"
+#include "osRegex.h"
 
 #include "osXmlParser.h"
 #include "osXsdParser.h"
@@ -29,13 +30,37 @@
 #define OS_XML_SCHEMA_LEN		9
 
 
+/* the facets of a simpleType compiled into one check per kind of facet.  The range and length facets are merged into
+ * bounds, the enums are sorted for binary search, and the patterns are compiled osRegex programs.  The validator is
+ * built when the xsd is loaded and is read only afterwards */
+typedef struct osXmlSTypeValidator {
+	bool isEnum;				//the value must equal one of the enums
+	bool isNoValue;				//the range facets exclude all values, like minExclusive of the max uint64_t
+	uint32_t enumNum;
+	uint32_t patternNum;		//the value must match one of the patterns, 0 if no pattern or a pattern can not be compiled
+	uint64_t minValue;			//inclusive, for a numerical base type, min/maxInclusive and min/maxExclusive are merged
+	uint64_t maxValue;
+	uint64_t totalDigits;
+	uint64_t minLen;			//for xs:string, length, minLength and maxLength are merged
+	uint64_t maxLen;
+	union {
+		uint64_t* enumValue;		//sorted, for a numerical base type
+		osPointerLen_t* enumStr;	//sorted by length, then by content, for xs:string
+	};
+	osRegexProg_t* pattern;
+} osXmlSTypeValidator_t;
+
+
 
 static osStatus_e osXsdSimpleType_getSubTagInfo(osXmlSimpleType_t* pSimpleInfo, osXmlTagInfo_t* pTagInfo);
-static osStatus_e osXsdSimpleType_getAttrInfo(osList_t* pAttrList, osXmlSimpleType_t* pSInfo);
+static osStatus_e osXsdSimpleType_getAttrInfo(osVec_t* pAttrList, osXmlSimpleType_t* pSInfo);
 static osXmlRestrictionFacet_t* osXsdSimpleType_getFacet(osXmlRestrictionFacet_e facetType, osXmlDataType_e baseType, osXmlTagInfo_t* pTagInfo);
 static bool osXml_isXSSimpleType(osXmlDataType_e dataType);
-static bool osXml_isDigitType(osXmlDataType_e dataType);
-static void osXmlSimpleType_cleanup(void* data);
+static bool osXmlSTypeValidator_compilePattern(osPointerLen_t* pPattern, osRegexProg_t* pProg);
+static bool osXmlSTypeValidator_checkValue(osXmlSTypeValidator_t* pValidator, uint64_t value, int digitNum);
+static bool osXmlSTypeValidator_checkStr(osXmlSTypeValidator_t* pValidator, osPointerLen_t* pStr);
+static int osXmlSTypeValidator_cmpValue(const void* a, const void* b);
+static int osXmlSTypeValidator_cmpStr(const void* a, const void* b);
 
 
 /* parse <xxx> between <xs:simpleType> and </xs:simpleType>, like <<xs:restriction>
@@ -103,16 +128,14 @@ static osStatus_e osXsdSimpleType_getSubTagInfo(osXmlSimpleType_t* pSimpleInfo,
 					//this function deals with simpleType facet except for this one and "xs:union".  Special handling.
 					if(strncmp("restriction", &pTagInfo->tag.p[realTagStart], 11) == 0)
             		{
-					    osListElement_t* pLE = pTagInfo->attrNVList.head;
-    					while(pLE)
+					    for(uint32_t i=0; i<osVec_getCount(&pTagInfo->attrNVList); i++)
     					{
-        					if(osPL_strcmp(&((osXmlNameValue_t*)pLE->data)->name, "base") == 0)
+        					osXmlNameValue_t* pNV = osVec_get(&pTagInfo->attrNVList, i);
+        					if(osPL_strcmp(&pNV->name, "base") == 0)
         					{
-								pSimpleInfo->baseType = osXsd_getElemDataType(&((osXmlNameValue_t*)pLE->data)->value);
+								pSimpleInfo->baseType = osXsd_getElemDataType(&pNV->value);
 								break;
 							}
-								
-							pLE = pLE->next;
 						}
 
 						if(!osXml_isXSSimpleType(pSimpleInfo->baseType))
@@ -213,7 +236,7 @@ osXmlSimpleType_t* osXsdSimpleType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pSim
         goto EXIT;
     }
 
-    pSimpleInfo = osmalloc(sizeof(osXmlSimpleType_t), osXmlSimpleType_cleanup);
+    pSimpleInfo = oszalloc(sizeof(osXmlSimpleType_t), osXmlSimpleType_cleanup);
     osXsdSimpleType_getAttrInfo(&pSimpleTagInfo->attrNVList, pSimpleInfo);
 
     while(pXmlBuf->pos < pXmlBuf->end)
@@ -246,10 +269,16 @@ osXmlSimpleType_t* osXsdSimpleType_parse(osMBuf_t* pXmlBuf, osXmlTagInfo_t* pSim
                         mlogInfo(LM_XMLP, "parsed a simpleType without type name, and there is no parent element, pos=%ld.", pXmlBuf->pos);
                     }
 
+                    if((status = osXmlSimpleType_compile(pSimpleInfo)) != OS_STATUS_OK)
+                    {
+                        logError("fails to compile simpleType(%r).", &pSimpleInfo->typeName);
+                        goto EXIT;
+                    }
+
                     if(pParentElem)
                     {
                         //if the simpleType is embedded inside a element, directly assign the simpleType to the parent element
-                        if(osPL_cmp(&pParentElem->elemTypeName, &pSimpleInfo->typeName) == 0 || pParentElem->elemTypeName.l == 0)
+                        if(osAtom_isPLEqual(pParentElem->elemTypeNameAtom, &pParentElem->elemTypeName, pSimpleInfo->typeNameAtom, &pSimpleInfo->typeName) || pParentElem->elemTypeName.l == 0)
                         {
                             pParentElem->dataType = OS_XML_DATA_TYPE_SIMPLE;
                             pParentElem->pSimple = pSimpleInfo;
@@ -311,7 +340,7 @@ EXIT:
 }
                                                                                                                         
 
-static osStatus_e osXsdSimpleType_getAttrInfo(osList_t* pAttrList, osXmlSimpleType_t* pSInfo)
+static osStatus_e osXsdSimpleType_getAttrInfo(osVec_t* pAttrList, osXmlSimpleType_t* pSInfo)
 {
     osStatus_e status = OS_STATUS_OK;
     if(!pSInfo || !pAttrList)
@@ -321,10 +350,9 @@ static osStatus_e osXsdSimpleType_getAttrInfo(osList_t* pAttrList, osXmlSimpleTy
         goto EXIT;
     }
 
-    osListElement_t* pLE = pAttrList->head;
-    while(pLE)
+    for(uint32_t i=0; i<osVec_getCount(pAttrList); i++)
     {
-        osXmlNameValue_t* pNV = pLE->data;
+        osXmlNameValue_t* pNV = osVec_get(pAttrList, i);
         if(!pNV)
         {
             logError("pNV is NULL, this shall never happen.");
@@ -338,6 +366,7 @@ static osStatus_e osXsdSimpleType_getAttrInfo(osList_t* pAttrList, osXmlSimpleTy
                 if(pNV->name.l == 4 && strncmp("name", pNV->name.p, pNV->name.l) == 0)
                 {
                     pSInfo->typeName = pNV->value;
+                    pSInfo->typeNameAtom = osAtom_intern(&pSInfo->typeName, false);
                     isIgnored = false;
                 }
                 break;
@@ -349,8 +378,6 @@ static osStatus_e osXsdSimpleType_getAttrInfo(osList_t* pAttrList, osXmlSimpleTy
         {
             mlogInfo(LM_XMLP, "attribute(%r) is ignored.", &pNV->name);
         }
-
-        pLE = pLE->next;
     }
 
 EXIT:
@@ -415,27 +442,25 @@ static osXmlRestrictionFacet_t* osXsdSimpleType_getFacet(osXmlRestrictionFacet_e
 
     pFacet->facet = facetType;
 
-    osListElement_t* pLE = pTagInfo->attrNVList.head;
-    while(pLE)
+    for(uint32_t i=0; i<osVec_getCount(&pTagInfo->attrNVList); i++)
     {
-        if(osPL_strcmp(&((osXmlNameValue_t*)pLE->data)->name, "value") == 0)
+        osXmlNameValue_t* pNV = osVec_get(&pTagInfo->attrNVList, i);
+        if(osPL_strcmp(&pNV->name, "value") == 0)
         {
             if(isNumerical)
             {
-                if(osPL_convertStr2u64(&((osXmlNameValue_t*)pLE->data)->value, &pFacet->value, NULL) != OS_STATUS_OK)
+                if(osPL_convertStr2u64(&pNV->value, &pFacet->value, NULL) != OS_STATUS_OK)
                 {
-                    logError("expect a numerical value for a facet(%d), but the real value is(%r).", facetType, &((osXmlNameValue_t*)pLE->data)->value);
+                    logError("expect a numerical value for a facet(%d), but the real value is(%r).", facetType, &pNV->value);
                     goto EXIT;
 				}
             }
             else
             {
-                pFacet->string = ((osXmlNameValue_t*)pLE->data)->value;
+                pFacet->string = pNV->value;
             }
             goto EXIT;
         }
-
-        pLE = pLE->next;
     }
 
 EXIT:
@@ -444,8 +469,157 @@ EXIT:
 
 
 
+/* compile the facets of pSimple into pSimple->pValidator, so that a xml value is checked against each kind of facet once
+ * instead of walking facetList.  A pattern facet is compiled into a osRegex program if the pattern only uses the syntax
+ * osRegex and xsd agree on, i.e., literal chars and character classes with a '*', '+' or {n} (n=1-9) repetition, and
+ * each unbounded class can not take the chars of what follows it (osRegex does not backtrack).  Otherwise the patterns
+ * of the simpleType are not checked, the same as before the patterns were supported.  The patterns are compiled case
+ * sensitive via osRegex_compileCase(), as xsd requires.
+ */
+osStatus_e osXmlSimpleType_compile(osXmlSimpleType_t* pSimple)
+{
+	if(!pSimple)
+	{
+		logError("null pointer, pSimple.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	pSimple->pValidator = osfree(pSimple->pValidator);
+
+	uint32_t enumNum = 0, patternNum = 0;
+	for(osListElement_t* pLE = pSimple->facetList.head; pLE; pLE = pLE->next)
+	{
+		switch(((osXmlRestrictionFacet_t*)pLE->data)->facet)
+		{
+			case OS_XML_RESTRICTION_FACET_ENUM:
+				enumNum++;
+				break;
+			case OS_XML_RESTRICTION_FACET_PATTERN:
+				patternNum++;
+				break;
+			default:
+				break;
+		}
+	}
+
+	bool isDigit = osXml_isDigitType(pSimple->baseType);
+	size_t enumSize = enumNum * (isDigit ? sizeof(uint64_t) : sizeof(osPointerLen_t));
+	osXmlSTypeValidator_t* pValidator = oszalloc(sizeof(osXmlSTypeValidator_t) + enumSize + patternNum * sizeof(osRegexProg_t), NULL);
+	if(!pValidator)
+	{
+		logError("fails to oszalloc for the validator of simpleType(%r).", &pSimple->typeName);
+		return OS_ERROR_MEMORY_ALLOC_FAILURE;
+	}
+
+	pValidator->maxValue = UINT64_MAX;
+	pValidator->totalDigits = UINT64_MAX;
+	pValidator->maxLen = UINT64_MAX;
+	pValidator->enumValue = (void*)&pValidator[1];
+	pValidator->pattern = (osRegexProg_t*)((char*)&pValidator[1] + enumSize);
+
+	bool isPatternSkipped = false;
+	for(osListElement_t* pLE = pSimple->facetList.head; pLE; pLE = pLE->next)
+	{
+		osXmlRestrictionFacet_t* pFacet = pLE->data;
+		switch(pFacet->facet)
+		{
+			case OS_XML_RESTRICTION_FACET_ENUM:
+				pValidator->isEnum = true;
+				if(isDigit)
+				{
+					pValidator->enumValue[pValidator->enumNum++] = pFacet->value;
+				}
+				else
+				{
+					pValidator->enumStr[pValidator->enumNum++] = pFacet->string;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_MIN_INCLUSIVE:
+				if(pFacet->value > pValidator->minValue)
+				{
+					pValidator->minValue = pFacet->value;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_MAX_INCLUSIVE:
+				if(pFacet->value < pValidator->maxValue)
+				{
+					pValidator->maxValue = pFacet->value;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_MIN_EXCLUSIVE:
+				if(pFacet->value == UINT64_MAX)
+				{
+					pValidator->isNoValue = true;
+				}
+				else if(pFacet->value + 1 > pValidator->minValue)
+				{
+					pValidator->minValue = pFacet->value + 1;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_MAX_EXCLUSIVE:
+				if(pFacet->value == 0)
+				{
+					pValidator->isNoValue = true;
+				}
+				else if(pFacet->value - 1 < pValidator->maxValue)
+				{
+					pValidator->maxValue = pFacet->value - 1;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_TOTAL_DIGITS:
+				if(pFacet->value < pValidator->totalDigits)
+				{
+					pValidator->totalDigits = pFacet->value;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_LENGTH:
+			case OS_XML_RESTRICTION_FACET_MIN_LENGTH:
+			case OS_XML_RESTRICTION_FACET_MAX_LENGTH:
+				if(pFacet->facet != OS_XML_RESTRICTION_FACET_MAX_LENGTH && pFacet->value > pValidator->minLen)
+				{
+					pValidator->minLen = pFacet->value;
+				}
+				if(pFacet->facet != OS_XML_RESTRICTION_FACET_MIN_LENGTH && pFacet->value < pValidator->maxLen)
+				{
+					pValidator->maxLen = pFacet->value;
+				}
+				break;
+			case OS_XML_RESTRICTION_FACET_PATTERN:
+				if(!isPatternSkipped && osXmlSTypeValidator_compilePattern(&pFacet->string, &pValidator->pattern[pValidator->patternNum]))
+				{
+					pValidator->patternNum++;
+				}
+				else
+				{
+					isPatternSkipped = true;
+				}
+				break;
+			default:
+				mlogInfo(LM_XMLP, "simpleType(%r) base type=%d, unsupported facet(%d), ignore.", &pSimple->typeName, pSimple->baseType, pFacet->facet);
+				break;
+		}
+	}
+
+	//the patterns of a simpleType are ORed, if one can not be compiled, none can be checked
+	if(isPatternSkipped)
+	{
+		mlogInfo(LM_XMLP, "simpleType(%r) has a pattern that can not be compiled, the patterns are not checked.", &pSimple->typeName);
+		pValidator->patternNum = 0;
+	}
+
+	if(pValidator->enumNum > 1)
+	{
+		qsort(pValidator->enumValue, pValidator->enumNum, isDigit ? sizeof(uint64_t) : sizeof(osPointerLen_t), isDigit ? osXmlSTypeValidator_cmpValue : osXmlSTypeValidator_cmpStr);
+	}
+
+	pSimple->pValidator = pValidator;
+	return OS_STATUS_OK;
+}
+
+
 /* perform sanity check of the simpleType data from an xml input against the facets of a pSimple object from the xsd.  
  * A xs:simpleType is converted to the simpleType's baseType, the data value will also be set in pXmlData as an output.
+ * The facets are checked via pSimple->pValidator that is compiled when the xsd is loaded.
  *
  * pValue: the data value gotten from xml input
  * pSimple: a osXmlSimpleType_t object that was parsed based on xsd
@@ -468,7 +642,6 @@ osStatus_e osXmlSimpleType_convertData(osXmlSimpleType_t* pSimple, osPointerLen_
     	case OS_XML_DATA_TYPE_XS_LONG:
 		{
 			int digitNum=0;
-			int isEnumMatch = -1;		//-1: not an enum simpleType, 0: an enum simpleType, but match has not found, 1: an enum simpleType, and match found
 			if(osPL_convertStr2u64(pValue, &pXmlData->xmlInt, &digitNum) != OS_STATUS_OK)
             {
 				pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
@@ -477,82 +650,11 @@ osStatus_e osXmlSimpleType_convertData(osXmlSimpleType_t* pSimple, osPointerLen_
                 goto EXIT;
 			}
 
-			osListElement_t* pLE = pSimple->facetList.head;
-			while(pLE)
-			{
-				switch(((osXmlRestrictionFacet_t*)pLE->data)->facet)
-				{
-    				case OS_XML_RESTRICTION_FACET_ENUM:          //can be value or string, depending on the restriction base type
-						if(isEnumMatch == -1)
-						{
-							isEnumMatch = 0;
-						}
-						if(isEnumMatch != 1 && pXmlData->xmlInt == ((osXmlRestrictionFacet_t*)pLE->data)->value)
-						{
-							isEnumMatch=1;
-						}
-						break;
-    				case OS_XML_RESTRICTION_FACET_MIN_INCLUSIVE:
-						if(pXmlData->xmlInt < ((osXmlRestrictionFacet_t*)pLE->data)->value)
-						{
-							pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-			                status = OS_ERROR_INVALID_VALUE;
-							logError("pXmlData->xmlInt(%ld) < OS_XML_RESTRICTION_FACET_MIN_INCLUSIVE(%ld).", pXmlData->xmlInt, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-			                goto EXIT;
-            			}
-						break;
-					case OS_XML_RESTRICTION_FACET_MAX_INCLUSIVE:
-                        if(pXmlData->xmlInt > ((osXmlRestrictionFacet_t*)pLE->data)->value)
-                        {
-                            pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-			                status = OS_ERROR_INVALID_VALUE;
-                            logError("pXmlData->xmlInt(%ld) > OS_XML_RESTRICTION_FACET_MAX_INCLUSIVE(%ld).", pXmlData->xmlInt, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-                    case OS_XML_RESTRICTION_FACET_MIN_EXCLUSIVE:
-                        if(pXmlData->xmlInt <= ((osXmlRestrictionFacet_t*)pLE->data)->value)
-                        {
-                            pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-                            logError("pXmlData->xmlInt(%ld) <= OS_XML_RESTRICTION_FACET_MIN_EXCLUSIVE(%ld).", pXmlData->xmlInt, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-    				case OS_XML_RESTRICTION_FACET_MAX_EXCLUSIVE:
-                        if(pXmlData->xmlInt >= ((osXmlRestrictionFacet_t*)pLE->data)->value)
-                        {
-                            pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-                            logError("pXmlData->xmlInt(%ld) >= OS_XML_RESTRICTION_FACET_MAX_EXCLUSIVE(%ld).", pXmlData->xmlInt, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-    				case OS_XML_RESTRICTION_FACET_TOTAL_DIGITS:
-						//only check no decimal value
-						if(digitNum > ((osXmlRestrictionFacet_t*)pLE->data)->value)
-                        {
-                            pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-                            logError("pXmlData->xmlInt(%ld) digit num(%d) > OS_XML_RESTRICTION_FACET_TOTAL_DIGITS(%ld).", pXmlData->xmlInt, digitNum, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-    				case OS_XML_RESTRICTION_FACET_FRACTION_DIGITS:
-					default:
-						logInfo("simpleType base type=%d, unsupported facet(%d), ignore.", pSimple->baseType, ((osXmlRestrictionFacet_t*)pLE->data)->facet);
-						break;
-				}
-				
-				pLE = pLE->next;
-			} //while(pLE)
-
-			//an enum simpleType, but the xml data does not match in xsd
-			if(isEnumMatch == 0)
+			if(pSimple->pValidator && !osXmlSTypeValidator_checkValue(pSimple->pValidator, pXmlData->xmlInt, digitNum))
 			{
 				pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
                 status = OS_ERROR_INVALID_VALUE;
-                logError("pXmlData->xmlInt(%ld) is an enum, but does not match enum value in xsd.", pXmlData->xmlInt);
+                logError("simpleType(%r) value(%r) does not satisfy the xsd facets.", &pSimple->typeName, pValue);
                 goto EXIT;
             }
 
@@ -563,67 +665,13 @@ osStatus_e osXmlSimpleType_convertData(osXmlSimpleType_t* pSimple, osPointerLen_
 		}	//case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE etc.
     	case OS_XML_DATA_TYPE_XS_STRING: 	//xs:anyURI falls in this enum
 		{
-            int isEnumMatch = -1;       //-1: not an enum simpleType, 0: an enum simpleType, but match has not found, 1: an enum simpleType, and match found
 			pXmlData->xmlStr = *pValue;
 
-            osListElement_t* pLE = pSimple->facetList.head;
-            while(pLE)
-            {
-                switch(((osXmlRestrictionFacet_t*)pLE->data)->facet)
-                {
-        			case OS_XML_RESTRICTION_FACET_LENGTH:
-						if(pValue->l != ((osXmlRestrictionFacet_t*)pLE->data)->value)
-						{
-							pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-							logError("pXmlData->xmlStr length(%ld) does not equal to XSD length facet(%ld).", pValue->l, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-							goto EXIT;
-						}
-						break;
-            		case OS_XML_RESTRICTION_FACET_MIN_LENGTH:
-						if(pValue->l < ((osXmlRestrictionFacet_t*)pLE->data)->value)
-						{
-							pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-                    		logError("pXmlData->xmlStr length(%ld) < OS_XML_RESTRICTION_FACET_MIN_LENGTH(%ld).", pValue->l, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-            		case OS_XML_RESTRICTION_FACET_MAX_LENGTH:
-                        if(pValue->l > ((osXmlRestrictionFacet_t*)pLE->data)->value)
-                        {
-                            pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
-                            status = OS_ERROR_INVALID_VALUE;
-                            logError("pXmlData->xmlStr length(%ld) > OS_XML_RESTRICTION_FACET_MAX_LENGTH(%ld).", pValue->l, ((osXmlRestrictionFacet_t*)pLE->data)->value);
-                            goto EXIT;
-                        }
-                        break;
-                    case OS_XML_RESTRICTION_FACET_ENUM:          //can be value or string, depending on the restriction base type
-                        if(isEnumMatch == -1)
-                        {
-                            isEnumMatch = 0;
-                        }
-                        if(isEnumMatch != 1 && osPL_cmp(&pXmlData->xmlStr, &((osXmlRestrictionFacet_t*)pLE->data)->string) == 0)
-                        {
-                            isEnumMatch=1;
-                        }
-						break;
-            		case OS_XML_RESTRICTION_FACET_PATTERN:       //regular expression pattern
-            		case OS_XML_RESTRICTION_FACET_WHITE_SPACE:   //"preserve", "replace", "collapse"
-					default:
-                        logInfo("simpleType base type=%d, unsupported facet(%d), ignore.", pSimple->baseType, ((osXmlRestrictionFacet_t*)pLE->data)->facet);
-                        break;
-                }
-
-                pLE = pLE->next;
-            }	//while(pLE)
-
-            //an enum simpleType, but the xml data does not match in xsd
-            if(isEnumMatch == 0)
+			if(pSimple->pValidator && !osXmlSTypeValidator_checkStr(pSimple->pValidator, &pXmlData->xmlStr))
             {
                 pXmlData->dataType = OS_XML_DATA_TYPE_INVALID;
                 status = OS_ERROR_INVALID_VALUE;
-                logError("pXmlData->xmlStr(%r) is an enum, but does not match enum value in xsd.", &pXmlData->xmlStr);
+                logError("simpleType(%r) value(%r) does not satisfy the xsd facets.", &pSimple->typeName, pValue);
                 goto EXIT;
             }
 
@@ -642,7 +690,7 @@ EXIT:
 }
 
 
-static void osXmlSimpleType_cleanup(void* data)
+void osXmlSimpleType_cleanup(void* data)
 {
 	if(!data)
 	{
@@ -651,10 +699,11 @@ static void osXmlSimpleType_cleanup(void* data)
 
 	osXmlSimpleType_t* pSimple = data;
 	osList_delete(&pSimple->facetList);
+	osfree(pSimple->pValidator);
 }
 
 
-static bool osXml_isDigitType(osXmlDataType_e dataType)
+bool osXml_isDigitType(osXmlDataType_e dataType)
 {
     switch(dataType)
     {
@@ -690,3 +739,246 @@ static bool osXml_isXSSimpleType(osXmlDataType_e dataType)
 
     return true;
 }		
+
+
+static bool osXmlSTypeValidator_checkValue(osXmlSTypeValidator_t* pValidator, uint64_t value, int digitNum)
+{
+	if(pValidator->isNoValue || value < pValidator->minValue || value > pValidator->maxValue)
+	{
+		logError("value(%ld) is out of the facet range [%ld, %ld].", value, pValidator->minValue, pValidator->maxValue);
+		return false;
+	}
+
+	//only check no decimal value
+	if(digitNum > pValidator->totalDigits)
+	{
+		logError("value(%ld) digit num(%d) > OS_XML_RESTRICTION_FACET_TOTAL_DIGITS(%ld).", value, digitNum, pValidator->totalDigits);
+		return false;
+	}
+
+	if(!pValidator->isEnum)
+	{
+		return true;
+	}
+
+	uint32_t low = 0, high = pValidator->enumNum;
+	while(low < high)
+	{
+		uint32_t mid = (low + high) / 2;
+		if(pValidator->enumValue[mid] < value)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	if(low == pValidator->enumNum || pValidator->enumValue[low] != value)
+	{
+		logError("value(%ld) is an enum, but does not match enum value in xsd.", value);
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool osXmlSTypeValidator_checkStr(osXmlSTypeValidator_t* pValidator, osPointerLen_t* pStr)
+{
+	if(pStr->l < pValidator->minLen || pStr->l > pValidator->maxLen)
+	{
+		logError("string(%r) length(%ld) is out of the facet length range [%ld, %ld].", pStr, pStr->l, pValidator->minLen, pValidator->maxLen);
+		return false;
+	}
+
+	if(pValidator->isEnum)
+	{
+		uint32_t low = 0, high = pValidator->enumNum;
+		while(low < high)
+		{
+			uint32_t mid = (low + high) / 2;
+			if(osXmlSTypeValidator_cmpStr(&pValidator->enumStr[mid], pStr) < 0)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		if(low == pValidator->enumNum || osXmlSTypeValidator_cmpStr(&pValidator->enumStr[low], pStr) != 0)
+		{
+			logError("string(%r) is an enum, but does not match enum value in xsd.", pStr);
+			return false;
+		}
+	}
+
+	if(!pValidator->patternNum)
+	{
+		return true;
+	}
+
+	for(uint32_t i=0; i<pValidator->patternNum; i++)
+	{
+		if(osRegex_matchAll(&pValidator->pattern[i], pStr->p, pStr->l) == 0)
+		{
+			return true;
+		}
+	}
+
+	logError("string(%r) does not match any xsd pattern.", pStr);
+	return false;
+}
+
+
+//convert a xsd pattern into the osRegex syntax and compile it, return false if the pattern can not be expressed in osRegex
+static bool osXmlSTypeValidator_compilePattern(osPointerLen_t* pPattern, osRegexProg_t* pProg)
+{
+	//a class without repetition gets a '1' appended, and a '-' before ']' is escaped, the expr is at most twice of the pattern
+	char expr[OS_XML_STYPE_MAX_PATTERN_LEN * 2 + 1];
+	size_t n = 0;
+	bool isInClass = false;
+
+	if(pPattern->l > OS_XML_STYPE_MAX_PATTERN_LEN)
+	{
+		return false;
+	}
+
+	for(size_t i=0; i<pPattern->l; i++)
+	{
+		char c = pPattern->p[i];
+		if(!c)
+		{
+			return false;
+		}
+
+		if(!isInClass)
+		{
+			//escapes, wildcard, groups, alternation and the repetitions of a literal char are not in osRegex
+			if(strchr("\\.|(){}?*+^$", c))
+			{
+				return false;
+			}
+
+			isInClass = c == '[';
+			expr[n++] = c;
+			continue;
+		}
+
+		//escapes and class subtraction are not in osRegex, '~' as the first char is osRegex quote escape
+		if(c == '\\' || c == '[' || (c == '~' && pPattern->p[i-1] == '['))
+		{
+			return false;
+		}
+
+		//a xsd '-' right before ']' is a literal char, like [a-z-], but osRegex takes it as the start of a range
+		if(c == '-' && i+1 < pPattern->l && pPattern->p[i+1] == ']')
+		{
+			expr[n++] = '\\';
+		}
+
+		expr[n++] = c;
+		if(c != ']')
+		{
+			continue;
+		}
+
+		//osRegex requires a repetition after each class
+		isInClass = false;
+		char next = i+1 < pPattern->l ? pPattern->p[i+1] : 0;
+		if(next == '*' || next == '+')
+		{
+			expr[n++] = next;
+			i++;
+		}
+		else if(next == '{' && i+3 < pPattern->l && pPattern->p[i+2] >= '1' && pPattern->p[i+2] <= '9' && pPattern->p[i+3] == '}')
+		{
+			expr[n++] = pPattern->p[i+2];
+			i += 3;
+		}
+		else if(next == '?' || next == '{')
+		{
+			return false;
+		}
+		else
+		{
+			expr[n++] = '1';
+		}
+	}
+
+	if(isInClass)
+	{
+		return false;
+	}
+
+	//xsd patterns are case sensitive
+	expr[n] = 0;
+	if(osRegex_compileCase(pProg, expr, true) != 0)
+	{
+		return false;
+	}
+
+	//an unbounded class takes the longest run, it must not take a char that an element after it up to the first element
+	//that must match a char could start with
+	for(uint8_t i=0; i<pProg->elemNum; i++)
+	{
+		const osRegexElem_t* pElem = &pProg->elem[i];
+		if(pElem->type != OS_REGEX_ELEM_CLASS || pElem->nmin == pElem->nmax)
+		{
+			continue;
+		}
+
+		for(uint8_t j=i+1; j<pProg->elemNum; j++)
+		{
+			const osRegexElem_t* pNext = &pProg->elem[j];
+			if(pNext->type == OS_REGEX_ELEM_LITERAL)
+			{
+				uint8_t lc = pProg->literal[pNext->litPos];
+				if(pElem->map[lc >> 3] & (1 << (lc & 0x7)))
+				{
+					return false;
+				}
+				break;
+			}
+
+			for(int k=0; k<32; k++)
+			{
+				if(pElem->map[k] & pNext->map[k])
+				{
+					return false;
+				}
+			}
+
+			if(pNext->nmin)
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+static int osXmlSTypeValidator_cmpValue(const void* a, const void* b)
+{
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+
+//order by length first, a enum match is then decided by the length for most strings
+static int osXmlSTypeValidator_cmpStr(const void* a, const void* b)
+{
+	const osPointerLen_t* x = a;
+	const osPointerLen_t* y = b;
+	if(x->l != y->l)
+	{
+		return x->l < y->l ? -1 : 1;
+	}
+
+	return memcmp(x->p, y->p, x->l);
+}
@@ -0,0 +1,541 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osXmlPath.c
+ * extract the values of a set of element paths from a xml without parsing the whole xml.  The elements that are not
+ * on any path are skipped by counting the tags only, the extraction stops as soon as all paths are found.
+ ********************************************************/
+
+#include <string.h>
+
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osList.h"
+#include "osVec.h"
+#include "osDebug.h"
+#include "osMemory.h"
+#include "osScan.h"
+
+#include "osXmlParser.h"
+#include "osXsdParser.h"
+#include "osXmlParserCommon.h"
+#include "osXmlParserSType.h"
+#include "osXmlMisc.h"
+
+
+#define OS_XML_PATH_NO_NODE		-1
+
+
+/* a node of the path tree.  The tree is stored in osXmlPathSet_t.node[], node[0] is a virtual node whose children are the
+ * root elements of the paths.  A node shared by multiple paths, like "a/b" in "a/b/c" and "a/b/d", is stored once */
+typedef struct {
+	osPointerLen_t name;		//element name without ns alias, refers the string pool of the path set
+	int firstChild;				//OS_XML_PATH_NO_NODE if the node has no child
+	int nextSibling;			//OS_XML_PATH_NO_NODE if the node is the last child of its parent
+	int pathIdx;				//the idx of the path that ends at this node, OS_XML_PATH_NO_NODE if no path ends here
+	int eDataName;				//from osXmlPath_t, valid if pathIdx != OS_XML_PATH_NO_NODE
+	bool isMulti;				//from osXmlPath_t, valid if pathIdx != OS_XML_PATH_NO_NODE
+	osXsdElement_t* pXsdElem;	//the xsd element of the node, NULL if the xsd is not provided or the element is not found in the xsd
+} osXmlPathNode_t;
+
+
+struct osXmlPathSet {
+	uint32_t pathNum;
+	uint32_t singleNum;			//the number of the paths that are done after the first match (isMulti = false)
+	uint32_t nodeNum;
+	osXmlPathNode_t node[];		//followed by the string pool
+};
+
+
+static int osXmlPath_getChild(const osXmlPathSet_t* pPathSet, int parent, osPointerLen_t* pName);
+static osXsdElement_t* osXmlPath_getXsdChild(osXsdElement_t* pParentElem, osPointerLen_t* pName);
+static osStatus_e osXmlPath_report(const osXmlPathNode_t* pNode, osPointerLen_t* pTag, osPointerLen_t* pValue, osXmlDataCallback_h callback, void* appData);
+static osStatus_e osXmlPath_skipElem(osMBuf_t* pBuf, osXmlStructIdx_t* pIdx);
+static bool osXmlPath_skipPast(osMBuf_t* pBuf, size_t* pPos, const char* pattern, size_t patternLen);
+
+
+/* compile a set of element paths.  Each path is a list of element names from the root element separated by '/', like
+ * "Sh-Data/RepositoryData/ServiceData", a element name does not include the ns alias.
+ *
+ * pPath:   IN, the paths, the path strings are copied, the caller does not need to keep them
+ * pathNum: IN, the number of paths, shall not exceed OS_XML_PATH_MAX_NUM
+ * xsdName: IN, the name of a parsed xsd.  If not NULL, a path that is found in the xsd gets its value converted per the xsd
+ *          data type, otherwise, the value is reported as a xs:string.  The xsd shall not be freed while the path set is used
+ *
+ * return the compiled path set, to be freed via osfree(), NULL if a path is invalid or duplicated
+ */
+osXmlPathSet_t* osXml_compilePaths(const osXmlPath_t* pPath, uint32_t pathNum, osPointerLen_t* xsdName)
+{
+	osXmlPathSet_t* pPathSet = NULL;
+
+	if(!pPath || !pathNum || pathNum > OS_XML_PATH_MAX_NUM)
+	{
+		logError("invalid input, pPath=%p, pathNum=%d.", pPath, pathNum);
+		return NULL;
+	}
+
+	//a path with n names adds at most n nodes
+	size_t nodeMax = 1, poolSize = 0;
+	for(uint32_t i=0; i<pathNum; i++)
+	{
+		if(!pPath[i].path.p || !pPath[i].path.l)
+		{
+			logError("path(%d) is empty.", i);
+			return NULL;
+		}
+
+		poolSize += pPath[i].path.l;
+		for(size_t k=0; k<pPath[i].path.l; k++)
+		{
+			nodeMax += pPath[i].path.p[k] == '/';
+		}
+		nodeMax++;
+	}
+
+	bool isEmptyTargetNS = false;
+	if(xsdName)
+	{
+		osVec_t schemaVec = {};
+		if(osXsd_getSchemas(xsdName, &schemaVec, &isEmptyTargetNS) != OS_STATUS_OK)
+		{
+			logError("xsd(%r) has not been parsed.", xsdName);
+			return NULL;
+		}
+		osVec_clear(&schemaVec);
+	}
+
+	pPathSet = oszalloc(sizeof(osXmlPathSet_t) + nodeMax * sizeof(osXmlPathNode_t) + poolSize, NULL);
+	if(!pPathSet)
+	{
+		logError("fails to allocate osXmlPathSet_t, nodeMax=%ld, poolSize=%ld.", nodeMax, poolSize);
+		return NULL;
+	}
+
+	char* pPool = (char*)&pPathSet->node[nodeMax];
+	pPathSet->pathNum = pathNum;
+	pPathSet->nodeNum = 1;
+	pPathSet->node[0].firstChild = OS_XML_PATH_NO_NODE;
+	pPathSet->node[0].nextSibling = OS_XML_PATH_NO_NODE;
+	pPathSet->node[0].pathIdx = OS_XML_PATH_NO_NODE;
+
+	for(uint32_t i=0; i<pathNum; i++)
+	{
+		memcpy(pPool, pPath[i].path.p, pPath[i].path.l);
+		osPointerLen_t path = {pPool, pPath[i].path.l};
+		pPool += pPath[i].path.l;
+
+		int node = 0, depth = 0;
+		size_t start = 0;
+		while(start <= path.l)
+		{
+			size_t end = start;
+			while(end < path.l && path.p[end] != '/')
+			{
+				end++;
+			}
+
+			osPointerLen_t name = {&path.p[start], end - start};
+			if(!name.l || ++depth > OS_XML_PATH_MAX_DEPTH)
+			{
+				logError("path(%r) has a empty element name, or is deeper than %d.", &pPath[i].path, OS_XML_PATH_MAX_DEPTH);
+				goto FAIL;
+			}
+
+			int child = osXmlPath_getChild(pPathSet, node, &name);
+			if(child == OS_XML_PATH_NO_NODE)
+			{
+				child = pPathSet->nodeNum++;
+				osXmlPathNode_t* pChild = &pPathSet->node[child];
+				pChild->name = name;
+				pChild->firstChild = OS_XML_PATH_NO_NODE;
+				pChild->pathIdx = OS_XML_PATH_NO_NODE;
+				if(xsdName)
+				{
+					pChild->pXsdElem = node ? osXmlPath_getXsdChild(pPathSet->node[node].pXsdElem, &name) : osXsd_getNSRootElem(xsdName, isEmptyTargetNS, &name);
+				}
+
+				//keep the children in the path order
+				int* pLink = &pPathSet->node[node].firstChild;
+				while(*pLink != OS_XML_PATH_NO_NODE)
+				{
+					pLink = &pPathSet->node[*pLink].nextSibling;
+				}
+				*pLink = child;
+				pChild->nextSibling = OS_XML_PATH_NO_NODE;
+			}
+
+			node = child;
+			start = end + 1;
+		}
+
+		osXmlPathNode_t* pNode = &pPathSet->node[node];
+		if(pNode->pathIdx != OS_XML_PATH_NO_NODE)
+		{
+			logError("path(%r) is duplicated.", &pPath[i].path);
+			goto FAIL;
+		}
+
+		pNode->pathIdx = i;
+		pNode->eDataName = pPath[i].eDataName;
+		pNode->isMulti = pPath[i].isMulti;
+		if(!pNode->isMulti)
+		{
+			pPathSet->singleNum++;
+		}
+
+		mdebug(LM_XMLP, "path(%r) is compiled, xsd element is %s.", &pPath[i].path, pNode->pXsdElem ? "found" : "not found");
+	}
+
+	return pPathSet;
+
+FAIL:
+	return osfree(pPathSet);
+}
+
+
+/* extract the values of the paths in pPathSet from a xml.  For each element that matches a path, callback is called with
+ * the value between the start and the end tag, osXmlData_t.eDataName is the eDataName of the path.  The value of a element
+ * that has child elements is its raw content.  The elements that are not on any path are skipped without any check, and
+ * the extraction stops once all paths with isMulti = false have been found if there is no isMulti = true path.
+ *
+ * pXmlBuf:  IN, the xml, pXmlBuf->pos is moved to where the extraction stops
+ * pPathSet: IN, created by osXml_compilePaths(), it is read only and can be used by multiple threads at the same time
+ * callback: IN, called for each matched element, the pnsAliasInfo is always NULL
+ * appData:  IN, passed back in callback
+ */
+osStatus_e osXml_extract(osMBuf_t* pXmlBuf, const osXmlPathSet_t* pPathSet, osXmlDataCallback_h callback, void* appData)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXmlTagDesc_t tagDesc = {};
+	osXmlTagInfo_t* pTagInfo = &tagDesc.tagInfo;
+	osXmlStructIdx_t structIdx;
+	int nodeStack[OS_XML_PATH_MAX_DEPTH];
+	size_t valueStartPos[OS_XML_PATH_MAX_DEPTH];
+	int depth = 0;
+	uint64_t foundMask = 0;
+	uint32_t foundNum = 0;
+
+	if(!pXmlBuf || !pPathSet || !callback)
+	{
+		logError("null pointer, pXmlBuf=%p, pPathSet=%p, callback=%p.", pXmlBuf, pPathSet, callback);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	//parse <?xml version="1.0" encoding="UTF-8"?>
+	if((status = osXml_parseFirstTag(pXmlBuf)) != OS_STATUS_OK)
+	{
+		logError("xml parse the first line failure.");
+		goto EXIT;
+	}
+
+	osXmlStructIdx_init(&structIdx, pXmlBuf);
+	tagDesc.pStructIdx = &structIdx;
+
+	bool isMultiExist = pPathSet->singleNum < pPathSet->pathNum;
+	while(pXmlBuf->pos < pXmlBuf->end)
+	{
+		size_t tagStartPos = 0;
+		status = osXml_scanTag(pXmlBuf, false, false, &tagDesc, &tagStartPos);
+		if(status != OS_STATUS_OK)
+		{
+			logError("fails to osXml_scanTag for xml, pos=%ld.", pXmlBuf->pos);
+			goto EXIT;
+		}
+
+		//no more tag
+		if(!pTagInfo->tag.p)
+		{
+			break;
+		}
+
+		osPointerLen_t nsAlias, name;
+		osXml_singleDelimitParse(&pTagInfo->tag, ':', &nsAlias, &name);
+
+		int node = OS_XML_PATH_NO_NODE;
+		if(pTagInfo->isEndTag)
+		{
+			if(!depth)
+			{
+				logError("unexpected end tag(%r), pos=%ld.", &pTagInfo->tag, pXmlBuf->pos);
+				status = OS_ERROR_INVALID_VALUE;
+				goto EXIT;
+			}
+
+			node = nodeStack[--depth];
+			if(osPL_cmp(&name, &pPathSet->node[node].name) != 0)
+			{
+				logError("end tag(%r) does not match the start tag(%r), pos=%ld.", &pTagInfo->tag, &pPathSet->node[node].name, pXmlBuf->pos);
+				status = OS_ERROR_INVALID_VALUE;
+				goto EXIT;
+			}
+
+			osPointerLen_t value = {(char*)&pXmlBuf->buf[valueStartPos[depth]], tagStartPos - valueStartPos[depth]};
+			if(pPathSet->node[node].pathIdx == OS_XML_PATH_NO_NODE || (foundMask & (1ULL << pPathSet->node[node].pathIdx)))
+			{
+				//no path ends here, or the path is done
+				node = OS_XML_PATH_NO_NODE;
+			}
+			else if((status = osXmlPath_report(&pPathSet->node[node], &pTagInfo->tag, &value, callback, appData)) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+		}
+		else
+		{
+			node = osXmlPath_getChild(pPathSet, depth ? nodeStack[depth-1] : 0, &name);
+			if(node == OS_XML_PATH_NO_NODE)
+			{
+				//not on any path, skip the element and all its children
+				if(!pTagInfo->isTagDone && (status = osXmlPath_skipElem(pXmlBuf, &structIdx)) != OS_STATUS_OK)
+				{
+					logError("fails to skip element(%r).", &pTagInfo->tag);
+					goto EXIT;
+				}
+				continue;
+			}
+
+			if(pTagInfo->isTagDone)
+			{
+				//<element />, the value is empty
+				osPointerLen_t value = {(char*)&pXmlBuf->buf[pXmlBuf->pos], 0};
+				if(pPathSet->node[node].pathIdx == OS_XML_PATH_NO_NODE || (foundMask & (1ULL << pPathSet->node[node].pathIdx)))
+				{
+					node = OS_XML_PATH_NO_NODE;
+				}
+				else if((status = osXmlPath_report(&pPathSet->node[node], &pTagInfo->tag, &value, callback, appData)) != OS_STATUS_OK)
+				{
+					goto EXIT;
+				}
+			}
+			else
+			{
+				nodeStack[depth] = node;
+				valueStartPos[depth++] = pXmlBuf->pos;
+				continue;
+			}
+		}
+
+		//a path is reported
+		if(node != OS_XML_PATH_NO_NODE && !pPathSet->node[node].isMulti)
+		{
+			foundMask |= 1ULL << pPathSet->node[node].pathIdx;
+			if(++foundNum == pPathSet->singleNum && !isMultiExist)
+			{
+				mdebug(LM_XMLP, "all paths are found, stop at pos=%ld.", pXmlBuf->pos);
+				goto EXIT;
+			}
+		}
+
+		//the root element is done
+		if(pTagInfo->isEndTag && !depth)
+		{
+			goto EXIT;
+		}
+	}
+
+	if(depth)
+	{
+		logError("the xml ends before the end tag of element(%r).", &pPathSet->node[nodeStack[depth-1]].name);
+		status = OS_ERROR_INVALID_VALUE;
+	}
+
+EXIT:
+	osXmlTagDesc_reset(&tagDesc);
+	return status;
+}
+
+
+static int osXmlPath_getChild(const osXmlPathSet_t* pPathSet, int parent, osPointerLen_t* pName)
+{
+	for(int child = pPathSet->node[parent].firstChild; child != OS_XML_PATH_NO_NODE; child = pPathSet->node[child].nextSibling)
+	{
+		if(osPL_cmp(&pPathSet->node[child].name, pName) == 0)
+		{
+			return child;
+		}
+	}
+
+	return OS_XML_PATH_NO_NODE;
+}
+
+
+static osXsdElement_t* osXmlPath_getXsdChild(osXsdElement_t* pParentElem, osPointerLen_t* pName)
+{
+	if(!pParentElem || pParentElem->dataType != OS_XML_DATA_TYPE_COMPLEX || !pParentElem->pComplex)
+	{
+		return NULL;
+	}
+
+	osListElement_t* pLE = pParentElem->pComplex->elemList.head;
+	while(pLE)
+	{
+		osXsdElement_t* pElem = pLE->data;
+		if(pElem->dataType != OS_XML_DATA_TYPE_ANY && osPL_cmp(&pElem->elemName, pName) == 0)
+		{
+			return pElem;
+		}
+
+		pLE = pLE->next;
+	}
+
+	return NULL;
+}
+
+
+//the value of a simple type element is converted per its xsd data type, all other values are reported as xs:string
+static osStatus_e osXmlPath_report(const osXmlPathNode_t* pNode, osPointerLen_t* pTag, osPointerLen_t* pValue, osXmlDataCallback_h callback, void* appData)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXmlData_t xmlData = {};
+
+	xmlData.eDataName = pNode->eDataName;
+	osXml_singleDelimitParse(pTag, ':', &xmlData.nsAlias, &xmlData.dataName);
+	xmlData.isEOT = true;
+
+	osXsdElement_t* pXsdElem = pNode->pXsdElem;
+	if(pXsdElem && osXml_isXsdElemSimpleType(pXsdElem))
+	{
+		if(pXsdElem->dataType == OS_XML_DATA_TYPE_SIMPLE)
+		{
+			status = osXmlSimpleType_convertData(pXsdElem->pSimple, pValue, &xmlData);
+		}
+		else
+		{
+			status = osXmlXSType_convertData(&pXsdElem->elemName, pValue, pXsdElem->dataType, &xmlData);
+		}
+	}
+	else
+	{
+		status = osXmlXSType_convertData(&xmlData.dataName, pValue, OS_XML_DATA_TYPE_XS_STRING, &xmlData);
+	}
+
+	if(status != OS_STATUS_OK)
+	{
+		logError("fails to convert the value(%r) of element(%r).", pValue, pTag);
+		return status;
+	}
+
+	callback(&xmlData, NULL, appData);
+	return status;
+}
+
+
+/* skip a element whose start tag has been scanned, pBuf->pos is right after the '>' of the start tag.  Only the tag
+ * boundaries are checked: the nested start and end tags are counted until the matching end tag, the comments, CDATA
+ * sections and processing instructions are skipped as a whole, no tag name or attribute is parsed.  When returns,
+ * pBuf->pos is right after the '>' of the matching end tag.
+ */
+static osStatus_e osXmlPath_skipElem(osMBuf_t* pBuf, osXmlStructIdx_t* pIdx)
+{
+	int depth = 1;
+	size_t pos = pBuf->pos;
+	while(depth > 0)
+	{
+		pos = osXmlStructIdx_next(pIdx, pos);
+		if(pos + 1 >= pBuf->end)
+		{
+			logError("the xml ends inside a element, depth=%d.", depth);
+			return OS_ERROR_INVALID_VALUE;
+		}
+
+		//only '<' matters in the element content
+		if(pBuf->buf[pos] != '<')
+		{
+			pos++;
+			continue;
+		}
+
+		switch(pBuf->buf[pos+1])
+		{
+			case '!':
+				if(pos + 4 <= pBuf->end && pBuf->buf[pos+2] == '-' && pBuf->buf[pos+3] == '-')
+				{
+					pos += 4;
+					if(!osXmlPath_skipPast(pBuf, &pos, "-->", 3))
+					{
+						return OS_ERROR_INVALID_VALUE;
+					}
+				}
+				else if(pos + 9 <= pBuf->end && strncmp((char*)&pBuf->buf[pos+2], "[CDATA[", 7) == 0)
+				{
+					pos += 9;
+					if(!osXmlPath_skipPast(pBuf, &pos, "]]>", 3))
+					{
+						return OS_ERROR_INVALID_VALUE;
+					}
+				}
+				else if(!osXmlPath_skipPast(pBuf, &pos, ">", 1))
+				{
+					return OS_ERROR_INVALID_VALUE;
+				}
+				break;
+			case '?':
+				pos += 2;
+				if(!osXmlPath_skipPast(pBuf, &pos, "?>", 2))
+				{
+					return OS_ERROR_INVALID_VALUE;
+				}
+				break;
+			case '/':
+				pos += 2;
+				if(!osXmlPath_skipPast(pBuf, &pos, ">", 1))
+				{
+					return OS_ERROR_INVALID_VALUE;
+				}
+				depth--;
+				break;
+			default:
+				//a start tag, a '>' inside a attribute value is not the end of the tag
+				for(pos++; ; )
+				{
+					pos = osXmlStructIdx_next(pIdx, pos);
+					if(pos >= pBuf->end || pBuf->buf[pos] == '<')
+					{
+						logError("a start tag is not closed, pos=%ld.", pos);
+						return OS_ERROR_INVALID_VALUE;
+					}
+
+					if(pBuf->buf[pos] == '>')
+					{
+						break;
+					}
+
+					//a quote, skip to the closing one
+					pos++;
+					ssize_t n = osScan_findChar(&pBuf->buf[pos], pBuf->end - pos, pBuf->buf[pos-1]);
+					if(n < 0)
+					{
+						logError("a attribute value is not closed, pos=%ld.", pos);
+						return OS_ERROR_INVALID_VALUE;
+					}
+					pos += n + 1;
+				}
+
+				//<element ... /> does not have a end tag
+				if(pBuf->buf[pos-1] != '/')
+				{
+					depth++;
+				}
+				pos++;
+				break;
+		}
+	}
+
+	pBuf->pos = pos;
+	return OS_STATUS_OK;
+}
+
+
+//move *pPos to right after the first pattern at or after *pPos
+static bool osXmlPath_skipPast(osMBuf_t* pBuf, size_t* pPos, const char* pattern, size_t patternLen)
+{
+	ssize_t n = osScan_findStr(&pBuf->buf[*pPos], pBuf->end - *pPos, pattern, patternLen);
+	if(n < 0)
+	{
+		logError("pattern(%s) is not found after pos=%ld.", pattern, *pPos);
+		return false;
+	}
+
+	*pPos += n + patternLen;
+	return true;
+}
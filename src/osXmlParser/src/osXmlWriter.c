@@ -0,0 +1,1190 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osXmlWriter.c
+ * write a xml document element by element into a mbuf or a chained buffer.  The element tags are precompiled, the
+ * values are escaped only when they contain a char to be escaped, and the numbers are formatted in place.  If a xsd
+ * is provided, each element is checked against the xsd when it is written.
+ ********************************************************/
+
+#include <string.h>
+
+#include "osMBuf.h"
+#include "osMBufChain.h"
+#include "osPL.h"
+#include "osList.h"
+#include "osDebug.h"
+#include "osMemory.h"
+#include "osMisc.h"
+#include "osAtom.h"
+#include "osScan.h"
+
+#include "osXmlParser.h"
+#include "osXsdParser.h"
+#include "osXmlParserCommon.h"
+#include "osXmlParserSType.h"
+
+
+#define OS_XML_WRITER_DECL	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+
+
+struct osXmlWriterTag {
+	osPointerLen_t nsAlias;		//empty if the element has no ns alias
+	osPointerLen_t name;		//element name without ns alias
+	osAtom_t nameAtom;			//osAtom_find() of name, OS_ATOM_NONE if name is not interned, in which case it is not a xsd element
+	osPointerLen_t openTag;		//"<alias:name"
+	osPointerLen_t closeTag;	//"</alias:name>"
+};	//followed by the string pool that openTag and closeTag refer
+
+
+//a element that is started but not ended yet
+typedef struct {
+	const osXmlWriterTag_t* pTag;
+	osXsdElement_t* pXsdElem;	//NULL if the element is not checked against the xsd, like a element under a <xs:any>
+	bool isValueWritten;		//a value of a simple type element has been written
+	//the children are checked as they are written, only the last child and a bitmap of the written children are kept
+	osXsdElement_t* pLastChild;	//the xsd of the last written child
+	int lastChildIdx;			//the elemList idx of pLastChild
+	int lastChildCount;			//the number of the consecutive children of lastChildIdx
+	uint64_t childMask;			//bit i is set if a child of elemList idx i has been written
+} osXmlWriterElem_t;
+
+
+struct osXmlWriter {
+	osMBuf_t* pBuf;				//the target mbuf, NULL if the target is pChain
+	osMBufChain_t* pChain;
+	osMBuf_t* pSegBuf;			//for a chain target, the writer owned buffer the document is written into, pSegBuf->buf[flushPos, end) has not been appended to pChain
+	size_t flushPos;
+	osStatus_e status;			//the first error, nothing is written after a error
+	bool isStartTagOpen;		//the start tag of the top element is not closed by '>' yet, a attribute can still be added
+	bool isRootDone;
+	bool isXsd;
+	bool isEmptyTargetNS;
+	osPointerLen_t xsdName;
+	osScanSet_t textSet;		//the chars to be escaped in a element value
+	osScanSet_t attrSet;		//the chars to be escaped in a attribute value
+	int depth;
+	osXmlWriterElem_t elem[OS_XML_WRITER_MAX_DEPTH];
+};
+
+
+static bool osXmlWriter_isName(const osPointerLen_t* pName);
+static bool osXmlWriter_isAttrName(const osPointerLen_t* pName);
+static uint8_t* osXmlWriter_grow(osXmlWriter_t* pWriter, size_t len);
+static osStatus_e osXmlWriter_flush(osXmlWriter_t* pWriter);
+static bool osXmlWriter_writeEscaped(osXmlWriter_t* pWriter, const osPointerLen_t* pValue, const osScanSet_t* pSet);
+static bool osXmlWriter_closeStartTag(osXmlWriter_t* pWriter);
+static osStatus_e osXmlWriter_checkChild(osXmlWriter_t* pWriter, const osPointerLen_t* pName, osAtom_t nameAtom, osXsdElement_t** ppXsdElem);
+static osStatus_e osXmlWriter_checkMinOccurs(osXmlWriterElem_t* pElem);
+static osStatus_e osXmlWriter_checkEnd(osXmlWriterElem_t* pElem);
+static osStatus_e osXmlWriter_checkValue(osXsdElement_t* pXsdElem, osXmlDataType_e dataType, osPointerLen_t* pValue);
+static osStatus_e osXmlWriter_value(osXmlWriter_t* pWriter, const osXmlData_t* pXmlData);
+static osStatus_e osXmlWriter_number(osXmlWriter_t* pWriter, uint64_t value, bool isNegative);
+static osStatus_e osXmlWriter_dataLeaf(osXmlWriter_t* pWriter, const osPointerLen_t* pNsAlias, osXsdElement_t* pXsdElem, const osXmlData_t* pXmlData);
+
+
+static inline osMBuf_t* osXmlWriter_getMBuf(osXmlWriter_t* pWriter)
+{
+	return pWriter->pBuf ? pWriter->pBuf : pWriter->pSegBuf;
+}
+
+
+//return the position to write len bytes, the position is valid until osXmlWriter_commit()
+static inline uint8_t* osXmlWriter_reserve(osXmlWriter_t* pWriter, size_t len)
+{
+	osMBuf_t* pMBuf = osXmlWriter_getMBuf(pWriter);
+	if(pMBuf && pMBuf->size - pMBuf->pos >= len)
+	{
+		return &pMBuf->buf[pMBuf->pos];
+	}
+
+	return osXmlWriter_grow(pWriter, len);
+}
+
+
+static inline void osXmlWriter_commit(osXmlWriter_t* pWriter, size_t len)
+{
+	osMBuf_t* pMBuf = osXmlWriter_getMBuf(pWriter);
+	pMBuf->pos += len;
+	if(pMBuf->end < pMBuf->pos)
+	{
+		pMBuf->end = pMBuf->pos;
+	}
+}
+
+
+static inline bool osXmlWriter_write(osXmlWriter_t* pWriter, const void* data, size_t len)
+{
+	uint8_t* p = osXmlWriter_reserve(pWriter, len);
+	if(!p)
+	{
+		return false;
+	}
+
+	memcpy(p, data, len);
+	osXmlWriter_commit(pWriter, len);
+	return true;
+}
+
+
+static inline bool osXmlWriter_writePL(osXmlWriter_t* pWriter, const osPointerLen_t* pl)
+{
+	return osXmlWriter_write(pWriter, pl->p, pl->l);
+}
+
+
+/* create a xml writer.  The document is written into pBuf from pBuf->pos, pBuf grows when needed.  If pBuf is NULL, the
+ * document is appended to pChain, the writer writes into its own buffers and appends them to pChain by reference, the
+ * data in pChain is complete after osXmlWriter_finish().
+ *
+ * pBuf:      IN, the target mbuf, NULL if the target is pChain
+ * pChain:    IN, the target chain, only relevant when pBuf is NULL
+ * xsdName:   IN, the name of a parsed xsd, if not NULL, each element is checked against the xsd when it is written: a element
+ *            shall be a root element or a child of its parent element in the xsd, the children of a sequence shall be in the
+ *            xsd order and within maxOccurs, minOccurs is checked when the parent element ends, and a value shall match the
+ *            xsd data type and facets.  The xsd shall not be freed while the writer is used
+ * isXmlDecl: IN, whether to write <?xml version="1.0" encoding="UTF-8"?> in the beginning
+ *
+ * return the writer, to be freed by osXmlWriter_finish()
+ */
+osXmlWriter_t* osXmlWriter_create(osMBuf_t* pBuf, osMBufChain_t* pChain, osPointerLen_t* xsdName, bool isXmlDecl)
+{
+	if(!pBuf && !pChain)
+	{
+		logError("null pointer, pBuf and pChain.");
+		return NULL;
+	}
+
+	bool isEmptyTargetNS = false;
+	if(xsdName)
+	{
+		osVec_t schemaVec = {};
+		if(osXsd_getSchemas(xsdName, &schemaVec, &isEmptyTargetNS) != OS_STATUS_OK)
+		{
+			logError("xsd(%r) has not been parsed.", xsdName);
+			return NULL;
+		}
+		osVec_clear(&schemaVec);
+	}
+
+	osXmlWriter_t* pWriter = oszalloc(sizeof(osXmlWriter_t), NULL);
+	if(!pWriter)
+	{
+		logError("fails to allocate pWriter.");
+		return NULL;
+	}
+
+	pWriter->pBuf = pBuf;
+	pWriter->pChain = pBuf ? NULL : pChain;
+	if(xsdName)
+	{
+		pWriter->isXsd = true;
+		pWriter->isEmptyTargetNS = isEmptyTargetNS;
+		pWriter->xsdName = *xsdName;
+	}
+	osScan_initSet(&pWriter->textSet, "&<>", 3);
+	osScan_initSet(&pWriter->attrSet, "&<>\"", 4);
+
+	if(isXmlDecl && !osXmlWriter_write(pWriter, OS_XML_WRITER_DECL, sizeof(OS_XML_WRITER_DECL) - 1))
+	{
+		osXmlWriter_finish(pWriter);
+		return NULL;
+	}
+
+	return pWriter;
+}
+
+
+/* complete the document and free pWriter.  For a chain target, the rest of the document is appended to the chain.
+ * If any write has failed, or a element is not ended, a error is returned, the target contains a partial document and
+ * shall be discarded.
+ */
+osStatus_e osXmlWriter_finish(osXmlWriter_t* pWriter)
+{
+	if(!pWriter)
+	{
+		logError("null pointer, pWriter.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	osStatus_e status = pWriter->status;
+	if(status == OS_STATUS_OK && (pWriter->depth || !pWriter->isRootDone))
+	{
+		logError("the document is not complete, depth=%d.", pWriter->depth);
+		status = OS_ERROR_INVALID_VALUE;
+	}
+
+	if(status == OS_STATUS_OK)
+	{
+		status = osXmlWriter_flush(pWriter);
+	}
+
+	osMBuf_dealloc(pWriter->pSegBuf);
+	osfree(pWriter);
+
+	return status;
+}
+
+
+/* precompile the start tag "<alias:name" and the end tag "</alias:name>" of a element.  The element name is checked once
+ * here, so it is written as is afterwards.
+ *
+ * nsAlias: IN, the ns alias of the element, NULL or empty if the element has no ns alias
+ * name:    IN, the element name without ns alias, it is copied, the caller does not need to keep it
+ *
+ * return the tag, to be freed via osfree(), NULL if nsAlias or name is not a valid xml name
+ */
+osXmlWriterTag_t* osXmlWriter_compileTag(const osPointerLen_t* nsAlias, const osPointerLen_t* name)
+{
+	if(!name || !osXmlWriter_isName(name) || (nsAlias && nsAlias->l && !osXmlWriter_isName(nsAlias)))
+	{
+		logError("invalid element name(%r) or ns alias(%r).", name, nsAlias);
+		return NULL;
+	}
+
+	size_t aliasLen = nsAlias ? nsAlias->l : 0;
+	size_t qNameLen = aliasLen ? aliasLen + 1 + name->l : name->l;
+	osXmlWriterTag_t* pTag = oszalloc(sizeof(osXmlWriterTag_t) + qNameLen * 2 + 4, NULL);
+	if(!pTag)
+	{
+		logError("fails to allocate pTag for element(%r).", name);
+		return NULL;
+	}
+
+	//the pool is "<alias:name</alias:name>"
+	char* pPool = (char*)(pTag + 1);
+	char* p = pPool;
+	*p++ = '<';
+	if(aliasLen)
+	{
+		memcpy(p, nsAlias->p, aliasLen);
+		p += aliasLen;
+		*p++ = ':';
+	}
+	memcpy(p, name->p, name->l);
+	p += name->l;
+
+	pTag->openTag = (osPointerLen_t){pPool, qNameLen + 1};
+	pTag->nsAlias = (osPointerLen_t){aliasLen ? pPool + 1 : NULL, aliasLen};
+	pTag->name = (osPointerLen_t){pPool + 1 + (aliasLen ? aliasLen + 1 : 0), name->l};
+	pTag->nameAtom = osAtom_find(&pTag->name, false);
+
+	pTag->closeTag = (osPointerLen_t){p, qNameLen + 3};
+	*p++ = '<';
+	*p++ = '/';
+	memcpy(p, pPool + 1, qNameLen);
+	p += qNameLen;
+	*p = '>';
+
+	return pTag;
+}
+
+
+osStatus_e osXmlWriter_startElem(osXmlWriter_t* pWriter, const osXmlWriterTag_t* pTag)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXsdElement_t* pXsdElem = NULL;
+
+	if(!pWriter || !pTag)
+	{
+		logError("null pointer, pWriter=%p, pTag=%p.", pWriter, pTag);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	if(pWriter->isRootDone || pWriter->depth >= OS_XML_WRITER_MAX_DEPTH)
+	{
+		logError("element(%r) is after the root element, or deeper than %d.", &pTag->name, OS_XML_WRITER_MAX_DEPTH);
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	if(pWriter->isXsd && (status = osXmlWriter_checkChild(pWriter, &pTag->name, pTag->nameAtom, &pXsdElem)) != OS_STATUS_OK)
+	{
+		goto EXIT;
+	}
+
+	if(!osXmlWriter_closeStartTag(pWriter) || !osXmlWriter_writePL(pWriter, &pTag->openTag))
+	{
+		status = pWriter->status;
+		goto EXIT;
+	}
+
+	osXmlWriterElem_t* pElem = &pWriter->elem[pWriter->depth++];
+	pElem->pTag = pTag;
+	pElem->pXsdElem = pXsdElem;
+	pElem->isValueWritten = false;
+	pElem->pLastChild = NULL;
+	pElem->lastChildIdx = -1;
+	pElem->lastChildCount = 0;
+	pElem->childMask = 0;
+	pWriter->isStartTagOpen = true;
+
+EXIT:
+	if(status != OS_STATUS_OK)
+	{
+		pWriter->status = status;
+	}
+	return status;
+}
+
+
+//an element without value and children is written as <tag/>
+osStatus_e osXmlWriter_endElem(osXmlWriter_t* pWriter)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(!pWriter)
+	{
+		logError("null pointer, pWriter.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	if(!pWriter->depth)
+	{
+		logError("there is no element to end.");
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	osXmlWriterElem_t* pElem = &pWriter->elem[pWriter->depth - 1];
+	if((status = osXmlWriter_checkEnd(pElem)) != OS_STATUS_OK)
+	{
+		goto EXIT;
+	}
+
+	if(pWriter->isStartTagOpen)
+	{
+		pWriter->isStartTagOpen = false;
+		if(!osXmlWriter_write(pWriter, "/>", 2))
+		{
+			status = pWriter->status;
+			goto EXIT;
+		}
+	}
+	else if(!osXmlWriter_writePL(pWriter, &pElem->pTag->closeTag))
+	{
+		status = pWriter->status;
+		goto EXIT;
+	}
+
+	if(--pWriter->depth == 0)
+	{
+		pWriter->isRootDone = true;
+	}
+
+EXIT:
+	if(status != OS_STATUS_OK)
+	{
+		pWriter->status = status;
+	}
+	return status;
+}
+
+
+osStatus_e osXmlWriter_attr(osXmlWriter_t* pWriter, const osPointerLen_t* name, const osPointerLen_t* value)
+{
+	if(!pWriter || !name || !value)
+	{
+		logError("null pointer, pWriter=%p, name=%p, value=%p.", pWriter, name, value);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	if(!pWriter->isStartTagOpen || !osXmlWriter_isAttrName(name))
+	{
+		logError("attribute(%r) is not right after a start tag, or has invalid name.", name);
+		pWriter->status = OS_ERROR_INVALID_VALUE;
+		return pWriter->status;
+	}
+
+	if(!osXmlWriter_write(pWriter, " ", 1) || !osXmlWriter_writePL(pWriter, name) || !osXmlWriter_write(pWriter, "=\"", 2) || !osXmlWriter_writeEscaped(pWriter, value, &pWriter->attrSet) || !osXmlWriter_write(pWriter, "\"", 1))
+	{
+		return pWriter->status;
+	}
+
+	return OS_STATUS_OK;
+}
+
+
+osStatus_e osXmlWriter_nsDecl(osXmlWriter_t* pWriter, const osPointerLen_t* nsAlias, const osPointerLen_t* ns)
+{
+	if(!pWriter || !ns)
+	{
+		logError("null pointer, pWriter=%p, ns=%p.", pWriter, ns);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(!nsAlias || !nsAlias->l)
+	{
+		osPointerLen_t xmlns = {"xmlns", 5};
+		return osXmlWriter_attr(pWriter, &xmlns, ns);
+	}
+
+	if(!osXmlWriter_isName(nsAlias))
+	{
+		logError("invalid ns alias(%r).", nsAlias);
+		pWriter->status = OS_ERROR_INVALID_VALUE;
+		return pWriter->status;
+	}
+
+	char name[nsAlias->l + 6];
+	memcpy(name, "xmlns:", 6);
+	memcpy(&name[6], nsAlias->p, nsAlias->l);
+	osPointerLen_t xmlnsAlias = {name, nsAlias->l + 6};
+	return osXmlWriter_attr(pWriter, &xmlnsAlias, ns);
+}
+
+
+osStatus_e osXmlWriter_str(osXmlWriter_t* pWriter, const osPointerLen_t* value)
+{
+	if(!pWriter || !value)
+	{
+		logError("null pointer, pWriter=%p, value=%p.", pWriter, value);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	osXmlData_t xmlData = {.dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = *value};
+	return osXmlWriter_value(pWriter, &xmlData);
+}
+
+
+osStatus_e osXmlWriter_int(osXmlWriter_t* pWriter, int64_t value)
+{
+	if(!pWriter)
+	{
+		logError("null pointer, pWriter.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	if(!pWriter->depth)
+	{
+		logError("there is no element for the value.");
+		pWriter->status = OS_ERROR_INVALID_VALUE;
+		return pWriter->status;
+	}
+
+	return osXmlWriter_number(pWriter, value < 0 ? -(uint64_t)value : value, value < 0);
+}
+
+
+osStatus_e osXmlWriter_bool(osXmlWriter_t* pWriter, bool value)
+{
+	if(!pWriter)
+	{
+		logError("null pointer, pWriter.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	osXmlData_t xmlData = {.dataType = OS_XML_DATA_TYPE_XS_BOOLEAN, .xmlIsTrue = value};
+	return osXmlWriter_value(pWriter, &xmlData);
+}
+
+
+osStatus_e osXmlWriter_leaf(osXmlWriter_t* pWriter, const osXmlWriterTag_t* pTag, const osXmlData_t* pXmlData)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(!pWriter || !pTag || !pXmlData)
+	{
+		logError("null pointer, pWriter=%p, pTag=%p, pXmlData=%p.", pWriter, pTag, pXmlData);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if((status = osXmlWriter_startElem(pWriter, pTag)) != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	if((status = osXmlWriter_value(pWriter, pXmlData)) != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	return osXmlWriter_endElem(pWriter);
+}
+
+
+/* write the leaf children of the current element in the xsd order, no matter what the order of xmlData is.  Each xmlData[i]
+ * is the value of a child element named xmlData[i].dataName, the value is taken per xmlData[i].dataType as in
+ * osXmlWriter_leaf().  A child of the same name may have multiple xmlData entries, they are written in the xmlData order.
+ * The child elements take the ns alias of the current element.
+ *
+ * The children are checked the same as the ones written by osXmlWriter_startElem(), so the children written by this
+ * function shall not be before the children that have been written in a sequence.
+ */
+osStatus_e osXmlWriter_writeData(osXmlWriter_t* pWriter, const osXmlData_t* xmlData, uint32_t dataNum)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(!pWriter || !xmlData)
+	{
+		logError("null pointer, pWriter=%p, xmlData=%p.", pWriter, xmlData);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	osXmlWriterElem_t* pElem = pWriter->depth ? &pWriter->elem[pWriter->depth - 1] : NULL;
+	if(!pWriter->isXsd || !pElem || !pElem->pXsdElem || pElem->pXsdElem->dataType != OS_XML_DATA_TYPE_COMPLEX)
+	{
+		logError("the writer has no xsd, or the current element is not a xsd complex type element.");
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	uint32_t writtenNum = 0;
+	osListElement_t* pLE = pElem->pXsdElem->pComplex->elemList.head;
+	while(pLE && writtenNum < dataNum)
+	{
+		osXsdElement_t* pChildElem = pLE->data;
+		pLE = pLE->next;
+		if(pChildElem->dataType == OS_XML_DATA_TYPE_ANY)
+		{
+			continue;
+		}
+
+		for(uint32_t i=0; i<dataNum; i++)
+		{
+			if(osPL_cmp(&xmlData[i].dataName, &pChildElem->elemName) != 0)
+			{
+				continue;
+			}
+
+			if(!osXml_isXsdElemSimpleType(pChildElem))
+			{
+				logError("element(%r) is not a leaf element.", &pChildElem->elemName);
+				status = OS_ERROR_INVALID_VALUE;
+				goto EXIT;
+			}
+
+			if((status = osXmlWriter_dataLeaf(pWriter, &pElem->pTag->nsAlias, pChildElem, &xmlData[i])) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+			writtenNum++;
+		}
+	}
+
+	if(writtenNum < dataNum)
+	{
+		logError("%d of %d data are not the child of element(%r).", dataNum - writtenNum, dataNum, &pElem->pTag->name);
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+EXIT:
+	if(status != OS_STATUS_OK)
+	{
+		pWriter->status = status;
+	}
+	return status;
+}
+
+
+//a xml name, the ':' is not allowed since the ns alias and the name are passed separately
+static bool osXmlWriter_isName(const osPointerLen_t* pName)
+{
+	if(!pName->p || !pName->l)
+	{
+		return false;
+	}
+
+	for(size_t i=0; i<pName->l; i++)
+	{
+		uint8_t c = pName->p[i];
+		if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80)
+		{
+			continue;
+		}
+
+		if(i && ((c >= '0' && c <= '9') || c == '-' || c == '.'))
+		{
+			continue;
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+
+//a attribute name, may have one ':' between a prefix and the local name, like xmlns:sh or xsi:type
+static bool osXmlWriter_isAttrName(const osPointerLen_t* pName)
+{
+	if(!pName->p || !pName->l)
+	{
+		return false;
+	}
+
+	const char* pColon = memchr(pName->p, ':', pName->l);
+	if(!pColon)
+	{
+		return osXmlWriter_isName(pName);
+	}
+
+	osPointerLen_t prefix = {pName->p, pColon - pName->p};
+	osPointerLen_t localName = {pColon + 1, pName->l - prefix.l - 1};
+	return osXmlWriter_isName(&prefix) && osXmlWriter_isName(&localName);
+}
+
+
+/* get a buffer that has at least len bytes free.  A mbuf target is reallocated, the written data is kept.  For a chain
+ * target, the written data is appended to the chain, and a new buffer is allocated, the chain keeps a reference of the
+ * old buffer.
+ */
+static uint8_t* osXmlWriter_grow(osXmlWriter_t* pWriter, size_t len)
+{
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return NULL;
+	}
+
+	if(pWriter->pBuf)
+	{
+		osMBuf_t* pBuf = pWriter->pBuf;
+		size_t size = pBuf->size ? pBuf->size * 2 : OS_XML_WRITER_SEG_SIZE;
+		if(size < pBuf->pos + len)
+		{
+			size = pBuf->pos + len;
+		}
+
+		if(osMBuf_realloc(pBuf, size) != 0)
+		{
+			logError("fails to osMBuf_realloc, size=%ld.", size);
+			pWriter->status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			return NULL;
+		}
+
+		return &pBuf->buf[pBuf->pos];
+	}
+
+	if(osXmlWriter_flush(pWriter) != OS_STATUS_OK)
+	{
+		return NULL;
+	}
+
+	osMBuf_dealloc(pWriter->pSegBuf);
+	pWriter->flushPos = 0;
+	pWriter->pSegBuf = osMBuf_alloc(len > OS_XML_WRITER_SEG_SIZE ? len : OS_XML_WRITER_SEG_SIZE);
+	if(!pWriter->pSegBuf)
+	{
+		logError("fails to allocate pSegBuf, len=%ld.", len);
+		pWriter->status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+		return NULL;
+	}
+
+	return pWriter->pSegBuf->buf;
+}
+
+
+//append the data written after the last flush to the chain target
+static osStatus_e osXmlWriter_flush(osXmlWriter_t* pWriter)
+{
+	osMBuf_t* pSegBuf = pWriter->pSegBuf;
+	if(!pWriter->pChain || !pSegBuf || pSegBuf->end == pWriter->flushPos)
+	{
+		return OS_STATUS_OK;
+	}
+
+	if(osMBufChain_appendRef(pWriter->pChain, pSegBuf, pWriter->flushPos, pSegBuf->end - pWriter->flushPos) != 0)
+	{
+		logError("fails to osMBufChain_appendRef, len=%ld.", pSegBuf->end - pWriter->flushPos);
+		pWriter->status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+		return pWriter->status;
+	}
+
+	pWriter->flushPos = pSegBuf->end;
+	return OS_STATUS_OK;
+}
+
+
+//a value without any char in pSet is written in one copy
+static bool osXmlWriter_writeEscaped(osXmlWriter_t* pWriter, const osPointerLen_t* pValue, const osScanSet_t* pSet)
+{
+	const char* p = pValue->p;
+	size_t len = pValue->l;
+	while(len)
+	{
+		ssize_t i = osScan_findSet(p, len, pSet);
+		if(i < 0)
+		{
+			return osXmlWriter_write(pWriter, p, len);
+		}
+
+		if(i && !osXmlWriter_write(pWriter, p, i))
+		{
+			return false;
+		}
+
+		bool isWritten;
+		switch(p[i])
+		{
+			case '&':
+				isWritten = osXmlWriter_write(pWriter, "&amp;", 5);
+				break;
+			case '<':
+				isWritten = osXmlWriter_write(pWriter, "&lt;", 4);
+				break;
+			case '>':
+				isWritten = osXmlWriter_write(pWriter, "&gt;", 4);
+				break;
+			default:
+				isWritten = osXmlWriter_write(pWriter, "&quot;", 6);
+				break;
+		}
+
+		if(!isWritten)
+		{
+			return false;
+		}
+
+		p += i + 1;
+		len -= i + 1;
+	}
+
+	return true;
+}
+
+
+static bool osXmlWriter_closeStartTag(osXmlWriter_t* pWriter)
+{
+	if(!pWriter->isStartTagOpen)
+	{
+		return true;
+	}
+
+	pWriter->isStartTagOpen = false;
+	return osXmlWriter_write(pWriter, ">", 1);
+}
+
+
+/* check a element against the xsd of its parent, which is the current element, and count it in the parent.  *ppXsdElem
+ * is set to NULL if the element is not checked, i.e., it is under a element that is not checked, or it matches a <xs:any>.
+ */
+static osStatus_e osXmlWriter_checkChild(osXmlWriter_t* pWriter, const osPointerLen_t* pName, osAtom_t nameAtom, osXsdElement_t** ppXsdElem)
+{
+	*ppXsdElem = NULL;
+
+	if(!pWriter->depth)
+	{
+		*ppXsdElem = osXsd_getNSRootElem(&pWriter->xsdName, pWriter->isEmptyTargetNS, (osPointerLen_t*)pName);
+		if(!*ppXsdElem)
+		{
+			logError("element(%r) is not a root element of xsd(%r).", pName, &pWriter->xsdName);
+			return OS_ERROR_INVALID_VALUE;
+		}
+
+		return OS_STATUS_OK;
+	}
+
+	osXmlWriterElem_t* pParent = &pWriter->elem[pWriter->depth - 1];
+	osXsdElement_t* pParentXsdElem = pParent->pXsdElem;
+	if(!pParentXsdElem || pParentXsdElem->dataType == OS_XML_DATA_TYPE_ANY)
+	{
+		return OS_STATUS_OK;
+	}
+
+	if(pParentXsdElem->dataType != OS_XML_DATA_TYPE_COMPLEX || pParent->isValueWritten)
+	{
+		logError("element(%r) can not have child element(%r).", &pParentXsdElem->elemName, pName);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	//all xsd element names are interned, a name that is not interned can only match a <xs:any>
+	osXmlComplexType_t* pCT = pParentXsdElem->pComplex;
+	int listIdx = -1;
+	if(nameAtom != OS_ATOM_NONE)
+	{
+		if(pCT->pChildIndex)
+		{
+			*ppXsdElem = osXsd_atomIndex_get(pCT->pChildIndex, nameAtom, &listIdx);
+		}
+		else
+		{
+			osListElement_t* pLE = pCT->elemList.head;
+			while(pLE)
+			{
+				listIdx++;
+				if(osAtom_isPLEqual(nameAtom, pName, ((osXsdElement_t*)pLE->data)->elemNameAtom, &((osXsdElement_t*)pLE->data)->elemName))
+				{
+					*ppXsdElem = pLE->data;
+					break;
+				}
+				pLE = pLE->next;
+			}
+		}
+	}
+
+	if(!*ppXsdElem)
+	{
+		osListElement_t* pLE = pCT->elemList.head;
+		while(pLE)
+		{
+			if(((osXsdElement_t*)pLE->data)->dataType == OS_XML_DATA_TYPE_ANY)
+			{
+				return OS_STATUS_OK;
+			}
+			pLE = pLE->next;
+		}
+
+		logError("element(%r) is not a child of element(%r).", pName, &pParentXsdElem->elemName);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	if(listIdx >= OS_XSD_COMPLEX_TYPE_MAX_ALLOWED_CHILD_ELEM)
+	{
+		logError("element(%r) exceeds the maximum allowed child elements of element(%r).", pName, &pParentXsdElem->elemName);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	uint64_t childBit = 1ULL << listIdx;
+	if(listIdx == pParent->lastChildIdx)
+	{
+		pParent->lastChildCount++;
+	}
+	else
+	{
+		if(pCT->elemDispType == OS_XML_ELEMENT_DISP_TYPE_SEQUENCE)
+		{
+			if(listIdx < pParent->lastChildIdx)
+			{
+				logError("element(%r) is out of the xsd sequence order of element(%r).", pName, &pParentXsdElem->elemName);
+				return OS_ERROR_INVALID_VALUE;
+			}
+
+			//the children of the previous idx are done
+			osStatus_e status = osXmlWriter_checkMinOccurs(pParent);
+			if(status != OS_STATUS_OK)
+			{
+				return status;
+			}
+		}
+		else if(pParent->childMask & childBit)
+		{
+			//a child of <xs:all> appears at most once
+			logError("element(%r) appears more than once in element(%r).", pName, &pParentXsdElem->elemName);
+			return OS_ERROR_INVALID_VALUE;
+		}
+
+		pParent->pLastChild = *ppXsdElem;
+		pParent->lastChildIdx = listIdx;
+		pParent->lastChildCount = 1;
+	}
+
+	if((*ppXsdElem)->maxOccurs != -1 && pParent->lastChildCount > (*ppXsdElem)->maxOccurs)
+	{
+		logError("element(%r) exceeds maxOccurs(%d).", pName, (*ppXsdElem)->maxOccurs);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	pParent->childMask |= childBit;
+
+	return OS_STATUS_OK;
+}
+
+
+//check the minOccurs of the last written child, called when the children of lastChildIdx are done
+static osStatus_e osXmlWriter_checkMinOccurs(osXmlWriterElem_t* pElem)
+{
+	osXsdElement_t* pChildElem = pElem->pLastChild;
+	if(pChildElem && !pChildElem->pChoiceInfo && pElem->lastChildCount < pChildElem->minOccurs)
+	{
+		logError("element(%r) requires minOccurs(%d) child element(%r), %d is written.", &pElem->pXsdElem->elemName, pChildElem->minOccurs, &pChildElem->elemName, pElem->lastChildCount);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	return OS_STATUS_OK;
+}
+
+
+/* check a element against the xsd when it ends.  A simple type element without value is checked with a empty value, and
+ * a complex type element is checked for the minOccurs of its children, a child in a choice block is not checked.
+ */
+static osStatus_e osXmlWriter_checkEnd(osXmlWriterElem_t* pElem)
+{
+	if(!pElem->pXsdElem)
+	{
+		return OS_STATUS_OK;
+	}
+
+	if(osXml_isXsdElemSimpleType(pElem->pXsdElem))
+	{
+		osPointerLen_t value = {"", 0};
+		return pElem->isValueWritten ? OS_STATUS_OK : osXmlWriter_checkValue(pElem->pXsdElem, OS_XML_DATA_TYPE_XS_STRING, &value);
+	}
+
+	if(pElem->pXsdElem->dataType != OS_XML_DATA_TYPE_COMPLEX)
+	{
+		return OS_STATUS_OK;
+	}
+
+	osStatus_e status = osXmlWriter_checkMinOccurs(pElem);
+	if(status != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	//the children that are not written at all
+	int listIdx = 0;
+	osListElement_t* pLE = pElem->pXsdElem->pComplex->elemList.head;
+	while(pLE && listIdx < OS_XSD_COMPLEX_TYPE_MAX_ALLOWED_CHILD_ELEM)
+	{
+		osXsdElement_t* pChildElem = pLE->data;
+		if(pChildElem->dataType != OS_XML_DATA_TYPE_ANY && !pChildElem->pChoiceInfo && pChildElem->minOccurs > 0 && !(pElem->childMask & (1ULL << listIdx)))
+		{
+			logError("element(%r) requires minOccurs(%d) child element(%r), none is written.", &pElem->pXsdElem->elemName, pChildElem->minOccurs, &pChildElem->elemName);
+			return OS_ERROR_INVALID_VALUE;
+		}
+
+		listIdx++;
+		pLE = pLE->next;
+	}
+
+	return OS_STATUS_OK;
+}
+
+
+/* check a value against the data type and the facets of a simple type xsd element.  dataType is the data type the value
+ * is written from, a string can be written for any simple type, a boolean or a number only for the same kind of type.
+ * A negative number does not pass the check since the xml parser only supports unsigned numbers.
+ */
+static osStatus_e osXmlWriter_checkValue(osXsdElement_t* pXsdElem, osXmlDataType_e dataType, osPointerLen_t* pValue)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXmlData_t xmlData = {};
+
+	if(pXsdElem->dataType == OS_XML_DATA_TYPE_SIMPLE)
+	{
+		status = osXmlSimpleType_convertData(pXsdElem->pSimple, pValue, &xmlData);
+	}
+	else
+	{
+		status = osXmlXSType_convertData(&pXsdElem->elemName, pValue, pXsdElem->dataType, &xmlData);
+	}
+
+	if(status != OS_STATUS_OK)
+	{
+		logError("value(%r) does not match the xsd of element(%r).", pValue, &pXsdElem->elemName);
+		return status;
+	}
+
+	bool isNumber = xmlData.dataType >= OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE && xmlData.dataType <= OS_XML_DATA_TYPE_XS_LONG;
+	if((dataType == OS_XML_DATA_TYPE_XS_BOOLEAN && xmlData.dataType != OS_XML_DATA_TYPE_XS_BOOLEAN) || (dataType == OS_XML_DATA_TYPE_XS_LONG && !isNumber))
+	{
+		logError("a value of dataType(%d) is written for element(%r) of dataType(%d).", dataType, &pXsdElem->elemName, xmlData.dataType);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	return OS_STATUS_OK;
+}
+
+
+//write the value of the current element, a string is escaped
+static osStatus_e osXmlWriter_value(osXmlWriter_t* pWriter, const osXmlData_t* pXmlData)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	if(pWriter->status != OS_STATUS_OK)
+	{
+		return pWriter->status;
+	}
+
+	if(!pWriter->depth)
+	{
+		logError("there is no element for the value.");
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	osXmlWriterElem_t* pElem = &pWriter->elem[pWriter->depth - 1];
+	osXsdElement_t* pXsdElem = pElem->pXsdElem;
+
+	switch(pXmlData->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			return osXmlWriter_number(pWriter, pXmlData->xmlInt, false);
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+		case OS_XML_DATA_TYPE_XS_STRING:
+			break;
+		default:
+			logError("dataType(%d) of element(%r) is not a value.", pXmlData->dataType, &pElem->pTag->name);
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+			break;
+	}
+
+	osPointerLen_t value = pXmlData->dataType == OS_XML_DATA_TYPE_XS_STRING ? pXmlData->xmlStr : (pXmlData->xmlIsTrue ? (osPointerLen_t){"true", 4} : (osPointerLen_t){"false", 5});
+	if(pXsdElem)
+	{
+		if(!osXml_isXsdElemSimpleType(pXsdElem) || pElem->isValueWritten)
+		{
+			logError("element(%r) is not a simple type, or its value has been written.", &pXsdElem->elemName);
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+		}
+
+		if((status = osXmlWriter_checkValue(pXsdElem, pXmlData->dataType, &value)) != OS_STATUS_OK)
+		{
+			goto EXIT;
+		}
+		pElem->isValueWritten = true;
+	}
+
+	if(!osXmlWriter_closeStartTag(pWriter))
+	{
+		status = pWriter->status;
+		goto EXIT;
+	}
+
+	if(pXmlData->dataType == OS_XML_DATA_TYPE_XS_STRING ? !osXmlWriter_writeEscaped(pWriter, &value, &pWriter->textSet) : !osXmlWriter_writePL(pWriter, &value))
+	{
+		status = pWriter->status;
+		goto EXIT;
+	}
+
+EXIT:
+	if(status != OS_STATUS_OK)
+	{
+		pWriter->status = status;
+	}
+	return status;
+}
+
+
+//the number is formatted in place in the target buffer, and checked there against pXsdElem before it is committed
+static osStatus_e osXmlWriter_number(osXmlWriter_t* pWriter, uint64_t value, bool isNegative)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXmlWriterElem_t* pElem = &pWriter->elem[pWriter->depth - 1];
+	osXsdElement_t* pXsdElem = pElem->pXsdElem;
+
+	if(pXsdElem && (!osXml_isXsdElemSimpleType(pXsdElem) || pElem->isValueWritten))
+	{
+		logError("element(%r) is not a simple type, or its value has been written.", &pXsdElem->elemName);
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	//one more byte for '>' to close the start tag, and one for the sign
+	uint8_t* p = osXmlWriter_reserve(pWriter, OS_MAX_UINT64_STR_LEN + 2);
+	if(!p)
+	{
+		status = pWriter->status;
+		goto EXIT;
+	}
+
+	size_t len = 0;
+	if(pWriter->isStartTagOpen)
+	{
+		p[len++] = '>';
+	}
+	size_t numPos = len;
+	if(isNegative)
+	{
+		p[len++] = '-';
+	}
+	len += osUInt2DecStr(value, (char*)&p[len]);
+
+	if(pXsdElem)
+	{
+		osPointerLen_t number = {(char*)&p[numPos], len - numPos};
+		if((status = osXmlWriter_checkValue(pXsdElem, OS_XML_DATA_TYPE_XS_LONG, &number)) != OS_STATUS_OK)
+		{
+			goto EXIT;
+		}
+		pElem->isValueWritten = true;
+	}
+
+	pWriter->isStartTagOpen = false;
+	osXmlWriter_commit(pWriter, len);
+
+EXIT:
+	if(status != OS_STATUS_OK)
+	{
+		pWriter->status = status;
+	}
+	return status;
+}
+
+
+//write a leaf child of the current element for osXmlWriter_writeData(), the tags are composed on the fly
+static osStatus_e osXmlWriter_dataLeaf(osXmlWriter_t* pWriter, const osPointerLen_t* pNsAlias, osXsdElement_t* pXsdElem, const osXmlData_t* pXmlData)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXsdElement_t* pChildElem = NULL;
+
+	//pChildElem is the same as pXsdElem, the check is for the sequence order and maxOccurs
+	if((status = osXmlWriter_checkChild(pWriter, &pXsdElem->elemName, pXsdElem->elemNameAtom, &pChildElem)) != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	if(pWriter->depth >= OS_XML_WRITER_MAX_DEPTH)
+	{
+		logError("element(%r) is deeper than %d.", &pXsdElem->elemName, OS_XML_WRITER_MAX_DEPTH);
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	//a temporary tag so that the value is written and checked the same as a element started by osXmlWriter_startElem()
+	osXmlWriterTag_t tag = {*pNsAlias, pXsdElem->elemName, pXsdElem->elemNameAtom};
+	bool isWritten = osXmlWriter_closeStartTag(pWriter) && osXmlWriter_write(pWriter, "<", 1);
+	if(isWritten && pNsAlias->l)
+	{
+		isWritten = osXmlWriter_writePL(pWriter, pNsAlias) && osXmlWriter_write(pWriter, ":", 1);
+	}
+	if(!isWritten || !osXmlWriter_writePL(pWriter, &pXsdElem->elemName))
+	{
+		return pWriter->status;
+	}
+
+	osXmlWriterElem_t* pElem = &pWriter->elem[pWriter->depth++];
+	pElem->pTag = &tag;
+	pElem->pXsdElem = pXsdElem;
+	pElem->isValueWritten = false;
+	pWriter->isStartTagOpen = true;
+
+	status = osXmlWriter_value(pWriter, pXmlData);
+	pWriter->depth--;
+	if(status != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	isWritten = osXmlWriter_write(pWriter, "</", 2);
+	if(isWritten && pNsAlias->l)
+	{
+		isWritten = osXmlWriter_writePL(pWriter, pNsAlias) && osXmlWriter_write(pWriter, ":", 1);
+	}
+	if(!isWritten || !osXmlWriter_writePL(pWriter, &pXsdElem->elemName) || !osXmlWriter_write(pWriter, ">", 1))
+	{
+		return pWriter->status;
+	}
+
+	return OS_STATUS_OK;
+}
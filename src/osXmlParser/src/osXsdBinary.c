@@ -0,0 +1,983 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file osXsdBinary.c
+ * export a parsed xsd to a precompiled binary file, and load the binary file without parsing the xsd text.
+ * The loaded xsd refers the names and values in the mapped binary file directly, the file mapping is kept
+ * as long as the schema exists, the same as pXsdBuf of a parsed xsd.
+ ********************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osList.h"
+#include "osVec.h"
+#include "osDebug.h"
+#include "osMemory.h"
+#include "osAtom.h"
+
+#include "osXmlParser.h"
+#include "osXsdParser.h"
+#include "osXmlParserCommon.h"
+#include "osXmlParserCType.h"
+#include "osXmlParserSType.h"
+#include "osXsdBinary.h"
+
+
+#define OS_XSD_BIN_ALIGN(a)		(((a) + 7) & ~7U)
+
+
+//objects of a namespace collected for export, each vector entry is a pointer to the object, the idx is the table idx
+typedef struct {
+	osVec_t schemaVec;		//osXsdSchema_t
+	osVec_t elemVec;		//osXsdElement_t
+	osVec_t ctVec;			//osXmlComplexType_t
+	osVec_t stVec;			//osXmlSimpleType_t
+	osVec_t choiceVec;		//osXsd_choiceInfo_t
+	uint32_t nsAliasNum;
+	uint32_t facetNum;
+	bool isEmptyTargetNS;	//the schema is in the empty target namespace, its targetNS is the xsd name
+} osXsdBin_exportInfo_t;
+
+
+typedef struct {
+	int fd;
+	uint32_t strPoolPos;	//the file offset of the string pool
+	uint32_t strPos;		//the next free position in the string pool
+	bool isError;
+} osXsdBin_writer_t;
+
+
+//the loaded tables of a mapped binary file
+typedef struct {
+	const uint8_t* pBase;
+	const osXsdBin_header_t* pHeader;
+	const char* pStrPool;
+} osXsdBin_reader_t;
+
+
+static const size_t osXsdBin_recordSize[OS_XSD_BIN_TABLE_NUM] = {
+	sizeof(osXsdBin_schema_t),
+	sizeof(osXsdBin_nsAlias_t),
+	sizeof(osXsdBin_element_t),
+	sizeof(osXsdBin_complexType_t),
+	sizeof(osXsdBin_simpleType_t),
+	sizeof(osXsdBin_facet_t),
+	sizeof(osXsdBin_choice_t),
+	1,
+};
+
+
+static osStatus_e osXsdBin_collect(osXsdBin_exportInfo_t* pInfo);
+static osStatus_e osXsdBin_collectElem(osXsdBin_exportInfo_t* pInfo, osXsdElement_t* pElem);
+static osStatus_e osXsdBin_addUnique(osVec_t* pVec, void* pData);
+static int osXsdBin_getIdx(const osVec_t* pVec, const void* pData);
+static void osXsdBin_write(osXsdBin_writer_t* pWriter, const void* pData, size_t len, uint32_t pos);
+static osXsdBin_str_t osXsdBin_writeStr(osXsdBin_writer_t* pWriter, const osPointerLen_t* pl);
+static osStatus_e osXsdBin_writeTables(osXsdBin_writer_t* pWriter, osXsdBin_exportInfo_t* pInfo, osXsdBin_header_t* pHeader);
+static const osXsdBin_header_t* osXsdBin_checkHeader(osMBuf_t* pBinBuf);
+static bool osXsdBin_getPL(const osXsdBin_reader_t* pReader, const osXsdBin_str_t* pStr, osPointerLen_t* pl);
+static bool osXsdBin_isRangeValid(const osXsdBin_reader_t* pReader, const osXsdBin_range_t* pRange, osXsdBinTable_e table);
+static bool osXsdBin_isIdxValid(const osXsdBin_reader_t* pReader, int32_t idx, osXsdBinTable_e table);
+static osStatus_e osXsdBin_load(osXsdBin_reader_t* pReader, osMBuf_t* pBinBuf);
+
+
+static inline const void* osXsdBin_getRecord(const osXsdBin_reader_t* pReader, osXsdBinTable_e table, uint32_t idx)
+{
+	return pReader->pBase + pReader->pHeader->table[table].start + idx * osXsdBin_recordSize[table];
+}
+
+
+static inline uint32_t osXsdBin_getNum(const osXsdBin_reader_t* pReader, osXsdBinTable_e table)
+{
+	return pReader->pHeader->table[table].num;
+}
+
+
+/* export a parsed xsd to a binary file.
+ * xsdName:     IN, the target namespace of the xsd, or the xsd file name if the xsd has no target namespace.  All schemas
+ *              of the target namespace are exported.
+ * fileFolder:  IN, the folder of the binary file
+ * binFileName: IN, the binary file name
+ */
+osStatus_e osXsd_exportBin(osPointerLen_t* xsdName, char* fileFolder, char* binFileName)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXsdBin_exportInfo_t info = {};
+	osXsdBin_writer_t writer = {-1, 0, 0, false};
+	char binFile[OS_XML_MAX_FILE_NAME_SIZE];
+
+	if(!xsdName || !binFileName)
+	{
+		logError("null pointer, xsdName=%p, binFileName=%p.", xsdName, binFileName);
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(snprintf(binFile, OS_XML_MAX_FILE_NAME_SIZE, "%s/%s", fileFolder ? fileFolder : ".", binFileName) >= OS_XML_MAX_FILE_NAME_SIZE)
+	{
+		logError("binFile name is truncated.");
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	status = osXsd_getSchemas(xsdName, &info.schemaVec, &info.isEmptyTargetNS);
+	if(status != OS_STATUS_OK)
+	{
+		goto EXIT;
+	}
+
+	status = osXsdBin_collect(&info);
+	if(status != OS_STATUS_OK)
+	{
+		logError("fails to osXsdBin_collect for xsd(%r).", xsdName);
+		goto EXIT;
+	}
+
+	writer.fd = open(binFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(writer.fd < 0)
+	{
+		logError("fails to open file(%s), errno=%d.", binFile, errno);
+		status = OS_ERROR_SYSTEM_FAILURE;
+		goto EXIT;
+	}
+
+	osXsdBin_header_t header = {};
+	header.magic = OS_XSD_BIN_MAGIC;
+	header.version = OS_XSD_BIN_VERSION;
+	header.headerSize = sizeof(osXsdBin_header_t);
+	header.table[OS_XSD_BIN_TABLE_SCHEMA].num = osVec_getCount(&info.schemaVec);
+	header.table[OS_XSD_BIN_TABLE_NS_ALIAS].num = info.nsAliasNum;
+	header.table[OS_XSD_BIN_TABLE_ELEMENT].num = osVec_getCount(&info.elemVec);
+	header.table[OS_XSD_BIN_TABLE_COMPLEX_TYPE].num = osVec_getCount(&info.ctVec);
+	header.table[OS_XSD_BIN_TABLE_SIMPLE_TYPE].num = osVec_getCount(&info.stVec);
+	header.table[OS_XSD_BIN_TABLE_FACET].num = info.facetNum;
+	header.table[OS_XSD_BIN_TABLE_CHOICE].num = osVec_getCount(&info.choiceVec);
+
+	//all table sizes are known, place the tables, the string pool follows the last table
+	uint32_t pos = OS_XSD_BIN_ALIGN(sizeof(osXsdBin_header_t));
+	for(int i=0; i<OS_XSD_BIN_TABLE_STRING; i++)
+	{
+		header.table[i].start = pos;
+		pos = OS_XSD_BIN_ALIGN(pos + header.table[i].num * osXsdBin_recordSize[i]);
+	}
+	header.table[OS_XSD_BIN_TABLE_STRING].start = pos;
+	writer.strPoolPos = pos;
+
+	status = osXsdBin_writeTables(&writer, &info, &header);
+	if(status != OS_STATUS_OK)
+	{
+		goto EXIT;
+	}
+
+	header.table[OS_XSD_BIN_TABLE_STRING].num = writer.strPos;
+	header.fileSize = writer.strPoolPos + writer.strPos;
+	osXsdBin_write(&writer, &header, sizeof(osXsdBin_header_t), 0);
+	if(writer.isError)
+	{
+		logError("fails to write file(%s).", binFile);
+		status = OS_ERROR_SYSTEM_FAILURE;
+		goto EXIT;
+	}
+
+	mlogInfo(LM_XMLP, "xsd(%r) is exported to %s, elements=%d, complexTypes=%d, simpleTypes=%d, fileSize=%d.", xsdName, binFile, header.table[OS_XSD_BIN_TABLE_ELEMENT].num, header.table[OS_XSD_BIN_TABLE_COMPLEX_TYPE].num, header.table[OS_XSD_BIN_TABLE_SIMPLE_TYPE].num, header.fileSize);
+
+EXIT:
+	if(writer.fd >= 0)
+	{
+		close(writer.fd);
+		if(status != OS_STATUS_OK)
+		{
+			unlink(binFile);
+		}
+	}
+
+	osVec_clear(&info.schemaVec);
+	osVec_clear(&info.elemVec);
+	osVec_clear(&info.ctVec);
+	osVec_clear(&info.stVec);
+	osVec_clear(&info.choiceVec);
+
+	return status;
+}
+
+
+/* load a binary xsd file created by osXsd_exportBin().  The file is mapped, and the names and values of the xsd are used
+ * in place, no xsd text is parsed or kept.  If the xsd has already been parsed or loaded, nothing is done.
+ */
+osStatus_e osXsd_initNSBin(char* fileFolder, char* binFileName)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osMBuf_t* pBinBuf = NULL;
+	char binFile[OS_XML_MAX_FILE_NAME_SIZE];
+
+	if(!binFileName)
+	{
+		logError("null pointer, binFileName.");
+		return OS_ERROR_NULL_POINTER;
+	}
+
+	if(snprintf(binFile, OS_XML_MAX_FILE_NAME_SIZE, "%s/%s", fileFolder ? fileFolder : ".", binFileName) >= OS_XML_MAX_FILE_NAME_SIZE)
+	{
+		logError("binFile name is truncated.");
+		return OS_ERROR_INVALID_VALUE;
+	}
+
+	pBinBuf = osMBuf_mapFile(binFile);
+	if(!pBinBuf)
+	{
+		logError("fails to map binFile(%s).", binFile);
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	osXsdBin_reader_t reader;
+	reader.pBase = pBinBuf->buf;
+	reader.pHeader = osXsdBin_checkHeader(pBinBuf);
+	if(!reader.pHeader)
+	{
+		logError("binFile(%s) is not a valid precompiled xsd.", binFile);
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+	reader.pStrPool = (const char*)reader.pBase + reader.pHeader->table[OS_XSD_BIN_TABLE_STRING].start;
+
+	//the first schema decides if the namespace or xsd has been parsed/loaded
+	osPointerLen_t targetNS;
+	const osXsdBin_schema_t* pBinSchema = osXsdBin_getRecord(&reader, OS_XSD_BIN_TABLE_SCHEMA, 0);
+	if(!osXsdBin_getPL(&reader, &pBinSchema->targetNS, &targetNS))
+	{
+		status = OS_ERROR_INVALID_VALUE;
+		goto EXIT;
+	}
+
+	if(osXsd_isExistSchema(&targetNS))
+	{
+		mlogInfo(LM_XMLP, "xsd(%r) already exists, binFile(%s) is not loaded.", &targetNS, binFile);
+		goto EXIT;
+	}
+
+	status = osXsdBin_load(&reader, pBinBuf);
+	if(status != OS_STATUS_OK)
+	{
+		logError("fails to load binFile(%s).", binFile);
+		goto EXIT;
+	}
+
+	logInfo("xsd(%r) is loaded from %s.", &targetNS, binFile);
+
+EXIT:
+	//each loaded schema keeps its own reference of pBinBuf
+	osMBuf_dealloc(pBinBuf);
+	return status;
+}
+
+
+static osStatus_e osXsdBin_collect(osXsdBin_exportInfo_t* pInfo)
+{
+	osStatus_e status = OS_STATUS_OK;
+
+	//the global types of each schema are put first, so that each schema's global type list is a range in the type table
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->schemaVec); i++)
+	{
+		osXsdSchema_t* pSchema = osVec_get(&pInfo->schemaVec, i);
+		pInfo->nsAliasNum += osList_getCount(&pSchema->schemaInfo.nsAliasList);
+
+		osListElement_t* pLE = pSchema->gComplexList.head;
+		while(pLE)
+		{
+			if((status = osVec_append(&pInfo->ctVec, pLE->data)) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+			pLE = pLE->next;
+		}
+
+		pLE = pSchema->gSimpleList.head;
+		while(pLE)
+		{
+			if((status = osVec_append(&pInfo->stVec, pLE->data)) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+			pLE = pLE->next;
+		}
+	}
+
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->schemaVec); i++)
+	{
+		osXsdSchema_t* pSchema = osVec_get(&pInfo->schemaVec, i);
+		osListElement_t* pLE = pSchema->gElementList.head;
+		while(pLE)
+		{
+			if((status = osXsdBin_collectElem(pInfo, pLE->data)) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+			pLE = pLE->next;
+		}
+	}
+
+	//ctVec grows when a embedded complexType is found in the child elements, each complexType's children are collected once
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->ctVec); i++)
+	{
+		osXmlComplexType_t* pCT = osVec_get(&pInfo->ctVec, i);
+		osListElement_t* pLE = pCT->elemList.head;
+		while(pLE)
+		{
+			if((status = osXsdBin_collectElem(pInfo, pLE->data)) != OS_STATUS_OK)
+			{
+				goto EXIT;
+			}
+			pLE = pLE->next;
+		}
+	}
+
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->stVec); i++)
+	{
+		pInfo->facetNum += osList_getCount(&((osXmlSimpleType_t*)osVec_get(&pInfo->stVec, i))->facetList);
+	}
+
+EXIT:
+	return status;
+}
+
+
+static osStatus_e osXsdBin_collectElem(osXsdBin_exportInfo_t* pInfo, osXsdElement_t* pElem)
+{
+	osStatus_e status = osVec_append(&pInfo->elemVec, pElem);
+	if(status != OS_STATUS_OK)
+	{
+		return status;
+	}
+
+	if(pElem->dataType == OS_XML_DATA_TYPE_COMPLEX && pElem->pComplex)
+	{
+		status = osXsdBin_addUnique(&pInfo->ctVec, pElem->pComplex);
+	}
+	else if(pElem->dataType == OS_XML_DATA_TYPE_SIMPLE && pElem->pSimple)
+	{
+		status = osXsdBin_addUnique(&pInfo->stVec, pElem->pSimple);
+	}
+
+	if(status == OS_STATUS_OK && pElem->pChoiceInfo)
+	{
+		status = osXsdBin_addUnique(&pInfo->choiceVec, pElem->pChoiceInfo);
+	}
+
+	return status;
+}
+
+
+//export is done once offline, a linear search is good enough to dedup the shared types and choices
+static osStatus_e osXsdBin_addUnique(osVec_t* pVec, void* pData)
+{
+	if(osXsdBin_getIdx(pVec, pData) != OS_XSD_BIN_NO_IDX)
+	{
+		return OS_STATUS_OK;
+	}
+
+	return osVec_append(pVec, pData);
+}
+
+
+static int osXsdBin_getIdx(const osVec_t* pVec, const void* pData)
+{
+	void** pArray = osVec_getArray(pVec);
+	for(uint32_t i=0; i<osVec_getCount(pVec); i++)
+	{
+		if(pArray[i] == pData)
+		{
+			return i;
+		}
+	}
+
+	return OS_XSD_BIN_NO_IDX;
+}
+
+
+static void osXsdBin_write(osXsdBin_writer_t* pWriter, const void* pData, size_t len, uint32_t pos)
+{
+	if(pWriter->isError || !len)
+	{
+		return;
+	}
+
+	if(pwrite(pWriter->fd, pData, len, pos) != len)
+	{
+		logError("fails to pwrite %ld bytes at pos(%d), errno=%d.", len, pos, errno);
+		pWriter->isError = true;
+	}
+}
+
+
+//write a string into the string pool, a empty string is not written, its off and len are 0
+static osXsdBin_str_t osXsdBin_writeStr(osXsdBin_writer_t* pWriter, const osPointerLen_t* pl)
+{
+	osXsdBin_str_t str = {0, 0};
+	if(!pl || !pl->l)
+	{
+		return str;
+	}
+
+	str.off = pWriter->strPos;
+	str.len = pl->l;
+	osXsdBin_write(pWriter, pl->p, pl->l, pWriter->strPoolPos + pWriter->strPos);
+	osXsdBin_write(pWriter, "", 1, pWriter->strPoolPos + pWriter->strPos + pl->l);
+	pWriter->strPos += pl->l + 1;
+
+	return str;
+}
+
+
+static osStatus_e osXsdBin_writeTables(osXsdBin_writer_t* pWriter, osXsdBin_exportInfo_t* pInfo, osXsdBin_header_t* pHeader)
+{
+	uint32_t nsAliasIdx = 0, gElemIdx = 0, gComplexIdx = 0, gSimpleIdx = 0;
+	uint32_t pos = pHeader->table[OS_XSD_BIN_TABLE_SCHEMA].start;
+	uint32_t aliasPos = pHeader->table[OS_XSD_BIN_TABLE_NS_ALIAS].start;
+
+	//each schema's nsAlias, global elements and global types are contiguous in their tables in the schema order, see osXsdBin_collect()
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->schemaVec); i++)
+	{
+		osXsdSchema_t* pSchema = osVec_get(&pInfo->schemaVec, i);
+		osXsdBin_schema_t binSchema = {};
+
+		binSchema.targetNS = osXsdBin_writeStr(pWriter, (osPointerLen_t*)&pSchema->schemaInfo.targetNS);
+		binSchema.defaultNS = osXsdBin_writeStr(pWriter, &pSchema->schemaInfo.defaultNS);
+		binSchema.xsAlias = osXsdBin_writeStr(pWriter, &pSchema->schemaInfo.xsAlias);
+		binSchema.isEmptyTargetNS = pInfo->isEmptyTargetNS;
+
+		binSchema.nsAlias.start = nsAliasIdx;
+		osListElement_t* pLE = pSchema->schemaInfo.nsAliasList.head;
+		while(pLE)
+		{
+			osXsd_nsAliasInfo_t* pAlias = pLE->data;
+			osXsdBin_nsAlias_t binAlias = {};
+			binAlias.nsUseLabel = pAlias->nsUseLabel;
+			binAlias.ns = osXsdBin_writeStr(pWriter, &pAlias->ns);
+			binAlias.nsAlias = osXsdBin_writeStr(pWriter, &pAlias->nsAlias);
+			osXsdBin_write(pWriter, &binAlias, sizeof(binAlias), aliasPos);
+			aliasPos += sizeof(binAlias);
+			nsAliasIdx++;
+			pLE = pLE->next;
+		}
+		binSchema.nsAlias.num = nsAliasIdx - binSchema.nsAlias.start;
+
+		binSchema.gElement.start = gElemIdx;
+		binSchema.gElement.num = osList_getCount(&pSchema->gElementList);
+		gElemIdx += binSchema.gElement.num;
+		binSchema.gComplex.start = gComplexIdx;
+		binSchema.gComplex.num = osList_getCount(&pSchema->gComplexList);
+		gComplexIdx += binSchema.gComplex.num;
+		binSchema.gSimple.start = gSimpleIdx;
+		binSchema.gSimple.num = osList_getCount(&pSchema->gSimpleList);
+		gSimpleIdx += binSchema.gSimple.num;
+
+		osXsdBin_write(pWriter, &binSchema, sizeof(binSchema), pos);
+		pos += sizeof(binSchema);
+	}
+
+	pos = pHeader->table[OS_XSD_BIN_TABLE_ELEMENT].start;
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->elemVec); i++)
+	{
+		osXsdElement_t* pElem = osVec_get(&pInfo->elemVec, i);
+		osXsdBin_element_t binElem = {};
+
+		binElem.elemName = osXsdBin_writeStr(pWriter, &pElem->elemName);
+		binElem.elemTypeName = osXsdBin_writeStr(pWriter, &pElem->elemTypeName);
+		binElem.elemDefault = osXsdBin_writeStr(pWriter, &pElem->elemDefault);
+		binElem.fixed = osXsdBin_writeStr(pWriter, &pElem->fixed);
+		binElem.schemaIdx = OS_XSD_BIN_NO_IDX;
+		for(uint32_t j=0; pElem->pSchema && j<osVec_getCount(&pInfo->schemaVec); j++)
+		{
+			if(&((osXsdSchema_t*)osVec_get(&pInfo->schemaVec, j))->schemaInfo == pElem->pSchema)
+			{
+				binElem.schemaIdx = j;
+				break;
+			}
+		}
+		binElem.choiceIdx = pElem->pChoiceInfo ? osXsdBin_getIdx(&pInfo->choiceVec, pElem->pChoiceInfo) : OS_XSD_BIN_NO_IDX;
+		binElem.minOccurs = pElem->minOccurs;
+		binElem.maxOccurs = pElem->maxOccurs;
+		binElem.dataType = pElem->dataType;
+		binElem.isRootElement = pElem->isRootElement;
+		binElem.isQualified = pElem->isQualified;
+		binElem.typeIdx = OS_XSD_BIN_NO_IDX;
+		switch(pElem->dataType)
+		{
+			case OS_XML_DATA_TYPE_COMPLEX:
+				binElem.typeIdx = osXsdBin_getIdx(&pInfo->ctVec, pElem->pComplex);
+				break;
+			case OS_XML_DATA_TYPE_SIMPLE:
+				binElem.typeIdx = osXsdBin_getIdx(&pInfo->stVec, pElem->pSimple);
+				break;
+			case OS_XML_DATA_TYPE_ANY:
+				binElem.isXmlAnyElem = pElem->anyElem.isXmlAnyElem;
+				if(pElem->anyElem.isXmlAnyElem)
+				{
+					binElem.isLeaf = pElem->anyElem.xmlAnyElem.isLeaf;
+					binElem.isRootAnyElem = pElem->anyElem.xmlAnyElem.isRootAnyElem;
+				}
+				else
+				{
+					binElem.anyElemNS = pElem->anyElem.elemAnyTag.elemNamespace;
+					binElem.anyElemPS = pElem->anyElem.elemAnyTag.processContent;
+				}
+				break;
+			default:
+				break;
+		}
+
+		osXsdBin_write(pWriter, &binElem, sizeof(binElem), pos);
+		pos += sizeof(binElem);
+	}
+
+	//the child elements of complexTypes follow the global elements in the ctVec order
+	uint32_t elemIdx = gElemIdx;
+	pos = pHeader->table[OS_XSD_BIN_TABLE_COMPLEX_TYPE].start;
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->ctVec); i++)
+	{
+		osXmlComplexType_t* pCT = osVec_get(&pInfo->ctVec, i);
+		osXsdBin_complexType_t binCT = {};
+
+		binCT.typeName = osXsdBin_writeStr(pWriter, &pCT->typeName);
+		binCT.elem.start = elemIdx;
+		binCT.elem.num = osList_getCount(&pCT->elemList);
+		elemIdx += binCT.elem.num;
+		binCT.isMixed = pCT->isMixed;
+		binCT.elemDispType = pCT->elemDispType;
+
+		osXsdBin_write(pWriter, &binCT, sizeof(binCT), pos);
+		pos += sizeof(binCT);
+	}
+
+	uint32_t facetIdx = 0;
+	uint32_t facetPos = pHeader->table[OS_XSD_BIN_TABLE_FACET].start;
+	pos = pHeader->table[OS_XSD_BIN_TABLE_SIMPLE_TYPE].start;
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->stVec); i++)
+	{
+		osXmlSimpleType_t* pST = osVec_get(&pInfo->stVec, i);
+		osXsdBin_simpleType_t binST = {};
+
+		binST.typeName = osXsdBin_writeStr(pWriter, &pST->typeName);
+		binST.baseType = pST->baseType;
+		binST.facet.start = facetIdx;
+		osListElement_t* pLE = pST->facetList.head;
+		while(pLE)
+		{
+			osXmlRestrictionFacet_t* pFacet = pLE->data;
+			osXsdBin_facet_t binFacet = {};
+			binFacet.facet = pFacet->facet;
+			//the same rule as osXsdSimpleType_getFacet()
+			binFacet.isString = pFacet->facet == OS_XML_RESTRICTION_FACET_PATTERN || (pFacet->facet == OS_XML_RESTRICTION_FACET_ENUM && !osXml_isDigitType(pST->baseType));
+			if(binFacet.isString)
+			{
+				binFacet.string = osXsdBin_writeStr(pWriter, &pFacet->string);
+			}
+			else
+			{
+				binFacet.value = pFacet->value;
+			}
+			osXsdBin_write(pWriter, &binFacet, sizeof(binFacet), facetPos);
+			facetPos += sizeof(binFacet);
+			facetIdx++;
+			pLE = pLE->next;
+		}
+		binST.facet.num = facetIdx - binST.facet.start;
+
+		osXsdBin_write(pWriter, &binST, sizeof(binST), pos);
+		pos += sizeof(binST);
+	}
+
+	pos = pHeader->table[OS_XSD_BIN_TABLE_CHOICE].start;
+	for(uint32_t i=0; i<osVec_getCount(&pInfo->choiceVec); i++)
+	{
+		osXsd_choiceInfo_t* pChoice = osVec_get(&pInfo->choiceVec, i);
+		osXsdBin_choice_t binChoice = {pChoice->minOccurs, pChoice->maxOccurs, pChoice->tag, 0};
+		osXsdBin_write(pWriter, &binChoice, sizeof(binChoice), pos);
+		pos += sizeof(binChoice);
+	}
+
+	if(pWriter->isError)
+	{
+		return OS_ERROR_SYSTEM_FAILURE;
+	}
+
+	return OS_STATUS_OK;
+}
+
+
+//check the header and the table boundaries, the records are checked when they are loaded
+static const osXsdBin_header_t* osXsdBin_checkHeader(osMBuf_t* pBinBuf)
+{
+	if(pBinBuf->size < sizeof(osXsdBin_header_t))
+	{
+		logError("the file size(%ld) is too small.", pBinBuf->size);
+		return NULL;
+	}
+
+	const osXsdBin_header_t* pHeader = (const osXsdBin_header_t*)pBinBuf->buf;
+	if(pHeader->magic != OS_XSD_BIN_MAGIC || pHeader->version != OS_XSD_BIN_VERSION || pHeader->headerSize != sizeof(osXsdBin_header_t))
+	{
+		logError("unexpected magic(0x%x), version(%d) or headerSize(%d).", pHeader->magic, pHeader->version, pHeader->headerSize);
+		return NULL;
+	}
+
+	if(pHeader->fileSize != pBinBuf->size)
+	{
+		logError("the fileSize(%d) in the header does not match the real file size(%ld).", pHeader->fileSize, pBinBuf->size);
+		return NULL;
+	}
+
+	for(int i=0; i<OS_XSD_BIN_TABLE_NUM; i++)
+	{
+		if(pHeader->table[i].start & 7 || (uint64_t)pHeader->table[i].start + (uint64_t)pHeader->table[i].num * osXsdBin_recordSize[i] > pHeader->fileSize)
+		{
+			logError("table(%d) (start=%d, num=%d) is out of the file.", i, pHeader->table[i].start, pHeader->table[i].num);
+			return NULL;
+		}
+	}
+
+	if(pHeader->table[OS_XSD_BIN_TABLE_SCHEMA].num == 0)
+	{
+		logError("no schema in the file.");
+		return NULL;
+	}
+
+	return pHeader;
+}
+
+
+static bool osXsdBin_getPL(const osXsdBin_reader_t* pReader, const osXsdBin_str_t* pStr, osPointerLen_t* pl)
+{
+	if((uint64_t)pStr->off + pStr->len > pReader->pHeader->table[OS_XSD_BIN_TABLE_STRING].num)
+	{
+		logError("string(off=%d, len=%d) is out of the string pool.", pStr->off, pStr->len);
+		return false;
+	}
+
+	pl->p = pStr->len ? pReader->pStrPool + pStr->off : NULL;
+	pl->l = pStr->len;
+	return true;
+}
+
+
+static bool osXsdBin_isRangeValid(const osXsdBin_reader_t* pReader, const osXsdBin_range_t* pRange, osXsdBinTable_e table)
+{
+	if((uint64_t)pRange->start + pRange->num > osXsdBin_getNum(pReader, table))
+	{
+		logError("range(start=%d, num=%d) is out of table(%d).", pRange->start, pRange->num, table);
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool osXsdBin_isIdxValid(const osXsdBin_reader_t* pReader, int32_t idx, osXsdBinTable_e table)
+{
+	if(idx < 0 || idx >= osXsdBin_getNum(pReader, table))
+	{
+		logError("idx(%d) is out of table(%d).", idx, table);
+		return false;
+	}
+
+	return true;
+}
+
+
+/* create the xsd objects from the tables, link them, and add the schemas into the global NS list.  All objects are created
+ * before any of them is linked, so that a invalid record is found before the objects depend on each other
+ */
+static osStatus_e osXsdBin_load(osXsdBin_reader_t* pReader, osMBuf_t* pBinBuf)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osVec_t schemaVec = {}, elemVec = {}, ctVec = {}, stVec = {}, choiceVec = {};
+	bool isLinked = false;
+
+	if((status = osVec_reserve(&schemaVec, osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_SCHEMA))) != OS_STATUS_OK
+		|| (status = osVec_reserve(&elemVec, osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_ELEMENT))) != OS_STATUS_OK
+		|| (status = osVec_reserve(&ctVec, osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_COMPLEX_TYPE))) != OS_STATUS_OK
+		|| (status = osVec_reserve(&stVec, osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_SIMPLE_TYPE))) != OS_STATUS_OK
+		|| (status = osVec_reserve(&choiceVec, osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_CHOICE))) != OS_STATUS_OK)
+	{
+		goto EXIT;
+	}
+
+	for(uint32_t i=0; i<osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_CHOICE); i++)
+	{
+		const osXsdBin_choice_t* pBinChoice = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_CHOICE, i);
+		osXsd_choiceInfo_t* pChoice = oszalloc(sizeof(osXsd_choiceInfo_t), NULL);
+		if(!pChoice)
+		{
+			status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			goto EXIT;
+		}
+		pChoice->minOccurs = pBinChoice->minOccurs;
+		pChoice->maxOccurs = pBinChoice->maxOccurs;
+		pChoice->tag = pBinChoice->tag;
+		osVec_append(&choiceVec, pChoice);
+	}
+
+	for(uint32_t i=0; i<osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_COMPLEX_TYPE); i++)
+	{
+		const osXsdBin_complexType_t* pBinCT = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_COMPLEX_TYPE, i);
+		osXmlComplexType_t* pCT = oszalloc(sizeof(osXmlComplexType_t), osXmlComplexType_cleanup);
+		if(!pCT)
+		{
+			status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			goto EXIT;
+		}
+		osVec_append(&ctVec, pCT);
+
+		if(!osXsdBin_getPL(pReader, &pBinCT->typeName, &pCT->typeName) || !osXsdBin_isRangeValid(pReader, &pBinCT->elem, OS_XSD_BIN_TABLE_ELEMENT))
+		{
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+		}
+		pCT->typeNameAtom = pCT->typeName.l ? osAtom_intern(&pCT->typeName, false) : OS_ATOM_NONE;
+		pCT->isMixed = pBinCT->isMixed;
+		pCT->elemDispType = pBinCT->elemDispType;
+	}
+
+	for(uint32_t i=0; i<osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_SIMPLE_TYPE); i++)
+	{
+		const osXsdBin_simpleType_t* pBinST = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_SIMPLE_TYPE, i);
+		osXmlSimpleType_t* pST = oszalloc(sizeof(osXmlSimpleType_t), osXmlSimpleType_cleanup);
+		if(!pST)
+		{
+			status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			goto EXIT;
+		}
+		osVec_append(&stVec, pST);
+
+		if(!osXsdBin_getPL(pReader, &pBinST->typeName, &pST->typeName) || !osXsdBin_isRangeValid(pReader, &pBinST->facet, OS_XSD_BIN_TABLE_FACET))
+		{
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+		}
+		pST->typeNameAtom = pST->typeName.l ? osAtom_intern(&pST->typeName, false) : OS_ATOM_NONE;
+		pST->baseType = pBinST->baseType;
+
+		for(uint32_t j=0; j<pBinST->facet.num; j++)
+		{
+			const osXsdBin_facet_t* pBinFacet = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_FACET, pBinST->facet.start + j);
+			osXmlRestrictionFacet_t* pFacet = oszalloc(sizeof(osXmlRestrictionFacet_t), NULL);
+			if(!pFacet)
+			{
+				status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+				goto EXIT;
+			}
+			osList_append(&pST->facetList, pFacet);
+
+			pFacet->facet = pBinFacet->facet;
+			if(!pBinFacet->isString)
+			{
+				pFacet->value = pBinFacet->value;
+			}
+			else if(!osXsdBin_getPL(pReader, &pBinFacet->string, &pFacet->string))
+			{
+				status = OS_ERROR_INVALID_VALUE;
+				goto EXIT;
+			}
+		}
+
+		if((status = osXmlSimpleType_compile(pST)) != OS_STATUS_OK)
+		{
+			goto EXIT;
+		}
+	}
+
+	for(uint32_t i=0; i<osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_SCHEMA); i++)
+	{
+		const osXsdBin_schema_t* pBinSchema = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_SCHEMA, i);
+		osXsdSchema_t* pSchema = oszalloc(sizeof(osXsdSchema_t), osXsdSchema_cleanup);
+		if(!pSchema)
+		{
+			status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			goto EXIT;
+		}
+		osVec_append(&schemaVec, pSchema);
+
+		osPointerLen_t targetNS;
+		if(!osXsdBin_getPL(pReader, &pBinSchema->targetNS, &targetNS) || !osXsdBin_getPL(pReader, &pBinSchema->defaultNS, &pSchema->schemaInfo.defaultNS)
+			|| !osXsdBin_getPL(pReader, &pBinSchema->xsAlias, &pSchema->schemaInfo.xsAlias)
+			|| !osXsdBin_isRangeValid(pReader, &pBinSchema->nsAlias, OS_XSD_BIN_TABLE_NS_ALIAS)
+			|| !osXsdBin_isRangeValid(pReader, &pBinSchema->gElement, OS_XSD_BIN_TABLE_ELEMENT)
+			|| !osXsdBin_isRangeValid(pReader, &pBinSchema->gComplex, OS_XSD_BIN_TABLE_COMPLEX_TYPE)
+			|| !osXsdBin_isRangeValid(pReader, &pBinSchema->gSimple, OS_XSD_BIN_TABLE_SIMPLE_TYPE))
+		{
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+		}
+
+		//for a empty target namespace, the xsd name is filled into targetNS by osXsd_addSchema()
+		if(!pBinSchema->isEmptyTargetNS)
+		{
+			osDPL_dup(&pSchema->schemaInfo.targetNS, &targetNS);
+		}
+
+		for(uint32_t j=0; j<pBinSchema->nsAlias.num; j++)
+		{
+			const osXsdBin_nsAlias_t* pBinAlias = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_NS_ALIAS, pBinSchema->nsAlias.start + j);
+			osXsd_nsAliasInfo_t* pAlias = oszalloc(sizeof(osXsd_nsAliasInfo_t), NULL);
+			if(!pAlias)
+			{
+				status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+				goto EXIT;
+			}
+			osList_append(&pSchema->schemaInfo.nsAliasList, pAlias);
+
+			pAlias->nsUseLabel = pBinAlias->nsUseLabel;
+			if(!osXsdBin_getPL(pReader, &pBinAlias->ns, &pAlias->ns) || !osXsdBin_getPL(pReader, &pBinAlias->nsAlias, &pAlias->nsAlias))
+			{
+				status = OS_ERROR_INVALID_VALUE;
+				goto EXIT;
+			}
+			pAlias->nsAliasAtom = pAlias->nsAlias.l ? osAtom_intern(&pAlias->nsAlias, false) : OS_ATOM_NONE;
+		}
+	}
+
+	for(uint32_t i=0; i<osXsdBin_getNum(pReader, OS_XSD_BIN_TABLE_ELEMENT); i++)
+	{
+		const osXsdBin_element_t* pBinElem = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_ELEMENT, i);
+		osXsdElement_t* pElem = oszalloc(sizeof(osXsdElement_t), osXsdElement_cleanup);
+		if(!pElem)
+		{
+			status = OS_ERROR_MEMORY_ALLOC_FAILURE;
+			goto EXIT;
+		}
+		osVec_append(&elemVec, pElem);
+
+		if(!osXsdBin_getPL(pReader, &pBinElem->elemName, &pElem->elemName) || !osXsdBin_getPL(pReader, &pBinElem->elemTypeName, &pElem->elemTypeName)
+			|| !osXsdBin_getPL(pReader, &pBinElem->elemDefault, &pElem->elemDefault) || !osXsdBin_getPL(pReader, &pBinElem->fixed, &pElem->fixed)
+			|| (pBinElem->schemaIdx != OS_XSD_BIN_NO_IDX && !osXsdBin_isIdxValid(pReader, pBinElem->schemaIdx, OS_XSD_BIN_TABLE_SCHEMA))
+			|| (pBinElem->choiceIdx != OS_XSD_BIN_NO_IDX && !osXsdBin_isIdxValid(pReader, pBinElem->choiceIdx, OS_XSD_BIN_TABLE_CHOICE)))
+		{
+			status = OS_ERROR_INVALID_VALUE;
+			goto EXIT;
+		}
+
+		pElem->elemNameAtom = pElem->elemName.l ? osAtom_intern(&pElem->elemName, false) : OS_ATOM_NONE;
+		pElem->elemTypeNameAtom = pElem->elemTypeName.l ? osAtom_intern(&pElem->elemTypeName, false) : OS_ATOM_NONE;
+		pElem->isRootElement = pBinElem->isRootElement;
+		pElem->isQualified = pBinElem->isQualified;
+		pElem->minOccurs = pBinElem->minOccurs;
+		pElem->maxOccurs = pBinElem->maxOccurs;
+		if(pBinElem->schemaIdx != OS_XSD_BIN_NO_IDX)
+		{
+			pElem->pSchema = &((osXsdSchema_t*)osVec_get(&schemaVec, pBinElem->schemaIdx))->schemaInfo;
+		}
+		if(pBinElem->choiceIdx != OS_XSD_BIN_NO_IDX)
+		{
+			pElem->pChoiceInfo = osmemref(osVec_get(&choiceVec, pBinElem->choiceIdx));
+		}
+
+		switch(pBinElem->dataType)
+		{
+			case OS_XML_DATA_TYPE_COMPLEX:
+				if(!osXsdBin_isIdxValid(pReader, pBinElem->typeIdx, OS_XSD_BIN_TABLE_COMPLEX_TYPE))
+				{
+					status = OS_ERROR_INVALID_VALUE;
+					goto EXIT;
+				}
+				pElem->pComplex = osVec_get(&ctVec, pBinElem->typeIdx);
+				break;
+			case OS_XML_DATA_TYPE_SIMPLE:
+				if(!osXsdBin_isIdxValid(pReader, pBinElem->typeIdx, OS_XSD_BIN_TABLE_SIMPLE_TYPE))
+				{
+					status = OS_ERROR_INVALID_VALUE;
+					goto EXIT;
+				}
+				pElem->pSimple = osVec_get(&stVec, pBinElem->typeIdx);
+				break;
+			case OS_XML_DATA_TYPE_ANY:
+				pElem->anyElem.isXmlAnyElem = pBinElem->isXmlAnyElem;
+				if(pBinElem->isXmlAnyElem)
+				{
+					pElem->anyElem.xmlAnyElem.isLeaf = pBinElem->isLeaf;
+					pElem->anyElem.xmlAnyElem.isRootAnyElem = pBinElem->isRootAnyElem;
+				}
+				else
+				{
+					pElem->anyElem.elemAnyTag.elemNamespace = pBinElem->anyElemNS;
+					pElem->anyElem.elemAnyTag.processContent = pBinElem->anyElemPS;
+				}
+				break;
+			default:
+				break;
+		}
+		//the dataType is set last, so that osXsdElement_cleanup() would not touch a pComplex that is not set
+		pElem->dataType = pBinElem->dataType;
+	}
+
+	//all records are valid, link the objects.  From now on, the objects are owned by the schemas
+	isLinked = true;
+	for(uint32_t i=0; i<osVec_getCount(&ctVec); i++)
+	{
+		const osXsdBin_complexType_t* pBinCT = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_COMPLEX_TYPE, i);
+		osXmlComplexType_t* pCT = osVec_get(&ctVec, i);
+		for(uint32_t j=0; j<pBinCT->elem.num; j++)
+		{
+			osList_append(&pCT->elemList, osVec_get(&elemVec, pBinCT->elem.start + j));
+		}
+		pCT->pChildIndex = osXsd_atomIndex_create(&pCT->elemList, offsetof(osXsdElement_t, elemNameAtom), offsetof(osXsdElement_t, elemName));
+	}
+
+	for(uint32_t i=0; i<osVec_getCount(&schemaVec); i++)
+	{
+		const osXsdBin_schema_t* pBinSchema = osXsdBin_getRecord(pReader, OS_XSD_BIN_TABLE_SCHEMA, i);
+		osXsdSchema_t* pSchema = osVec_get(&schemaVec, i);
+		for(uint32_t j=0; j<pBinSchema->gElement.num; j++)
+		{
+			osList_append(&pSchema->gElementList, osVec_get(&elemVec, pBinSchema->gElement.start + j));
+		}
+		for(uint32_t j=0; j<pBinSchema->gComplex.num; j++)
+		{
+			osList_append(&pSchema->gComplexList, osVec_get(&ctVec, pBinSchema->gComplex.start + j));
+		}
+		for(uint32_t j=0; j<pBinSchema->gSimple.num; j++)
+		{
+			osList_append(&pSchema->gSimpleList, osVec_get(&stVec, pBinSchema->gSimple.start + j));
+		}
+
+		pSchema->pGElemIndex = osXsd_atomIndex_create(&pSchema->gElementList, offsetof(osXsdElement_t, elemNameAtom), offsetof(osXsdElement_t, elemName));
+		pSchema->pCTypeIndex = osXsd_atomIndex_create(&pSchema->gComplexList, offsetof(osXmlComplexType_t, typeNameAtom), offsetof(osXmlComplexType_t, typeName));
+		pSchema->pSTypeIndex = osXsd_atomIndex_create(&pSchema->gSimpleList, offsetof(osXmlSimpleType_t, typeNameAtom), offsetof(osXmlSimpleType_t, typeName));
+
+		osPointerLen_t xsdName;
+		osXsdBin_getPL(pReader, &pBinSchema->targetNS, &xsdName);
+		//set before the schema is published to other threads, it is released with pSchema if osXsd_addSchema() fails
+		pSchema->pXsdBuf = osmemref(pBinBuf);
+		if(!osXsd_addSchema(pSchema, &xsdName))
+		{
+			logError("fails to osXsd_addSchema for xsd(%r).", &xsdName);
+			status = OS_ERROR_INVALID_VALUE;
+			continue;
+		}
+	}
+
+EXIT:
+	if(!isLinked)
+	{
+		//the elements are freed first, as they refer the types and choices
+		osVec_delete(&elemVec);
+		osVec_delete(&ctVec);
+		osVec_delete(&stVec);
+		osVec_delete(&schemaVec);
+	}
+
+	//each element that is in a choice holds a reference of the choice
+	osVec_delete(&choiceVec);
+	osVec_clear(&schemaVec);
+	osVec_clear(&elemVec);
+	osVec_clear(&ctVec);
+	osVec_clear(&stVec);
+
+	return status;
+}
+
@@ -10,6 +10,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include "osMBuf.h"
 #include "osPL.h"
@@ -27,14 +28,13 @@
 
 
 static osXsdSchema_t* osXsd_parseSchema(osMBuf_t* pXmlBuf);
-static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osList_t* pCTypeList, osList_t* pSTypeList);
+static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osXsdSchema_t* pSchema);
 static osStatus_e osXsd_parseGlobalTag(osMBuf_t* pXmlBuf, osList_t* pTypeList, osList_t* pSTypeList, osXmlTagInfo_t** pGlobalElemTagInfo, bool* isEndSchemaTag);
-static void* osXsd_getTypeByname(osList_t* pTypeList, osPointerLen_t* pElemTypeName);
+static void* osXsd_getTypeByname(osList_t* pTypeList, osXsd_atomIndex_t* pTypeIndex, osPointerLen_t* pElemTypeName, osAtom_t elemTypeNameAtom);
 osStatus_e osXsd_parseSchemaTag(osMBuf_t* pXmlBuf, osXsd_schemaInfo_t* pSchemaInfo, bool* isSchemaTagDone);
 static osXsdNamespace_t* osXsd_getNS(osList_t* pXsdNSList, osPointerLen_t* pTargetNS, bool isCreateNS, bool* isNewNS);
-static void osXsdSchema_cleanup(void* data);
 static void osXsdNS_cleanup(void* data);
-static osXsdElement_t* osXsd_getElementFromList(osList_t* pList, osPointerLen_t* pTag);
+static osXsdElement_t* osXsd_getElementFromList(osList_t* pList, osXsd_atomIndex_t* pIndex, osPointerLen_t* pTag);
 static osStatus_e osXmlElement_getSubTagInfo(osXsdElement_t* pElement, osXmlTagInfo_t* pTagInfo);
 
 
@@ -45,6 +45,9 @@ static __thread osList_t gXsdNSList;	//each entry contains a osXsdNamespace_t
 #else
 static osList_t gXsdNSList;    //each entry contains a osXsdNamespace_t
 #endif
+/* a schema is read only after it is added into gXsdNSList, and shared by the xml parses of all threads.  The lock only
+ * protects the list itself, a xsd shall not be freed while a xml parse that uses it is ongoing */
+static pthread_rwlock_t gXsdNSListLock = PTHREAD_RWLOCK_INITIALIZER;
 
 static void tempPrint(osList_t* pList, int i)
 {
@@ -79,8 +82,8 @@ osMBuf_t* osXsd_initNS(char* fileFolder, char* xsdFileName)
         status = OS_ERROR_INVALID_VALUE;
     }
 
-    //8000 is the initial mBuf size.  If the reading needs more than 8000, the function will realloc new memory
-    xsdMBuf = osMBuf_readFile(xsdFile, 8000);
+    //map the xsd file instead of reading it, the schema keeps referring the xsd buffer
+    xsdMBuf = osMBuf_mapFile(xsdFile);
     if(!xsdMBuf)
     {
         logError("read xsdMBuf fails.");
@@ -114,13 +117,11 @@ EXIT:
 
 osXsdNamespace_t* osXsd_parse(osMBuf_t* pXmlBuf, osPointerLen_t* pXsdName)
 {
-	osStatus_e status = OS_STATUS_OK;
 	osXsdNamespace_t* pNS = NULL;
 	osXsdSchema_t* pSchema = NULL;
     if(!pXmlBuf || !pXsdName)
     {
         logError("null pointer, pXmlBuf=%p, pXsdName=%p.", pXmlBuf, pXsdName);
-        status = OS_ERROR_NULL_POINTER;
         goto EXIT;
     }
 
@@ -128,15 +129,40 @@ osXsdNamespace_t* osXsd_parse(osMBuf_t* pXmlBuf, osPointerLen_t* pXsdName)
 	if(!pSchema)
 	{
 		logError("fails to osXsd_parseSchema.");
-		status = OS_ERROR_INVALID_VALUE;
 		goto EXIT;
 	}
 
+	//set before the schema is published, other threads may use the schema as soon as it is added.  If
+	//osXsd_addSchema() fails, it frees pSchema together with this reference
+	pSchema->pXsdBuf = osmemref(pXmlBuf);
+	pNS = osXsd_addSchema(pSchema, pXsdName);
+
+EXIT:
+	return pNS;
+} //osXsd_parse()
+
+
+/* add a schema into the global NS list.  If the schema has no target namespace, pXsdName is used to refer the schema.
+ * pSchema is freed if it can not be added
+ */
+osXsdNamespace_t* osXsd_addSchema(osXsdSchema_t* pSchema, osPointerLen_t* pXsdName)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXsdNamespace_t* pNS = NULL;
+    if(!pSchema || !pXsdName)
+    {
+        logError("null pointer, pSchema=%p, pXsdName=%p.", pSchema, pXsdName);
+        status = OS_ERROR_NULL_POINTER;
+        goto EXIT;
+    }
+
 	//for now assume the same schema is only inputed/parsed one time.  In the future, for safety, add a xsd name check to prevent the same schema been parsed multiple times
 	bool isNewNS = false;
+	pthread_rwlock_wrlock(&gXsdNSListLock);
 	pNS = osXsd_getNS(&gXsdNSList, (osPointerLen_t*)&pSchema->schemaInfo.targetNS, true, &isNewNS);
 	if(!pNS)
 	{
+		pthread_rwlock_unlock(&gXsdNSListLock);
         logError("fails to osXsd_getNS for a pSchema(%r).", &pSchema->schemaInfo.targetNS);
         osfree(pSchema);
         status = OS_ERROR_INVALID_VALUE;
@@ -154,6 +180,7 @@ osXsdNamespace_t* osXsd_parse(osMBuf_t* pXmlBuf, osPointerLen_t* pXsdName)
 
     if(!osList_append(&pNS->schemaList, pSchema))
 	{
+		pthread_rwlock_unlock(&gXsdNSListLock);
 		logError("fails to osList_append a pSchema(%r).", &pSchema->schemaInfo.targetNS);
 		osfree(pSchema);
 		status = OS_ERROR_INVALID_VALUE;
@@ -164,9 +191,7 @@ osXsdNamespace_t* osXsd_parse(osMBuf_t* pXmlBuf, osPointerLen_t* pXsdName)
 	{
 		osList_append(&gXsdNSList, pNS);
 	}
-
-	//intentionally to put last to make sure in error cases above, pXmlBuf will not be freed twice or not freed
-	pSchema->pXsdBuf = osmemref(pXmlBuf);
+	pthread_rwlock_unlock(&gXsdNSListLock);
 
 EXIT:
 	if(status != OS_STATUS_OK)
@@ -175,7 +200,7 @@ EXIT:
 	}
 
 	return pNS;
-} //osXsd_parse()
+}
 	
 
 osXsdSchema_t* osXsd_parseSchema(osMBuf_t* pXmlBuf)	
@@ -255,13 +280,18 @@ osXsdSchema_t* osXsd_parseSchema(osMBuf_t* pXmlBuf)
 		}
 	}
 
+	//index the global elements and types by name atom, so that a type or a root element is resolved without walking the lists
+	pSchema->pGElemIndex = osXsd_atomIndex_create(&pSchema->gElementList, offsetof(osXsdElement_t, elemNameAtom), offsetof(osXsdElement_t, elemName));
+	pSchema->pCTypeIndex = osXsd_atomIndex_create(&pSchema->gComplexList, offsetof(osXmlComplexType_t, typeNameAtom), offsetof(osXmlComplexType_t, typeName));
+	pSchema->pSTypeIndex = osXsd_atomIndex_create(&pSchema->gSimpleList, offsetof(osXmlSimpleType_t, typeNameAtom), offsetof(osXmlSimpleType_t, typeName));
+
 	// link the root element with the child complex type.
 	osListElement_t* pLE = pSchema->gElementList.head;
 	while(pLE)
 	{
 //tempPrint(&ctypeList, 1);
 		pRootElem = pLE->data;
-		status = osXsd_elemLinkChild(pRootElem, &pSchema->gComplexList, &pSchema->gSimpleList);
+		status = osXsd_elemLinkChild(pRootElem, pSchema);
 //tempPrint(&ctypeList, 2);
 		pLE = pLE->next;
 	}
@@ -350,17 +380,17 @@ bool osXsd_isValid(osMBuf_t* pXsdBuf, osPointerLen_t* xsdName, bool isKeepNsList
 
 /* link the parent and child complex type to make a tree.  When this function is called, all global complexType and simpleType shall have been resolved.
  * The first call of this function shall have pParentElem as the xsd root element.
+ * When a complex type is resolved, its child index is built, so that a xml tag is matched to a child element in O(1).
  * pParentElem: IN, the parent element
- * pCTypeList:  IN, a list of osXmlComplexType_t entries
- * pSTypeList:  IN, a list of osXmlSimpleType_t entries
+ * pSchema:     IN, the schema that contains the global complexType and simpleType lists and their indexes
  */
-static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osList_t* pCTypeList, osList_t* pSTypeList)
+static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osXsdSchema_t* pSchema)
 {
 	osStatus_e status = OS_STATUS_OK;
 
-	if(!pParentElem || !pCTypeList)
+	if(!pParentElem || !pSchema)
 	{
-		logError("null pointyer, pParentElem=%p, pCTypeList=%p.", pParentElem, pCTypeList);
+		logError("null pointyer, pParentElem=%p, pSchema=%p.", pParentElem, pSchema);
 		status = OS_ERROR_NULL_POINTER;
 		goto EXIT;
 	}
@@ -376,15 +406,20 @@ static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osList_t* pCT
 	switch(pParentElem->dataType)
 	{
 		case OS_XML_DATA_TYPE_NO_XS:
-			pParentElem->pComplex = osXsd_getTypeByname(pCTypeList, &pParentElem->elemTypeName);
+			pParentElem->pComplex = osXsd_getTypeByname(&pSchema->gComplexList, pSchema->pCTypeIndex, &pParentElem->elemTypeName, pParentElem->elemTypeNameAtom);
 			//first check if the element is a complex type
 			if(pParentElem->pComplex)
 			{
 				pParentElem->dataType = OS_XML_DATA_TYPE_COMPLEX;
+				if(!pParentElem->pComplex->pChildIndex)
+				{
+					pParentElem->pComplex->pChildIndex = osXsd_atomIndex_create(&pParentElem->pComplex->elemList, offsetof(osXsdElement_t, elemNameAtom), offsetof(osXsdElement_t, elemName));
+				}
+
 	            osListElement_t* pLE = pParentElem->pComplex->elemList.head;
     	        while(pLE)
         	    {
-            	    status = osXsd_elemLinkChild((osXsdElement_t*)pLE->data, pCTypeList, pSTypeList);
+            	    status = osXsd_elemLinkChild((osXsdElement_t*)pLE->data, pSchema);
                 	if(status != OS_STATUS_OK)
                 	{
                     	logError("fails to osXsd_elemLinkChild for (%r).", pLE->data ? &((osXsdElement_t*)pLE->data)->elemName : NULL);
@@ -396,7 +431,7 @@ static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osList_t* pCT
 			}
 
 			//if not a complex type, check if it is a simple type
-			pParentElem->pSimple = osXsd_getTypeByname(pSTypeList, &pParentElem->elemTypeName);
+			pParentElem->pSimple = osXsd_getTypeByname(&pSchema->gSimpleList, pSchema->pSTypeIndex, &pParentElem->elemTypeName, pParentElem->elemTypeNameAtom);
 			if(pParentElem->pSimple)
 			{
 				pParentElem->dataType = OS_XML_DATA_TYPE_SIMPLE;
@@ -416,6 +451,11 @@ static osStatus_e osXsd_elemLinkChild(osXsdElement_t* pParentElem, osList_t* pCT
 				status = OS_ERROR_INVALID_VALUE;
 				goto EXIT;
 			}
+
+			if(!pParentElem->pComplex->pChildIndex)
+			{
+				pParentElem->pComplex->pChildIndex = osXsd_atomIndex_create(&pParentElem->pComplex->elemList, offsetof(osXsdElement_t, elemNameAtom), offsetof(osXsdElement_t, elemName));
+			}
 			break;
 		case OS_XML_DATA_TYPE_SIMPLE:
             //this is the case for a simple type embedded inside a <xs:element></xs:element>, the pParentElem->pSimple shall have been resolved
@@ -644,11 +684,11 @@ osStatus_e osXsd_parseSchemaTag(osMBuf_t* pXmlBuf, osXsd_schemaInfo_t* pSchemaIn
     }
 
 	bool isXSAliasFound = false;
-	osListElement_t* pLE = pTagInfo->attrNVList.head;
 	osXsd_nsAliasInfo_t* pnsAlias;
-	while(pLE)
+	for(uint32_t i=0; i<osVec_getCount(&pTagInfo->attrNVList); i++)
 	{
-		status = osXml_getNSAlias((osXmlNameValue_t*)pLE->data, &pSchemaInfo->defaultNS, &pnsAlias, &isXSAliasFound, &pSchemaInfo->xsAlias);
+		osXmlNameValue_t* pNV = osVec_get(&pTagInfo->attrNVList, i);
+		status = osXml_getNSAlias(pNV, &pSchemaInfo->defaultNS, &pnsAlias, &isXSAliasFound, &pSchemaInfo->xsAlias);
 		if(status != OS_STATUS_OK)
 		{
 			logError("fails to osXml_getNSAlias().");
@@ -660,14 +700,12 @@ osStatus_e osXsd_parseSchemaTag(osMBuf_t* pXmlBuf, osXsd_schemaInfo_t* pSchemaIn
 		{
 			osList_append(&pSchemaInfo->nsAliasList, pnsAlias);
 		}
-		else if(osPL_strplcmp("targetNamespace", 15, &((osXmlNameValue_t*)pLE->data)->name, true) == 0)
+		else if(osPL_strplcmp("targetNamespace", 15, &pNV->name, true) == 0)
 		{
 			//also copy pl->p
-			osDPL_dup(&pSchemaInfo->targetNS, &((osXmlNameValue_t*)pLE->data)->value);
-			//pSchemaInfo->targetNS = ((osXmlNameValue_t*)pLE->data)->value;
+			osDPL_dup(&pSchemaInfo->targetNS, &pNV->value);
+			//pSchemaInfo->targetNS = pNV->value;
 		}
-
-		pLE = pLE->next;
 	}
 
 	if(!isXSAliasFound)
@@ -954,7 +992,7 @@ EXIT:
 }
 
 
-osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElement)
+osStatus_e osXmlElement_getAttrInfo(osVec_t* pAttrList, osXsdElement_t* pElement)
 {
 	osStatus_e status = OS_STATUS_OK;
 	if(!pElement || !pAttrList)
@@ -968,10 +1006,9 @@ osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElemen
     pElement->minOccurs = 1;
     pElement->maxOccurs = 1;
 
-	osListElement_t* pLE = pAttrList->head;
-	while(pLE)
+	for(uint32_t i=0; i<osVec_getCount(pAttrList); i++)
 	{
-		osXmlNameValue_t* pNV = pLE->data;
+		osXmlNameValue_t* pNV = osVec_get(pAttrList, i);
 		if(!pNV)
 		{
 			logError("pNV is NULL, this shall never happen.");
@@ -985,6 +1022,7 @@ osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElemen
 				if(pNV->name.l == 4 && strncmp("name", pNV->name.p, pNV->name.l) == 0)		
 				{
 					pElement->elemName = pNV->value;
+					pElement->elemNameAtom = osAtom_intern(&pElement->elemName, false);
 				}
 				else if(pElement->dataType == OS_XML_DATA_TYPE_ANY && pNV->name.l == 9 && strncmp("namespace", pNV->name.p, pNV->name.l) == 0)
 				{
@@ -1009,6 +1047,7 @@ osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElemen
 				if(pNV->name.l == 4 && strncmp("type", pNV->name.p, pNV->name.l) == 0)
                 {
 					pElement->elemTypeName = pNV->value;
+					pElement->elemTypeNameAtom = osAtom_intern(&pElement->elemTypeName, false);
 				}
 				pElement->dataType = osXsd_getElemDataType(&pElement->elemTypeName);
 				break;
@@ -1111,8 +1150,6 @@ osStatus_e osXmlElement_getAttrInfo(osList_t* pAttrList, osXsdElement_t* pElemen
 				logError("unexpected element attribute, ignore.");
 				break;
 		}
-
-		pLE = pLE->next;
 	}
 
 EXIT:
@@ -1133,10 +1170,12 @@ static osStatus_e osXmlElement_getSubTagInfo(osXsdElement_t* pElement, osXmlTagI
  * it does not matter which type to cast in osPL_cmp().  In the implementation, osXmlComplexType_t* is casted
  *
  * pTypeList:     IN, either pCTypeList or pSTypeList.
+ * pTypeIndex:    IN, the atom index of pTypeList, can be NULL.  When both pTypeIndex and elemTypeNameAtom are available, pTypeList is not walked
  * pElemTypeName: IN, the type name of an element that is trying to get the type and type object
+ * elemTypeNameAtom: IN, the atom of pElemTypeName, OS_ATOM_NONE if not interned
  * return value:  void*, can be either osXmlComplexType_t or osXmlSimpleType_t.  The caller shall know which it is based on the pTypeList it used
  */
-static void* osXsd_getTypeByname(osList_t* pTypeList, osPointerLen_t* pElemTypeName)
+static void* osXsd_getTypeByname(osList_t* pTypeList, osXsd_atomIndex_t* pTypeIndex, osPointerLen_t* pElemTypeName, osAtom_t elemTypeNameAtom)
 {
 	if(!pTypeList || !pElemTypeName)
 	{
@@ -1144,10 +1183,16 @@ static void* osXsd_getTypeByname(osList_t* pTypeList, osPointerLen_t* pElemTypeN
 		return NULL;
 	}
 
+	if(pTypeIndex && elemTypeNameAtom != OS_ATOM_NONE)
+	{
+		return osXsd_atomIndex_get(pTypeIndex, elemTypeNameAtom, NULL);
+	}
+
 	osListElement_t* pLE = pTypeList->head;
 	while(pLE)
 	{
-		if(osPL_cmp(&((osXmlComplexType_t*)pLE->data)->typeName, pElemTypeName) == 0)
+		//osXmlComplexType_t and osXmlSimpleType_t have typeName and typeNameAtom at the same offset
+		if(osAtom_isPLEqual(((osXmlComplexType_t*)pLE->data)->typeNameAtom, &((osXmlComplexType_t*)pLE->data)->typeName, elemTypeNameAtom, pElemTypeName))
 		{
 			return pLE->data;
 		}
@@ -1346,9 +1391,10 @@ bool osXsd_isExistSchema(osPointerLen_t* pTargetNS)
     if(!pTargetNS)
     {
         logError("NULL pointer, pTargetNS=%p.", pTargetNS);
-        goto EXIT;
+        return false;
     }
 
+	pthread_rwlock_rdlock(&gXsdNSListLock);
     osListElement_t* pLE = gXsdNSList.head;
     while(pLE)
     {
@@ -1384,14 +1430,82 @@ bool osXsd_isExistSchema(osPointerLen_t* pTargetNS)
 	}
 
 EXIT:
+	pthread_rwlock_unlock(&gXsdNSListLock);
 	return isExistNS;
 }
 
 
+/* collect the schemas of a target namespace into pSchemaVec, or the schema of a xsd name if the xsd has no target namespace.
+ * pName:            IN, the target namespace or the xsd name
+ * pSchemaVec:       OUT, each entry is a osXsdSchema_t, the schemas are still owned by the global NS list
+ * pIsEmptyTargetNS: OUT, whether pName is a xsd name of a no target namespace xsd
+ */
+osStatus_e osXsd_getSchemas(osPointerLen_t* pName, osVec_t* pSchemaVec, bool* pIsEmptyTargetNS)
+{
+	osStatus_e status = OS_STATUS_OK;
+	osXsdNamespace_t* pNullNS = NULL;
+
+    if(!pName || !pSchemaVec || !pIsEmptyTargetNS)
+    {
+        logError("NULL pointer, pName=%p, pSchemaVec=%p, pIsEmptyTargetNS=%p.", pName, pSchemaVec, pIsEmptyTargetNS);
+        return OS_ERROR_NULL_POINTER;
+    }
+
+	*pIsEmptyTargetNS = false;
+	pthread_rwlock_rdlock(&gXsdNSListLock);
+    osListElement_t* pLE = gXsdNSList.head;
+    while(pLE)
+    {
+		if(((osXsdNamespace_t*)pLE->data)->pTargetNS == NULL)
+		{
+			pNullNS = pLE->data;
+		}
+       	else if(osPL_cmp(pName, ((osXsdNamespace_t*)pLE->data)->pTargetNS) == 0)
+       	{
+			osListElement_t* pLE1 = ((osXsdNamespace_t*)pLE->data)->schemaList.head;
+			while(pLE1)
+			{
+				status = osVec_append(pSchemaVec, pLE1->data);
+				if(status != OS_STATUS_OK)
+				{
+					goto EXIT;
+				}
+				pLE1 = pLE1->next;
+			}
+           	goto EXIT;
+       	}
+        pLE = pLE->next;
+    }
+
+	if(pNullNS)
+	{
+        osListElement_t* pLE1 = pNullNS->schemaList.head;
+        while(pLE1)
+        {
+			if(osPL_cmp((osPointerLen_t*)&((osXsdSchema_t*)pLE1->data)->schemaInfo.targetNS, pName) == 0)
+			{
+				*pIsEmptyTargetNS = true;
+				status = osVec_append(pSchemaVec, pLE1->data);
+				goto EXIT;
+			}
+			pLE1 = pLE1->next;
+		}
+	}
+
+	logError("xsd(%r) has not been parsed.", pName);
+	status = OS_ERROR_INVALID_VALUE;
+
+EXIT:
+	pthread_rwlock_unlock(&gXsdNSListLock);
+	return status;
+}
+
+
 void osXsd_dbgListTargetNS()
 {
     osXsdNamespace_t* pNS = NULL;
 
+	pthread_rwlock_rdlock(&gXsdNSListLock);
 	debug("gXsdNSList count = %d.", osList_getCount(&gXsdNSList));
     osListElement_t* pLE = gXsdNSList.head;
     while(pLE)
@@ -1414,6 +1528,7 @@ void osXsd_dbgListTargetNS()
 
         pLE = pLE->next;
     }
+	pthread_rwlock_unlock(&gXsdNSListLock);
 }
 	
 
@@ -1476,6 +1591,7 @@ osXsdElement_t* osXsd_getNSRootElem(osPointerLen_t* pTargetNS, bool isEmptyTarge
 	}
 
 	//find the right NS from gXsdNSList based on pTargetNS and isEmptyTargetNS
+	pthread_rwlock_rdlock(&gXsdNSListLock);
 	osListElement_t* pLE = gXsdNSList.head;
 	while(pLE)
 	{
@@ -1510,14 +1626,14 @@ osXsdElement_t* osXsd_getNSRootElem(osPointerLen_t* pTargetNS, bool isEmptyTarge
 			{
 				if(osPL_cmp((osPointerLen_t*)&((osXsdSchema_t*)pLE1->data)->schemaInfo.targetNS, pTargetNS) == 0)
 				{
-					pElem = osXsd_getElementFromList(&((osXsdSchema_t*)pLE1->data)->gElementList, pElemTag);
+					pElem = osXsd_getElementFromList(&((osXsdSchema_t*)pLE1->data)->gElementList, ((osXsdSchema_t*)pLE1->data)->pGElemIndex, pElemTag);
 					break;
 				}
 			}
 			else
 			{
 				//for targetNS, going through the schema one after another (a ns may contains multiple schema)
-				pElem = osXsd_getElementFromList(&((osXsdSchema_t*)pLE1->data)->gElementList, pElemTag);
+				pElem = osXsd_getElementFromList(&((osXsdSchema_t*)pLE1->data)->gElementList, ((osXsdSchema_t*)pLE1->data)->pGElemIndex, pElemTag);
 				if(pElem)
 				{
 					break;
@@ -1527,6 +1643,7 @@ osXsdElement_t* osXsd_getNSRootElem(osPointerLen_t* pTargetNS, bool isEmptyTarge
 			pLE1 = pLE1->next;
 		}
 	}
+	pthread_rwlock_unlock(&gXsdNSListLock);
 
 EXIT:
 	mdebug(LM_XMLP, "root element for tag(%r) in pTargetNS(%r), isEmptyTargetNS(%d) is %s", pElemTag, pTargetNS, isEmptyTargetNS, pElem ? "found" : "not found");
@@ -1539,7 +1656,8 @@ EXIT:
 }
 
 
-static osXsdElement_t* osXsd_getElementFromList(osList_t* pList, osPointerLen_t* pTag)
+//pIndex is the atom index of pList, can be NULL
+static osXsdElement_t* osXsd_getElementFromList(osList_t* pList, osXsd_atomIndex_t* pIndex, osPointerLen_t* pTag)
 {
     osXsdElement_t* pElem = NULL;
     if(!pList || !pTag)
@@ -1547,10 +1665,22 @@ static osXsdElement_t* osXsd_getElementFromList(osList_t* pList, osPointerLen_t*
         return NULL;
     }
 
+    //all xsd element names are interned, a tag that is not interned can not match any of them
+    osAtom_t tagAtom = osAtom_find(pTag, false);
+    if(tagAtom == OS_ATOM_NONE)
+    {
+        return NULL;
+    }
+
+    if(pIndex)
+    {
+        return osXsd_atomIndex_get(pIndex, tagAtom, NULL);
+    }
+
     osListElement_t* pLE = pList->head;
     while(pLE)
     {
-        if(osPL_cmp(&((osXsdElement_t*)pLE->data)->elemName, pTag) == 0)
+        if(osAtom_isPLEqual(((osXsdElement_t*)pLE->data)->elemNameAtom, &((osXsdElement_t*)pLE->data)->elemName, tagAtom, pTag))
         {
             pElem = pLE->data;
             break;
@@ -1599,6 +1729,9 @@ void osXsdSchema_cleanup(void* data)
 	osList_delete(&pSchema->gElementList);
 	osList_delete(&pSchema->gComplexList);
 	osList_delete(&pSchema->gSimpleList);
+	osfree(pSchema->pGElemIndex);
+	osfree(pSchema->pCTypeIndex);
+	osfree(pSchema->pSTypeIndex);
 	osList_delete(&pSchema->schemaInfo.nsAliasList);
 	osDPL_dealloc((osDPointerLen_t*)&pSchema->schemaInfo.targetNS);
 	osfree(pSchema->pXsdBuf);
@@ -1620,6 +1753,7 @@ void osXsd_freeNsList(osPointerLen_t* pTargetNS)
 {
 	osListElement_t* pEmptyNSLE = NULL;
 
+	pthread_rwlock_wrlock(&gXsdNSListLock);
 	osListElement_t* pLE = gXsdNSList.head;
 	while(pLE)
 	{
@@ -1665,5 +1799,5 @@ void osXsd_freeNsList(osPointerLen_t* pTargetNS)
     }
 
 EXIT:
-	return;
+	pthread_rwlock_unlock(&gXsdNSListLock);
 }
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osPL.h"
+#include "osGenericParam.h"
+
+
+/* check osGenericParam_get/isExist/apply/tokenize and the perfect hash osGenericParam_getMulti against
+ * a set of parameter strings, including repeated names, empty values, quoted values and a trailing ';'.
+ * usage: ./gparam
+ */
+
+
+typedef struct gparamGetCase {
+	const char* pl;
+	const char* name;
+	bool isExist;			//expected osGenericParam_isExist()
+	const char* value;		//expected osGenericParam_get() value, NULL if get shall return false
+} gparamGetCase_t;
+
+
+static gparamGetCase_t getCase[] = {
+	{";transport=tcp;lr", "transport", true, "tcp"},
+	{";transport=tcp;lr", "TRANSPORT", true, "tcp"},
+	{";transport=tcp;lr", "lr", true, NULL},
+	{";transport=tcp;lr", "maddr", false, NULL},
+	{";ab=1", "a", false, NULL},
+	{";a=1;", "a", true, "1"},
+	{"a=1;;b;", "b", true, NULL},
+	{";x;x=1", "x", true, "1"},
+	{";x=;x=2", "x", true, "2"},
+	{";x=1;x=2", "x", true, "1"},
+	{";x=", "x", true, NULL},
+	{";x=\"\"", "x", true, NULL},
+	{" ; a = 1 ; b", "a", true, "1"},
+	{";tag=\"a;b c\";x=y", "tag", true, "a;b c"},
+	{";tag=\"a;b c\";x=y", "x", true, "y"},
+	{";tag=\"a\\\"b\";x=y", "x", true, "y"},
+};
+
+
+static int failNum;
+
+
+static void check(bool isOK, const char* desc, const char* pl)
+{
+	if(!isOK)
+	{
+		printf("failed: %s, pl=%s\n", desc, pl);
+		failNum++;
+	}
+}
+
+
+static bool isPLEqual(const osPointerLen_t* pl, const char* str)
+{
+	return pl->l == strlen(str) && !memcmp(pl->p, str, pl->l);
+}
+
+
+static void countParam(const osPointerLen_t *name, const osPointerLen_t *val, void *arg)
+{
+	(*(int*)arg)++;
+}
+
+
+static void testGet(void)
+{
+	for(int i=0; i<sizeof(getCase)/sizeof(getCase[0]); i++)
+	{
+		osPointerLen_t pl = {getCase[i].pl, strlen(getCase[i].pl)};
+		osPointerLen_t value = {NULL, 0};
+
+		check(osGenericParam_isExist(&pl, getCase[i].name) == getCase[i].isExist, "isExist", getCase[i].pl);
+
+		bool isFound = osGenericParam_get(&pl, getCase[i].name, &value);
+		if(getCase[i].value)
+		{
+			check(isFound && isPLEqual(&value, getCase[i].value), "get", getCase[i].pl);
+		}
+		else
+		{
+			check(!isFound, "get without value", getCase[i].pl);
+		}
+	}
+}
+
+
+static void testTokenize(void)
+{
+	const char* str = ";x;x=1; y= ;z=\"q;w\";";
+	const char* expect[][2] = {{"x", ""}, {"x", "1"}, {"y", ""}, {"z", "q;w"}};
+	osPointerLen_t pl = {str, strlen(str)};
+	osGenericParam_t param[8];
+
+	int num = osGenericParam_tokenize(&pl, param, 8);
+	check(num == 4, "tokenize number", str);
+	for(int i=0; i<num && i<4; i++)
+	{
+		check(isPLEqual(&param[i].name, expect[i][0]) && isPLEqual(&param[i].value, expect[i][1]), "tokenize pair", str);
+	}
+
+	check(osGenericParam_tokenize(&pl, param, 2) == 2, "tokenize paramMax", str);
+
+	int count = 0;
+	osGenericParam_apply(&pl, countParam, &count);
+	check(count == 4, "apply", str);
+
+	const char* empty[] = {"", ";", " ; ;; ", "=1;=2"};
+	for(int i=0; i<sizeof(empty)/sizeof(empty[0]); i++)
+	{
+		pl = (osPointerLen_t){empty[i], strlen(empty[i])};
+		check(osGenericParam_tokenize(&pl, param, 8) == 0, "tokenize without parameter", empty[i]);
+	}
+}
+
+
+static void testGetMulti(void)
+{
+	const char* name[] = {"transport", "lr", "maddr", "ttl"};
+	osGenericParamSet_t set;
+
+	check(osGenericParamSet_init(&set, name, 4) == 0, "set init", "");
+
+	for(int i=0; i<4; i++)
+	{
+		osPointerLen_t pl = {name[i], strlen(name[i])};
+		check(osGenericParamSet_lookup(&set, &pl) == i, "set lookup", name[i]);
+	}
+	osPointerLen_t upper = {"LR", 2};
+	check(osGenericParamSet_lookup(&set, &upper) == 1, "set lookup case insensitive", "LR");
+	osPointerLen_t unknown = {"user", 4};
+	check(osGenericParamSet_lookup(&set, &unknown) == -1, "set lookup of a non member", "user");
+
+	const char* str = ";lr;transport=tcp;ttl=;TTL=5;unknown=1;transport=udp;";
+	osPointerLen_t pl = {str, strlen(str)};
+	osGenericParam_t param[4];
+	check(osGenericParam_getMulti(&pl, &set, param) == 3, "getMulti number", str);
+	check(isPLEqual(&param[0].value, "tcp"), "getMulti first transport wins", str);
+	check(isPLEqual(&param[1].name, "lr") && param[1].value.l == 0, "getMulti lr without value", str);
+	check(param[2].name.l == 0, "getMulti maddr not exist", str);
+	check(isPLEqual(&param[3].name, "ttl") && param[3].value.l == 0, "getMulti first ttl wins even without value", str);
+
+	const char* dup[] = {"lr", "ttl", "LR"};
+	check(osGenericParamSet_init(&set, dup, 3) == EINVAL, "set init with duplicate names", "");
+
+	//a full set
+	char fullName[OS_GENERIC_PARAM_SET_MAX_NUM][16];
+	const char* pFullName[OS_GENERIC_PARAM_SET_MAX_NUM + 1];
+	for(int i=0; i<OS_GENERIC_PARAM_SET_MAX_NUM; i++)
+	{
+		snprintf(fullName[i], sizeof(fullName[i]), "param%d", i);
+		pFullName[i] = fullName[i];
+	}
+	check(osGenericParamSet_init(&set, pFullName, OS_GENERIC_PARAM_SET_MAX_NUM) == 0, "full set init", "");
+	for(int i=0; i<OS_GENERIC_PARAM_SET_MAX_NUM; i++)
+	{
+		osPointerLen_t pl = {fullName[i], strlen(fullName[i])};
+		check(osGenericParamSet_lookup(&set, &pl) == i, "full set lookup", fullName[i]);
+	}
+	pFullName[OS_GENERIC_PARAM_SET_MAX_NUM] = "extra";
+	check(osGenericParamSet_init(&set, pFullName, OS_GENERIC_PARAM_SET_MAX_NUM + 1) == EINVAL, "set init with too many names", "");
+}
+
+
+int main(int argc, char* argv[])
+{
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	testGet();
+	testTokenize();
+	testGetMulti();
+
+	if(failNum)
+	{
+		printf("generic param failed, %d checks failed.\n", failNum);
+		return 1;
+	}
+
+	printf("generic param OK.\n");
+	return 0;
+}
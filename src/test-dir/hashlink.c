@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osPL.h"
+#include "osList.h"
+#include "osHash.h"
+
+
+/* add, look up and remove user data structures in a hash via the embedded osHashLink_t, mixed with the allocated
+ * hash elements, and check osHash_clear()/osHash_delete() leave the linked user data structures alone.
+ * usage: ./hashlink
+ */
+
+
+#define HASH_LINK_TEST_NUM			200
+#define HASH_LINK_TEST_BUCKET_SIZE	16
+
+
+typedef struct hashLinkUser {
+	uint32_t id;
+	char name[16];
+	osPointerLen_t namePL;
+	osHashLink_t link;
+} hashLinkUser_t;
+
+
+static int failNum;
+
+
+static void check(bool isOK, const char* desc, int idx)
+{
+	if(!isOK)
+	{
+		printf("failed: %s, idx=%d\n", desc, idx);
+		failNum++;
+	}
+}
+
+
+//even users are keyed by id, odd users by name
+static void addUser(osHash_t* pHash, hashLinkUser_t* pUser)
+{
+	if(pUser->id % 2)
+	{
+		pUser->link.hashData.hashKeyType = OSHASHKEY_STR;
+		pUser->link.hashData.hashKeyStr.pl = pUser->namePL;
+		pUser->link.hashData.hashKeyStr.isCase = true;
+	}
+	else
+	{
+		pUser->link.hashData.hashKeyType = OSHASHKEY_INT;
+		pUser->link.hashData.hashKeyInt = pUser->id;
+	}
+
+	osListElement_t* pLE = osHash_addLink(pHash, &pUser->link, pUser);
+	check(pLE == &pUser->link.hashLE, "addLink", pUser->id);
+}
+
+
+static hashLinkUser_t* lookupUser(osHash_t* pHash, hashLinkUser_t* pUser)
+{
+	osListElement_t* pLE;
+	if(pUser->id % 2)
+	{
+		osStrKeyInfo_t key = {pUser->namePL, true};
+		pLE = osHash_lookupByKey(pHash, &key, OSHASHKEY_STR);
+	}
+	else
+	{
+		pLE = osHash_lookupByKey(pHash, &pUser->id, OSHASHKEY_INT);
+	}
+
+	if(!pLE)
+	{
+		return NULL;
+	}
+
+	hashLinkUser_t* pFound = osHash_getUserDataByLE(pLE);
+	check(osList_entry(osHash_getLink(pLE), hashLinkUser_t, link) == pFound, "link entry is the user data", pUser->id);
+	return pFound;
+}
+
+
+int main(int argc, char* argv[])
+{
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osHash_t* pHash = osHash_create(HASH_LINK_TEST_BUCKET_SIZE);
+	hashLinkUser_t* user = calloc(HASH_LINK_TEST_NUM, sizeof(hashLinkUser_t));
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		user[i].id = i;
+		user[i].namePL.l = snprintf(user[i].name, sizeof(user[i].name), "user-%d", i);
+		user[i].namePL.p = user[i].name;
+		addUser(pHash, &user[i]);
+	}
+	check(osHash_addLink(pHash, &user[0].link, &user[0]) == NULL, "a link can not be added twice", 0);
+
+	//allocated elements with int keys beyond the user ids in the same hash
+	for(uint32_t i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		osHashData_t* pHashData = oszalloc(sizeof(osHashData_t), NULL);
+		pHashData->hashKeyType = OSHASHKEY_INT;
+		pHashData->hashKeyInt = HASH_LINK_TEST_NUM + i;
+		check(osHash_add(pHash, pHashData) != NULL, "add an allocated element", i);
+	}
+	check(osHash_getBucketElementsCountGlobal(pHash) == 2 * HASH_LINK_TEST_NUM, "element count", 0);
+
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		check(lookupUser(pHash, &user[i]) == &user[i], "lookup", i);
+	}
+
+	//remove every third user, the others are still found
+	for(int i=0; i<HASH_LINK_TEST_NUM; i+=3)
+	{
+		osHash_removeLink(&user[i].link);
+		check(user[i].link.hashLE.list == NULL, "removeLink unlinks", i);
+	}
+	osHash_removeLink(&user[0].link);
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		check(lookupUser(pHash, &user[i]) == (i % 3 ? &user[i] : NULL), "lookup after removeLink", i);
+	}
+
+	//a removed link can be added again
+	addUser(pHash, &user[0]);
+	check(lookupUser(pHash, &user[0]) == &user[0], "lookup after add again", 0);
+
+	//clear frees the allocated elements, and only unlinks the links
+	osHash_clear(pHash);
+	check(osHash_getBucketElementsCountGlobal(pHash) == 0, "count after clear", 0);
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		check(user[i].link.hashLE.list == NULL && user[i].id == i, "user data after clear", i);
+		check(lookupUser(pHash, &user[i]) == NULL, "lookup after clear", i);
+	}
+
+	//delete behaves the same for the links
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		addUser(pHash, &user[i]);
+	}
+	osHashData_t* pHashData = oszalloc(sizeof(osHashData_t), NULL);
+	pHashData->hashKeyType = OSHASHKEY_INT;
+	pHashData->hashKeyInt = HASH_LINK_TEST_NUM;
+	osHash_add(pHash, pHashData);
+	osHash_delete(pHash);
+	for(int i=0; i<HASH_LINK_TEST_NUM; i++)
+	{
+		check(user[i].link.hashLE.list == NULL && user[i].id == i && !osPL_strcmp(&user[i].namePL, user[i].name), "user data after delete", i);
+	}
+
+	osfree(pHash);
+	free(user);
+
+	if(failNum)
+	{
+		printf("hash link failed, %d checks failed.\n", failNum);
+		return 1;
+	}
+
+	printf("hash link OK.\n");
+	return 0;
+}
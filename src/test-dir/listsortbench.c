@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osList.h"
+
+
+//benchmark of osList_sort() and osList_orderAppendBatch().  usage: ./listsortbench [num], num defaults to 10000
+
+#define LIST_BENCH_DEFAULT_NUM	10000
+
+typedef struct {
+	uint32_t key;
+	uint32_t seq;		//the input order, to check the stability
+} listBenchData_t;
+
+
+static long long nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+//osList_sort() semantics, true if le1 can stay before le2
+static bool listBench_isInOrder(osListElement_t *le1, osListElement_t *le2, void *arg)
+{
+	return ((listBenchData_t*)le1->data)->key <= ((listBenchData_t*)le2->data)->key;
+}
+
+
+//osList_orderAppend() semantics, true if le2 shall be placed before le1
+static bool listBench_isSwitch(osListElement_t *le1, osListElement_t *le2, void *arg)
+{
+	return ((listBenchData_t*)le1->data)->key > ((listBenchData_t*)le2->data)->key;
+}
+
+
+//the swap-adjacent sort osList_sort() used before, kept here as the reference
+static void listBench_swapSort(osList_t *list, osListSortHandler sortHandler, void *arg)
+{
+	uint32_t totalLE = osList_getCount(list);
+
+	while(totalLE > 1)
+	{
+		osListElement_t *le = list->head;
+		for(uint32_t i=1; i<totalLE; i++, le = le->next)
+		{
+			if(!sortHandler(le, le->next, arg))
+			{
+				void* data = le->data;
+				le->data = le->next->data;
+				le->next->data = data;
+			}
+		}
+		totalLE--;
+	}
+}
+
+
+//return true if the list is sorted by key, and equal keys are in input order
+static bool listBench_isSorted(osList_t* list, uint32_t num)
+{
+	uint32_t count = 0;
+	listBenchData_t* pPrev = NULL;
+	for(osListElement_t* pLE = list->head; pLE; pLE = pLE->next, count++)
+	{
+		listBenchData_t* pData = pLE->data;
+		if(pPrev && (pPrev->key > pData->key || (pPrev->key == pData->key && pPrev->seq > pData->seq)))
+		{
+			return false;
+		}
+
+		if(pLE->next && pLE->next->prev != pLE)
+		{
+			return false;
+		}
+		pPrev = pData;
+	}
+
+	return count == num && (!list->tail || list->tail->data == pPrev);
+}
+
+
+static void listBench_fill(osList_t* list, listBenchData_t* pData, uint32_t num)
+{
+	osList_init(list);
+	for(uint32_t i=0; i<num; i++)
+	{
+		osList_append(list, &pData[i]);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t num = argc > 1 ? atoi(argv[1]) : LIST_BENCH_DEFAULT_NUM;
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	listBenchData_t* pData = malloc(num * sizeof(listBenchData_t));
+	void** ppData = malloc(num * sizeof(void*));
+	srand(1);
+	for(uint32_t i=0; i<num; i++)
+	{
+		pData[i].key = rand() % (num / 4 + 1);	//with duplicated keys
+		pData[i].seq = i;
+		ppData[i] = &pData[i];
+	}
+
+	osList_t list;
+	long long start;
+
+	listBench_fill(&list, pData, num);
+	start = nsec();
+	listBench_swapSort(&list, listBench_isInOrder, NULL);
+	printf("%-32s %6u elements: %10.3f ms, sorted=%d\n", "swap-adjacent sort", num, (nsec() - start) / 1e6, listBench_isSorted(&list, num));
+	osList_clear(&list);
+
+	listBench_fill(&list, pData, num);
+	start = nsec();
+	osList_sort(&list, listBench_isInOrder, NULL);
+	printf("%-32s %6u elements: %10.3f ms, sorted=%d\n", "osList_sort", num, (nsec() - start) / 1e6, listBench_isSorted(&list, num));
+	osList_clear(&list);
+
+	osList_init(&list);
+	start = nsec();
+	for(uint32_t i=0; i<num; i++)
+	{
+		osList_orderAppend(&list, listBench_isSwitch, ppData[i], NULL);
+	}
+	printf("%-32s %6u elements: %10.3f ms, sorted=%d\n", "osList_orderAppend", num, (nsec() - start) / 1e6, listBench_isSorted(&list, num));
+	osList_clear(&list);
+
+	//half of the list already exists, the other half is added in a batch
+	osList_init(&list);
+	osList_orderAppendBatch(&list, listBench_isSwitch, ppData, num / 2, NULL);
+	start = nsec();
+	osList_orderAppendBatch(&list, listBench_isSwitch, &ppData[num / 2], num - num / 2, NULL);
+	printf("%-32s %6u elements: %10.3f ms, sorted=%d\n", "osList_orderAppendBatch (half)", num, (nsec() - start) / 1e6, listBench_isSorted(&list, num));
+	osList_clear(&list);
+
+	osList_init(&list);
+	start = nsec();
+	osList_orderAppendBatch(&list, listBench_isSwitch, ppData, num, NULL);
+	printf("%-32s %6u elements: %10.3f ms, sorted=%d\n", "osList_orderAppendBatch", num, (nsec() - start) / 1e6, listBench_isSorted(&list, num));
+
+	//a batch with a NULL data is rejected as a whole, the list is not changed
+	void* pSaved = ppData[num / 2];
+	ppData[num / 2] = NULL;
+	osStatus_e status = osList_orderAppendBatch(&list, listBench_isSwitch, ppData, num, NULL);
+	ppData[num / 2] = pSaved;
+	printf("%-32s %6u elements: status=%d, count=%u, sorted=%d\n", "osList_orderAppendBatch (NULL)", num, status, osList_getCount(&list), listBench_isSorted(&list, num));
+	osList_clear(&list);
+
+	free(ppData);
+	free(pData);
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osMBufChain.h"
+#include "osPL.h"
+
+
+/* build chains by osMBufChain_appendRef/appendMBuf/appendPL/appendCopy/appendChain, and read them back
+ * across the segment boundaries via flatten, iovec and the cursor.
+ * usage: ./mbufchain
+ */
+
+
+#define MBUF_CHAIN_TEST_EXPECT_SIZE	4096
+
+
+static char expect[MBUF_CHAIN_TEST_EXPECT_SIZE];
+static size_t expectLen;
+static int failNum;
+
+
+static void check(bool isOK, const char* desc)
+{
+	if(!isOK)
+	{
+		printf("failed: %s\n", desc);
+		failNum++;
+	}
+}
+
+
+static void appendExpect(const void* data, size_t len)
+{
+	memcpy(&expect[expectLen], data, len);
+	expectLen += len;
+}
+
+
+static void appendRef(osMBufChain_t* pChain, osMBuf_t* pMBuf, size_t startPos, size_t len)
+{
+	check(osMBufChain_appendRef(pChain, pMBuf, startPos, len) == 0, "appendRef");
+	appendExpect(&pMBuf->buf[startPos], len);
+}
+
+
+static void appendCopy(osMBufChain_t* pChain, const char* str)
+{
+	check(osMBufChain_appendCopy(pChain, str, strlen(str)) == 0, "appendCopy");
+	appendExpect(str, strlen(str));
+}
+
+
+//read the whole chain back via each reader and compare with expect[0, expectLen)
+static void checkChain(osMBufChain_t* pChain)
+{
+	char buf[MBUF_CHAIN_TEST_EXPECT_SIZE];
+
+	check(osMBufChain_getLen(pChain) == expectLen, "chain len");
+
+	osMBuf_t* pFlat = osMBufChain_flatten(pChain);
+	check(pFlat && pFlat->end == expectLen && memcmp(pFlat->buf, expect, expectLen) == 0, "flatten");
+	osMBuf_dealloc(pFlat);
+
+	//iovec
+	struct iovec iov[128];
+	check(osMBufChain_toIovec(pChain, iov, osMBufChain_getSegNum(pChain) - 1) == -1, "toIovec with a too small iov");
+	int iovNum = osMBufChain_toIovec(pChain, iov, 128);
+	check(iovNum == osMBufChain_getSegNum(pChain), "toIovec iov number");
+	size_t len = 0;
+	for(int i=0; i<iovNum; i++)
+	{
+		memcpy(&buf[len], iov[i].iov_base, iov[i].iov_len);
+		len += iov[i].iov_len;
+	}
+	check(len == expectLen && memcmp(buf, expect, expectLen) == 0, "toIovec data");
+
+	//read in chunks of all sizes, so that each chunk size crosses the segment boundaries at different offsets
+	osMBufChainCursor_t cursor;
+	for(size_t chunk=1; chunk<=17; chunk++)
+	{
+		osMBufChainCursor_init(&cursor, pChain);
+		len = 0;
+		size_t n;
+		while((n = osMBufChainCursor_read(&cursor, &buf[len], chunk)) > 0)
+		{
+			len += n;
+			check(cursor.pos == len && osMBufChainCursor_getRemaining(&cursor) == expectLen - len, "cursor pos after read");
+		}
+		check(len == expectLen && memcmp(buf, expect, expectLen) == 0, "cursor read");
+	}
+
+	//byte by byte
+	osMBufChainCursor_init(&cursor, pChain);
+	bool isMatch = true;
+	for(size_t i=0; i<expectLen; i++)
+	{
+		if(osMBufChainCursor_peekU8(&cursor) != (uint8_t)expect[i] || osMBufChainCursor_readU8(&cursor) != (uint8_t)expect[i])
+		{
+			isMatch = false;
+			break;
+		}
+	}
+	check(isMatch, "cursor readU8");
+	check(osMBufChainCursor_peekU8(&cursor) == -1 && osMBufChainCursor_readU8(&cursor) == -1, "cursor readU8 at the end");
+
+	//advance to each position, the current segment starts with the byte at the position
+	isMatch = true;
+	for(size_t i=0; i<expectLen; i++)
+	{
+		osMBufChainCursor_init(&cursor, pChain);
+		osPointerLen_t seg;
+		if(osMBufChainCursor_advance(&cursor, i) != i || cursor.pos != i)
+		{
+			isMatch = false;
+			break;
+		}
+
+		seg = osMBufChainCursor_getCurSeg(&cursor);
+		if(!seg.p || !seg.l || seg.l > expectLen - i || memcmp(seg.p, &expect[i], seg.l) != 0)
+		{
+			isMatch = false;
+			break;
+		}
+	}
+	check(isMatch, "cursor advance and getCurSeg");
+	osMBufChainCursor_init(&cursor, pChain);
+	check(osMBufChainCursor_advance(&cursor, expectLen + 10) == expectLen, "cursor advance beyond the end");
+	check(osMBufChainCursor_getCurSeg(&cursor).p == NULL, "getCurSeg at the end");
+
+	//find each '|' across the segments
+	osMBufChainCursor_init(&cursor, pChain);
+	isMatch = true;
+	char* p = expect;
+	ssize_t pos;
+	while((pos = osMBufChainCursor_skipUntil(&cursor, '|')) >= 0)
+	{
+		p = memchr(p, '|', expectLen - (p - expect));
+		if(!p || pos != p - expect || osMBufChainCursor_readU8(&cursor) != '|')
+		{
+			isMatch = false;
+			break;
+		}
+		p++;
+	}
+	check(isMatch && memchr(p, '|', expectLen - (p - expect)) == NULL, "cursor skipUntil");
+	check(osMBufChainCursor_getRemaining(&cursor) == 0, "cursor at the end after skipUntil");
+}
+
+
+int main(int argc, char* argv[])
+{
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osMBuf_t* pDigit = osMBuf_alloc(64);
+	osMBuf_writeStr(pDigit, "0123456789abcdefghijklmnopqrstuvwxyz", true);
+	osMBuf_t* pText = osMBuf_alloc(64);
+	osMBuf_writeStr(pText, "The quick brown fox jumps over the lazy dog", true);
+
+	osMBufChain_t* pChain = osMBufChain_alloc();
+
+	//continuous slices of the same memory are merged into one segment
+	appendRef(pChain, pDigit, 0, 10);
+	appendRef(pChain, pDigit, 10, 6);
+	check(osMBufChain_getSegNum(pChain) == 1, "continuous slices are merged");
+	check(osMBufChain_appendRef(pChain, pDigit, 60, 5) != 0, "appendRef beyond the mbuf size is rejected");
+
+	appendCopy(pChain, "\r\n");
+	osPointerLen_t quick = {(char*)&pText->buf[4], 5};
+	check(osMBufChain_appendPL(pChain, pText, &quick) == 0, "appendPL");
+	appendExpect(quick.p, quick.l);
+	osPointerLen_t outside = {"quick", 5};
+	check(osMBufChain_appendPL(pChain, pText, &outside) != 0, "appendPL outside of the mbuf is rejected");
+	check(osMBufChain_appendMBuf(pChain, pText) == 0, "appendMBuf");
+	appendExpect(pText->buf, pText->end);
+
+	//more segments than OS_MBUF_CHAIN_INIT_SEG_NUM, and small copies that fill more than one copy buffer
+	for(int i=0; i<40; i++)
+	{
+		appendRef(pChain, pDigit, i % 30, 3);
+		appendCopy(pChain, i % 8 ? "|" : "|a longer piece that is appended by copy|");
+	}
+	check(osMBufChain_getSegNum(pChain) > OS_MBUF_CHAIN_INIT_SEG_NUM, "segment array grows");
+
+	//the chain keeps its own reference of the appended memory
+	osMBuf_dealloc(pDigit);
+	osMBuf_dealloc(pText);
+
+	checkChain(pChain);
+	printf("chain: len=%lu, segNum=%u.\n", osMBufChain_getLen(pChain), osMBufChain_getSegNum(pChain));
+
+	//a chain of another chain
+	size_t innerLen = expectLen;
+	char inner[MBUF_CHAIN_TEST_EXPECT_SIZE];
+	memcpy(inner, expect, innerLen);
+	expectLen = 0;
+
+	osMBufChain_t* pOuter = osMBufChain_alloc();
+	appendCopy(pOuter, "<head>");
+	check(osMBufChain_appendChain(pOuter, pChain) == 0, "appendChain");
+	appendExpect(inner, innerLen);
+	appendCopy(pOuter, "</head>");
+	check(osMBufChain_appendChain(pOuter, pOuter) != 0, "appendChain to itself is rejected");
+
+	//the outer chain still refers the memory after the inner one is gone
+	osMBufChain_dealloc(pChain);
+	checkChain(pOuter);
+	printf("outer chain: len=%lu, segNum=%u.\n", osMBufChain_getLen(pOuter), osMBufChain_getSegNum(pOuter));
+
+	//reuse after reset
+	osMBufChain_reset(pOuter);
+	check(osMBufChain_getLen(pOuter) == 0 && osMBufChain_getSegNum(pOuter) == 0, "reset");
+	expectLen = 0;
+	appendCopy(pOuter, "after reset");
+	checkChain(pOuter);
+	osMBufChain_dealloc(pOuter);
+
+	if(failNum)
+	{
+		printf("mbuf chain failed, %d checks failed.\n", failNum);
+		return 1;
+	}
+
+	printf("mbuf chain OK.\n");
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osPrintf.h"
+
+
+/* compare the output of the compiled formats, osPrintf_mbufC() and osPrintf_execMBuf(), with osPrintf_mbuf()
+ * byte for byte.  Each mbuf starts small with a prefix, so the compiled path has to expand the mbuf and append
+ * after the existing data.
+ * usage: ./printfc
+ */
+
+
+#define PRINTFC_INIT_MBUF_SIZE	8
+
+
+static int failNum;
+static int caseNum;
+
+
+static void compare(const osMBuf_t* pExpect, const osMBuf_t* pCompiled, const osMBuf_t* pExec, const char* fmt)
+{
+	caseNum++;
+	if(pCompiled->end != pExpect->end || memcmp(pCompiled->buf, pExpect->buf, pExpect->end) ||
+		pExec->end != pExpect->end || memcmp(pExec->buf, pExpect->buf, pExpect->end))
+	{
+		printf("failed: fmt=\"%s\"\n  osPrintf_mbuf: %.*s\n  osPrintf_mbufC: %.*s\n  osPrintf_execMBuf: %.*s\n", fmt,
+			(int)pExpect->end, pExpect->buf, (int)pCompiled->end, pCompiled->buf, (int)pExec->end, pExec->buf);
+		failNum++;
+	}
+}
+
+
+//fmt shall be a string literal, each use of the macro is a separate osPrintf_mbufC() call site
+#define PRINTFC_CHECK(fmt, ...)	do { \
+	osMBuf_t* pExpect_ = osMBuf_alloc(PRINTFC_INIT_MBUF_SIZE); \
+	osMBuf_t* pCompiled_ = osMBuf_alloc(PRINTFC_INIT_MBUF_SIZE); \
+	osMBuf_t* pExec_ = osMBuf_alloc(PRINTFC_INIT_MBUF_SIZE); \
+	osMBuf_writeStr(pExpect_, "pre:", true); \
+	osMBuf_writeStr(pCompiled_, "pre:", true); \
+	osMBuf_writeStr(pExec_, "pre:", true); \
+	osPrintfFmt_t* pFmt_ = osPrintf_compile(fmt); \
+	osPrintf_mbuf(pExpect_, fmt, ##__VA_ARGS__); \
+	osPrintf_mbufC(pCompiled_, fmt, ##__VA_ARGS__); \
+	if(pFmt_) \
+	{ \
+		osPrintf_execMBuf(pExec_, pFmt_, ##__VA_ARGS__); \
+	} \
+	compare(pExpect_, pCompiled_, pExec_, fmt); \
+	osfree(pFmt_); \
+	osMBuf_dealloc(pExpect_); \
+	osMBuf_dealloc(pCompiled_); \
+	osMBuf_dealloc(pExec_); \
+} while(0)
+
+
+int main(int argc, char* argv[])
+{
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osPointerLen_t pl = {"pointer-len", 11};
+	osPointerLen_t emptyPL = {NULL, 0};
+	uint8_t bin[] = {0x00, 0x7f, 0xab, 0xff};
+	osMBuf_t* pMBuf = osMBuf_alloc(32);
+	osMBuf_writeStr(pMBuf, "mbuf content", true);
+	char longStr[300];
+	memset(longStr, 'L', sizeof(longStr) - 1);
+	longStr[sizeof(longStr) - 1] = 0;
+
+	PRINTFC_CHECK("plain literal only");
+	PRINTFC_CHECK("");
+	PRINTFC_CHECK("100%% and %%d");
+	PRINTFC_CHECK("%d|%5d|%-5d|%05d|%5d|%-5d|%05d", 42, 42, 42, 42, -42, -42, -42);
+	PRINTFC_CHECK("%d %d %i", 0, INT_MIN, INT_MAX);
+	PRINTFC_CHECK("%u|%x|%X|%8x|%-8X|%08x", 4000000000u, 0xbeefu, 0xbeefu, 0x1fu, 0x1fu, 0x1fu);
+	PRINTFC_CHECK("%ld %lu %lld %llu %zu", LONG_MIN, ULONG_MAX, LLONG_MIN, ULLONG_MAX, (size_t)12345);
+	PRINTFC_CHECK("%lx|%llX|%016lx", 0xdeadbeefcafeUL, 0xdeadbeefcafeULL, 0x1UL);
+	PRINTFC_CHECK("%c%c|%3c|%-3c|", 'a', 'b', 'c', 'd');
+	PRINTFC_CHECK("%s|%10s|%-10s|%2s|%s", "abc", "abc", "abc", "abcdef", (char*)NULL);
+	PRINTFC_CHECK("%s", longStr);
+	PRINTFC_CHECK("[%300s]", "right aligned in a wide pad");
+	PRINTFC_CHECK("%b|%8b|%-8b|", "abcdef", (size_t)3, "xyz", (size_t)2, "xyz", (size_t)2);
+	PRINTFC_CHECK("%r|%15r|%-15r|%r|", &pl, &pl, &pl, &emptyPL);
+	PRINTFC_CHECK("%M|%20M|", pMBuf, pMBuf);
+	PRINTFC_CHECK("%w|%W|%12w|%-12W|", bin, sizeof(bin), bin, sizeof(bin), bin, (size_t)2, bin, (size_t)2);
+	PRINTFC_CHECK("%f|%F|%.2f|%8.3f|%-8.1f|%08.2f", 3.14159, -2.5, 1.005, 123.456, 0.5, -1.5);
+	PRINTFC_CHECK("%f|%.0f|%.6f", 0.0, 1e10, -1e-7);
+	PRINTFC_CHECK("%p|%p", (void*)pMBuf, NULL);
+	PRINTFC_CHECK("unknown %q conversion, %d after it", 7);
+	PRINTFC_CHECK("a trailing %");
+	//only supported by the handler, the compiled format falls back to osPrintf_onMBuf()
+	PRINTFC_CHECK("error: %m.", EINVAL);
+	//more conversions than OS_PRINTF_MAX_ARG fall back too
+	PRINTFC_CHECK("%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d",
+		1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34);
+	PRINTFC_CHECK("Via: SIP/2.0/%s %r:%u;branch=z9hG4bK%lx;rport\r\n", "UDP", &pl, 5060u, 0x12345678UL);
+
+	//the same osPrintf_mbufC() call site is compiled only once
+	for(int i=0; i<3; i++)
+	{
+		PRINTFC_CHECK("loop %d of %s", i, "the same call site");
+	}
+
+	osMBuf_dealloc(pMBuf);
+
+	if(failNum)
+	{
+		printf("printf compiled failed, %d of %d formats differ.\n", failNum, caseNum);
+		return 1;
+	}
+
+	printf("printf compiled OK, %d formats are same as osPrintf_mbuf().\n", caseNum);
+	return 0;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osScan.h"
+
+
+//benchmark of the osScan kernels.  usage: ./scanbench [file], if no file is given, a buffer of SIP messages is used
+
+#define SCAN_BENCH_BUF_SIZE		(4*1024*1024)
+#define SCAN_BENCH_MIN_NSEC		200000000LL
+
+static const char* sipMsg =
+	"INVITE sip:bob@biloxi.example.com SIP/2.0\r\n"
+	"Via: SIP/2.0/UDP pc33.atlanta.example.com;branch=z9hG4bKnashds8\r\n"
+	"Max-Forwards: 70\r\n"
+	"To: Bob <sip:bob@biloxi.example.com>\r\n"
+	"From: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+	"Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+	"CSeq: 314159 INVITE\r\n"
+	"Contact: <sip:alice@pc33.atlanta.example.com>\r\n"
+	"Content-Type: application/sdp\r\n"
+	"Content-Length: 142\r\n"
+	"\r\n"
+	"v=0\r\n"
+	"o=alice 2890844526 2890844526 IN IP4 pc33.atlanta.example.com\r\n"
+	"s=-\r\n"
+	"c=IN IP4 192.0.2.101\r\n"
+	"t=0 0\r\n"
+	"m=audio 49172 RTP/AVP 0\r\n"
+	"a=rtpmap:0 PCMU/8000\r\n";
+
+typedef enum {
+	SCAN_BENCH_CHAR,		//walk all '\n'
+	SCAN_BENCH_SET,			//walk all chars of <>"/
+	SCAN_BENCH_STR,			//walk all "\r\n\r\n"
+	SCAN_BENCH_STR_CASE,	//walk all "content-length"
+	SCAN_BENCH_NONE_STR,	//search a string that does not exist
+	SCAN_BENCH_BITMAP,		//mark all chars of <>"/ in a bitmap, 4KB at a time
+} scanBenchType_e;
+
+static const char* benchName[] = {"findChar '\\n'", "findSet <>\"/", "findStr CRLFCRLF", "findStrCase content-length", "findStrCase absent", "buildBitmap <>\"/"};
+
+
+static long long nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+//walk through the whole buffer, return the number of matches
+static size_t scanBench_run(const uint8_t* buf, size_t len, scanBenchType_e type, const osScanSet_t* pSet)
+{
+	size_t count = 0;
+	size_t pos = 0;
+	if(type == SCAN_BENCH_BITMAP)
+	{
+		uint64_t bitmap[64];
+		for(; pos < len; pos += sizeof(bitmap) * 8)
+		{
+			size_t n = len - pos < sizeof(bitmap) * 8 ? len - pos : sizeof(bitmap) * 8;
+			osScan_buildBitmap(&buf[pos], n, pSet, bitmap);
+			for(size_t i=0; i<(n + 63) / 64; i++)
+			{
+				count += __builtin_popcountll(bitmap[i]);
+			}
+		}
+
+		return count;
+	}
+
+	while(pos < len)
+	{
+		ssize_t n = -1;
+		switch(type)
+		{
+			case SCAN_BENCH_CHAR:
+				n = osScan_findChar(&buf[pos], len - pos, '\n');
+				break;
+			case SCAN_BENCH_SET:
+				n = osScan_findSet(&buf[pos], len - pos, pSet);
+				break;
+			case SCAN_BENCH_STR:
+				n = osScan_findStr(&buf[pos], len - pos, "\r\n\r\n", 4);
+				break;
+			case SCAN_BENCH_STR_CASE:
+				n = osScan_findStrCase(&buf[pos], len - pos, "content-length", 14);
+				break;
+			case SCAN_BENCH_NONE_STR:
+			default:
+				n = osScan_findStrCase(&buf[pos], len - pos, "p-asserted-identity", 19);
+				break;
+		}
+
+		if(n < 0)
+		{
+			break;
+		}
+
+		count++;
+		pos += n + 1;
+	}
+
+	return count;
+}
+
+
+int main(int argc, char* argv[])
+{
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	uint8_t* buf = malloc(SCAN_BENCH_BUF_SIZE);
+	size_t len = 0;
+	if(argc > 1)
+	{
+		osMBuf_t* pMBuf = osMBuf_mapFile(argv[1]);
+		if(!pMBuf)
+		{
+			printf("fails to map %s.\n", argv[1]);
+			return 1;
+		}
+		while(len + pMBuf->end <= SCAN_BENCH_BUF_SIZE && pMBuf->end)
+		{
+			memcpy(&buf[len], pMBuf->buf, pMBuf->end);
+			len += pMBuf->end;
+		}
+		osMBuf_dealloc(pMBuf);
+	}
+	else
+	{
+		size_t msgLen = strlen(sipMsg);
+		while(len + msgLen <= SCAN_BENCH_BUF_SIZE)
+		{
+			memcpy(&buf[len], sipMsg, msgLen);
+			len += msgLen;
+		}
+	}
+
+	osScanSet_t set;
+	osScan_initSet(&set, "<>\"/", 0);
+
+	printf("buffer size=%ld\n", len);
+	osScanLevel_e level[] = {OS_SCAN_LEVEL_SCALAR, OS_SCAN_LEVEL_SSE2, OS_SCAN_LEVEL_AVX2};
+	const char* levelName[] = {"auto", "scalar", "sse2", "avx2"};
+	for(scanBenchType_e type=SCAN_BENCH_CHAR; type<=SCAN_BENCH_BITMAP; type++)
+	{
+		size_t expected = 0;
+		for(int i=0; i<sizeof(level)/sizeof(level[0]); i++)
+		{
+			if(osScan_setLevel(level[i]) != level[i])
+			{
+				printf("%-28s %-7s not supported\n", benchName[type], levelName[level[i]]);
+				continue;
+			}
+
+			int loop = 0;
+			size_t count = 0;
+			long long start = nsec(), elapsed;
+			do {
+				count = scanBench_run(buf, len, type, &set);
+				loop++;
+				elapsed = nsec() - start;
+			} while(elapsed < SCAN_BENCH_MIN_NSEC);
+
+			if(i == 0)
+			{
+				expected = count;
+			}
+			printf("%-28s %-7s matches=%-8ld %6.2f GB/s%s\n", benchName[type], levelName[level[i]], count, (double)len * loop / elapsed, count == expected ? "" : "  MISMATCH");
+		}
+	}
+
+	free(buf);
+	return 0;
+}
@@ -122,11 +122,10 @@ void callback(osXmlData_t* pXmlValue, void* nsInfo)
 				default:
 					if(pXmlValue->pNoXmlnsAttrList)
 					{
-						osListElement_t* pLE = pXmlValue->pNoXmlnsAttrList->head;
-						while(pLE)
+						for(uint32_t i=0; i<osVec_getCount(pXmlValue->pNoXmlnsAttrList); i++)
 						{
-							debug("	attribute name=%r, value=%r", &((osXmlNameValue_t*)pLE->data)->name, &((osXmlNameValue_t*)pLE->data)->value);
-							pLE = pLE->next;
+							osXmlNameValue_t* pNV = osVec_get(pXmlValue->pNoXmlnsAttrList, i);
+							debug("	attribute name=%r, value=%r", &pNV->name, &pNV->value);
 						}
 					}
 					break;
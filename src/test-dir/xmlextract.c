@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* extract the values of the given element paths from a xml via osXml_extract().
+ * usage: ./xmlextract xsd_file_name|- xml_file_name path [path ...]
+ *        xsd_file_name: "-" to extract without xsd, all values are reported as string
+ *        path:          like Sh-Data/PublicIdentifiers/IMSPublicIdentity, a trailing '+' reports all matching elements
+ *                       instead of the first one
+ */
+
+
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	if(!pXmlValue)
+	{
+		return;
+	}
+
+	int* pCount = appData;
+	(*pCount)++;
+
+	switch(pXmlValue->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+			printf("path(%d) %.*s = %s\n", pXmlValue->eDataName, (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlIsTrue ? "true" : "false");
+			break;
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			printf("path(%d) %.*s = %lu\n", pXmlValue->eDataName, (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlInt);
+			break;
+		case OS_XML_DATA_TYPE_XS_STRING:
+			printf("path(%d) %.*s = %.*s\n", pXmlValue->eDataName, (int)pXmlValue->dataName.l, pXmlValue->dataName.p, (int)pXmlValue->xmlStr.l, pXmlValue->xmlStr.p);
+			break;
+		default:
+			printf("path(%d) %.*s, dataType=%d\n", pXmlValue->eDataName, (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->dataType);
+			break;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 4)
+	{
+		printf("usage: ./xmlextract xsd_file_name|- xml_file_name path [path ...]\n");
+		return 1;
+	}
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osPointerLen_t xsdName = {argv[1], strlen(argv[1])};
+	bool isXsd = strcmp(argv[1], "-") != 0;
+	if(isXsd && !osXsd_initNS(".", argv[1]))
+	{
+		printf("fails to parse %s.\n", argv[1]);
+		return 1;
+	}
+
+	osMBuf_t* xmlMBuf = osMBuf_mapFile(argv[2]);
+	if(!xmlMBuf)
+	{
+		printf("fails to read %s.\n", argv[2]);
+		return 1;
+	}
+
+	uint32_t pathNum = argc - 3;
+	osXmlPath_t* paths = calloc(pathNum, sizeof(osXmlPath_t));
+	for(uint32_t i=0; i<pathNum; i++)
+	{
+		size_t len = strlen(argv[i+3]);
+		paths[i].isMulti = len && argv[i+3][len-1] == '+';
+		paths[i].path = (osPointerLen_t){argv[i+3], paths[i].isMulti ? len-1 : len};
+		paths[i].eDataName = i;
+	}
+
+	osXmlPathSet_t* pPathSet = osXml_compilePaths(paths, pathNum, isXsd ? &xsdName : NULL);
+	if(!pPathSet)
+	{
+		printf("fails to compile the paths.\n");
+		return 1;
+	}
+
+	int count = 0;
+	osStatus_e status = osXml_extract(xmlMBuf, pPathSet, callback, &count);
+	printf("xml extract status=%d, values=%d, stop at pos=%lu of %lu.\n", status, count, xmlMBuf->pos, xmlMBuf->end);
+
+	osfree(pPathSet);
+	free(paths);
+	osMBuf_dealloc(xmlMBuf);
+	return status == OS_STATUS_OK ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osList.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* parse a xml in one shot, or feed it to the incremental parser piece by piece.  The xml values printed shall be the same
+ * for any piece size.
+ * usage: ./xmlfeed xsd_file_name xml_file_name [piece_size]
+ *        piece_size = 0 or not present: one shot parse via osXml_parse()
+ */
+
+
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	if(!pXmlValue)
+	{
+		return;
+	}
+
+	switch(pXmlValue->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+			printf("%.*s = %s\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlIsTrue ? "true" :"false");
+			break;
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			printf("%.*s = %lu\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlInt);
+			break;
+		case OS_XML_DATA_TYPE_XS_STRING:
+			printf("%.*s = %.*s\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, (int)pXmlValue->xmlStr.l, pXmlValue->xmlStr.p);
+			break;
+		default:
+			printf("%.*s, dataType=%d, isEOT=%d\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->dataType, pXmlValue->isEOT);
+			break;
+	}
+}
+
+
+//each piece is copied to a scratch buffer that is overwritten after the feed, the parser shall not refer a piece after the feed
+static bool feedPiece(const uint8_t* data, size_t len, size_t offset, void* pData)
+{
+	static char scratch[65536];
+	osXmlParseCtx_t* pCtx = pData;
+
+	memcpy(scratch, data, len);
+	osPointerLen_t piece = {scratch, len};
+	osStatus_e status = osXml_parseFeed(pCtx, &piece);
+	memset(scratch, 'X', len);
+
+	if(status != OS_STATUS_OK)
+	{
+		printf("fails to feed the piece at offset %lu.\n", offset);
+		return false;
+	}
+
+	return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		printf("usage: ./xmlfeed xsd_file_name xml_file_name [piece_size]\n");
+		return 1;
+	}
+
+	size_t pieceSize = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+	if(pieceSize > 65536)
+	{
+		printf("piece_size shall not exceed 65536.\n");
+		return 1;
+	}
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osMBuf_t* xsdMBuf = osXsd_initNS(".", argv[1]);
+	if(!xsdMBuf)
+	{
+		printf("fails to parse %s.\n", argv[1]);
+		return 1;
+	}
+
+	osPointerLen_t xsdName = {argv[1], strlen(argv[1])};
+	osXmlDataCallbackInfo_t cbInfo = {true, false, true, callback, NULL, NULL, 0};
+	osStatus_e status = OS_STATUS_OK;
+
+	if(!pieceSize)
+	{
+		osMBuf_t* xmlMBuf = osMBuf_mapFile(argv[2]);
+		if(!xmlMBuf)
+		{
+			printf("fails to read %s.\n", argv[2]);
+			return 1;
+		}
+
+		status = osXml_parse(xmlMBuf, NULL, &xsdName, &cbInfo);
+		osMBuf_dealloc(xmlMBuf);
+	}
+	else
+	{
+		osXmlParseCtx_t* pCtx = osXml_parseFeedStart(&xsdName, &cbInfo);
+		if(osMBuf_streamFile(argv[2], pieceSize, feedPiece, pCtx) < 0)
+		{
+			printf("fails to stream %s.\n", argv[2]);
+		}
+		status = osXml_parseFeedEnd(pCtx);
+	}
+
+	printf("xml parse %s.\n", status == OS_STATUS_OK ? "OK" : "failed");
+	return status == OS_STATUS_OK ? 0 : 1;
+}
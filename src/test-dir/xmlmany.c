@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* parse copies of a xml document via osXml_parseMany(), first on one thread, then on the given number of threads.  Each
+ * copy shall get the same values, and the same values as the one thread parse.
+ * usage: ./xmlmany xsd_file_name xml_file_name [copies] [threads]
+ *        copies:  default 64
+ *        threads: default 0, one thread per online cpu
+ */
+
+
+//the summary of the values of a document
+typedef struct {
+	uint32_t count;
+	uint64_t checksum;
+} xmlManyResult_t;
+
+
+static uint64_t checksum(uint64_t sum, const char* p, size_t len)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		sum = sum * 31 + (uint8_t)p[i];
+	}
+
+	return sum;
+}
+
+
+//called from any worker thread, appData is owned by one document
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	xmlManyResult_t* pResult = appData;
+	if(!pXmlValue || !pResult)
+	{
+		return;
+	}
+
+	pResult->count++;
+	pResult->checksum = checksum(pResult->checksum, pXmlValue->dataName.p, pXmlValue->dataName.l);
+	switch(pXmlValue->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+			pResult->checksum = pResult->checksum * 31 + pXmlValue->xmlIsTrue;
+			break;
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			pResult->checksum = pResult->checksum * 31 + pXmlValue->xmlInt;
+			break;
+		case OS_XML_DATA_TYPE_XS_STRING:
+			pResult->checksum = checksum(pResult->checksum, pXmlValue->xmlStr.p, pXmlValue->xmlStr.l);
+			break;
+		default:
+			pResult->checksum = pResult->checksum * 31 + pXmlValue->isEOT;
+			break;
+	}
+}
+
+
+static long long nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+//parse all copies on nThread threads, return the number of copies whose result does not match pExpected
+static int xmlMany_run(osMBuf_t* xmlMBuf, osPointerLen_t* xsdName, uint32_t copies, uint32_t nThread, xmlManyResult_t* pExpected)
+{
+	osXmlParseDoc_t* docs = calloc(copies, sizeof(osXmlParseDoc_t));
+	osMBuf_t* bufs = calloc(copies, sizeof(osMBuf_t));
+	osXmlDataCallbackInfo_t* cbInfo = calloc(copies, sizeof(osXmlDataCallbackInfo_t));
+	xmlManyResult_t* results = calloc(copies, sizeof(xmlManyResult_t));
+
+	for(uint32_t i=0; i<copies; i++)
+	{
+		//all copies share the same xml content, each has its own position
+		bufs[i] = *xmlMBuf;
+		bufs[i].pos = 0;
+		cbInfo[i] = (osXmlDataCallbackInfo_t){true, false, true, callback, &results[i], NULL, 0};
+		docs[i].pXmlBuf = &bufs[i];
+		docs[i].callbackInfo = &cbInfo[i];
+	}
+
+	long long start = nsec();
+	osStatus_e status = osXml_parseMany(docs, copies, xsdName, nThread);
+	long long elapsed = nsec() - start;
+
+	if(!pExpected->count)
+	{
+		*pExpected = results[0];
+	}
+
+	int mismatch = 0;
+	for(uint32_t i=0; i<copies; i++)
+	{
+		if(docs[i].status != OS_STATUS_OK || results[i].count != pExpected->count || results[i].checksum != pExpected->checksum)
+		{
+			mismatch++;
+		}
+	}
+
+	printf("threads=%-3u copies=%u status=%d values=%u mismatch=%d %.2f ms\n", nThread, copies, status, pExpected->count, mismatch, elapsed / 1000000.0);
+
+	free(docs);
+	free(bufs);
+	free(cbInfo);
+	free(results);
+	return mismatch;
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		printf("usage: ./xmlmany xsd_file_name xml_file_name [copies] [threads]\n");
+		return 1;
+	}
+
+	uint32_t copies = argc > 3 ? strtoul(argv[3], NULL, 10) : 64;
+	uint32_t nThread = argc > 4 ? strtoul(argv[4], NULL, 10) : 0;
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	osMBuf_t* xsdMBuf = osXsd_initNS(".", argv[1]);
+	if(!xsdMBuf)
+	{
+		printf("fails to parse %s.\n", argv[1]);
+		return 1;
+	}
+
+	osMBuf_t* xmlMBuf = osMBuf_mapFile(argv[2]);
+	if(!xmlMBuf)
+	{
+		printf("fails to read %s.\n", argv[2]);
+		return 1;
+	}
+
+	osPointerLen_t xsdName = {argv[1], strlen(argv[1])};
+	xmlManyResult_t expected = {};
+	int mismatch = xmlMany_run(xmlMBuf, &xsdName, copies, 1, &expected);
+	mismatch += xmlMany_run(xmlMBuf, &xsdName, copies, nThread, &expected);
+
+	osMBuf_dealloc(xmlMBuf);
+
+	printf("xml parse many %s.\n", mismatch == 0 ? "OK" : "failed");
+	return mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osMBufChain.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* write a Sh-Data document via osXmlWriter checked against 3gppsh.xsd, into a mbuf and into a chain, then parse it back.
+ * A few documents that violate the xsd shall be rejected by the writer.
+ * usage: ./xmlwriter [xsd_file_name] [loops]
+ *        xsd_file_name: default 3gppsh.xsd
+ *        loops:         default 100000, the number of documents written for the timing
+ */
+
+
+#define PL(s)	(osPointerLen_t){s, sizeof(s)-1}
+
+
+typedef enum {
+	XML_WRITER_TAG_SH_DATA,
+	XML_WRITER_TAG_PUBLIC_IDENTIFIERS,
+	XML_WRITER_TAG_EXTENSION,
+	XML_WRITER_TAG_IDENTITY_TYPE,
+	XML_WRITER_TAG_REPOSITORY_DATA,
+	XML_WRITER_TAG_IMS_PUBLIC_IDENTITY,
+	XML_WRITER_TAG_APP_DATA,
+	XML_WRITER_TAG_NUM,
+} xmlWriterTag_e;
+
+
+static osXmlWriterTag_t* tags[XML_WRITER_TAG_NUM];
+
+
+//the values expected when the document written by writeShData() is parsed back, in the document order.  The parser
+//reports a string value as it is in the document, the escaped chars are not converted back
+static const char* parseBackValue[][2] = {
+	{"IMSPublicIdentity", "sip:+12548718041@ims.mnc970.mcc310.3gppnetwork.org"},
+	{"IMSPublicIdentity", "tel:+12548718041"},
+	{"MSISDN", "12548718041"},
+	{"IdentityType", "2"},
+	{"ServiceIndication", "mmtel&lt;&amp;&gt;\"service\""},
+	{"SequenceNumber", "17"},
+	{"AppData", "x &lt; y &amp;&amp; y &gt; z"},
+};
+
+
+typedef struct parseBackInfo {
+	int count;
+	int failNum;
+} parseBackInfo_t;
+
+
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	if(!pXmlValue)
+	{
+		return;
+	}
+
+	char value[128];
+	int len = 0;
+	switch(pXmlValue->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+			len = snprintf(value, sizeof(value), "%s", pXmlValue->xmlIsTrue ? "true" : "false");
+			break;
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			len = snprintf(value, sizeof(value), "%lu", pXmlValue->xmlInt);
+			break;
+		case OS_XML_DATA_TYPE_XS_STRING:
+			len = snprintf(value, sizeof(value), "%.*s", (int)pXmlValue->xmlStr.l, pXmlValue->xmlStr.p);
+			break;
+		default:
+			return;
+	}
+	printf("    %.*s = %s\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, value);
+
+	parseBackInfo_t* pInfo = appData;
+	int idx = pInfo->count++;
+	if(idx >= sizeof(parseBackValue) / sizeof(parseBackValue[0]) ||
+		osPL_strcmp(&pXmlValue->dataName, parseBackValue[idx][0]) || len != strlen(parseBackValue[idx][1]) || memcmp(value, parseBackValue[idx][1], len))
+	{
+		printf("failed: parsed value %d (%.*s = %s) is not the written one.\n", idx, (int)pXmlValue->dataName.l, pXmlValue->dataName.p, value);
+		pInfo->failNum++;
+	}
+}
+
+
+//the values are listed out of the xsd order, osXmlWriter_writeData() writes them in the xsd order
+static osStatus_e writeShData(osXmlWriter_t* pWriter)
+{
+	osXmlData_t publicId[] = {
+		{.dataName = PL("MSISDN"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("12548718041")},
+		{.dataName = PL("IMSPublicIdentity"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("sip:+12548718041@ims.mnc970.mcc310.3gppnetwork.org")},
+		{.dataName = PL("IMSPublicIdentity"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("tel:+12548718041")},
+	};
+	osXmlData_t repository[] = {
+		{.dataName = PL("SequenceNumber"), .dataType = OS_XML_DATA_TYPE_XS_INTEGER, .xmlInt = 17},
+		{.dataName = PL("ServiceIndication"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("mmtel<&>\"service\"")},
+	};
+
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_SH_DATA]);
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS]);
+	osXmlWriter_writeData(pWriter, publicId, sizeof(publicId) / sizeof(osXmlData_t));
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_EXTENSION]);
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_IDENTITY_TYPE]);
+	osXmlWriter_int(pWriter, 2);
+	osXmlWriter_endElem(pWriter);
+	osXmlWriter_endElem(pWriter);
+	osXmlWriter_endElem(pWriter);
+
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_REPOSITORY_DATA]);
+	osXmlWriter_writeData(pWriter, repository, sizeof(repository) / sizeof(osXmlData_t));
+	osXmlWriter_endElem(pWriter);
+
+	//a element that matches a <xs:any> is not checked
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_APP_DATA]);
+	osXmlWriter_attr(pWriter, &PL("note"), &PL("a \"quoted\" & <tagged> note"));
+	osXmlWriter_attr(pWriter, &PL("app:id"), &PL("1"));
+	osXmlWriter_str(pWriter, &PL("x < y && y > z"));
+	osXmlWriter_endElem(pWriter);
+
+	return osXmlWriter_endElem(pWriter);
+}
+
+
+//a document that spans multiple chain segments
+static osStatus_e writeBigShData(osXmlWriter_t* pWriter, int idNum)
+{
+	char id[64];
+	osXmlData_t xmlData = {.dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = {id, 0}};
+
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_SH_DATA]);
+	osXmlWriter_nsDecl(pWriter, NULL, &PL("urn:3gpp:sh"));
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS]);
+	for(int i=0; i<idNum; i++)
+	{
+		xmlData.xmlStr.l = snprintf(id, sizeof(id), "sip:user%d@ims.mnc970.mcc310.3gppnetwork.org", i);
+		osXmlWriter_leaf(pWriter, tags[XML_WRITER_TAG_IMS_PUBLIC_IDENTITY], &xmlData);
+	}
+	osXmlWriter_endElem(pWriter);
+
+	return osXmlWriter_endElem(pWriter);
+}
+
+
+//each case violates the xsd, the writer shall fail
+static int writeBadDoc(osPointerLen_t* xsdName, int badCase)
+{
+	osMBuf_t* pBuf = osMBuf_alloc(512);
+	osXmlWriter_t* pWriter = osXmlWriter_create(pBuf, NULL, xsdName, true);
+	osXmlData_t seqNum = {.dataName = PL("SequenceNumber"), .dataType = OS_XML_DATA_TYPE_XS_INTEGER, .xmlInt = 1};
+	osXmlData_t unknown = {.dataName = PL("NoSuchElement"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("x")};
+	osXmlData_t repository[] = {
+		{.dataName = PL("ServiceIndication"), .dataType = OS_XML_DATA_TYPE_XS_STRING, .xmlStr = PL("mmtel")},
+		{.dataName = PL("SequenceNumber"), .dataType = OS_XML_DATA_TYPE_XS_INTEGER, .xmlInt = 1},
+	};
+
+	osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_SH_DATA]);
+	switch(badCase)
+	{
+		case 0:
+			//RepositoryData is after PublicIdentifiers in the xsd sequence
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_REPOSITORY_DATA]);
+			osXmlWriter_writeData(pWriter, repository, 2);
+			osXmlWriter_endElem(pWriter);
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS]);
+			osXmlWriter_endElem(pWriter);
+			break;
+		case 1:
+			//ServiceIndication is required
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_REPOSITORY_DATA]);
+			osXmlWriter_writeData(pWriter, &seqNum, 1);
+			osXmlWriter_endElem(pWriter);
+			break;
+		case 2:
+			//IdentityType is at most 3
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS]);
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_EXTENSION]);
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_IDENTITY_TYPE]);
+			osXmlWriter_int(pWriter, 7);
+			break;
+		case 3:
+			//IdentityType is a number
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS]);
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_EXTENSION]);
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_IDENTITY_TYPE]);
+			osXmlWriter_bool(pWriter, true);
+			break;
+		case 4:
+			//not a child of RepositoryData
+			osXmlWriter_startElem(pWriter, tags[XML_WRITER_TAG_REPOSITORY_DATA]);
+			osXmlWriter_writeData(pWriter, &unknown, 1);
+			break;
+		case 5:
+			//a attribute name can not start with a digit
+			osXmlWriter_attr(pWriter, &PL("1note"), &PL("x"));
+			break;
+		case 6:
+			//a attribute name has at most one ':'
+			osXmlWriter_attr(pWriter, &PL("a:b:c"), &PL("x"));
+			break;
+		default:
+			//the root element is not ended
+			break;
+	}
+
+	osStatus_e status = osXmlWriter_finish(pWriter);
+	printf("bad case %d: %s.\n", badCase, status != OS_STATUS_OK ? "rejected" : "NOT rejected");
+
+	osMBuf_dealloc(pBuf);
+	return status != OS_STATUS_OK ? 0 : 1;
+}
+
+
+static long long nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+int main(int argc, char* argv[])
+{
+	char* xsdFile = argc > 1 ? argv[1] : "3gppsh.xsd";
+	int loops = argc > 2 ? atoi(argv[2]) : 100000;
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	if(!osXsd_initNS(".", xsdFile))
+	{
+		printf("fails to parse %s.\n", xsdFile);
+		return 1;
+	}
+	osPointerLen_t xsdName = {xsdFile, strlen(xsdFile)};
+
+	tags[XML_WRITER_TAG_SH_DATA] = osXmlWriter_compileTag(NULL, &PL("Sh-Data"));
+	tags[XML_WRITER_TAG_PUBLIC_IDENTIFIERS] = osXmlWriter_compileTag(NULL, &PL("PublicIdentifiers"));
+	tags[XML_WRITER_TAG_EXTENSION] = osXmlWriter_compileTag(NULL, &PL("Extension"));
+	tags[XML_WRITER_TAG_IDENTITY_TYPE] = osXmlWriter_compileTag(NULL, &PL("IdentityType"));
+	tags[XML_WRITER_TAG_REPOSITORY_DATA] = osXmlWriter_compileTag(NULL, &PL("RepositoryData"));
+	tags[XML_WRITER_TAG_IMS_PUBLIC_IDENTITY] = osXmlWriter_compileTag(NULL, &PL("IMSPublicIdentity"));
+	tags[XML_WRITER_TAG_APP_DATA] = osXmlWriter_compileTag(NULL, &PL("AppData"));
+
+	//write into a mbuf
+	osMBuf_t* pBuf = osMBuf_alloc(64);
+	osXmlWriter_t* pWriter = osXmlWriter_create(pBuf, NULL, &xsdName, true);
+	writeShData(pWriter);
+	osStatus_e status = osXmlWriter_finish(pWriter);
+	printf("write to mbuf status=%d, len=%lu:\n%.*s\n", status, pBuf->end, (int)pBuf->end, pBuf->buf);
+	if(status != OS_STATUS_OK)
+	{
+		return 1;
+	}
+
+	//write into a chain, the document shall be the same
+	osMBufChain_t* pChain = osMBufChain_alloc();
+	pWriter = osXmlWriter_create(NULL, pChain, &xsdName, true);
+	writeShData(pWriter);
+	status = osXmlWriter_finish(pWriter);
+	osMBuf_t* pFlat = osMBufChain_flatten(pChain);
+	bool isSame = pFlat && pFlat->end == pBuf->end && memcmp(pFlat->buf, pBuf->buf, pBuf->end) == 0;
+	printf("write to chain status=%d, segNum=%u, %s the mbuf document.\n", status, osMBufChain_getSegNum(pChain), isSame ? "same as" : "different from");
+	osMBuf_dealloc(pFlat);
+	osMBufChain_dealloc(pChain);
+	if(status != OS_STATUS_OK || !isSame)
+	{
+		return 1;
+	}
+
+	//a big document, the chain shall have the same data as the mbuf
+	osMBuf_t* pBigBuf = osMBuf_alloc(64);
+	pWriter = osXmlWriter_create(pBigBuf, NULL, NULL, true);
+	writeBigShData(pWriter, 200);
+	status = osXmlWriter_finish(pWriter);
+	pChain = osMBufChain_alloc();
+	pWriter = osXmlWriter_create(NULL, pChain, NULL, true);
+	writeBigShData(pWriter, 200);
+	status |= osXmlWriter_finish(pWriter);
+	pFlat = osMBufChain_flatten(pChain);
+	isSame = pFlat && pFlat->end == pBigBuf->end && memcmp(pFlat->buf, pBigBuf->buf, pBigBuf->end) == 0;
+	printf("write a big document status=%d, len=%lu, segNum=%u, the chain is %s the mbuf.\n", status, pBigBuf->end, osMBufChain_getSegNum(pChain), isSame ? "same as" : "different from");
+	osMBuf_dealloc(pFlat);
+	osMBufChain_dealloc(pChain);
+	osMBuf_dealloc(pBigBuf);
+	if(status != OS_STATUS_OK || !isSame)
+	{
+		return 1;
+	}
+
+	//parse it back
+	parseBackInfo_t parseBack = {0, 0};
+	osXmlDataCallbackInfo_t cbInfo = {false, false, true, callback, &parseBack, NULL, 0};
+	pBuf->pos = 0;
+	status = osXml_parse(pBuf, NULL, &xsdName, &cbInfo);
+	printf("parse back status=%d, values=%d.\n", status, parseBack.count);
+	if(status != OS_STATUS_OK || parseBack.failNum || parseBack.count != sizeof(parseBackValue) / sizeof(parseBackValue[0]))
+	{
+		return 1;
+	}
+
+	int failed = 0;
+	for(int i=0; i<8; i++)
+	{
+		failed += writeBadDoc(&xsdName, i);
+	}
+
+	//timing, a document of 8 IMSPublicIdentity is written with and without the xsd check, the mbuf is reused for each document
+	osXmlWriter_t* pTimeWriter = NULL;
+	for(int isXsd=0; isXsd<2; isXsd++)
+	{
+		long long start = nsec();
+		for(int i=0; i<loops; i++)
+		{
+			pBuf->pos = pBuf->end = 0;
+			pTimeWriter = osXmlWriter_create(pBuf, NULL, isXsd ? &xsdName : NULL, true);
+			writeBigShData(pTimeWriter, 8);
+			failed += osXmlWriter_finish(pTimeWriter) != OS_STATUS_OK;
+		}
+		long long elapsed = nsec() - start;
+		printf("%s: %d documents, %.1f ns/document.\n", isXsd ? "with xsd" : "without xsd", loops, loops ? (double)elapsed / loops : 0);
+	}
+
+	osMBuf_dealloc(pBuf);
+	for(int i=0; i<XML_WRITER_TAG_NUM; i++)
+	{
+		osfree(tags[i]);
+	}
+
+	printf("xml writer %s.\n", failed == 0 ? "OK" : "failed");
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osList.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* export a xsd to a precompiled binary file, and parse a xml against the xsd text or the binary file.  The xml values
+ * printed by "parse" and "load" shall be the same.
+ * usage: ./xsdbin export xsd_file_name bin_file_name
+ *        ./xsdbin parse xsd_file_name xml_file_name
+ *        ./xsdbin load bin_file_name xsd_file_name xml_file_name
+ */
+
+
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	if(!pXmlValue)
+	{
+		return;
+	}
+
+	switch(pXmlValue->dataType)
+	{
+		case OS_XML_DATA_TYPE_XS_BOOLEAN:
+			printf("%.*s = %s\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlIsTrue ? "true" :"false");
+			break;
+		case OS_XML_DATA_TYPE_XS_UNSIGNED_BYTE:
+		case OS_XML_DATA_TYPE_XS_SHORT:
+		case OS_XML_DATA_TYPE_XS_INTEGER:
+		case OS_XML_DATA_TYPE_XS_LONG:
+			printf("%.*s = %lu\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->xmlInt);
+			break;
+		case OS_XML_DATA_TYPE_XS_STRING:
+			printf("%.*s = %.*s\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, (int)pXmlValue->xmlStr.l, pXmlValue->xmlStr.p);
+			break;
+		default:
+			printf("%.*s, dataType=%d, isEOT=%d\n", (int)pXmlValue->dataName.l, pXmlValue->dataName.p, pXmlValue->dataType, pXmlValue->isEOT);
+			break;
+	}
+}
+
+
+static double getTimeUs(struct timespec* pStart)
+{
+	struct timespec stop;
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	return (stop.tv_sec - pStart->tv_sec) * 1e6 + (stop.tv_nsec - pStart->tv_nsec) / 1e3;
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 4 || (strcmp(argv[1], "load") == 0 && argc != 5))
+	{
+		printf("usage: ./xsdbin export xsd_file_name bin_file_name\n");
+		printf("       ./xsdbin parse xsd_file_name xml_file_name\n");
+		printf("       ./xsdbin load bin_file_name xsd_file_name xml_file_name\n");
+		return 1;
+	}
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	osXmlDataCallbackInfo_t cbInfo = {true, false, true, callback, NULL, NULL, 0};
+
+	if(strcmp(argv[1], "export") == 0)
+	{
+		osMBuf_t* xsdMBuf = osXsd_initNS(".", argv[2]);
+		if(!xsdMBuf)
+		{
+			printf("fails to parse %s.\n", argv[2]);
+			return 1;
+		}
+		printf("xsd text parse takes %.1f us.\n", getTimeUs(&start));
+
+		osPointerLen_t xsdName = {argv[2], strlen(argv[2])};
+		osStatus_e status = osXsd_exportBin(&xsdName, ".", argv[3]);
+		printf("export %s to %s %s.\n", argv[2], argv[3], status == OS_STATUS_OK ? "OK" : "failed");
+		return status == OS_STATUS_OK ? 0 : 1;
+	}
+
+	char* xsdFileName = argv[2];
+	char* xmlFileName = argv[3];
+	if(strcmp(argv[1], "load") == 0)
+	{
+		if(osXsd_initNSBin(".", argv[2]) != OS_STATUS_OK)
+		{
+			printf("fails to load %s.\n", argv[2]);
+			return 1;
+		}
+		printf("xsd binary load takes %.1f us.\n", getTimeUs(&start));
+
+		xsdFileName = argv[3];
+		xmlFileName = argv[4];
+	}
+	else
+	{
+		osMBuf_t* xsdMBuf = osXsd_initNS(".", xsdFileName);
+		if(!xsdMBuf)
+		{
+			printf("fails to parse %s.\n", xsdFileName);
+			return 1;
+		}
+		printf("xsd text parse takes %.1f us.\n", getTimeUs(&start));
+	}
+
+	osMBuf_t* xmlMBuf = osMBuf_mapFile(xmlFileName);
+	if(!xmlMBuf)
+	{
+		printf("fails to read %s.\n", xmlFileName);
+		return 1;
+	}
+
+	osPointerLen_t xsdName = {xsdFileName, strlen(xsdFileName)};
+	osStatus_e status = osXml_getElemValue(&xsdName, NULL, xmlMBuf, true, &cbInfo);
+	printf("xml parse %s.\n", status == OS_STATUS_OK ? "OK" : "failed");
+
+	osMBuf_dealloc(xmlMBuf);
+	return status == OS_STATUS_OK ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osMemory.h"
+#include "osPreMemory.h"
+#include "osDebug.h"
+#include "osMBuf.h"
+#include "osPL.h"
+#include "osXmlParserIntf.h"
+
+
+/* validate the simpleType values of stype.xsd: the integer range and exclusive bounds, totalDigits, the int and
+ * string enumerations (the binary search of an unsorted enumeration list), the length bounds, and the patterns,
+ * including a trailing '-' in a class and the case sensitivity of the classes and the literals.
+ * usage: ./xsdstype
+ */
+
+
+typedef struct xsdSTypeCase {
+	const char* elem;
+	const char* value;
+	bool isValid;
+} xsdSTypeCase_t;
+
+
+static xsdSTypeCase_t stypeCase[] = {
+	{"Range", "10", true},
+	{"Range", "15", true},
+	{"Range", "20", true},
+	{"Range", "9", false},
+	{"Range", "21", false},
+	{"Exclusive", "11", true},
+	{"Exclusive", "19", true},
+	{"Exclusive", "10", false},
+	{"Exclusive", "20", false},
+	{"Digits", "999", true},
+	{"Digits", "1000", false},
+	{"IntEnum", "2", true},
+	{"IntEnum", "3", true},
+	{"IntEnum", "5", true},
+	{"IntEnum", "7", true},
+	{"IntEnum", "11", true},
+	{"IntEnum", "1", false},
+	{"IntEnum", "4", false},
+	{"IntEnum", "12", false},
+	{"StrEnum", "udp", true},
+	{"StrEnum", "sctp", true},
+	{"StrEnum", "ws", true},
+	{"StrEnum", "UDP", false},
+	{"StrEnum", "tc", false},
+	{"StrEnum", "tcpx", false},
+	{"Length", "ab", true},
+	{"Length", "abcd", true},
+	{"Length", "a", false},
+	{"Length", "abcde", false},
+	{"ExactLength", "abc", true},
+	{"ExactLength", "ab", false},
+	{"ExactLength", "abcd", false},
+	{"Hyphen", "abc", true},
+	{"Hyphen", "ab-c", true},
+	{"Hyphen", "-", true},
+	{"Hyphen", "ab_c", false},
+	{"Hyphen", "aBc", false},
+	{"Upper", "AB", true},
+	{"Upper", "ab", false},
+	{"Upper", "ABC", false},
+	{"Upper", "A", false},
+	{"Literal", "ABC", true},
+	{"Literal", "abc", false},
+	{"Literal", "ABD", false},
+	{"Tel", "tel:+1234", true},
+	{"Tel", "TEL:+1234", false},
+	{"Tel", "tel:1234", false},
+	{"Tel", "tel:+1", false},
+	{"DigitOrHex", "123", true},
+	{"DigitOrHex", "0xbeef", true},
+	{"DigitOrHex", "0xBEEF", false},
+	{"DigitOrHex", "beef", false},
+	//a pattern osRegex can not compile is not checked
+	{"NotCompiled", "anything", true},
+};
+
+
+static int failNum;
+
+
+static void callback(osXmlData_t* pXmlValue, void* nsInfo, void* appData)
+{
+	(*(int*)appData)++;
+}
+
+
+static void checkValue(osPointerLen_t* xsdName, xsdSTypeCase_t* pCase)
+{
+	char doc[256];
+	int len = snprintf(doc, sizeof(doc), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Values>\n\t<%s>%s</%s>\n</Values>\n", pCase->elem, pCase->value, pCase->elem);
+
+	osMBuf_t* pBuf = osMBuf_alloc(len);
+	osMBuf_writeBuf(pBuf, (uint8_t*)doc, len, true);
+	pBuf->pos = 0;
+
+	int count = 0;
+	osXmlDataCallbackInfo_t cbInfo = {false, false, true, callback, &count, NULL, 0};
+	osStatus_e status = osXml_parse(pBuf, NULL, xsdName, &cbInfo);
+	if((status == OS_STATUS_OK) != pCase->isValid)
+	{
+		printf("failed: <%s>%s</%s> is expected %s, status=%d\n", pCase->elem, pCase->value, pCase->elem, pCase->isValid ? "valid" : "invalid", status);
+		failNum++;
+	}
+
+	osMBuf_dealloc(pBuf);
+}
+
+
+int main(int argc, char* argv[])
+{
+	char* xsdFile = "stype.xsd";
+
+	osPreMem_init();
+	osDbg_init(DBG_ERROR, DBG_ALL);
+
+	if(!osXsd_initNS(".", xsdFile))
+	{
+		printf("fails to parse %s.\n", xsdFile);
+		return 1;
+	}
+	osPointerLen_t xsdName = {xsdFile, strlen(xsdFile)};
+
+	for(int i=0; i<sizeof(stypeCase)/sizeof(stypeCase[0]); i++)
+	{
+		checkValue(&xsdName, &stypeCase[i]);
+	}
+
+	if(failNum)
+	{
+		printf("xsd simpleType failed, %d checks failed.\n", failNum);
+		return 1;
+	}
+
+	printf("xsd simpleType OK, %lu values checked.\n", sizeof(stypeCase)/sizeof(stypeCase[0]));
+	return 0;
+}
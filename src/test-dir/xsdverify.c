@@ -30,7 +30,7 @@ int main(int argc, char* argv[])
 	osmem_allusedinfo();
 
 	debug("i am ok here.");
-	osMBuf_t* xsdMBuf = osMBuf_readFile(argv[1], 16000);
+	osMBuf_t* xsdMBuf = osMBuf_mapFile(argv[1]);
 	debug("xsdMsg=\n%M", xsdMBuf);
 
 	osPointerLen_t xsdName = {argv[1], strlen(argv[1])};
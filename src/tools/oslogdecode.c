@@ -0,0 +1,447 @@
+/********************************************************
+ * Copyright (C) 2020 Sean Dai
+ *
+ * @file oslogdecode.c  render a binary log file (see osDebugBin.h) to the text log format
+ *
+ * usage: oslogdecode [-l maxLevel] [-m module] [-t threadId] [-s siteId] binLogFile
+ *   -l: only output the logs with level <= maxLevel, 0(emergency) to 7(debug)
+ *   -m: only output the logs of a module, the osLogModule_e value
+ *   -t: only output the logs of a thread, the hex thread id as printed in the text log
+ *   -s: only output the logs of a call site
+ ********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "osTypes.h"
+#include "osPrintf.h"
+#include "osDebug.h"
+#include "osDebugBin.h"
+
+
+typedef struct {
+	bool isValid;
+	uint32_t line;
+	char* file;
+	char* func;
+	char* levelStr;
+	char* fmt;
+	bool isNoPrefix;
+} logSite_t;
+
+
+typedef struct {
+	int maxLevel;
+	int module;
+	uint64_t tid;
+	bool isTidFilter;
+	uint32_t siteId;
+} logFilter_t;
+
+
+static logSite_t* siteTable;
+static uint32_t siteTableSize;
+static uint64_t* threadTable;
+static uint32_t threadTableSize;
+static uint64_t startRealUsec;
+static uint64_t startMonoUsec;
+
+
+static void logDecode_usage(void);
+static bool logDecode_getStr(const uint8_t* rec, size_t recLen, size_t* pPos, const uint8_t** ppStr, uint16_t* pLen);
+static char* logDecode_dupStr(const uint8_t* rec, size_t recLen, size_t* pPos);
+static void logDecode_site(osDbgBinRecHdr_t* pHdr, const uint8_t* rec);
+static void logDecode_thread(osDbgBinRecHdr_t* pHdr, const uint8_t* rec);
+static void logDecode_prefix(osDbgBinRecHdr_t* pHdr, logSite_t* pSite);
+static void logDecode_args(const char* fmt, const uint8_t* rec, size_t recLen, size_t pos);
+
+
+int main(int argc, char* argv[])
+{
+	logFilter_t filter = {DBG_DEBUG, -1, 0, false, 0};
+	uint8_t rec[OS_DBG_BIN_MAX_REC_SIZE];
+	osDbgBinRecHdr_t* pHdr = (osDbgBinRecHdr_t*)rec;
+	int opt;
+
+	while((opt = getopt(argc, argv, "l:m:t:s:")) != -1)
+	{
+		switch(opt)
+		{
+			case 'l':
+				filter.maxLevel = atoi(optarg);
+				break;
+			case 'm':
+				filter.module = atoi(optarg);
+				break;
+			case 't':
+				filter.tid = strtoull(optarg, NULL, 16);
+				filter.isTidFilter = true;
+				break;
+			case 's':
+				filter.siteId = strtoul(optarg, NULL, 10);
+				break;
+			default:
+				logDecode_usage();
+				return 1;
+		}
+	}
+
+	if(optind != argc - 1)
+	{
+		logDecode_usage();
+		return 1;
+	}
+
+	FILE* f = fopen(argv[optind], "rb");
+	if(!f)
+	{
+		printf("fails to open %s.\n", argv[optind]);
+		return 1;
+	}
+
+	while(fread(rec, 1, sizeof(osDbgBinRecHdr_t), f) == sizeof(osDbgBinRecHdr_t))
+	{
+		if(pHdr->recLen < sizeof(osDbgBinRecHdr_t) || pHdr->recLen > OS_DBG_BIN_MAX_REC_SIZE)
+		{
+			printf("invalid record length(%d), stop decoding.\n", pHdr->recLen);
+			break;
+		}
+
+		size_t bodyLen = pHdr->recLen - sizeof(osDbgBinRecHdr_t);
+		if(fread(&rec[sizeof(osDbgBinRecHdr_t)], 1, bodyLen, f) != bodyLen)
+		{
+			printf("truncated record at the end of file.\n");
+			break;
+		}
+
+		switch(pHdr->recType)
+		{
+			case OS_DBG_BIN_REC_START:
+			{
+				size_t pos = sizeof(osDbgBinRecHdr_t);
+				if(pHdr->recLen < pos + OS_DBG_BIN_MAGIC_LEN + sizeof(uint32_t) + sizeof(uint64_t) || memcmp(&rec[pos], OS_DBG_BIN_MAGIC, OS_DBG_BIN_MAGIC_LEN))
+				{
+					printf("not a binary log file, or the file is corrupted.\n");
+					goto EXIT;
+				}
+				pos += OS_DBG_BIN_MAGIC_LEN + sizeof(uint32_t);
+				memcpy(&startRealUsec, &rec[pos], sizeof(uint64_t));
+				startMonoUsec = pHdr->usec;
+
+				//each start means the file was opened again, the site and thread ids will be written again
+				for(int i=0; i<siteTableSize; i++)
+				{
+					siteTable[i].isValid = false;
+				}
+				break;
+			}
+			case OS_DBG_BIN_REC_SITE:
+				logDecode_site(pHdr, rec);
+				break;
+			case OS_DBG_BIN_REC_THREAD:
+				logDecode_thread(pHdr, rec);
+				break;
+			case OS_DBG_BIN_REC_LOG:
+			case OS_DBG_BIN_REC_TEXT:
+			{
+				if(pHdr->level > filter.maxLevel || (filter.module >= 0 && pHdr->module != filter.module) || (filter.siteId && pHdr->siteId != filter.siteId))
+				{
+					break;
+				}
+
+				if(filter.isTidFilter && (pHdr->threadIdx >= threadTableSize || threadTable[pHdr->threadIdx] != filter.tid))
+				{
+					break;
+				}
+
+				if(pHdr->siteId >= siteTableSize || !siteTable[pHdr->siteId].isValid)
+				{
+					printf("log record refers to an unknown call site(%d), skip it.\n", pHdr->siteId);
+					break;
+				}
+
+				logSite_t* pSite = &siteTable[pHdr->siteId];
+				if(!pSite->isNoPrefix)
+				{
+					logDecode_prefix(pHdr, pSite);
+				}
+
+				if(pHdr->recType == OS_DBG_BIN_REC_LOG)
+				{
+					logDecode_args(pSite->fmt, rec, pHdr->recLen, sizeof(osDbgBinRecHdr_t));
+				}
+				else
+				{
+					size_t pos = sizeof(osDbgBinRecHdr_t);
+					const uint8_t* text;
+					uint16_t textLen;
+					if(logDecode_getStr(rec, pHdr->recLen, &pos, &text, &textLen))
+					{
+						fwrite(text, 1, textLen, stdout);
+					}
+				}
+
+				if(!pSite->isNoPrefix)
+				{
+					fputc('\n', stdout);
+				}
+				break;
+			}
+			default:
+				printf("unknown record type(%d), skip it.\n", pHdr->recType);
+				break;
+		}
+	}
+
+EXIT:
+	fclose(f);
+	return 0;
+}
+
+
+static void logDecode_usage(void)
+{
+	printf("usage: oslogdecode [-l maxLevel] [-m module] [-t threadId] [-s siteId] binLogFile\n");
+}
+
+
+static bool logDecode_getStr(const uint8_t* rec, size_t recLen, size_t* pPos, const uint8_t** ppStr, uint16_t* pLen)
+{
+	if(*pPos + sizeof(uint16_t) > recLen)
+	{
+		return false;
+	}
+
+	memcpy(pLen, &rec[*pPos], sizeof(uint16_t));
+	*pPos += sizeof(uint16_t);
+	if(*pPos + *pLen > recLen)
+	{
+		return false;
+	}
+
+	*ppStr = &rec[*pPos];
+	*pPos += *pLen;
+
+	return true;
+}
+
+
+static char* logDecode_dupStr(const uint8_t* rec, size_t recLen, size_t* pPos)
+{
+	const uint8_t* str = NULL;
+	uint16_t len = 0;
+
+	logDecode_getStr(rec, recLen, pPos, &str, &len);
+
+	char* s = malloc(len + 1);
+	if(len)
+	{
+		memcpy(s, str, len);
+	}
+	s[len] = '\0';
+
+	return s;
+}
+
+
+static void logDecode_site(osDbgBinRecHdr_t* pHdr, const uint8_t* rec)
+{
+	if(pHdr->siteId >= siteTableSize)
+	{
+		uint32_t newSize = pHdr->siteId + 256;
+		siteTable = realloc(siteTable, newSize * sizeof(logSite_t));
+		memset(&siteTable[siteTableSize], 0, (newSize - siteTableSize) * sizeof(logSite_t));
+		siteTableSize = newSize;
+	}
+
+	logSite_t* pSite = &siteTable[pHdr->siteId];
+	if(pSite->file)
+	{
+		free(pSite->file);
+		free(pSite->func);
+		free(pSite->levelStr);
+		free(pSite->fmt);
+	}
+
+	size_t pos = sizeof(osDbgBinRecHdr_t);
+	memcpy(&pSite->line, &rec[pos], sizeof(uint32_t));
+	pos += sizeof(uint32_t);
+	pSite->file = logDecode_dupStr(rec, pHdr->recLen, &pos);
+	pSite->func = logDecode_dupStr(rec, pHdr->recLen, &pos);
+	pSite->levelStr = logDecode_dupStr(rec, pHdr->recLen, &pos);
+	pSite->fmt = logDecode_dupStr(rec, pHdr->recLen, &pos);
+	pSite->isNoPrefix = pos < pHdr->recLen ? rec[pos] : false;
+	pSite->isValid = true;
+}
+
+
+static void logDecode_thread(osDbgBinRecHdr_t* pHdr, const uint8_t* rec)
+{
+	if(pHdr->threadIdx >= threadTableSize)
+	{
+		uint32_t newSize = pHdr->threadIdx + 64;
+		threadTable = realloc(threadTable, newSize * sizeof(uint64_t));
+		memset(&threadTable[threadTableSize], 0, (newSize - threadTableSize) * sizeof(uint64_t));
+		threadTableSize = newSize;
+	}
+
+	memcpy(&threadTable[pHdr->threadIdx], &rec[sizeof(osDbgBinRecHdr_t)], sizeof(uint64_t));
+}
+
+
+//the same prefix as the log macros in osDebug.h
+static void logDecode_prefix(osDbgBinRecHdr_t* pHdr, logSite_t* pSite)
+{
+	uint64_t usec = startRealUsec + (pHdr->usec - startMonoUsec);
+	time_t sec = usec / 1000000;
+	uint64_t tid = pHdr->threadIdx < threadTableSize ? threadTable[pHdr->threadIdx] : 0;
+	struct tm d;
+
+	gmtime_r(&sec, &d);
+	if(pSite->levelStr[0])
+	{
+		printf("%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d, %s] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, (long)(usec % 1000000), tid, pSite->file, pSite->func, pSite->line, pSite->levelStr);
+	}
+	else
+	{
+		printf("%d/%02d/%02d %02d:%02d:%02d.%-6ld:0x%lx[%s:%s:%d] ", d.tm_year+1900, d.tm_mon+1, d.tm_mday, d.tm_hour, d.tm_min, d.tm_sec, (long)(usec % 1000000), tid, pSite->file, pSite->func, pSite->line);
+	}
+}
+
+
+/* render the raw arguments using the site fmt.  Each conversion is printed by osPrintf() with the original
+ * flags and width, and with the length modifier adjusted to the stored argument type */
+static void logDecode_args(const char* fmt, const uint8_t* rec, size_t recLen, size_t pos)
+{
+	char spec[32];
+	size_t specLen = 0;
+	const char *p, *p0 = fmt;
+	const uint8_t* str;
+	uint16_t strLen;
+	bool fm = false;
+	int64_t n;
+	double dbl;
+
+	for(p = fmt; *p; p++)
+	{
+		if(!fm)
+		{
+			if(*p != '%')
+			{
+				continue;
+			}
+
+			if(p > p0)
+			{
+				fwrite(p0, 1, p - p0, stdout);
+			}
+			spec[0] = '%';
+			specLen = 1;
+			fm = true;
+			continue;
+		}
+
+		fm = false;
+		switch(*p)
+		{
+			case '-':
+			case '.':
+			case '0' ... '9':
+				if(specLen < sizeof(spec) - 4)
+				{
+					spec[specLen++] = *p;
+				}
+				fm = true;
+				break;
+			case 'l':
+			case 'z':
+				fm = true;
+				break;
+			case '%':
+				fputc('%', stdout);
+				break;
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'x':
+			case 'X':
+				if(pos + sizeof(int64_t) > recLen)
+				{
+					goto TRUNCATED;
+				}
+				memcpy(&n, &rec[pos], sizeof(int64_t));
+				pos += sizeof(int64_t);
+				spec[specLen++] = 'l';
+				spec[specLen++] = 'l';
+				spec[specLen++] = *p;
+				spec[specLen] = '\0';
+				osPrintf(stdout, spec, n);
+				break;
+			case 'c':
+			case 'm':
+			case 'p':
+				if(pos + sizeof(int64_t) > recLen)
+				{
+					goto TRUNCATED;
+				}
+				memcpy(&n, &rec[pos], sizeof(int64_t));
+				pos += sizeof(int64_t);
+				spec[specLen++] = *p;
+				spec[specLen] = '\0';
+				if(*p == 'p')
+				{
+					osPrintf(stdout, spec, (void*)(intptr_t)n);
+				}
+				else
+				{
+					osPrintf(stdout, spec, (int)n);
+				}
+				break;
+			case 'f':
+			case 'F':
+				if(pos + sizeof(double) > recLen)
+				{
+					goto TRUNCATED;
+				}
+				memcpy(&dbl, &rec[pos], sizeof(double));
+				pos += sizeof(double);
+				spec[specLen++] = *p;
+				spec[specLen] = '\0';
+				osPrintf(stdout, spec, dbl);
+				break;
+			case 's':
+			case 'r':
+			case 'b':
+			case 'M':
+				if(!logDecode_getStr(rec, recLen, &pos, &str, &strLen))
+				{
+					goto TRUNCATED;
+				}
+				spec[specLen++] = 'b';
+				spec[specLen] = '\0';
+				osPrintf(stdout, spec, str, (size_t)strLen);
+				break;
+			default:
+				//the writer would have used a text record for this fmt
+				fputc('?', stdout);
+				break;
+		}
+
+		if(!fm)
+		{
+			p0 = p + 1;
+		}
+	}
+
+	if(!fm && p > p0)
+	{
+		fwrite(p0, 1, p - p0, stdout);
+	}
+	return;
+
+TRUNCATED:
+	printf("<truncated>");
+}